@@ -0,0 +1,1363 @@
+/**
+ * \file Bench.c
+ * \brief Benchmark suite of the enumerators and indexes on synthetic images
+ * \author Tomtombinary
+ * \version 1.0
+ * \date 17 octobre 2026
+ * pebench [--quick] [--pe32] [--repeat N] [--filter TEXT] [--json FILE] [--compare FILE] [--threshold PERCENT] [--workdir DIR]
+ * Each benchmark is run once to warm up, then N times: the fastest run is
+ * reported as ns/entry and bytes/s. --json writes one JSON object per line,
+ * --compare reads such a file and exits with 2 when a benchmark is slower
+ * than the baseline by more than the threshold (10% by default).
+ * pebench exits with 3 when a malformed image of the validation suite isn't
+ * rejected with the expected PE_ERROR_* code, or a valid one is rejected.
+ * Variants "callback" use the HMODULE functions, which parse the headers
+ * again on each call, variants "image" use a PE_IMAGE initialized once.
+ */
+
+#include "stdafx.h"
+#include "SynthPE.h"
+#include "PETraits.h"
+#include "BulkEnum.h"
+#include "SectionIndex.h"
+#include "RelocIndex.h"
+#include "ExportIndex.h"
+#include "Validate.h"
+#include "MemUtils.h"
+#include "CpuUtils.h"
+#include "ThreadUtils.h"
+#include "FileUtils.h"
+#include "Rebase.h"
+#include "Scanner.h"
+#include "SparseLoader.h"
+#include "Instrument.h"
+#include "Binder.h"
+#include "Resource.h"
+#include "StringScan.h"
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#define BENCH_MAX_RESULTS 128
+#define BENCH_CHUNK 1024
+
+typedef struct _BENCH_RESULT
+{
+	char Name[64];
+	char Variant[64];
+	ULONGLONG nEntries;
+	ULONGLONG nBytes;
+	double Nanoseconds;
+}BENCH_RESULT,*PBENCH_RESULT;
+
+typedef struct _BENCH_STATE
+{
+	BOOL bQuick;
+	BOOL bPE32;
+	DWORD nRepeat;
+	LPCSTR Filter;
+	LPCSTR WorkDirectory;
+	FILE* Json;
+	BENCH_RESULT Results[BENCH_MAX_RESULTS];
+	DWORD nResults;
+	DWORD nFailures;
+}BENCH_STATE,*PBENCH_STATE;
+
+/* workload of a benchmark: the image, its buffer and precomputed inputs */
+typedef struct _BENCH_WORKLOAD
+{
+	SYNTH_CONFIG Config;
+	PBYTE Buffer;
+	SIZE_T Size;
+	PE_IMAGE Image;
+	DWORD nQueries;
+	PDWORD RVAs;
+	PDWORD Offsets;
+	LPCSTR* Types;
+	LPCSTR* Names;
+	DWORD Iterations;
+	ULONGLONG Base;
+	DWORD nThreads;
+	LPCSTR Path;
+	DWORD Tables;
+	PFILE_READER Reader;
+	ULONGLONG nBytesRead;
+	PPE_IMAGE Images;
+	DWORD nImages;
+	PBINDER Binder;
+	DWORD StringFlags;
+	ULONGLONG nReferences;
+}BENCH_WORKLOAD,*PBENCH_WORKLOAD;
+
+/* runs the measured operation once, returns the number of entries processed */
+typedef ULONGLONG(*BenchFunction)(PBENCH_WORKLOAD Workload);
+
+static ULONGLONG Bench_Now(VOID)
+{
+	struct timespec Time;
+	clock_gettime(CLOCK_MONOTONIC, &Time);
+	return (ULONGLONG)Time.tv_sec * 1000000000ULL + (ULONGLONG)Time.tv_nsec;
+}
+
+static VOID Bench_Report(PBENCH_STATE State, LPCSTR Name, LPCSTR Variant, ULONGLONG nEntries, ULONGLONG nBytes, double Nanoseconds)
+{
+	double NsPerEntry = nEntries != 0 ? Nanoseconds / (double)nEntries : 0.0;
+	double BytesPerSecond = Nanoseconds > 0.0 ? (double)nBytes * 1e9 / Nanoseconds : 0.0;
+	PBENCH_RESULT Result;
+
+	printf("%-20s %-16s %12llu %12.2f ns/entry %12.1f MB/s\n", Name, Variant, (unsigned long long)nEntries, NsPerEntry, BytesPerSecond / 1e6);
+	fflush(stdout);
+	if (State->Json != NULL)
+		fprintf(State->Json, "{\"name\":\"%s\",\"variant\":\"%s\",\"entries\":%llu,\"bytes\":%llu,\"ns\":%.0f,\"ns_per_entry\":%.4f,\"bytes_per_sec\":%.0f}\n",
+			Name, Variant, (unsigned long long)nEntries, (unsigned long long)nBytes, Nanoseconds, NsPerEntry, BytesPerSecond);
+	if (State->nResults < BENCH_MAX_RESULTS)
+	{
+		Result = &State->Results[State->nResults++];
+		snprintf(Result->Name, sizeof(Result->Name), "%s", Name);
+		snprintf(Result->Variant, sizeof(Result->Variant), "%s", Variant);
+		Result->nEntries = nEntries;
+		Result->nBytes = nBytes;
+		Result->Nanoseconds = Nanoseconds;
+	}
+}
+
+/* warm up, then keep the fastest of the runs */
+static VOID Bench_Measure(PBENCH_STATE State, LPCSTR Name, LPCSTR Variant, BenchFunction Function, PBENCH_WORKLOAD Workload, ULONGLONG nBytes)
+{
+	ULONGLONG Best = ~0ULL;
+	ULONGLONG nEntries = 0;
+	ULONGLONG Start, Elapsed;
+
+	if (State->Filter != NULL && strstr(Name, State->Filter) == NULL)
+		return;
+	Function(Workload);
+	for (DWORD i = 0; i < State->nRepeat; i++)
+	{
+		Start = Bench_Now();
+		nEntries = Function(Workload);
+		Elapsed = Bench_Now() - Start;
+		if (Elapsed < Best)
+			Best = Elapsed;
+	}
+	Bench_Report(State, Name, Variant, nEntries, nBytes, (double)Best);
+}
+
+static BOOL Bench_IsSelected(PBENCH_STATE State, LPCSTR Name)
+{
+	return State->Filter == NULL || strstr(Name, State->Filter) != NULL;
+}
+
+static DWORD Bench_Random(PDWORD lpState)
+{
+	DWORD x = *lpState;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	*lpState = x;
+	return x;
+}
+
+static BOOL Bench_InitWorkload(PBENCH_WORKLOAD Workload, PSYNTH_CONFIG Config)
+{
+	memset(Workload, 0, sizeof(BENCH_WORKLOAD));
+	Workload->Config = *Config;
+	if (!Synth_BuildImage(Config, &Workload->Buffer, &Workload->Size))
+	{
+		fprintf(stderr, "can't generate the image\n");
+		return FALSE;
+	}
+	/* the buffer is its own image: HMODULE functions and PE_IMAGE see the same tables */
+	if (!PE32_InitImage(&Workload->Image, Workload->Buffer, Workload->Size, PE_LAYOUT_IMAGE))
+	{
+		fprintf(stderr, "generated image is invalid (error %u)\n", Workload->Image.Error);
+		free(Workload->Buffer);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+static VOID Bench_ReleaseWorkload(PBENCH_WORKLOAD Workload)
+{
+	PE32_CloseImage(&Workload->Image);
+	free(Workload->Buffer);
+	free(Workload->RVAs);
+	free(Workload->Offsets);
+	free((LPVOID)Workload->Types);
+	free((LPVOID)Workload->Names);
+	memset(Workload, 0, sizeof(BENCH_WORKLOAD));
+}
+
+/*
+ * enumerators
+ */
+
+static BOOL Bench_CallbackCountSection(PSECTION_ENTRY lpSectionEntry, LPVOID UserArgs)
+{
+	*(PULONGLONG)UserArgs += lpSectionEntry->header->VirtualAddress != 0;
+	return TRUE;
+}
+
+static BOOL Bench_CallbackCountExport(PEXPORT_ENTRY lpExportEntry, LPVOID UserArgs)
+{
+	*(PULONGLONG)UserArgs += lpExportEntry->Name != NULL;
+	return TRUE;
+}
+
+static BOOL Bench_CallbackCountImport(PIMPORT_ENTRY lpImportEntry, LPVOID UserArgs)
+{
+	*(PULONGLONG)UserArgs += lpImportEntry->Thunk64 != 0;
+	return TRUE;
+}
+
+static BOOL Bench_CallbackCountRelocation(PRELOC_ENTRY lpRelocEntry, LPVOID UserArgs)
+{
+	*(PULONGLONG)UserArgs += lpRelocEntry->Type != IMAGE_REL_BASED_ABSOLUTE;
+	return TRUE;
+}
+
+static ULONGLONG Bench_SectionsCallback(PBENCH_WORKLOAD Workload)
+{
+	ULONGLONG nCount = 0;
+	for (DWORD i = 0; i < Workload->Iterations; i++)
+		PE32_EnumSections((HMODULE)Workload->Buffer, Bench_CallbackCountSection, &nCount);
+	return nCount;
+}
+
+static ULONGLONG Bench_SectionsImage(PBENCH_WORKLOAD Workload)
+{
+	ULONGLONG nCount = 0;
+	for (DWORD i = 0; i < Workload->Iterations; i++)
+		PE32_EnumSectionsEx(&Workload->Image, Bench_CallbackCountSection, &nCount);
+	return nCount;
+}
+
+static ULONGLONG Bench_ExportsCallback(PBENCH_WORKLOAD Workload)
+{
+	ULONGLONG nCount = 0;
+	PE32_EnumExports((HMODULE)Workload->Buffer, Bench_CallbackCountExport, &nCount);
+	return nCount;
+}
+
+static ULONGLONG Bench_ExportsImage(PBENCH_WORKLOAD Workload)
+{
+	ULONGLONG nCount = 0;
+	PE32_EnumExportsEx(&Workload->Image, Bench_CallbackCountExport, &nCount);
+	return nCount;
+}
+
+static ULONGLONG Bench_ImportsCallback(PBENCH_WORKLOAD Workload)
+{
+	ULONGLONG nCount = 0;
+	PE32_EnumImports((HMODULE)Workload->Buffer, Bench_CallbackCountImport, &nCount);
+	return nCount;
+}
+
+static ULONGLONG Bench_ImportsImage(PBENCH_WORKLOAD Workload)
+{
+	ULONGLONG nCount = 0;
+	PE32_EnumImportsEx(&Workload->Image, Bench_CallbackCountImport, &nCount);
+	return nCount;
+}
+
+static ULONGLONG Bench_ImportsBulk(PBENCH_WORKLOAD Workload)
+{
+	IMPORT_CURSOR Cursor;
+	IMPORT_ARRAYS Arrays;
+	LPCSTR Names[BENCH_CHUNK];
+	ULONGLONG Thunks[BENCH_CHUNK];
+	ULONGLONG nCount = 0;
+	DWORD n;
+
+	memset(&Arrays, 0, sizeof(Arrays));
+	Arrays.Names = Names;
+	Arrays.Thunks = Thunks;
+	PE32_InitImportCursor(&Workload->Image, &Cursor);
+	while ((n = PE32_GetImports(&Workload->Image, &Cursor, &Arrays, BENCH_CHUNK)) != 0)
+		nCount += n;
+	return nCount;
+}
+
+static ULONGLONG Bench_RelocationsCallback(PBENCH_WORKLOAD Workload)
+{
+	ULONGLONG nCount = 0;
+	PE32_EnumRelocations((HMODULE)Workload->Buffer, Bench_CallbackCountRelocation, &nCount);
+	return nCount;
+}
+
+static ULONGLONG Bench_RelocationsImage(PBENCH_WORKLOAD Workload)
+{
+	ULONGLONG nCount = 0;
+	PE32_EnumRelocationsEx(&Workload->Image, Bench_CallbackCountRelocation, &nCount);
+	return nCount;
+}
+
+static ULONGLONG Bench_RelocationsBulk(PBENCH_WORKLOAD Workload)
+{
+	RELOC_CURSOR Cursor;
+	DWORD RVAs[BENCH_CHUNK];
+	BYTE Types[BENCH_CHUNK];
+	ULONGLONG nCount = 0;
+	DWORD n;
+
+	PE32_InitRelocCursor(&Workload->Image, &Cursor);
+	while ((n = PE32_GetRelocations(&Workload->Image, &Cursor, RVAs, Types, BENCH_CHUNK)) != 0)
+		nCount += n;
+	return nCount;
+}
+
+/*
+ * lookups
+ */
+
+static ULONGLONG Bench_RVAToOffsetCallback(PBENCH_WORKLOAD Workload)
+{
+	ULONGLONG Sum = 0;
+	for (DWORD i = 0; i < Workload->nQueries; i++)
+		Sum += PE32_RVAToFileOffset((HMODULE)Workload->Buffer, Workload->RVAs[i]);
+	Workload->Base = Sum;
+	return Workload->nQueries;
+}
+
+static ULONGLONG Bench_RVAToOffsetIndex(PBENCH_WORKLOAD Workload)
+{
+	ULONGLONG Sum = 0;
+	for (DWORD i = 0; i < Workload->nQueries; i++)
+		Sum += PE32_RVAToFileOffsetEx(&Workload->Image, Workload->RVAs[i]);
+	Workload->Base = Sum;
+	return Workload->nQueries;
+}
+
+static ULONGLONG Bench_RVAToOffsetBatch(PBENCH_WORKLOAD Workload)
+{
+	PE32_RVAToFileOffsetBatch(&Workload->Image, Workload->RVAs, Workload->Offsets, Workload->nQueries);
+	return Workload->nQueries;
+}
+
+static ULONGLONG Bench_SearchRelocationCallback(PBENCH_WORKLOAD Workload)
+{
+	RELOC_SEARCH Search;
+	ULONGLONG nFound = 0;
+
+	for (DWORD i = 0; i < Workload->Iterations; i++)
+	{
+		Search.RVA = Workload->RVAs[i];
+		nFound += PE32_SearchRelocation((HMODULE)Workload->Buffer, &Search);
+	}
+	Workload->Base = nFound;
+	return Workload->Iterations;
+}
+
+static ULONGLONG Bench_SearchRelocationIndex(PBENCH_WORKLOAD Workload)
+{
+	ULONGLONG nFound = 0;
+	BYTE Type;
+
+	for (DWORD i = 0; i < Workload->nQueries; i++)
+		nFound += PE32_LookupRelocation(&Workload->Image, Workload->RVAs[i], &Type);
+	Workload->Base = nFound;
+	return Workload->nQueries;
+}
+
+typedef struct _BENCH_FIND_NAME
+{
+	LPCSTR Name;
+	BOOL bFound;
+}BENCH_FIND_NAME,*PBENCH_FIND_NAME;
+
+static BOOL Bench_CallbackFindExport(PEXPORT_ENTRY lpExportEntry, LPVOID UserArgs)
+{
+	PBENCH_FIND_NAME Find = (PBENCH_FIND_NAME)UserArgs;
+	Find->bFound = strcmp(lpExportEntry->Name, Find->Name) == 0;
+	return !Find->bFound;
+}
+
+static ULONGLONG Bench_FindExportEnum(PBENCH_WORKLOAD Workload)
+{
+	BENCH_FIND_NAME Find;
+	ULONGLONG nFound = 0;
+
+	for (DWORD i = 0; i < Workload->Iterations; i++)
+	{
+		Find.Name = Workload->Names[i];
+		Find.bFound = FALSE;
+		PE32_EnumExportsEx(&Workload->Image, Bench_CallbackFindExport, &Find);
+		nFound += Find.bFound;
+	}
+	Workload->Base = nFound;
+	return Workload->Iterations;
+}
+
+static ULONGLONG Bench_FindExportName(PBENCH_WORKLOAD Workload)
+{
+	EXPORT_ENTRY Entry;
+	ULONGLONG nFound = 0;
+
+	for (DWORD i = 0; i < Workload->nQueries; i++)
+		nFound += PE32_FindExportByName(&Workload->Image, Workload->Names[i], &Entry);
+	Workload->Base = nFound;
+	return Workload->nQueries;
+}
+
+/*
+ * validation, scans, checksum, rebase
+ */
+
+static ULONGLONG Bench_ValidateHeaders(PBENCH_WORKLOAD Workload)
+{
+	PE_IMAGE Image;
+	for (DWORD i = 0; i < Workload->Iterations; i++)
+	{
+		PE32_InitImage(&Image, Workload->Buffer, Workload->Size, PE_LAYOUT_IMAGE);
+		PE32_CloseImage(&Image);
+	}
+	return Workload->Iterations;
+}
+
+static ULONGLONG Bench_ValidateTables(PBENCH_WORKLOAD Workload)
+{
+	PE_IMAGE Image;
+	DWORD dwError = PE_ERROR_SUCCESS;
+
+	for (DWORD i = 0; i < Workload->Iterations; i++)
+	{
+		if (!PE32_InitImage(&Image, Workload->Buffer, Workload->Size, PE_LAYOUT_IMAGE))
+			dwError = Image.Error;
+		else
+			dwError = PE32_ValidateImage(&Image);
+		PE32_CloseImage(&Image);
+	}
+	Workload->Base = dwError;
+	return Workload->Iterations;
+}
+
+static ULONGLONG Bench_FindNullDword(PBENCH_WORKLOAD Workload)
+{
+	return MemFindNullDword(Workload->Buffer, (DWORD)(Workload->Size / sizeof(DWORD)));
+}
+
+static ULONGLONG Bench_FindNullQword(PBENCH_WORKLOAD Workload)
+{
+	return MemFindNullQword(Workload->Buffer, (DWORD)(Workload->Size / sizeof(ULONGLONG)));
+}
+
+static ULONGLONG Bench_MemIsNull(PBENCH_WORKLOAD Workload)
+{
+	Workload->Base = MemIsNull(Workload->Buffer, (DWORD)Workload->Size);
+	return Workload->Size;
+}
+
+static ULONGLONG Bench_ChecksumKernel(PBENCH_WORKLOAD Workload)
+{
+	Workload->Base = PE32_ComputeChecksum(Workload->Buffer, Workload->Size);
+	return Workload->Size / sizeof(WORD);
+}
+
+/* checksum as usually written: carries folded after each word */
+static ULONGLONG Bench_ChecksumReference(PBENCH_WORKLOAD Workload)
+{
+	SIZE_T ChecksumOffset = (SIZE_T)((PBYTE)&Workload->Image.NtHeaders->OptionalHeader.CheckSum - Workload->Buffer);
+	DWORD Sum = 0;
+
+	for (SIZE_T i = 0; i + 1 < Workload->Size; i += sizeof(WORD))
+	{
+		if (i == ChecksumOffset || i == ChecksumOffset + 2)
+			continue;
+		Sum += *(PWORD)(Workload->Buffer + i);
+		Sum = (Sum & 0xFFFF) + (Sum >> 16);
+	}
+	if (Workload->Size & 1)
+		Sum += Workload->Buffer[Workload->Size - 1];
+	Sum = (Sum & 0xFFFF) + (Sum >> 16);
+	Workload->Base = Sum + (DWORD)Workload->Size;
+	return Workload->Size / sizeof(WORD);
+}
+
+static ULONGLONG Bench_Rebase(PBENCH_WORKLOAD Workload)
+{
+	REBASE_STATS Stats;
+	ULONGLONG NewBase = Workload->Config.bPE32Plus ? 0x7FF600000000ULL : 0x20000000ULL;
+
+	/* back and forth between two bases, each run applies every relocation */
+	if (Workload->Base == NewBase)
+		NewBase = Workload->Config.bPE32Plus ? 0x180000000ULL : 0x10000000ULL;
+	PE32_RebaseImage(&Workload->Image, NewBase, Workload->nThreads, 0, &Stats);
+	Workload->Base = NewBase;
+	return Stats.nFixups;
+}
+
+static ULONGLONG Bench_OpenSparse(PBENCH_WORKLOAD Workload)
+{
+	PE_IMAGE Image;
+	ULONGLONG nCount = 0;
+	ULONGLONG nBytesRead = 0;
+
+	if (PE32_OpenFileSparse(Workload->Path, Workload->Tables, Workload->Reader, &Image, &nBytesRead))
+	{
+		PE32_EnumExportsEx(&Image, Bench_CallbackCountExport, &nCount);
+		PE32_CloseImage(&Image);
+	}
+	Workload->nBytesRead = nBytesRead;
+	return nCount;
+}
+
+static ULONGLONG Bench_OpenMapped(PBENCH_WORKLOAD Workload)
+{
+	PE_IMAGE Image;
+	ULONGLONG nCount = 0;
+
+	if (PE32_OpenFile(Workload->Path, &Image))
+	{
+		PE32_EnumExportsEx(&Image, Bench_CallbackCountExport, &nCount);
+		Workload->nBytesRead = Image.Size;
+		PE32_CloseImage(&Image);
+	}
+	return nCount;
+}
+
+/* one search per import in the exporting image, as a loader without symbol table does */
+typedef struct _BENCH_BIND_SEARCH
+{
+	PBENCH_WORKLOAD Workload;
+	PPE_IMAGE Image;
+	ULONGLONG nResolved;
+}BENCH_BIND_SEARCH,*PBENCH_BIND_SEARCH;
+
+static BOOL Bench_CallbackSearchImport(PIMPORT_ENTRY lpImportEntry, LPVOID UserArgs)
+{
+	PBENCH_BIND_SEARCH Search = (PBENCH_BIND_SEARCH)UserArgs;
+	PBINDER Binder = Search->Workload->Binder;
+	DWORD Module = Binder_FindModule(Binder, (LPCSTR)PE32_RVAToPointer(Search->Image, lpImportEntry->pImportDesc->Name));
+	EXPORT_ENTRY Entry;
+	char DllName[BIND_MAX_NAME];
+	LPCSTR Dot;
+	BOOL bFound;
+
+	if (Module == BIND_NO_MODULE)
+		return TRUE;
+	if (lpImportEntry->pImportByName != NULL)
+		bFound = PE32_FindExportByName(Binder->Modules[Module].Image, (LPCSTR)lpImportEntry->pImportByName->Name, &Entry);
+	else
+		bFound = PE32_FindExportByOrdinal(Binder->Modules[Module].Image, (DWORD)(lpImportEntry->Thunk64 & 0xFFFF), &Entry);
+	for (DWORD i = 0; bFound && Entry.Forwarder != NULL && i < BIND_MAX_FORWARDS; i++)
+	{
+		Dot = strrchr(Entry.Forwarder, '.');
+		snprintf(DllName, sizeof(DllName), "%.*s", (int)(Dot - Entry.Forwarder), Entry.Forwarder);
+		Module = Binder_FindModule(Binder, DllName);
+		bFound = Module != BIND_NO_MODULE && PE32_FindExportByName(Binder->Modules[Module].Image, Dot + 1, &Entry);
+	}
+	Search->nResolved += bFound && Entry.Forwarder == NULL;
+	return TRUE;
+}
+
+static ULONGLONG Bench_BindSearch(PBENCH_WORKLOAD Workload)
+{
+	BENCH_BIND_SEARCH Search;
+
+	Search.Workload = Workload;
+	Search.nResolved = 0;
+	for (DWORD i = 0; i < Workload->nImages; i++)
+	{
+		Search.Image = &Workload->Images[i];
+		PE32_EnumImportsEx(Search.Image, Bench_CallbackSearchImport, &Search);
+	}
+	return Search.nResolved;
+}
+
+static ULONGLONG Bench_BindBuild(PBENCH_WORKLOAD Workload)
+{
+	BINDER Binder;
+	ULONGLONG nSymbols;
+
+	Binder_Init(&Binder);
+	for (DWORD i = 0; i < Workload->nImages; i++)
+		Binder_AddModule(&Binder, &Workload->Images[i], Workload->Images[i].Traits->GetImageBase(&Workload->Images[i]), NULL);
+	Binder_Build(&Binder);
+	nSymbols = Binder.nSymbols;
+	Binder_Release(&Binder);
+	return nSymbols;
+}
+
+static ULONGLONG Bench_BindAll(PBENCH_WORKLOAD Workload)
+{
+	BIND_STATS Stats;
+
+	Binder_BindAll(Workload->Binder, &Stats);
+	return Stats.nImports;
+}
+
+static WORD Bench_Upper(WORD Char)
+{
+	return Char >= 'a' && Char <= 'z' ? Char - 'a' + 'A' : Char;
+}
+
+/* directory entry matching a type or a name, searched linearly as a hand written walk does */
+static PIMAGE_RESOURCE_DIRECTORY_ENTRY Bench_WalkDirectory(PBYTE Directory, DWORD Offset, LPCSTR Name)
+{
+	PIMAGE_RESOURCE_DIRECTORY lpDirectory = (PIMAGE_RESOURCE_DIRECTORY)(Directory + Offset);
+	PIMAGE_RESOURCE_DIRECTORY_ENTRY Entries = (PIMAGE_RESOURCE_DIRECTORY_ENTRY)(lpDirectory + 1);
+	PIMAGE_RESOURCE_DIR_STRING_U String;
+	DWORD nEntries = (DWORD)lpDirectory->NumberOfNamedEntries + lpDirectory->NumberOfIdEntries;
+	DWORD Length, c;
+
+	for (DWORD i = 0; i < nEntries; i++)
+	{
+		if (IS_INTRESOURCE(Name))
+		{
+			if (Entries[i].Name == (DWORD)(ULONG_PTR)Name)
+				return &Entries[i];
+			continue;
+		}
+		if (!(Entries[i].Name & IMAGE_RESOURCE_NAME_IS_STRING))
+			continue;
+		String = (PIMAGE_RESOURCE_DIR_STRING_U)(Directory + (Entries[i].Name & ~IMAGE_RESOURCE_NAME_IS_STRING));
+		Length = (DWORD)strlen(Name);
+		for (c = 0; c < Length && c < String->Length && Bench_Upper((BYTE)Name[c]) == Bench_Upper(String->NameString[c]); c++);
+		if (c == Length && c == String->Length)
+			return &Entries[i];
+	}
+	return NULL;
+}
+
+static ULONGLONG Bench_FindResourceWalk(PBENCH_WORKLOAD Workload)
+{
+	PBYTE Directory = (PBYTE)Workload->Image.Directories[IMAGE_DIRECTORY_ENTRY_RESOURCE].Data;
+	PIMAGE_RESOURCE_DIRECTORY_ENTRY Entry;
+	PIMAGE_RESOURCE_DIRECTORY Languages;
+	PIMAGE_RESOURCE_DATA_ENTRY Data;
+	ULONGLONG nFound = 0;
+
+	for (DWORD i = 0; i < Workload->Iterations; i++)
+	{
+		Entry = Bench_WalkDirectory(Directory, 0, Workload->Types[i]);
+		if (Entry != NULL)
+			Entry = Bench_WalkDirectory(Directory, Entry->OffsetToData & ~IMAGE_RESOURCE_DATA_IS_DIRECTORY, Workload->Names[i]);
+		if (Entry == NULL)
+			continue;
+		/* first language */
+		Languages = (PIMAGE_RESOURCE_DIRECTORY)(Directory + (Entry->OffsetToData & ~IMAGE_RESOURCE_DATA_IS_DIRECTORY));
+		Entry = (PIMAGE_RESOURCE_DIRECTORY_ENTRY)(Languages + 1);
+		Data = (PIMAGE_RESOURCE_DATA_ENTRY)(Directory + Entry->OffsetToData);
+		nFound += PE32_RVAToPointerRange(&Workload->Image, Data->OffsetToData, Data->Size) != NULL;
+	}
+	Workload->Base = nFound;
+	return Workload->Iterations;
+}
+
+static ULONGLONG Bench_FindResourceIndex(PBENCH_WORKLOAD Workload)
+{
+	RESOURCE_ENTRY Entry;
+	ULONGLONG nFound = 0;
+
+	for (DWORD i = 0; i < Workload->nQueries; i++)
+		nFound += PE32_FindResource(&Workload->Image, Workload->Types[i], Workload->Names[i], RESOURCE_ANY_LANGUAGE, &Entry) && Entry.Data != NULL;
+	Workload->Base = nFound;
+	return Workload->nQueries;
+}
+
+static BOOL Bench_CallbackCountResource(PRESOURCE_ENTRY lpResourceEntry, LPVOID UserArgs)
+{
+	*(PULONGLONG)UserArgs += lpResourceEntry->Data != NULL;
+	return TRUE;
+}
+
+static ULONGLONG Bench_EnumResources(PBENCH_WORKLOAD Workload)
+{
+	ULONGLONG nCount = 0;
+	PE32_EnumResources(&Workload->Image, NULL, Bench_CallbackCountResource, &nCount);
+	return nCount;
+}
+
+/* whole tree materialized on a new image each iteration */
+static ULONGLONG Bench_BuildResourceTree(PBENCH_WORKLOAD Workload)
+{
+	PE_IMAGE Image;
+	ULONGLONG nCount = 0;
+
+	for (DWORD i = 0; i < Workload->Iterations; i++)
+	{
+		if (!PE32_InitImage(&Image, Workload->Buffer, Workload->Size, PE_LAYOUT_IMAGE))
+			continue;
+		if (PE32_BuildResourceIndex(&Image, TRUE))
+			nCount += Image.ResourceIndex->nEntries;
+		PE32_CloseImage(&Image);
+	}
+	return nCount;
+}
+
+static BOOL Bench_IsPrintable(BYTE b)
+{
+	return (b >= 0x20 && b <= 0x7E) || b == '\t';
+}
+
+/* strings as usually extracted: one byte at a time, ASCII then UTF-16LE at even and odd offsets */
+static BOOL Bench_CallbackStringsReference(PSECTION_ENTRY lpSectionEntry, LPVOID UserArgs)
+{
+	PBENCH_WORKLOAD Workload = (PBENCH_WORKLOAD)UserArgs;
+	PBYTE Data = lpSectionEntry->SectionData;
+	SIZE_T Size = lpSectionEntry->SectionLimit > (ULONG_PTR)Data ? (SIZE_T)(lpSectionEntry->SectionLimit - (ULONG_PTR)Data) : 0;
+	DWORD Length = 0;
+
+	for (SIZE_T i = 0; i < Size; i++)
+	{
+		if (Bench_IsPrintable(Data[i]))
+			Length++;
+		else
+		{
+			Workload->Base += Length >= STRING_DEFAULT_MIN_LENGTH;
+			Length = 0;
+		}
+	}
+	Workload->Base += Length >= STRING_DEFAULT_MIN_LENGTH;
+	for (SIZE_T Parity = 0; Parity < 2; Parity++)
+	{
+		Length = 0;
+		for (SIZE_T i = Parity; i + 1 < Size; i += 2)
+		{
+			if (Bench_IsPrintable(Data[i]) && Data[i + 1] == 0)
+				Length++;
+			else
+			{
+				Workload->Base += Length >= STRING_DEFAULT_MIN_LENGTH;
+				Length = 0;
+			}
+		}
+		Workload->Base += Length >= STRING_DEFAULT_MIN_LENGTH;
+	}
+	return TRUE;
+}
+
+static BOOL Bench_CallbackStrings(PSECTION_ENTRY lpSectionEntry, LPVOID UserArgs)
+{
+	static STRING_CURSOR Cursor;
+	static STRING_ENTRY Entries[BENCH_CHUNK];
+	PBENCH_WORKLOAD Workload = (PBENCH_WORKLOAD)UserArgs;
+	DWORD n;
+
+	if (!PE32_InitStringCursor(&Workload->Image, lpSectionEntry, 0, Workload->StringFlags, &Cursor))
+		return FALSE;
+	while ((n = PE32_GetStrings(&Cursor, Entries, BENCH_CHUNK)) != 0)
+	{
+		Workload->Base += n;
+		for (DWORD i = 0; i < n; i++)
+			Workload->nReferences += Entries[i].References != 0;
+	}
+	return TRUE;
+}
+
+static ULONGLONG Bench_StringsReference(PBENCH_WORKLOAD Workload)
+{
+	Workload->Base = 0;
+	PE32_EnumSectionsEx(&Workload->Image, Bench_CallbackStringsReference, Workload);
+	return Workload->Base;
+}
+
+static ULONGLONG Bench_ExtractStrings(PBENCH_WORKLOAD Workload)
+{
+	Workload->Base = 0;
+	Workload->nReferences = 0;
+	PE32_EnumSectionsEx(&Workload->Image, Bench_CallbackStrings, Workload);
+	return Workload->Base;
+}
+
+/*
+ * suites
+ */
+
+static VOID Bench_GetEnumConfig(PBENCH_STATE State, PSYNTH_CONFIG Config)
+{
+	Synth_DefaultConfig(Config);
+	Config->bPE32Plus = !State->bPE32;
+	Config->nSections = State->bQuick ? 16 : 96;
+	Config->nImportDescriptors = State->bQuick ? 16 : 64;
+	Config->nThunks = State->bQuick ? 256 : 4096;
+	Config->nExports = State->bQuick ? 10000 : 100000;
+	Config->nRelocations = State->bQuick ? 200000 : 4000000;
+	Config->RelocDensity = 256;
+}
+
+static VOID Bench_Enumerators(PBENCH_STATE State)
+{
+	BENCH_WORKLOAD Workload;
+	SYNTH_CONFIG Config;
+	ULONGLONG ThunkSize, ImportBytes;
+
+	Bench_GetEnumConfig(State, &Config);
+	if (!Bench_InitWorkload(&Workload, &Config))
+		return;
+	ThunkSize = Config.bPE32Plus ? 8 : 4;
+	ImportBytes = (ULONGLONG)Config.nImportDescriptors * Config.nThunks * ThunkSize;
+
+	Workload.Iterations = State->bQuick ? 1000 : 10000;
+	Bench_Measure(State, "enum_sections", "callback", Bench_SectionsCallback, &Workload, (ULONGLONG)Workload.Iterations * Workload.Image.nSections * sizeof(IMAGE_SECTION_HEADER));
+	Bench_Measure(State, "enum_sections", "image", Bench_SectionsImage, &Workload, (ULONGLONG)Workload.Iterations * Workload.Image.nSections * sizeof(IMAGE_SECTION_HEADER));
+	Bench_Measure(State, "enum_exports", "callback", Bench_ExportsCallback, &Workload, Workload.Image.Directories[IMAGE_DIRECTORY_ENTRY_EXPORT].Size);
+	Bench_Measure(State, "enum_exports", "image", Bench_ExportsImage, &Workload, Workload.Image.Directories[IMAGE_DIRECTORY_ENTRY_EXPORT].Size);
+	Bench_Measure(State, "enum_imports", "callback", Bench_ImportsCallback, &Workload, ImportBytes);
+	Bench_Measure(State, "enum_imports", "image", Bench_ImportsImage, &Workload, ImportBytes);
+	Bench_Measure(State, "enum_imports", "bulk", Bench_ImportsBulk, &Workload, ImportBytes);
+	Bench_Measure(State, "enum_relocations", "callback", Bench_RelocationsCallback, &Workload, Workload.Image.Directories[IMAGE_DIRECTORY_ENTRY_BASERELOC].Size);
+	Bench_Measure(State, "enum_relocations", "image", Bench_RelocationsImage, &Workload, Workload.Image.Directories[IMAGE_DIRECTORY_ENTRY_BASERELOC].Size);
+	Bench_Measure(State, "enum_relocations", "bulk", Bench_RelocationsBulk, &Workload, Workload.Image.Directories[IMAGE_DIRECTORY_ENTRY_BASERELOC].Size);
+	Bench_ReleaseWorkload(&Workload);
+}
+
+static VOID Bench_Lookups(PBENCH_STATE State)
+{
+	BENCH_WORKLOAD Workload;
+	SYNTH_CONFIG Config;
+	RELOC_CURSOR Cursor;
+	DWORD Seed = 12345;
+	DWORD nRelocations = 0;
+	PDWORD Relocations;
+	PCHAR NamePool;
+
+	Bench_GetEnumConfig(State, &Config);
+	if (!Bench_InitWorkload(&Workload, &Config))
+		return;
+	Workload.nQueries = State->bQuick ? 100000 : 1000000;
+	Workload.RVAs = (PDWORD)malloc(Workload.nQueries * sizeof(DWORD));
+	Workload.Offsets = (PDWORD)malloc(Workload.nQueries * sizeof(DWORD));
+	Workload.Names = (LPCSTR*)malloc(Workload.nQueries * sizeof(LPCSTR));
+	NamePool = (PCHAR)malloc((SIZE_T)Workload.nQueries * 24);
+	Relocations = (PDWORD)malloc((SIZE_T)Config.nRelocations * sizeof(DWORD));
+	if (Workload.RVAs == NULL || Workload.Offsets == NULL || Workload.Names == NULL || NamePool == NULL || Relocations == NULL)
+	{
+		free(NamePool);
+		free(Relocations);
+		Bench_ReleaseWorkload(&Workload);
+		return;
+	}
+
+	/* RVAs spread over the whole image */
+	for (DWORD i = 0; i < Workload.nQueries; i++)
+		Workload.RVAs[i] = Bench_Random(&Seed) % (DWORD)Workload.Size;
+	Workload.Iterations = 0;
+	Bench_Measure(State, "rva_to_offset", "callback", Bench_RVAToOffsetCallback, &Workload, 0);
+	Bench_Measure(State, "rva_to_offset", "index", Bench_RVAToOffsetIndex, &Workload, 0);
+	Bench_Measure(State, "rva_to_offset", "batch", Bench_RVAToOffsetBatch, &Workload, 0);
+
+	/* RVAs of existing relocations, in random order */
+	PE32_InitRelocCursor(&Workload.Image, &Cursor);
+	while (nRelocations < Config.nRelocations)
+	{
+		DWORD n = PE32_GetRelocations(&Workload.Image, &Cursor, Relocations + nRelocations, NULL, Config.nRelocations - nRelocations);
+		if (n == 0)
+			break;
+		nRelocations += n;
+	}
+	for (DWORD i = 0; i < Workload.nQueries && nRelocations != 0; i++)
+		Workload.RVAs[i] = Relocations[Bench_Random(&Seed) % nRelocations];
+	/* linear search: a few queries are enough */
+	Workload.Iterations = State->bQuick ? 20 : 10;
+	if (Bench_IsSelected(State, "search_relocation"))
+		PE32_BuildRelocIndex(&Workload.Image);
+	Bench_Measure(State, "search_relocation", "callback", Bench_SearchRelocationCallback, &Workload, 0);
+	Bench_Measure(State, "search_relocation", "index", Bench_SearchRelocationIndex, &Workload, 0);
+
+	for (DWORD i = 0; i < Workload.nQueries; i++)
+	{
+		snprintf(NamePool + (SIZE_T)i * 24, 24, "Export_%08u", Bench_Random(&Seed) % Config.nExports);
+		Workload.Names[i] = NamePool + (SIZE_T)i * 24;
+	}
+	Workload.Iterations = State->bQuick ? 100 : 20;
+	Bench_Measure(State, "find_export", "enum", Bench_FindExportEnum, &Workload, 0);
+	Bench_Measure(State, "find_export", "binary", Bench_FindExportName, &Workload, 0);
+	if (Bench_IsSelected(State, "find_export"))
+	{
+		PE32_BuildExportIndex(&Workload.Image);
+		Bench_Measure(State, "find_export", "hash", Bench_FindExportName, &Workload, 0);
+	}
+
+	free(NamePool);
+	free(Relocations);
+	Bench_ReleaseWorkload(&Workload);
+}
+
+static VOID Bench_Validation(PBENCH_STATE State)
+{
+	static const struct
+	{
+		LPCSTR Variant;
+		DWORD Corruption;
+		DWORD Error;
+	}Cases[] = {
+		{ "tables", 0, PE_ERROR_SUCCESS },
+		{ "bad_exports", SYNTH_CORRUPT_EXPORTS, PE_ERROR_EXPORT_DIRECTORY },
+		{ "bad_imports", SYNTH_CORRUPT_IMPORTS, PE_ERROR_IMPORT_DIRECTORY },
+		{ "bad_relocs", SYNTH_CORRUPT_RELOCS, PE_ERROR_RELOC_DIRECTORY },
+		{ "bad_lfanew", SYNTH_CORRUPT_LFANEW, PE_ERROR_DOS_HEADER },
+		{ "reloc_block0", SYNTH_CORRUPT_RELOC_BLOCK, PE_ERROR_RELOC_DIRECTORY },
+		{ "reloc_truncated", SYNTH_CORRUPT_RELOC_TRUNCATED, PE_ERROR_RELOC_DIRECTORY },
+		{ "name_count", SYNTH_CORRUPT_NAME_COUNT, PE_ERROR_EXPORT_DIRECTORY },
+		{ "bad_ordinal", SYNTH_CORRUPT_ORDINAL, PE_ERROR_EXPORT_DIRECTORY }
+	};
+	BENCH_WORKLOAD Workload;
+	SYNTH_CONFIG Config;
+
+	if (!Bench_IsSelected(State, "validate"))
+		return;
+	Bench_GetEnumConfig(State, &Config);
+	for (DWORD i = 0; i < sizeof(Cases) / sizeof(Cases[0]); i++)
+	{
+		Config.Corruption = Cases[i].Corruption;
+		/* a malformed header is rejected by PE32_InitImage: the workload keeps the buffer only */
+		if (Config.Corruption & SYNTH_CORRUPT_LFANEW)
+		{
+			memset(&Workload, 0, sizeof(Workload));
+			if (!Synth_BuildImage(&Config, &Workload.Buffer, &Workload.Size))
+				return;
+		}
+		else if (!Bench_InitWorkload(&Workload, &Config))
+			return;
+		Workload.Iterations = 10;
+		if (i == 0)
+		{
+			Workload.Iterations = 100000;
+			Bench_Measure(State, "validate", "headers", Bench_ValidateHeaders, &Workload, 0);
+			Workload.Iterations = 10;
+		}
+		Bench_Measure(State, "validate", Cases[i].Variant, Bench_ValidateTables, &Workload, (ULONGLONG)Workload.Iterations * Workload.Size);
+		/* Base is the PE_ERROR_* code of the image */
+		if (Workload.Base != Cases[i].Error)
+		{
+			fprintf(stderr, "validate/%s: error %llu, %u expected\n", Cases[i].Variant, (unsigned long long)Workload.Base, Cases[i].Error);
+			State->nFailures++;
+		}
+		Bench_ReleaseWorkload(&Workload);
+	}
+}
+
+static VOID Bench_Scans(PBENCH_STATE State)
+{
+	BENCH_WORKLOAD Workload;
+	SYNTH_CONFIG Config;
+	SIZE_T Size;
+
+	if (!Bench_IsSelected(State, "scan") && !Bench_IsSelected(State, "checksum"))
+		return;
+	/* thunk arrays and blocks without terminator until the last element */
+	memset(&Workload, 0, sizeof(Workload));
+	Size = State->bQuick ? (8u << 20) : (64u << 20);
+	Workload.Buffer = (PBYTE)malloc(Size);
+	if (Workload.Buffer == NULL)
+		return;
+	memset(Workload.Buffer, 0x41, Size);
+	memset(Workload.Buffer + Size - sizeof(ULONGLONG), 0, sizeof(ULONGLONG));
+	Workload.Size = Size;
+	Bench_Measure(State, "scan_null", "dword", Bench_FindNullDword, &Workload, Size);
+	Bench_Measure(State, "scan_null", "qword", Bench_FindNullQword, &Workload, Size);
+	memset(Workload.Buffer, 0, Size);
+	Bench_Measure(State, "scan_null", "memisnull", Bench_MemIsNull, &Workload, Size);
+	free(Workload.Buffer);
+
+	Bench_GetEnumConfig(State, &Config);
+	if (!Bench_InitWorkload(&Workload, &Config))
+		return;
+	Bench_Measure(State, "checksum", "kernel", Bench_ChecksumKernel, &Workload, Workload.Size);
+	Bench_Measure(State, "checksum", "reference", Bench_ChecksumReference, &Workload, Workload.Size);
+	Bench_ReleaseWorkload(&Workload);
+}
+
+static VOID Bench_Rebases(PBENCH_STATE State)
+{
+	BENCH_WORKLOAD Workload;
+	SYNTH_CONFIG Config;
+	char Variant[32];
+	DWORD nProcessors = ThreadUtils_GetProcessorCount();
+
+	if (!Bench_IsSelected(State, "rebase"))
+		return;
+	Bench_GetEnumConfig(State, &Config);
+	/* adjacent slots: dense runs of the rebase engine */
+	Config.RelocDensity = Config.bPE32Plus ? 512 : 1024;
+	if (!Bench_InitWorkload(&Workload, &Config))
+		return;
+	Workload.Base = Workload.Image.Traits->GetImageBase(&Workload.Image);
+	Workload.nThreads = 1;
+	Bench_Measure(State, "rebase", "dense_1thread", Bench_Rebase, &Workload, (ULONGLONG)Config.nRelocations * (Config.bPE32Plus ? 8 : 4));
+	if (nProcessors > 1)
+	{
+		Workload.nThreads = nProcessors;
+		snprintf(Variant, sizeof(Variant), "dense_%uthreads", nProcessors);
+		Bench_Measure(State, "rebase", Variant, Bench_Rebase, &Workload, (ULONGLONG)Config.nRelocations * (Config.bPE32Plus ? 8 : 4));
+	}
+	Bench_ReleaseWorkload(&Workload);
+
+	Config.RelocDensity = 16;
+	if (!Bench_InitWorkload(&Workload, &Config))
+		return;
+	Workload.Base = Workload.Image.Traits->GetImageBase(&Workload.Image);
+	Workload.nThreads = 1;
+	Bench_Measure(State, "rebase", "sparse_1thread", Bench_Rebase, &Workload, (ULONGLONG)Config.nRelocations * (Config.bPE32Plus ? 8 : 4));
+	Bench_ReleaseWorkload(&Workload);
+}
+
+/* set of DLLs importing each other, with forwarder chains */
+static VOID Bench_Binding(PBENCH_STATE State)
+{
+	BENCH_WORKLOAD Workload;
+	SYNTH_CONFIG Config;
+	BINDER Binder;
+	PBYTE* Buffers;
+	SIZE_T Size;
+	DWORD nModules = State->bQuick ? 100 : 300;
+	DWORD nBuilt = 0;
+
+	if (!Bench_IsSelected(State, "bind"))
+		return;
+	memset(&Workload, 0, sizeof(Workload));
+	Buffers = (PBYTE*)calloc(nModules, sizeof(PBYTE));
+	Workload.Images = (PPE_IMAGE)calloc(nModules, sizeof(PE_IMAGE));
+	Binder_Init(&Binder);
+	if (Buffers == NULL || Workload.Images == NULL)
+		goto Release;
+	Synth_DefaultConfig(&Config);
+	Config.bPE32Plus = !State->bPE32;
+	Config.nSections = 4;
+	Config.nImportDescriptors = 8;
+	Config.nThunks = 128;
+	Config.nExports = 2000;
+	Config.nRelocations = 1000;
+	Config.nModules = nModules;
+	Config.ForwarderRate = 16;
+	for (; nBuilt < nModules; nBuilt++)
+	{
+		Config.ModuleIndex = nBuilt;
+		Config.Seed = nBuilt + 1;
+		if (!Synth_BuildImage(&Config, &Buffers[nBuilt], &Size))
+			goto Release;
+		if (!PE32_InitImage(&Workload.Images[nBuilt], Buffers[nBuilt], Size, PE_LAYOUT_IMAGE))
+		{
+			free(Buffers[nBuilt]);
+			goto Release;
+		}
+		Binder_AddModule(&Binder, &Workload.Images[nBuilt], Workload.Images[nBuilt].Traits->GetImageBase(&Workload.Images[nBuilt]), NULL);
+	}
+	Workload.nImages = nModules;
+	if (!Binder_Build(&Binder))
+		goto Release;
+	Workload.Binder = &Binder;
+
+	/* the search reads the IATs as lookup tables: measured before they are bound */
+	Bench_Measure(State, "bind", "search", Bench_BindSearch, &Workload, 0);
+	Bench_Measure(State, "bind", "build_table", Bench_BindBuild, &Workload, 0);
+	Bench_Measure(State, "bind", "bind_all", Bench_BindAll, &Workload, 0);
+
+Release:
+	if (nBuilt != nModules)
+		fprintf(stderr, "can't generate the set of modules\n");
+	Binder_Release(&Binder);
+	for (DWORD i = 0; i < nBuilt; i++)
+	{
+		PE32_CloseImage(&Workload.Images[i]);
+		free(Buffers[i]);
+	}
+	free(Workload.Images);
+	free(Buffers);
+}
+
+/* installer with tens of thousands of resources, looked up by type and name */
+static VOID Bench_Resources(PBENCH_STATE State)
+{
+	static const WORD Types[] = { RESOURCE_TYPE_ICON, RESOURCE_TYPE_STRING, RESOURCE_TYPE_RCDATA, RESOURCE_TYPE_GROUP_ICON };
+	BENCH_WORKLOAD Workload;
+	SYNTH_CONFIG Config;
+	DWORD Seed = 54321;
+	DWORD nPerType, n;
+	PCHAR NamePool;
+
+	if (!Bench_IsSelected(State, "find_resource") && !Bench_IsSelected(State, "enum_resources") && !Bench_IsSelected(State, "build_resources"))
+		return;
+	Synth_DefaultConfig(&Config);
+	Config.bPE32Plus = !State->bPE32;
+	Config.nSections = 8;
+	Config.nExports = 100;
+	Config.nResources = State->bQuick ? 20000 : 100000;
+	if (!Bench_InitWorkload(&Workload, &Config))
+		return;
+	/* one type out of five is "FILES", named FILE_000000...: the others use identifiers */
+	nPerType = (Config.nResources - 2) / 5;
+	Workload.nQueries = State->bQuick ? 100000 : 1000000;
+	Workload.Types = (LPCSTR*)malloc(Workload.nQueries * sizeof(LPCSTR));
+	Workload.Names = (LPCSTR*)malloc(Workload.nQueries * sizeof(LPCSTR));
+	NamePool = (PCHAR)malloc((SIZE_T)Workload.nQueries * 16);
+	if (Workload.Types == NULL || Workload.Names == NULL || NamePool == NULL)
+	{
+		free(NamePool);
+		Bench_ReleaseWorkload(&Workload);
+		return;
+	}
+	for (DWORD i = 0; i < Workload.nQueries; i++)
+	{
+		n = Bench_Random(&Seed) % nPerType;
+		if (i % 5 == 0)
+		{
+			snprintf(NamePool + (SIZE_T)i * 16, 16, "FILE_%06u", n);
+			Workload.Types[i] = "FILES";
+			Workload.Names[i] = NamePool + (SIZE_T)i * 16;
+		}
+		else
+		{
+			Workload.Types[i] = MAKEINTRESOURCEA(Types[i % 5 - 1]);
+			Workload.Names[i] = MAKEINTRESOURCEA(n + 1);
+		}
+	}
+
+	/* linear walk: a few queries are enough */
+	Workload.Iterations = State->bQuick ? 2000 : 5000;
+	Bench_Measure(State, "find_resource", "walk", Bench_FindResourceWalk, &Workload, 0);
+	Bench_Measure(State, "find_resource", "index", Bench_FindResourceIndex, &Workload, 0);
+	Bench_Measure(State, "enum_resources", "image", Bench_EnumResources, &Workload, Workload.Image.Directories[IMAGE_DIRECTORY_ENTRY_RESOURCE].Size);
+	Workload.Iterations = State->bQuick ? 20 : 10;
+	Bench_Measure(State, "build_resources", "full", Bench_BuildResourceTree, &Workload, (ULONGLONG)Workload.Iterations * Workload.Image.Directories[IMAGE_DIRECTORY_ENTRY_RESOURCE].Size);
+
+	free(NamePool);
+	Bench_ReleaseWorkload(&Workload);
+}
+
+/* .rdata full of strings between random bytes, as in a large application */
+static VOID Bench_Strings(PBENCH_STATE State)
+{
+	BENCH_WORKLOAD Workload;
+	SYNTH_CONFIG Config;
+	ULONGLONG nBytes, nReference;
+
+	if (!Bench_IsSelected(State, "strings"))
+		return;
+	Synth_DefaultConfig(&Config);
+	Config.bPE32Plus = !State->bPE32;
+	Config.nSections = 8;
+	Config.nImportDescriptors = 16;
+	Config.nThunks = 256;
+	Config.nExports = State->bQuick ? 2000 : 10000;
+	Config.nStrings = State->bQuick ? 20000 : 200000;
+	if (!Bench_InitWorkload(&Workload, &Config))
+		return;
+	nBytes = Workload.Size;
+	Bench_Measure(State, "strings", "reference", Bench_StringsReference, &Workload, nBytes);
+	nReference = Workload.Base;
+	Workload.StringFlags = STRING_ASCII | STRING_UTF16;
+	Bench_Measure(State, "strings", "masks", Bench_ExtractStrings, &Workload, nBytes);
+	if (Workload.Base != nReference)
+		fprintf(stderr, "strings/masks: %llu strings, %llu expected\n", (unsigned long long)Workload.Base, (unsigned long long)nReference);
+	Workload.StringFlags = STRING_ASCII | STRING_UTF16 | STRING_REFERENCES;
+	Bench_Measure(State, "strings", "references", Bench_ExtractStrings, &Workload, nBytes);
+	if (Workload.nReferences == 0)
+		fprintf(stderr, "strings/references: no string found in the import and export tables\n");
+	Bench_ReleaseWorkload(&Workload);
+}
+
+/* corpus of synthetic files written in a directory created for the run */
+static VOID Bench_Files(PBENCH_STATE State)
+{
+	BENCH_WORKLOAD Workload;
+	SYNTH_CONFIG Config;
+	SCANNER_CONFIG ScanConfig;
+	SCANNER_STATS Stats;
+	FILE_READER Reader;
+	PBYTE Buffer;
+	SIZE_T Size;
+	ULONGLONG nCorpusBytes = 0;
+	ULONGLONG Best;
+	DWORD nFiles = State->bQuick ? 32 : 256;
+	char Directory[512];
+	char Path[600];
+
+	if (!Bench_IsSelected(State, "scanner") && !Bench_IsSelected(State, "open_file"))
+		return;
+	snprintf(Directory, sizeof(Directory), "%s/pebench.XXXXXX", State->WorkDirectory);
+	if (mkdtemp(Directory) == NULL)
+	{
+		fprintf(stderr, "can't create a directory in %s\n", State->WorkDirectory);
+		return;
+	}
+
+	/* small and medium DLLs, one large image at the end */
+	for (DWORD i = 0; i <= nFiles; i++)
+	{
+		Synth_DefaultConfig(&Config);
+		Config.bPE32Plus = !State->bPE32;
+		Config.Seed = i + 1;
+		Config.nExports = 100 + (i % 16) * 500;
+		Config.nImportDescriptors = 4 + i % 24;
+		Config.nRelocations = 2000 + (i % 8) * 20000;
+		if (i == nFiles)
+			Bench_GetEnumConfig(State, &Config);
+		snprintf(Path, sizeof(Path), "%s/%s%04u.dll", Directory, i == nFiles ? "large" : "file", i);
+		if (!Synth_BuildImage(&Config, &Buffer, &Size))
+			break;
+		if (!FileUtils_WriteFile(Path, Buffer, Size))
+		{
+			free(Buffer);
+			break;
+		}
+		nCorpusBytes += Size;
+		free(Buffer);
+	}
+
+	memset(&ScanConfig, 0, sizeof(ScanConfig));
+	ScanConfig.Root = Directory;
+	if (Bench_IsSelected(State, "scanner"))
+	{
+		for (DWORD Sparse = 0; Sparse < 2; Sparse++)
+		{
+			ScanConfig.SparseTables = Sparse ? PE_TABLE_ALL : 0;
+			Best = ~0ULL;
+			memset(&Stats, 0, sizeof(Stats));
+			for (DWORD i = 0; i <= State->nRepeat; i++)
+			{
+				if (Scanner_Run(&ScanConfig, &Stats) && i != 0 && Stats.Microseconds * 1000 < Best)
+					Best = Stats.Microseconds * 1000;
+			}
+			/* bytes/s of the corpus, nBytes tells the I/O volume of the sparse mode */
+			Bench_Report(State, "scanner", Sparse ? "sparse" : "mapped", Stats.nFiles, nCorpusBytes, (double)Best);
+			printf("%-20s %-16s %llu of %llu bytes mapped or read\n", "", "", (unsigned long long)Stats.nBytes, (unsigned long long)nCorpusBytes);
+		}
+	}
+
+	if (Bench_IsSelected(State, "open_file"))
+	{
+		snprintf(Path, sizeof(Path), "%s/large%04u.dll", Directory, nFiles);
+		memset(&Workload, 0, sizeof(Workload));
+		Workload.Path = Path;
+		Bench_OpenMapped(&Workload);
+		Bench_Measure(State, "open_file", "mapped", Bench_OpenMapped, &Workload, Workload.nBytesRead);
+		FileUtils_InitReader(&Reader);
+		Workload.Reader = &Reader;
+		Workload.Tables = PE_TABLE_EXPORTS;
+		Bench_OpenSparse(&Workload);
+		Bench_Measure(State, "open_file", "sparse_exports", Bench_OpenSparse, &Workload, Workload.nBytesRead);
+		FileUtils_CloseReader(&Reader);
+	}
+
+	for (DWORD i = 0; i <= nFiles; i++)
+	{
+		snprintf(Path, sizeof(Path), "%s/%s%04u.dll", Directory, i == nFiles ? "large" : "file", i);
+		unlink(Path);
+	}
+	rmdir(Directory);
+}
+
+/*
+ * comparison with a baseline
+ */
+
+static int Bench_Compare(PBENCH_STATE State, LPCSTR Path, double Threshold)
+{
+	FILE* File = fopen(Path, "r");
+	char Line[512];
+	char Name[64], Variant[64];
+	double NsPerEntry;
+	int nRegressions = 0;
+
+	if (File == NULL)
+	{
+		fprintf(stderr, "can't read %s\n", Path);
+		return 1;
+	}
+	printf("\n%-20s %-16s %12s %12s %8s\n", "benchmark", "variant", "baseline", "current", "change");
+	while (fgets(Line, sizeof(Line), File) != NULL)
+	{
+		if (sscanf(Line, "{\"name\":\"%63[^\"]\",\"variant\":\"%63[^\"]\",\"entries\":%*u,\"bytes\":%*u,\"ns\":%*f,\"ns_per_entry\":%lf", Name, Variant, &NsPerEntry) != 3)
+			continue;
+		for (DWORD i = 0; i < State->nResults; i++)
+		{
+			PBENCH_RESULT Result = &State->Results[i];
+			double Current;
+			if (strcmp(Result->Name, Name) != 0 || strcmp(Result->Variant, Variant) != 0 || Result->nEntries == 0 || NsPerEntry <= 0.0)
+				continue;
+			Current = Result->Nanoseconds / (double)Result->nEntries;
+			printf("%-20s %-16s %12.2f %12.2f %+7.1f%%%s\n", Name, Variant, NsPerEntry, Current, (Current / NsPerEntry - 1.0) * 100.0,
+				Current > NsPerEntry * (1.0 + Threshold / 100.0) ? "  REGRESSION" : "");
+			nRegressions += Current > NsPerEntry * (1.0 + Threshold / 100.0);
+		}
+	}
+	fclose(File);
+	return nRegressions != 0 ? 2 : 0;
+}
+
+static VOID Bench_Usage(VOID)
+{
+	fprintf(stderr, "usage: pebench [--quick] [--pe32] [--repeat N] [--filter TEXT] [--json FILE] [--compare FILE] [--threshold PERCENT] [--workdir DIR]\n");
+}
+
+int main(int argc, char** argv)
+{
+	static BENCH_STATE State;
+	LPCSTR JsonPath = NULL;
+	LPCSTR ComparePath = NULL;
+	double Threshold = 10.0;
+
+	State.nRepeat = 5;
+	State.WorkDirectory = "/tmp";
+	for (int i = 1; i < argc; i++)
+	{
+		BOOL bValue = i + 1 < argc;
+		if (strcmp(argv[i], "--quick") == 0)
+			State.bQuick = TRUE;
+		else if (strcmp(argv[i], "--pe32") == 0)
+			State.bPE32 = TRUE;
+		else if (strcmp(argv[i], "--repeat") == 0 && bValue)
+			State.nRepeat = strtoul(argv[++i], NULL, 0);
+		else if (strcmp(argv[i], "--filter") == 0 && bValue)
+			State.Filter = argv[++i];
+		else if (strcmp(argv[i], "--json") == 0 && bValue)
+			JsonPath = argv[++i];
+		else if (strcmp(argv[i], "--compare") == 0 && bValue)
+			ComparePath = argv[++i];
+		else if (strcmp(argv[i], "--threshold") == 0 && bValue)
+			Threshold = atof(argv[++i]);
+		else if (strcmp(argv[i], "--workdir") == 0 && bValue)
+			State.WorkDirectory = argv[++i];
+		else
+		{
+			Bench_Usage();
+			return 1;
+		}
+	}
+	if (State.nRepeat == 0)
+		State.nRepeat = 1;
+	if (JsonPath != NULL)
+	{
+		State.Json = fopen(JsonPath, "w");
+		if (State.Json == NULL)
+		{
+			fprintf(stderr, "can't write %s\n", JsonPath);
+			return 1;
+		}
+		fprintf(State.Json, "{\"meta\":{\"quick\":%d,\"pe32\":%d,\"repeat\":%u,\"cpu_features\":%u,\"processors\":%u}}\n",
+			State.bQuick, State.bPE32, State.nRepeat, CpuUtils_GetFeatures(), ThreadUtils_GetProcessorCount());
+	}
+	printf("%s images, CPU features 0x%x, %u processors, best of %u runs\n", State.bPE32 ? "PE32" : "PE32+", CpuUtils_GetFeatures(), ThreadUtils_GetProcessorCount(), State.nRepeat);
+	printf("%-20s %-16s %12s\n", "benchmark", "variant", "entries");
+
+	Bench_Enumerators(&State);
+	Bench_Lookups(&State);
+	Bench_Validation(&State);
+	Bench_Scans(&State);
+	Bench_Rebases(&State);
+	Bench_Binding(&State);
+	Bench_Resources(&State);
+	Bench_Strings(&State);
+	Bench_Files(&State);
+
+	/* library built with PEUTILS_INSTRUMENT: work done by the probes during the run */
+	if (Instrument_IsEnabled())
+	{
+		INSTRUMENT_SNAPSHOT Snapshot;
+		Instrument_GetSnapshot(&Snapshot);
+		printf("\n");
+		Instrument_PrintSnapshot(stdout, &Snapshot);
+	}
+
+	if (State.Json != NULL)
+		fclose(State.Json);
+	if (State.nFailures != 0)
+	{
+		fprintf(stderr, "%u validation failures\n", State.nFailures);
+		return 3;
+	}
+	if (ComparePath != NULL)
+		return Bench_Compare(&State, ComparePath, Threshold);
+	return 0;
+}
@@ -0,0 +1,124 @@
+/**
+ * \file PEGen.c
+ * \brief Command line generator of synthetic PE files
+ * \author Tomtombinary
+ * \version 1.0
+ * \date 17 octobre 2026
+ * pegen [options] output.dll
+ *   --pe32              PE32 image (default PE32+)
+ *   --sections N        number of sections
+ *   --imports DxT       D import descriptors of T thunks
+ *   --exports N         named exports
+ *   --relocs N          relocations
+ *   --density N         relocations per page
+ *   --corrupt LIST      exports,imports,relocs,lfanew,block0,truncated,namecount,ordinal: malformed headers and tables
+ *   --seed N            seed of the pseudo-random RVAs
+ *   --module I/N        module I of a set of N modules importing each other
+ *   --forwarders R      in a set, 2 exports out of R forwarded to the next module
+ *   --resources N       resources in the resource directory
+ *   --strings N         ASCII and UTF-16LE strings in .rdata
+ */
+
+#include "stdafx.h"
+#include "SynthPE.h"
+#include "FileUtils.h"
+
+static VOID Usage(VOID)
+{
+	fprintf(stderr, "usage: pegen [--pe32] [--sections N] [--imports DxT] [--exports N] [--relocs N] [--density N] [--corrupt exports,imports,relocs,lfanew,block0,truncated,namecount,ordinal] [--seed N] [--module I/N] [--forwarders R] [--resources N] [--strings N] output.dll\n");
+}
+
+int main(int argc, char** argv)
+{
+	SYNTH_CONFIG Config;
+	LPCSTR Output = NULL;
+	PBYTE Buffer;
+	SIZE_T Size;
+
+	Synth_DefaultConfig(&Config);
+	for (int i = 1; i < argc; i++)
+	{
+		BOOL bValue = i + 1 < argc;
+		if (strcmp(argv[i], "--pe32") == 0)
+			Config.bPE32Plus = FALSE;
+		else if (strcmp(argv[i], "--sections") == 0 && bValue)
+			Config.nSections = strtoul(argv[++i], NULL, 0);
+		else if (strcmp(argv[i], "--imports") == 0 && bValue)
+		{
+			if (sscanf(argv[++i], "%ux%u", &Config.nImportDescriptors, &Config.nThunks) != 2)
+			{
+				Usage();
+				return 1;
+			}
+		}
+		else if (strcmp(argv[i], "--exports") == 0 && bValue)
+			Config.nExports = strtoul(argv[++i], NULL, 0);
+		else if (strcmp(argv[i], "--relocs") == 0 && bValue)
+			Config.nRelocations = strtoul(argv[++i], NULL, 0);
+		else if (strcmp(argv[i], "--density") == 0 && bValue)
+			Config.RelocDensity = strtoul(argv[++i], NULL, 0);
+		else if (strcmp(argv[i], "--corrupt") == 0 && bValue)
+		{
+			i++;
+			if (strstr(argv[i], "exports") != NULL)
+				Config.Corruption |= SYNTH_CORRUPT_EXPORTS;
+			if (strstr(argv[i], "imports") != NULL)
+				Config.Corruption |= SYNTH_CORRUPT_IMPORTS;
+			if (strstr(argv[i], "relocs") != NULL)
+				Config.Corruption |= SYNTH_CORRUPT_RELOCS;
+			if (strstr(argv[i], "lfanew") != NULL)
+				Config.Corruption |= SYNTH_CORRUPT_LFANEW;
+			if (strstr(argv[i], "block0") != NULL)
+				Config.Corruption |= SYNTH_CORRUPT_RELOC_BLOCK;
+			if (strstr(argv[i], "truncated") != NULL)
+				Config.Corruption |= SYNTH_CORRUPT_RELOC_TRUNCATED;
+			if (strstr(argv[i], "namecount") != NULL)
+				Config.Corruption |= SYNTH_CORRUPT_NAME_COUNT;
+			if (strstr(argv[i], "ordinal") != NULL)
+				Config.Corruption |= SYNTH_CORRUPT_ORDINAL;
+		}
+		else if (strcmp(argv[i], "--seed") == 0 && bValue)
+			Config.Seed = strtoul(argv[++i], NULL, 0);
+		else if (strcmp(argv[i], "--module") == 0 && bValue)
+		{
+			if (sscanf(argv[++i], "%u/%u", &Config.ModuleIndex, &Config.nModules) != 2 || Config.ModuleIndex >= Config.nModules)
+			{
+				Usage();
+				return 1;
+			}
+		}
+		else if (strcmp(argv[i], "--forwarders") == 0 && bValue)
+			Config.ForwarderRate = strtoul(argv[++i], NULL, 0);
+		else if (strcmp(argv[i], "--resources") == 0 && bValue)
+			Config.nResources = strtoul(argv[++i], NULL, 0);
+		else if (strcmp(argv[i], "--strings") == 0 && bValue)
+			Config.nStrings = strtoul(argv[++i], NULL, 0);
+		else if (argv[i][0] != '-' && Output == NULL)
+			Output = argv[i];
+		else
+		{
+			Usage();
+			return 1;
+		}
+	}
+	if (Output == NULL)
+	{
+		Usage();
+		return 1;
+	}
+
+	if (!Synth_BuildImage(&Config, &Buffer, &Size))
+	{
+		fprintf(stderr, "image too large or out of memory\n");
+		return 1;
+	}
+	if (!FileUtils_WriteFile(Output, Buffer, Size))
+	{
+		fprintf(stderr, "can't write %s\n", Output);
+		free(Buffer);
+		return 1;
+	}
+	printf("%s: %llu bytes\n", Output, (unsigned long long)Size);
+	free(Buffer);
+	return 0;
+}
@@ -0,0 +1,530 @@
+/**
+ * \file SynthPE.c
+ * \brief Defines function described in file SynthPE.h
+ * \author Tomtombinary
+ * \version 1.0
+ * \date 17 octobre 2026
+ */
+
+#include "stdafx.h"
+#include "SynthPE.h"
+
+#define SYNTH_PAGE 0x1000
+#define SYNTH_ALIGN(x, a) (((x) + (a) - 1) & ~((ULONGLONG)(a) - 1))
+#define SYNTH_MAX_NAMED_FUNCTIONS 0x10000
+
+static DWORD Synth_Random(PDWORD lpState)
+{
+	DWORD x = *lpState;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	*lpState = x;
+	return x;
+}
+
+/* bump allocator in the .rdata buffer, returns the offset of the reserved bytes */
+static DWORD Synth_Reserve(PDWORD lpUsed, DWORD Size, DWORD Alignment)
+{
+	DWORD Offset = (DWORD)SYNTH_ALIGN(*lpUsed, Alignment);
+	*lpUsed = Offset + Size;
+	return Offset;
+}
+
+VOID Synth_DefaultConfig(PSYNTH_CONFIG Config)
+{
+	Config->bPE32Plus = TRUE;
+	Config->nSections = 8;
+	Config->nImportDescriptors = 16;
+	Config->nThunks = 64;
+	Config->nExports = 1000;
+	Config->nRelocations = 10000;
+	Config->RelocDensity = 64;
+	Config->Corruption = 0;
+	Config->Seed = 1;
+	Config->nModules = 0;
+	Config->ModuleIndex = 0;
+	Config->ForwarderRate = 0;
+	Config->nResources = 0;
+	Config->nStrings = 0;
+}
+
+/* resource directory entry: Name is the offset of a string when bNamed, else an identifier */
+static VOID Synth_SetResourceEntry(PIMAGE_RESOURCE_DIRECTORY_ENTRY Entry, DWORD Name, BOOL bNamed, DWORD Offset, BOOL bDirectory)
+{
+	Entry->Name = bNamed ? Name | IMAGE_RESOURCE_NAME_IS_STRING : Name;
+	Entry->OffsetToData = bDirectory ? Offset | IMAGE_RESOURCE_DATA_IS_DIRECTORY : Offset;
+}
+
+/* resource tree of an installer after the other tables: icons, strings, raw data, group icons and named files, one version and one manifest */
+static VOID Synth_WriteResources(PSYNTH_CONFIG Config, PBYTE RData, DWORD RDataRVA, PDWORD lpUsed, PIMAGE_DATA_DIRECTORY Directories, PDWORD lpState)
+{
+	static const WORD Types[] = { 3, 6, 10, 14, 16, 24 };
+	static const WORD Languages[] = { 0x407, 0x409 };
+	DWORD nBulk = Config->nResources > 2 ? Config->nResources - 2 : 0;
+	DWORD Start, Offset, NamesOffset, LanguagesOffset, DataOffset, StringOffset, nNames, nLanguages, Size;
+	PIMAGE_RESOURCE_DIRECTORY Root, Names, Leaves;
+	PIMAGE_RESOURCE_DIRECTORY_ENTRY RootEntries, NameEntries, LanguageEntries;
+	PIMAGE_RESOURCE_DATA_ENTRY DataEntry;
+	char Name[32];
+	int Length;
+
+	/* at most 65535 names per type */
+	if (nBulk > 5 * 0xFFFF)
+		nBulk = 5 * 0xFFFF;
+	/* the named type "FILES" first, then the types by identifier */
+	Start = Synth_Reserve(lpUsed, sizeof(IMAGE_RESOURCE_DIRECTORY) + 7 * sizeof(IMAGE_RESOURCE_DIRECTORY_ENTRY), 4);
+	Root = (PIMAGE_RESOURCE_DIRECTORY)(RData + Start);
+	RootEntries = (PIMAGE_RESOURCE_DIRECTORY_ENTRY)(Root + 1);
+	Root->NumberOfNamedEntries = 1;
+	Root->NumberOfIdEntries = 6;
+	for (DWORD t = 0; t < 7; t++)
+	{
+		/* bulk types share the resources, version and manifest have one each */
+		if (t == 5 || t == 6)
+			nNames = 1;
+		else
+			nNames = nBulk / 5 + (t < nBulk % 5);
+		NamesOffset = Synth_Reserve(lpUsed, sizeof(IMAGE_RESOURCE_DIRECTORY) + nNames * sizeof(IMAGE_RESOURCE_DIRECTORY_ENTRY), 4);
+		Names = (PIMAGE_RESOURCE_DIRECTORY)(RData + NamesOffset);
+		NameEntries = (PIMAGE_RESOURCE_DIRECTORY_ENTRY)(Names + 1);
+		if (t == 0)
+		{
+			StringOffset = Synth_Reserve(lpUsed, sizeof(WORD) + 5 * sizeof(WORD), 2);
+			*(PWORD)(RData + StringOffset) = 5;
+			for (DWORD c = 0; c < 5; c++)
+				((PWORD)(RData + StringOffset + sizeof(WORD)))[c] = (WORD)"FILES"[c];
+			Synth_SetResourceEntry(&RootEntries[0], StringOffset - Start, TRUE, NamesOffset - Start, TRUE);
+			Names->NumberOfNamedEntries = (WORD)nNames;
+		}
+		else
+		{
+			Synth_SetResourceEntry(&RootEntries[t], Types[t - 1], FALSE, NamesOffset - Start, TRUE);
+			Names->NumberOfIdEntries = (WORD)nNames;
+		}
+
+		for (DWORD n = 0; n < nNames; n++)
+		{
+			/* fixed width names are sorted, one resource out of 4 has two languages */
+			if (t == 0)
+			{
+				Length = snprintf(Name, sizeof(Name), "FILE_%06u", n);
+				StringOffset = Synth_Reserve(lpUsed, sizeof(WORD) + Length * sizeof(WORD), 2);
+				*(PWORD)(RData + StringOffset) = (WORD)Length;
+				for (int c = 0; c < Length; c++)
+					((PWORD)(RData + StringOffset + sizeof(WORD)))[c] = (WORD)Name[c];
+			}
+			nLanguages = (n & 3) == 0 && t < 5 ? 2 : 1;
+			LanguagesOffset = Synth_Reserve(lpUsed, sizeof(IMAGE_RESOURCE_DIRECTORY) + nLanguages * sizeof(IMAGE_RESOURCE_DIRECTORY_ENTRY), 4);
+			Synth_SetResourceEntry(&NameEntries[n], t == 0 ? StringOffset - Start : n + 1, t == 0, LanguagesOffset - Start, TRUE);
+			Leaves = (PIMAGE_RESOURCE_DIRECTORY)(RData + LanguagesOffset);
+			LanguageEntries = (PIMAGE_RESOURCE_DIRECTORY_ENTRY)(Leaves + 1);
+			Leaves->NumberOfIdEntries = (WORD)nLanguages;
+			for (DWORD l = 0; l < nLanguages; l++)
+			{
+				Offset = Synth_Reserve(lpUsed, sizeof(IMAGE_RESOURCE_DATA_ENTRY), 4);
+				Size = 16 + Synth_Random(lpState) % 49;
+				DataOffset = Synth_Reserve(lpUsed, Size, 8);
+				memset(RData + DataOffset, (BYTE)(n + l), Size);
+				DataEntry = (PIMAGE_RESOURCE_DATA_ENTRY)(RData + Offset);
+				DataEntry->OffsetToData = RDataRVA + DataOffset;
+				DataEntry->Size = Size;
+				DataEntry->CodePage = 1252;
+				Synth_SetResourceEntry(&LanguageEntries[l], Languages[nLanguages == 2 ? l : 1], FALSE, Offset - Start, FALSE);
+			}
+		}
+	}
+	Directories[IMAGE_DIRECTORY_ENTRY_RESOURCE].VirtualAddress = RDataRVA + Start;
+	Directories[IMAGE_DIRECTORY_ENTRY_RESOURCE].Size = *lpUsed - Start;
+}
+
+/* constants of a program: messages, paths and formats in ASCII or UTF-16LE, names given to GetProcAddress, between random bytes */
+static VOID Synth_WriteStrings(PSYNTH_CONFIG Config, PBYTE RData, PDWORD lpUsed, PDWORD lpState)
+{
+	static const char* Words[] = {
+		"error", "cannot", "open", "file", "%s", "0x%08X", "failed", "Software\\Microsoft\\Windows", "update",
+		"config", "user", "https://", "download", "%d bytes", "registry", "service", "C:\\Windows\\System32", "invalid"
+	};
+	DWORD Offset, Size, nWords, Thunk;
+	char Text[128];
+	int Length;
+
+	for (DWORD i = 0; i < Config->nStrings; i++)
+	{
+		Size = 8 + Synth_Random(lpState) % 57;
+		Offset = Synth_Reserve(lpUsed, Size, 1);
+		for (DWORD k = 0; k < Size; k++)
+			RData[Offset + k] = (BYTE)Synth_Random(lpState);
+		/* one string out of 16 is a name of the tables, an export then an import */
+		if ((i & 31) == 0 && Config->nExports != 0)
+			Length = snprintf(Text, sizeof(Text), "Export_%08u", Synth_Random(lpState) % Config->nExports);
+		else if ((i & 31) == 16 && Config->nModules == 0 && Config->nImportDescriptors != 0 && Config->nThunks != 0)
+		{
+			/* imports 7, 15 ... are by ordinal */
+			Thunk = Synth_Random(lpState) % Config->nThunks;
+			Length = snprintf(Text, sizeof(Text), "Function_%u_%u", Synth_Random(lpState) % Config->nImportDescriptors, (Thunk & 7) == 7 ? Thunk - 1 : Thunk);
+		}
+		else
+		{
+			Length = 0;
+			nWords = 1 + Synth_Random(lpState) % 4;
+			for (DWORD w = 0; w < nWords; w++)
+				Length += snprintf(Text + Length, sizeof(Text) - Length, w == 0 ? "%s" : " %s", Words[Synth_Random(lpState) % (sizeof(Words) / sizeof(Words[0]))]);
+		}
+		if ((i & 3) == 1)
+		{
+			Offset = Synth_Reserve(lpUsed, (Length + 1) * sizeof(WORD), 2);
+			for (int c = 0; c <= Length; c++)
+				((PWORD)(RData + Offset))[c] = (BYTE)Text[c];
+		}
+		else
+		{
+			Offset = Synth_Reserve(lpUsed, Length + 1, 1);
+			memcpy(RData + Offset, Text, Length + 1);
+		}
+	}
+}
+
+/* imports, exports then resources, written at the start of a zeroed .rdata buffer, returns the bytes used */
+static DWORD Synth_WriteRData(PSYNTH_CONFIG Config, PBYTE RData, DWORD RDataRVA, DWORD TextRVA, DWORD TextSize, PIMAGE_DATA_DIRECTORY Directories, PDWORD lpState)
+{
+	DWORD ThunkSize = Config->bPE32Plus ? 8 : 4;
+	DWORD Used = 0;
+	DWORD DescriptorsOffset, NameOffset, IntOffset, IatOffset, ThunkValueOffset;
+	DWORD ExportOffset, FunctionsOffset, NamesOffset, OrdinalsOffset;
+	DWORD nFunctions, Target;
+	BOOL bSet = Config->nModules != 0 && Config->nExports != 0;
+	PIMAGE_IMPORT_DESCRIPTOR Descriptors;
+	PIMAGE_EXPORT_DIRECTORY Export;
+	char Name[64];
+	int Length;
+
+	nFunctions = Config->nExports < SYNTH_MAX_NAMED_FUNCTIONS ? Config->nExports : SYNTH_MAX_NAMED_FUNCTIONS;
+	if (Config->nImportDescriptors != 0)
+	{
+		DescriptorsOffset = Synth_Reserve(&Used, (Config->nImportDescriptors + 1) * sizeof(IMAGE_IMPORT_DESCRIPTOR), 8);
+		Descriptors = (PIMAGE_IMPORT_DESCRIPTOR)(RData + DescriptorsOffset);
+		Directories[IMAGE_DIRECTORY_ENTRY_IMPORT].VirtualAddress = RDataRVA + DescriptorsOffset;
+		Directories[IMAGE_DIRECTORY_ENTRY_IMPORT].Size = (Config->nImportDescriptors + 1) * sizeof(IMAGE_IMPORT_DESCRIPTOR);
+		for (DWORD i = 0; i < Config->nImportDescriptors; i++)
+		{
+			/* in a set, descriptors import the next modules */
+			Target = bSet ? (Config->ModuleIndex + 1 + i) % Config->nModules : i;
+			Length = snprintf(Name, sizeof(Name), "module_%04u.dll", Target);
+			NameOffset = Synth_Reserve(&Used, Length + 1, 2);
+			memcpy(RData + NameOffset, Name, Length + 1);
+			IntOffset = Synth_Reserve(&Used, (Config->nThunks + 1) * ThunkSize, 8);
+			IatOffset = Synth_Reserve(&Used, (Config->nThunks + 1) * ThunkSize, 8);
+			Descriptors[i].OriginalFirstThunk = RDataRVA + IntOffset;
+			Descriptors[i].Name = RDataRVA + NameOffset;
+			Descriptors[i].FirstThunk = RDataRVA + IatOffset;
+			for (DWORD j = 0; j < Config->nThunks; j++)
+			{
+				ULONGLONG Thunk;
+				/* one import out of 8 by ordinal */
+				if ((j & 7) == 7)
+					Thunk = (Config->bPE32Plus ? IMAGE_ORDINAL_FLAG64 : IMAGE_ORDINAL_FLAG32) | (bSet ? Synth_Random(lpState) % nFunctions + 1 : j + 1);
+				else
+				{
+					if (bSet)
+						Length = snprintf(Name, sizeof(Name), "Export_%08u", Synth_Random(lpState) % Config->nExports);
+					else
+						Length = snprintf(Name, sizeof(Name), "Function_%u_%u", i, j);
+					ThunkValueOffset = Synth_Reserve(&Used, sizeof(WORD) + Length + 1, 2);
+					*(PWORD)(RData + ThunkValueOffset) = (WORD)j;
+					memcpy(RData + ThunkValueOffset + sizeof(WORD), Name, Length + 1);
+					Thunk = RDataRVA + ThunkValueOffset;
+				}
+				memcpy(RData + IntOffset + j * ThunkSize, &Thunk, ThunkSize);
+				memcpy(RData + IatOffset + j * ThunkSize, &Thunk, ThunkSize);
+			}
+		}
+	}
+
+	if (Config->nExports != 0)
+	{
+		/* AddressOfNameOrdinals holds WORDs: beyond 65536 names, names are aliases of the first functions */
+		ExportOffset = Synth_Reserve(&Used, sizeof(IMAGE_EXPORT_DIRECTORY), 8);
+		FunctionsOffset = Synth_Reserve(&Used, nFunctions * sizeof(DWORD), 4);
+		NamesOffset = Synth_Reserve(&Used, Config->nExports * sizeof(DWORD), 4);
+		OrdinalsOffset = Synth_Reserve(&Used, Config->nExports * sizeof(WORD), 2);
+		Export = (PIMAGE_EXPORT_DIRECTORY)(RData + ExportOffset);
+		Export->Base = 1;
+		Export->NumberOfFunctions = nFunctions;
+		Export->NumberOfNames = Config->nExports;
+		Export->AddressOfFunctions = RDataRVA + FunctionsOffset;
+		Export->AddressOfNames = RDataRVA + NamesOffset;
+		Export->AddressOfNameOrdinals = RDataRVA + OrdinalsOffset;
+		if (Config->nModules != 0)
+			Length = snprintf(Name, sizeof(Name), "module_%04u.dll", Config->ModuleIndex);
+		else
+			Length = snprintf(Name, sizeof(Name), "synthetic.dll");
+		NameOffset = Synth_Reserve(&Used, Length + 1, 1);
+		memcpy(RData + NameOffset, Name, Length + 1);
+		Export->Name = RDataRVA + NameOffset;
+		for (DWORD i = 0; i < nFunctions; i++)
+		{
+			/* forwarded to the same name in the next module, which forwards some of them again */
+			if (Config->nModules > 1 && Config->ForwarderRate > 2 && (i + Config->ModuleIndex) % Config->ForwarderRate < 2)
+			{
+				Length = snprintf(Name, sizeof(Name), "module_%04u.Export_%08u", (Config->ModuleIndex + 1) % Config->nModules, i);
+				NameOffset = Synth_Reserve(&Used, Length + 1, 1);
+				memcpy(RData + NameOffset, Name, Length + 1);
+				((PDWORD)(RData + FunctionsOffset))[i] = RDataRVA + NameOffset;
+			}
+			else
+				((PDWORD)(RData + FunctionsOffset))[i] = TextRVA + ((Synth_Random(lpState) % TextSize) & ~15u);
+		}
+		for (DWORD i = 0; i < Config->nExports; i++)
+		{
+			/* fixed width: the names are sorted like a linker sorts them */
+			Length = snprintf(Name, sizeof(Name), "Export_%08u", i);
+			NameOffset = Synth_Reserve(&Used, Length + 1, 1);
+			memcpy(RData + NameOffset, Name, Length + 1);
+			((PDWORD)(RData + NamesOffset))[i] = RDataRVA + NameOffset;
+			((PWORD)(RData + OrdinalsOffset))[i] = (WORD)(i % nFunctions);
+		}
+		Directories[IMAGE_DIRECTORY_ENTRY_EXPORT].VirtualAddress = RDataRVA + ExportOffset;
+		Directories[IMAGE_DIRECTORY_ENTRY_EXPORT].Size = Used - ExportOffset;
+	}
+	if (Config->nResources != 0)
+		Synth_WriteResources(Config, RData, RDataRVA, &Used, Directories, lpState);
+	if (Config->nStrings != 0)
+		Synth_WriteStrings(Config, RData, &Used, lpState);
+	return Used;
+}
+
+/* upper bound of the .rdata size */
+static ULONGLONG Synth_RDataBound(PSYNTH_CONFIG Config)
+{
+	ULONGLONG ThunkSize = Config->bPE32Plus ? 8 : 4;
+	ULONGLONG Size = SYNTH_PAGE;
+
+	Size += ((ULONGLONG)Config->nImportDescriptors + 1) * (sizeof(IMAGE_IMPORT_DESCRIPTOR) + 32);
+	Size += (ULONGLONG)Config->nImportDescriptors * (Config->nThunks + 1) * (2 * ThunkSize + 40);
+	Size += (ULONGLONG)Config->nExports * (sizeof(DWORD) * 2 + sizeof(WORD) + 24);
+	if (Config->ForwarderRate > 2)
+		Size += (ULONGLONG)Config->nExports * 32;
+	/* directories, entries, data entries, names and data of each resource */
+	Size += ((ULONGLONG)Config->nResources + 8) * 256;
+	/* random bytes and a string of 127 characters at most */
+	Size += (ULONGLONG)Config->nStrings * (64 + 128 * sizeof(WORD));
+	return Size;
+}
+
+BOOL Synth_BuildImage(PSYNTH_CONFIG Config, PBYTE* lpBuffer, SIZE_T* lpSize)
+{
+	DWORD State = Config->Seed != 0 ? Config->Seed : 1;
+	DWORD SlotSize = Config->bPE32Plus ? 8 : 4;
+	DWORD SlotsPerPage = SYNTH_PAGE / SlotSize;
+	DWORD Density, nRelocPages, nSections;
+	DWORD TextRVA, TextSize, RDataRVA, RDataSize, RelocRVA, RelocSize, FillerRVA, SizeOfImage, SizeOfHeaders;
+	DWORD SectionTableOffset, SizeOfOptionalHeader;
+	ULONGLONG ImageBase = Config->bPE32Plus ? 0x180000000ULL : 0x10000000ULL;
+	ULONGLONG Bound;
+	IMAGE_DATA_DIRECTORY Directories[IMAGE_NUMBEROF_DIRECTORY_ENTRIES];
+	PIMAGE_DATA_DIRECTORY lpDirectories;
+	PIMAGE_NT_HEADERS32 NtHeaders;
+	PIMAGE_SECTION_HEADER Sections;
+	PBYTE RData, Buffer;
+	DWORD Remaining, Offset;
+
+	*lpBuffer = NULL;
+	*lpSize = 0;
+	memset(Directories, 0, sizeof(Directories));
+	nSections = Config->nSections < 3 ? 3 : Config->nSections;
+	if (nSections > 0xFFFF)
+		return FALSE;
+	Density = Config->RelocDensity == 0 ? 1 : (Config->RelocDensity > SlotsPerPage ? SlotsPerPage : Config->RelocDensity);
+	nRelocPages = (DWORD)(((ULONGLONG)Config->nRelocations + Density - 1) / Density);
+
+	SizeOfOptionalHeader = Config->bPE32Plus ? sizeof(IMAGE_OPTIONAL_HEADER64) : sizeof(IMAGE_OPTIONAL_HEADER32);
+	SectionTableOffset = sizeof(IMAGE_DOS_HEADER) + 0x40 + sizeof(DWORD) + sizeof(IMAGE_FILE_HEADER) + SizeOfOptionalHeader;
+	SizeOfHeaders = (DWORD)SYNTH_ALIGN(SectionTableOffset + nSections * sizeof(IMAGE_SECTION_HEADER), SYNTH_PAGE);
+
+	/* .text: pages of relocated slots, at least 64 KB for the exported functions */
+	TextRVA = SizeOfHeaders;
+	if ((ULONGLONG)nRelocPages * SYNTH_PAGE > 0x40000000)
+		return FALSE;
+	TextSize = (nRelocPages > 16 ? nRelocPages : 16) * SYNTH_PAGE;
+	RDataRVA = TextRVA + TextSize;
+	Bound = Synth_RDataBound(Config);
+	if (Bound > 0x40000000)
+		return FALSE;
+	RData = (PBYTE)calloc(1, (SIZE_T)Bound);
+	if (RData == NULL)
+		return FALSE;
+
+	RDataSize = Synth_WriteRData(Config, RData, RDataRVA, TextRVA, TextSize, Directories, &State);
+	RelocRVA = RDataRVA + (DWORD)SYNTH_ALIGN(RDataSize != 0 ? RDataSize : 1, SYNTH_PAGE);
+	RelocSize = 0;
+	Remaining = Config->nRelocations;
+	for (DWORD i = 0; i < nRelocPages; i++)
+	{
+		DWORD n = Remaining < Density ? Remaining : Density;
+		RelocSize += sizeof(IMAGE_BASE_RELOCATION) + (n + (n & 1)) * sizeof(WORD);
+		Remaining -= n;
+	}
+	FillerRVA = RelocRVA + (DWORD)SYNTH_ALIGN(RelocSize != 0 ? RelocSize : 1, SYNTH_PAGE);
+	if ((ULONGLONG)FillerRVA + (ULONGLONG)(nSections - 3) * SYNTH_PAGE > 0x7FFF0000)
+	{
+		free(RData);
+		return FALSE;
+	}
+	SizeOfImage = FillerRVA + (nSections - 3) * SYNTH_PAGE;
+
+	Buffer = (PBYTE)calloc(1, SizeOfImage);
+	if (Buffer == NULL)
+	{
+		free(RData);
+		return FALSE;
+	}
+	memcpy(Buffer + RDataRVA, RData, RDataSize);
+	free(RData);
+
+	/* headers */
+	((PIMAGE_DOS_HEADER)Buffer)->e_magic = IMAGE_DOS_SIGNATURE;
+	((PIMAGE_DOS_HEADER)Buffer)->e_lfanew = sizeof(IMAGE_DOS_HEADER) + 0x40;
+	NtHeaders = (PIMAGE_NT_HEADERS32)(Buffer + sizeof(IMAGE_DOS_HEADER) + 0x40);
+	NtHeaders->Signature = IMAGE_NT_SIGNATURE;
+	NtHeaders->FileHeader.Machine = Config->bPE32Plus ? IMAGE_FILE_MACHINE_AMD64 : IMAGE_FILE_MACHINE_I386;
+	NtHeaders->FileHeader.NumberOfSections = (WORD)nSections;
+	NtHeaders->FileHeader.TimeDateStamp = 0x5F000000;
+	NtHeaders->FileHeader.SizeOfOptionalHeader = (WORD)SizeOfOptionalHeader;
+	/* executable image, DLL, and large address aware or 32 bits machine */
+	NtHeaders->FileHeader.Characteristics = Config->bPE32Plus ? 0x2022 : 0x2102;
+	if (Config->bPE32Plus)
+	{
+		PIMAGE_OPTIONAL_HEADER64 Optional = &((PIMAGE_NT_HEADERS64)NtHeaders)->OptionalHeader;
+		Optional->Magic = IMAGE_NT_OPTIONAL_HDR64_MAGIC;
+		Optional->SizeOfCode = TextSize;
+		Optional->AddressOfEntryPoint = TextRVA;
+		Optional->BaseOfCode = TextRVA;
+		Optional->ImageBase = ImageBase;
+		Optional->SectionAlignment = SYNTH_PAGE;
+		Optional->FileAlignment = SYNTH_PAGE;
+		Optional->MajorOperatingSystemVersion = 6;
+		Optional->MajorSubsystemVersion = 6;
+		Optional->SizeOfImage = SizeOfImage;
+		Optional->SizeOfHeaders = SizeOfHeaders;
+		Optional->Subsystem = 2;
+		Optional->DllCharacteristics = 0x0160;
+		Optional->SizeOfStackReserve = 0x100000;
+		Optional->SizeOfStackCommit = SYNTH_PAGE;
+		Optional->SizeOfHeapReserve = 0x100000;
+		Optional->SizeOfHeapCommit = SYNTH_PAGE;
+		Optional->NumberOfRvaAndSizes = IMAGE_NUMBEROF_DIRECTORY_ENTRIES;
+		lpDirectories = Optional->DataDirectory;
+	}
+	else
+	{
+		PIMAGE_OPTIONAL_HEADER32 Optional = &NtHeaders->OptionalHeader;
+		Optional->Magic = IMAGE_NT_OPTIONAL_HDR32_MAGIC;
+		Optional->SizeOfCode = TextSize;
+		Optional->AddressOfEntryPoint = TextRVA;
+		Optional->BaseOfCode = TextRVA;
+		Optional->BaseOfData = RDataRVA;
+		Optional->ImageBase = (DWORD)ImageBase;
+		Optional->SectionAlignment = SYNTH_PAGE;
+		Optional->FileAlignment = SYNTH_PAGE;
+		Optional->MajorOperatingSystemVersion = 6;
+		Optional->MajorSubsystemVersion = 6;
+		Optional->SizeOfImage = SizeOfImage;
+		Optional->SizeOfHeaders = SizeOfHeaders;
+		Optional->Subsystem = 2;
+		Optional->DllCharacteristics = 0x0140;
+		Optional->SizeOfStackReserve = 0x100000;
+		Optional->SizeOfStackCommit = SYNTH_PAGE;
+		Optional->SizeOfHeapReserve = 0x100000;
+		Optional->SizeOfHeapCommit = SYNTH_PAGE;
+		Optional->NumberOfRvaAndSizes = IMAGE_NUMBEROF_DIRECTORY_ENTRIES;
+		lpDirectories = Optional->DataDirectory;
+	}
+	if (Config->nRelocations != 0)
+	{
+		Directories[IMAGE_DIRECTORY_ENTRY_BASERELOC].VirtualAddress = RelocRVA;
+		Directories[IMAGE_DIRECTORY_ENTRY_BASERELOC].Size = RelocSize;
+	}
+	memcpy(lpDirectories, Directories, sizeof(Directories));
+
+	Sections = (PIMAGE_SECTION_HEADER)(Buffer + SectionTableOffset);
+	memcpy(Sections[0].Name, ".text", 5);
+	Sections[0].VirtualAddress = TextRVA;
+	Sections[0].Misc.VirtualSize = TextSize;
+	Sections[0].Characteristics = IMAGE_SCN_CNT_CODE | IMAGE_SCN_MEM_EXECUTE | IMAGE_SCN_MEM_READ;
+	memcpy(Sections[1].Name, ".rdata", 6);
+	Sections[1].VirtualAddress = RDataRVA;
+	Sections[1].Misc.VirtualSize = RelocRVA - RDataRVA;
+	Sections[1].Characteristics = IMAGE_SCN_CNT_INITIALIZED_DATA | IMAGE_SCN_MEM_READ;
+	memcpy(Sections[2].Name, ".reloc", 6);
+	Sections[2].VirtualAddress = RelocRVA;
+	Sections[2].Misc.VirtualSize = FillerRVA - RelocRVA;
+	Sections[2].Characteristics = IMAGE_SCN_CNT_INITIALIZED_DATA | IMAGE_SCN_MEM_DISCARDABLE | IMAGE_SCN_MEM_READ;
+	for (DWORD i = 3; i < nSections; i++)
+	{
+		char Name[IMAGE_SIZEOF_SHORT_NAME + 1];
+		snprintf(Name, sizeof(Name), ".d%05u", i - 3);
+		memcpy(Sections[i].Name, Name, IMAGE_SIZEOF_SHORT_NAME);
+		Sections[i].VirtualAddress = FillerRVA + (i - 3) * SYNTH_PAGE;
+		Sections[i].Misc.VirtualSize = SYNTH_PAGE;
+		Sections[i].Characteristics = IMAGE_SCN_CNT_INITIALIZED_DATA | IMAGE_SCN_MEM_READ | IMAGE_SCN_MEM_WRITE;
+	}
+	/* raw data at the RVA: the file is its own image */
+	for (DWORD i = 0; i < nSections; i++)
+	{
+		Sections[i].PointerToRawData = Sections[i].VirtualAddress;
+		Sections[i].SizeOfRawData = Sections[i].Misc.VirtualSize;
+	}
+	memset(Buffer + TextRVA, 0xCC, TextSize);
+
+	/* relocations spread over each page, adjacent slots when the density fills the page */
+	Offset = RelocRVA;
+	Remaining = Config->nRelocations;
+	for (DWORD i = 0; i < nRelocPages; i++)
+	{
+		PIMAGE_BASE_RELOCATION Block = (PIMAGE_BASE_RELOCATION)(Buffer + Offset);
+		PWORD Items = (PWORD)(Block + 1);
+		DWORD n = Remaining < Density ? Remaining : Density;
+		DWORD Stride = (SlotsPerPage / n) * SlotSize;
+		DWORD PageRVA = TextRVA + i * SYNTH_PAGE;
+
+		Block->VirtualAddress = PageRVA;
+		Block->SizeOfBlock = sizeof(IMAGE_BASE_RELOCATION) + (n + (n & 1)) * sizeof(WORD);
+		for (DWORD k = 0; k < n; k++)
+		{
+			ULONGLONG Target = ImageBase + TextRVA + (Synth_Random(&State) % TextSize);
+			Items[k] = (WORD)(((Config->bPE32Plus ? IMAGE_REL_BASED_DIR64 : IMAGE_REL_BASED_HIGHLOW) << 12) | (k * Stride));
+			memcpy(Buffer + PageRVA + k * Stride, &Target, SlotSize);
+		}
+		if (Config->Corruption & SYNTH_CORRUPT_RELOCS && i == nRelocPages / 2)
+			Block->SizeOfBlock = 0x7FFFFFF0;
+		if (Config->Corruption & SYNTH_CORRUPT_RELOC_BLOCK && i == nRelocPages / 2)
+			Block->SizeOfBlock = 0;
+		Offset += sizeof(IMAGE_BASE_RELOCATION) + (n + (n & 1)) * sizeof(WORD);
+		Remaining -= n;
+	}
+
+	/* tables pointing one page beyond the image */
+	if ((Config->Corruption & SYNTH_CORRUPT_EXPORTS) && Directories[IMAGE_DIRECTORY_ENTRY_EXPORT].VirtualAddress != 0)
+		((PIMAGE_EXPORT_DIRECTORY)(Buffer + Directories[IMAGE_DIRECTORY_ENTRY_EXPORT].VirtualAddress))->AddressOfNames = SizeOfImage + SYNTH_PAGE;
+	if ((Config->Corruption & SYNTH_CORRUPT_IMPORTS) && Directories[IMAGE_DIRECTORY_ENTRY_IMPORT].VirtualAddress != 0)
+		((PIMAGE_IMPORT_DESCRIPTOR)(Buffer + Directories[IMAGE_DIRECTORY_ENTRY_IMPORT].VirtualAddress))[Config->nImportDescriptors - 1].OriginalFirstThunk = SizeOfImage + SYNTH_PAGE;
+	if ((Config->Corruption & (SYNTH_CORRUPT_NAME_COUNT | SYNTH_CORRUPT_ORDINAL)) && Config->nExports >= 2)
+	{
+		PIMAGE_EXPORT_DIRECTORY Export = (PIMAGE_EXPORT_DIRECTORY)(Buffer + Directories[IMAGE_DIRECTORY_ENTRY_EXPORT].VirtualAddress);
+		if (Config->Corruption & SYNTH_CORRUPT_NAME_COUNT)
+			Export->NumberOfFunctions = Export->NumberOfNames / 2;
+		if (Config->Corruption & SYNTH_CORRUPT_ORDINAL)
+			((PWORD)(Buffer + Export->AddressOfNameOrdinals))[Export->NumberOfNames / 2] = (WORD)Export->NumberOfFunctions;
+	}
+	/* the header of the last block stays in the directory, its entries don't */
+	if ((Config->Corruption & SYNTH_CORRUPT_RELOC_TRUNCATED) && Config->nRelocations != 0)
+		lpDirectories[IMAGE_DIRECTORY_ENTRY_BASERELOC].Size -= sizeof(WORD);
+
+	NtHeaders->OptionalHeader.CheckSum = PE32_ComputeChecksum(Buffer, SizeOfImage);
+	if (Config->Corruption & SYNTH_CORRUPT_LFANEW)
+		((PIMAGE_DOS_HEADER)Buffer)->e_lfanew = SizeOfImage + SYNTH_PAGE;
+	*lpBuffer = Buffer;
+	*lpSize = SizeOfImage;
+	return TRUE;
+}
@@ -0,0 +1,77 @@
+/**
+ * \file SynthPE.h
+ * \brief Generator of synthetic PE images for benchmarks
+ * \author Tomtombinary
+ * \version 1.0
+ * \date 17 octobre 2026
+ * Images have a section alignment equal to their file alignment and raw data
+ * at the RVA of each section: the same buffer can be used as a file
+ * (PE_LAYOUT_FILE) or as a loaded module (PE_LAYOUT_IMAGE, HMODULE functions).
+ * Sections: .text (relocated slots, exported functions), .rdata (imports,
+ * exports, resources), .reloc, then filler sections up to nSections.
+ */
+
+#pragma once
+#include "stdafx.h"
+#include "PEUtils.h"
+
+#define SYNTH_CORRUPT_EXPORTS 0x1 /* AddressOfNames out of the image */
+#define SYNTH_CORRUPT_IMPORTS 0x2 /* thunk array of the last descriptor out of the image */
+#define SYNTH_CORRUPT_RELOCS 0x4  /* a block in the middle of the table with a huge SizeOfBlock */
+#define SYNTH_CORRUPT_LFANEW 0x8  /* e_lfanew beyond the end of the file */
+#define SYNTH_CORRUPT_RELOC_BLOCK 0x10 /* a block in the middle of the table with a SizeOfBlock of 0 */
+#define SYNTH_CORRUPT_RELOC_TRUNCATED 0x20 /* directory size cutting the last block */
+#define SYNTH_CORRUPT_NAME_COUNT 0x40 /* NumberOfFunctions halved: NumberOfNames greater, ordinals of the last names out of range */
+#define SYNTH_CORRUPT_ORDINAL 0x80 /* an ordinal of AddressOfNameOrdinals equal to NumberOfFunctions */
+
+/**
+ * \struct SYNTH_CONFIG
+ * \brief content of a synthetic image, see Synth_DefaultConfig
+ * bPE32Plus: PE32+ (AMD64, DIR64 relocations) instead of PE32 (I386, HIGHLOW relocations)
+ * nSections: number of sections, at least 3
+ * nImportDescriptors, nThunks: imported modules and functions imported from each (one out of 8 by ordinal)
+ * nExports: exported functions, all named (names sorted as a linker does)
+ * nRelocations: relocation entries, padding excluded
+ * RelocDensity: relocations per page of 4 KB, clipped to the slots of a page
+ * Corruption: SYNTH_CORRUPT_* flags
+ * Seed: seed of the pseudo-random RVAs
+ * nModules, ModuleIndex: image ModuleIndex of a set of nModules images built with the same nExports, named module_NNNN.dll;
+ *   its descriptors import the next modules of the set and their exports (0: imports of Function_D_T from module_D.dll)
+ * ForwarderRate: in a set, 2 exports out of ForwarderRate are forwarded to the next module (0: none, at least 3)
+ * nResources: resources of the resource directory, in .rdata (icons, strings, data, group icons, named files, a version and a manifest), at most 327677
+ * nStrings: strings written in .rdata between random bytes, one out of 4 in UTF-16LE, one out of 16 a name of an import or an export
+ */
+typedef struct _SYNTH_CONFIG
+{
+	BOOL bPE32Plus;
+	DWORD nSections;
+	DWORD nImportDescriptors;
+	DWORD nThunks;
+	DWORD nExports;
+	DWORD nRelocations;
+	DWORD RelocDensity;
+	DWORD Corruption;
+	DWORD Seed;
+	DWORD nModules;
+	DWORD ModuleIndex;
+	DWORD ForwarderRate;
+	DWORD nResources;
+	DWORD nStrings;
+}SYNTH_CONFIG,*PSYNTH_CONFIG;
+
+/**
+ * \fn VOID Synth_DefaultConfig(PSYNTH_CONFIG Config);
+ * \brief a small PE32+ DLL: 8 sections, 16 x 64 imports, 1000 exports, 10000 relocations
+ * \param Config: [out] configuration
+ */
+VOID Synth_DefaultConfig(PSYNTH_CONFIG Config);
+
+/**
+ * \fn BOOL Synth_BuildImage(PSYNTH_CONFIG Config, PBYTE* lpBuffer, SIZE_T* lpSize);
+ * \brief generate an image, its CheckSum is set
+ * \param Config: content of the image
+ * \param lpBuffer: [out] image, released by free
+ * \param lpSize: [out] size of the image (SizeOfImage)
+ * \return FALSE if memory couldn't be allocated or the image would exceed 2 GB
+ */
+BOOL Synth_BuildImage(PSYNTH_CONFIG Config, PBYTE* lpBuffer, SIZE_T* lpSize);
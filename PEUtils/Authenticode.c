@@ -0,0 +1,289 @@
+/**
+ * \file Authenticode.c
+ * \brief Defines function described in file Authenticode.h
+ * \author Tomtombinary
+ * \version 1.0
+ * \date 17 octobre 2026
+ */
+
+#include "stdafx.h"
+#include "Authenticode.h"
+#include "PETraits.h"
+#include "ThreadUtils.h"
+
+/* bytes given to every digest at once in the single pass, small enough to stay in cache */
+#define AUTHENTICODE_CHUNK 0x10000
+/* smaller files are hashed on the calling thread */
+#define AUTHENTICODE_MIN_THREADED_SIZE 0x800000
+/* headers in 3 parts, the sections and the data after them */
+#define AUTHENTICODE_EXTRA_RANGES 4
+
+/**
+ * \struct AUTH_RANGE
+ * \brief part of the file covered by the digest, Section is NULL outside of the sections
+ */
+typedef struct _AUTH_RANGE
+{
+	PBYTE Data;
+	SIZE_T Size;
+	PSECTION_DIGEST Section;
+}AUTH_RANGE,*PAUTH_RANGE;
+
+/**
+ * \struct AUTH_CONTEXT
+ * \brief ranges of the file in hash order and tasks of the threads
+ * A task is a whole-file digest (Task < nAlgorithms) or the digest of a section with one algorithm.
+ */
+typedef struct _AUTH_CONTEXT
+{
+	PAUTH_RANGE Ranges;
+	DWORD nRanges;
+	PAUTHENTICODE_DIGEST Digest;
+	DWORD AlgorithmList[2];
+	DWORD nAlgorithms;
+	DWORD nTasks;
+	volatile LONG NextTask;
+}AUTH_CONTEXT,*PAUTH_CONTEXT;
+
+/**
+ * \struct AUTH_HASH
+ * \brief one digest being computed, SHA-1 or SHA-256
+ */
+typedef struct _AUTH_HASH
+{
+	DWORD Algorithm;
+	SHA_CONTEXT Sha;
+}AUTH_HASH,*PAUTH_HASH;
+
+static VOID Authenticode_Init(PAUTH_HASH Hash, DWORD Algorithm)
+{
+	Hash->Algorithm = Algorithm;
+	if (Algorithm == AUTHENTICODE_SHA1)
+		HashUtils_Sha1Init(&Hash->Sha);
+	else
+		HashUtils_Sha256Init(&Hash->Sha);
+}
+
+static VOID Authenticode_Update(PAUTH_HASH Hash, LPCVOID Data, SIZE_T SizeInBytes)
+{
+	if (Hash->Algorithm == AUTHENTICODE_SHA1)
+		HashUtils_Sha1Update(&Hash->Sha, Data, SizeInBytes);
+	else
+		HashUtils_Sha256Update(&Hash->Sha, Data, SizeInBytes);
+}
+
+/* the digest goes to the Sha1 or Sha256 field of a result */
+static VOID Authenticode_Final(PAUTH_HASH Hash, PBYTE Sha1, PBYTE Sha256)
+{
+	if (Hash->Algorithm == AUTHENTICODE_SHA1)
+		HashUtils_Sha1Final(&Hash->Sha, Sha1);
+	else
+		HashUtils_Sha256Final(&Hash->Sha, Sha256);
+}
+
+/* add [Start, End) to the ranges, clipped to the file, empty ranges are dropped */
+static VOID Authenticode_AddRange(PPE_IMAGE Image, PAUTH_CONTEXT Context, ULONGLONG Start, ULONGLONG End, PSECTION_DIGEST Section)
+{
+	if (End > Image->Size)
+		End = Image->Size;
+	if (Start >= End)
+		return;
+	Context->Ranges[Context->nRanges].Data = Image->Base + Start;
+	Context->Ranges[Context->nRanges].Size = (SIZE_T)(End - Start);
+	Context->Ranges[Context->nRanges].Section = Section;
+	Context->nRanges++;
+	Context->Digest->nHashedBytes += End - Start;
+}
+
+static int Authenticode_CompareSections(const void* lpFirst, const void* lpSecond)
+{
+	const SECTION_DIGEST* First = (const SECTION_DIGEST*)lpFirst;
+	const SECTION_DIGEST* Second = (const SECTION_DIGEST*)lpSecond;
+
+	if (First->Offset != Second->Offset)
+		return First->Offset < Second->Offset ? -1 : 1;
+	return First->Section < Second->Section ? -1 : (First->Section > Second->Section);
+}
+
+static BOOL Authenticode_BuildRanges(PPE_IMAGE Image, PAUTH_CONTEXT Context)
+{
+	PAUTHENTICODE_DIGEST Digest = Context->Digest;
+	PIMAGE_SECTION_HEADER lpSectionHeader = Image->SectionHeaders;
+	PIMAGE_DATA_DIRECTORY lpDataDirectory;
+	PPE_DIRECTORY lpSecurity = &Image->Directories[IMAGE_DIRECTORY_ENTRY_SECURITY];
+	ULONGLONG CheckSumOffset, SecurityOffset, HeadersEnd, SectionsEnd, DataEnd;
+	DWORD nDirectories;
+
+	Digest->Sections = (PSECTION_DIGEST)MemArenaAlloc(&Image->Arena, (Image->nSections + 1) * sizeof(SECTION_DIGEST));
+	Context->Ranges = (PAUTH_RANGE)malloc((Image->nSections + AUTHENTICODE_EXTRA_RANGES) * sizeof(AUTH_RANGE));
+	if (Digest->Sections == NULL || Context->Ranges == NULL)
+		return FALSE;
+
+	/* CheckSum has the same offset in both widths of optional header, the directories don't */
+	CheckSumOffset = (PBYTE)&Image->NtHeaders->OptionalHeader.CheckSum - Image->Base;
+	lpDataDirectory = Image->Traits->GetDirectories(Image->NtHeaders, &nDirectories);
+	HeadersEnd = Image->NtHeaders->OptionalHeader.SizeOfHeaders;
+	Authenticode_AddRange(Image, Context, 0, CheckSumOffset, NULL);
+	if (nDirectories > IMAGE_DIRECTORY_ENTRY_SECURITY)
+	{
+		SecurityOffset = (PBYTE)&lpDataDirectory[IMAGE_DIRECTORY_ENTRY_SECURITY] - Image->Base;
+		Authenticode_AddRange(Image, Context, CheckSumOffset + sizeof(DWORD), SecurityOffset, NULL);
+		Authenticode_AddRange(Image, Context, SecurityOffset + sizeof(IMAGE_DATA_DIRECTORY), HeadersEnd, NULL);
+	}
+	else
+		Authenticode_AddRange(Image, Context, CheckSumOffset + sizeof(DWORD), HeadersEnd, NULL);
+
+	/* sections with raw data, sorted by file offset */
+	for (DWORD i = 0; i < Image->nSections; i++, lpSectionHeader++)
+	{
+		if (lpSectionHeader->SizeOfRawData == 0 || lpSectionHeader->PointerToRawData >= Image->Size)
+			continue;
+		Digest->Sections[Digest->nSections].Section = i;
+		Digest->Sections[Digest->nSections].Offset = lpSectionHeader->PointerToRawData;
+		Digest->Sections[Digest->nSections].Size = lpSectionHeader->SizeOfRawData;
+		if ((ULONGLONG)lpSectionHeader->PointerToRawData + lpSectionHeader->SizeOfRawData > Image->Size)
+			Digest->Sections[Digest->nSections].Size = (DWORD)(Image->Size - lpSectionHeader->PointerToRawData);
+		Digest->nSections++;
+	}
+	qsort(Digest->Sections, Digest->nSections, sizeof(SECTION_DIGEST), Authenticode_CompareSections);
+	SectionsEnd = HeadersEnd;
+	for (DWORD i = 0; i < Digest->nSections; i++)
+	{
+		Authenticode_AddRange(Image, Context, Digest->Sections[i].Offset, (ULONGLONG)Digest->Sections[i].Offset + Digest->Sections[i].Size, &Digest->Sections[i]);
+		if ((ULONGLONG)Digest->Sections[i].Offset + Digest->Sections[i].Size > SectionsEnd)
+			SectionsEnd = (ULONGLONG)Digest->Sections[i].Offset + Digest->Sections[i].Size;
+	}
+
+	/* overlay, the certificate table at the end of the file excluded */
+	DataEnd = Image->Size;
+	if (lpSecurity->VirtualAddress != 0 && lpSecurity->Size != 0 && lpSecurity->VirtualAddress >= SectionsEnd && lpSecurity->VirtualAddress < DataEnd)
+		DataEnd = lpSecurity->VirtualAddress;
+	Authenticode_AddRange(Image, Context, SectionsEnd, DataEnd, NULL);
+	return TRUE;
+}
+
+/* one pass over the file, every digest updated chunk by chunk */
+static VOID Authenticode_HashSinglePass(PAUTH_CONTEXT Context)
+{
+	AUTH_HASH Whole[2];
+	AUTH_HASH Section[2];
+	PAUTH_RANGE lpRange;
+	SIZE_T Offset, Size;
+	DWORD a;
+
+	for (a = 0; a < Context->nAlgorithms; a++)
+		Authenticode_Init(&Whole[a], Context->AlgorithmList[a]);
+	for (DWORD i = 0; i < Context->nRanges; i++)
+	{
+		lpRange = &Context->Ranges[i];
+		for (a = 0; lpRange->Section != NULL && a < Context->nAlgorithms; a++)
+			Authenticode_Init(&Section[a], Context->AlgorithmList[a]);
+		for (Offset = 0; Offset < lpRange->Size; Offset += Size)
+		{
+			Size = lpRange->Size - Offset < AUTHENTICODE_CHUNK ? lpRange->Size - Offset : AUTHENTICODE_CHUNK;
+			for (a = 0; a < Context->nAlgorithms; a++)
+			{
+				Authenticode_Update(&Whole[a], lpRange->Data + Offset, Size);
+				if (lpRange->Section != NULL)
+					Authenticode_Update(&Section[a], lpRange->Data + Offset, Size);
+			}
+		}
+		for (a = 0; lpRange->Section != NULL && a < Context->nAlgorithms; a++)
+			Authenticode_Final(&Section[a], lpRange->Section->Sha1, lpRange->Section->Sha256);
+	}
+	for (a = 0; a < Context->nAlgorithms; a++)
+		Authenticode_Final(&Whole[a], Context->Digest->Sha1, Context->Digest->Sha256);
+}
+
+static VOID Authenticode_RunTask(PAUTH_CONTEXT Context, DWORD Task)
+{
+	AUTH_HASH Hash;
+	PAUTH_RANGE lpRange;
+	PSECTION_DIGEST lpSection;
+
+	if (Task < Context->nAlgorithms)
+	{
+		Authenticode_Init(&Hash, Context->AlgorithmList[Task]);
+		for (DWORD i = 0; i < Context->nRanges; i++)
+			Authenticode_Update(&Hash, Context->Ranges[i].Data, Context->Ranges[i].Size);
+		Authenticode_Final(&Hash, Context->Digest->Sha1, Context->Digest->Sha256);
+		return;
+	}
+	/* section tasks follow the file order, algorithms alternate */
+	Task -= Context->nAlgorithms;
+	lpSection = &Context->Digest->Sections[Task / Context->nAlgorithms];
+	Authenticode_Init(&Hash, Context->AlgorithmList[Task % Context->nAlgorithms]);
+	for (DWORD i = 0; i < Context->nRanges; i++)
+	{
+		lpRange = &Context->Ranges[i];
+		if (lpRange->Section == lpSection)
+			Authenticode_Update(&Hash, lpRange->Data, lpRange->Size);
+	}
+	Authenticode_Final(&Hash, lpSection->Sha1, lpSection->Sha256);
+}
+
+static VOID Authenticode_Worker(LPVOID UserArgs)
+{
+	PAUTH_CONTEXT Context = (PAUTH_CONTEXT)UserArgs;
+	LONG Task;
+
+	while ((Task = ThreadUtils_AtomicAdd(&Context->NextTask, 1) - 1) < (LONG)Context->nTasks)
+		Authenticode_RunTask(Context, (DWORD)Task);
+}
+
+static VOID Authenticode_HashThreaded(PAUTH_CONTEXT Context, DWORD nThreads)
+{
+	PTHREAD_HANDLE Threads;
+	DWORD nStarted;
+
+	Threads = (PTHREAD_HANDLE)calloc(nThreads, sizeof(THREAD_HANDLE));
+	if (Threads == NULL)
+	{
+		Authenticode_HashSinglePass(Context);
+		return;
+	}
+	/* whole-file digests first: they are the longest tasks */
+	Context->nTasks = Context->nAlgorithms * (1 + Context->Digest->nSections);
+	Context->NextTask = 0;
+	for (nStarted = 1; nStarted < nThreads; nStarted++)
+	{
+		if (!ThreadUtils_CreateThread(&Threads[nStarted], Authenticode_Worker, Context))
+			break;
+	}
+	/* the calling thread is a worker too, tasks of threads which couldn't start are left to the others */
+	Authenticode_Worker(Context);
+	for (DWORD i = 1; i < nStarted; i++)
+		ThreadUtils_JoinThread(&Threads[i]);
+	free(Threads);
+}
+
+BOOL PE32_ComputeAuthenticodeDigest(PPE_IMAGE Image, DWORD Algorithms, DWORD nThreads, PAUTHENTICODE_DIGEST Digest)
+{
+	AUTH_CONTEXT Context;
+
+	memset(Digest, 0, sizeof(AUTHENTICODE_DIGEST));
+	memset(&Context, 0, sizeof(AUTH_CONTEXT));
+	Algorithms &= AUTHENTICODE_SHA1 | AUTHENTICODE_SHA256;
+	if (Image->Layout != PE_LAYOUT_FILE || Algorithms == 0)
+		return FALSE;
+
+	Digest->Algorithms = Algorithms;
+	Context.Digest = Digest;
+	if (Algorithms & AUTHENTICODE_SHA1)
+		Context.AlgorithmList[Context.nAlgorithms++] = AUTHENTICODE_SHA1;
+	if (Algorithms & AUTHENTICODE_SHA256)
+		Context.AlgorithmList[Context.nAlgorithms++] = AUTHENTICODE_SHA256;
+	if (!Authenticode_BuildRanges(Image, &Context))
+	{
+		free(Context.Ranges);
+		memset(Digest, 0, sizeof(AUTHENTICODE_DIGEST));
+		return FALSE;
+	}
+
+	if (nThreads > 1 && Image->Size >= AUTHENTICODE_MIN_THREADED_SIZE)
+		Authenticode_HashThreaded(&Context, nThreads);
+	else
+		Authenticode_HashSinglePass(&Context);
+	free(Context.Ranges);
+	return TRUE;
+}
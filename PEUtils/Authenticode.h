@@ -0,0 +1,65 @@
+/**
+ * \file Authenticode.h
+ * \brief Authenticode digest of a PE file
+ * \author Tomtombinary
+ * \version 1.0
+ * \date 17 octobre 2026
+ * The digest covers the headers without OptionalHeader.CheckSum and the
+ * security directory entry, the raw data of the sections in file order,
+ * then the data after the last section up to the certificate table. The
+ * hashed bytes are read from the mapped file (PE_LAYOUT_FILE) without copy.
+ * With one thread, every requested digest and the digest of the current
+ * section are updated from the same chunk while it is in cache. A SHA
+ * digest can't be split, so with several threads each whole-file digest and
+ * each section digest is a task of its own.
+ */
+
+#pragma once
+#include "stdafx.h"
+#include "PEUtils.h"
+#include "HashUtils.h"
+
+#define AUTHENTICODE_SHA1 0x1
+#define AUTHENTICODE_SHA256 0x2
+
+/**
+ * \struct SECTION_DIGEST
+ * \brief digest of the raw data of a section
+ * Section: index of the section in the section table
+ * Offset, Size: raw data hashed (clipped to the end of the file)
+ */
+typedef struct _SECTION_DIGEST
+{
+	DWORD Section;
+	DWORD Offset;
+	DWORD Size;
+	BYTE Sha1[SHA1_DIGEST_SIZE];
+	BYTE Sha256[SHA256_DIGEST_SIZE];
+}SECTION_DIGEST,*PSECTION_DIGEST;
+
+/**
+ * \struct AUTHENTICODE_DIGEST
+ * \brief result of PE32_ComputeAuthenticodeDigest, only the requested digests are set
+ * Sections: digests of the sections with raw data, in file order (allocated in the image arena)
+ * nHashedBytes: number of bytes covered by the whole-file digests
+ */
+typedef struct _AUTHENTICODE_DIGEST
+{
+	DWORD Algorithms;
+	BYTE Sha1[SHA1_DIGEST_SIZE];
+	BYTE Sha256[SHA256_DIGEST_SIZE];
+	PSECTION_DIGEST Sections;
+	DWORD nSections;
+	ULONGLONG nHashedBytes;
+}AUTHENTICODE_DIGEST,*PAUTHENTICODE_DIGEST;
+
+/**
+ * \fn BOOL PE32_ComputeAuthenticodeDigest(PPE_IMAGE Image, DWORD Algorithms, DWORD nThreads, PAUTHENTICODE_DIGEST Digest);
+ * \brief compute the Authenticode digests of a file and the digests of its sections
+ * \param Image: image opened with PE_LAYOUT_FILE (PE32_OpenFile)
+ * \param Algorithms: AUTHENTICODE_SHA1 and/or AUTHENTICODE_SHA256
+ * \param nThreads: maximum number of threads (0 or 1 to stay on the calling thread), only used for large files
+ * \param Digest: [out] digests
+ * \return FALSE if the image isn't a file layout, no algorithm is requested or memory couldn't be allocated
+ */
+BOOL PE32_ComputeAuthenticodeDigest(PPE_IMAGE Image, DWORD Algorithms, DWORD nThreads, PAUTHENTICODE_DIGEST Digest);
@@ -0,0 +1,590 @@
+/**
+ * \file Binder.c
+ * \brief Defines function described in file Binder.h
+ * \author Tomtombinary
+ * \version 1.0
+ * \date 17 octobre 2026
+ */
+
+#include "stdafx.h"
+#include "Binder.h"
+#include "Validate.h"
+#include "PETraits.h"
+#include "CpuUtils.h"
+
+/* descriptor TimeDateStamp of an image bound with a bound import directory */
+#define BIND_NEW_STYLE 0xFFFFFFFF
+/* imports hashed ahead of their lookups */
+#define BIND_BATCH 16
+
+/* FNV-1a */
+static DWORD Binder_HashString(LPCSTR Name)
+{
+	DWORD Hash = 0x811c9dc5;
+	while (*Name != '\0')
+	{
+		Hash ^= (BYTE)*Name++;
+		Hash *= 0x01000193;
+	}
+	return Hash;
+}
+
+static DWORD Binder_HashName(DWORD Module, LPCSTR Name)
+{
+	return Binder_HashString(Name) ^ (Module * 0x9E3779B1);
+}
+
+/* 64 bits finalizer of MurmurHash3 */
+static DWORD Binder_HashOrdinal(DWORD Module, DWORD Ordinal)
+{
+	ULONGLONG Key = ((ULONGLONG)Module << 32) | Ordinal;
+	Key ^= Key >> 33;
+	Key *= 0xFF51AFD7ED558CCDULL;
+	Key ^= Key >> 33;
+	Key *= 0xC4CEB9FE1A85EC53ULL;
+	Key ^= Key >> 33;
+	return (DWORD)Key;
+}
+
+static DWORD Binder_HashSymbol(DWORD Module, LPCSTR Name, DWORD Ordinal)
+{
+	return Name != NULL ? Binder_HashName(Module, Name) : Binder_HashOrdinal(Module, Ordinal);
+}
+
+/* lowercase name without .dll extension, the length of at most Length bytes of Name, 0 if too long */
+static DWORD Binder_Normalize(LPCSTR Name, SIZE_T Length, PCHAR Buffer)
+{
+	DWORD i;
+
+	if (Length >= BIND_MAX_NAME)
+		return 0;
+	for (i = 0; i < Length && Name[i] != '\0'; i++)
+		Buffer[i] = (Name[i] >= 'A' && Name[i] <= 'Z') ? Name[i] - 'A' + 'a' : Name[i];
+	if (i > 4 && memcmp(Buffer + i - 4, ".dll", 4) == 0)
+		i -= 4;
+	Buffer[i] = '\0';
+	return i;
+}
+
+/* API set names lose their version (last number), other names are unchanged */
+static VOID Binder_StripVersion(PCHAR Name)
+{
+	PCHAR Dash;
+
+	if (strncmp(Name, "api-", 4) != 0 && strncmp(Name, "ext-", 4) != 0)
+		return;
+	Dash = strrchr(Name, '-');
+	if (Dash != NULL && Dash[1] >= '0' && Dash[1] <= '9')
+		*Dash = '\0';
+}
+
+static LPCSTR Binder_CopyString(PBINDER Binder, LPCSTR String)
+{
+	SIZE_T Length = strlen(String);
+	PCHAR Copy = (PCHAR)MemArenaAlloc(&Binder->Arena, Length + 1);
+
+	if (Copy != NULL)
+		memcpy(Copy, String, Length + 1);
+	return Copy;
+}
+
+VOID Binder_Init(PBINDER Binder)
+{
+	memset(Binder, 0, sizeof(BINDER));
+}
+
+BOOL Binder_AddModule(PBINDER Binder, PPE_IMAGE Image, ULONGLONG Base, LPCSTR Name)
+{
+	PIMAGE_EXPORT_DIRECTORY lpExportDirectory;
+	PBIND_MODULE Modules;
+	PBIND_MODULE Module;
+	CHAR Normalized[BIND_MAX_NAME];
+	DWORD MaxModules;
+
+	/* name of the export directory, bounded by the image */
+	if (Name == NULL)
+	{
+		lpExportDirectory = (PIMAGE_EXPORT_DIRECTORY)Image->Directories[IMAGE_DIRECTORY_ENTRY_EXPORT].Data;
+		if (lpExportDirectory == NULL || Image->Directories[IMAGE_DIRECTORY_ENTRY_EXPORT].Size < sizeof(IMAGE_EXPORT_DIRECTORY))
+			return FALSE;
+		Name = (LPCSTR)PE32_RVAToPointerRange(Image, lpExportDirectory->Name, 1);
+		if (Name == NULL || memchr(Name, 0, Image->Size - (SIZE_T)((PBYTE)Name - Image->Base)) == NULL)
+			return FALSE;
+	}
+	if (Binder_Normalize(Name, strlen(Name), Normalized) == 0)
+		return FALSE;
+
+	if (Binder->nModules == Binder->MaxModules)
+	{
+		MaxModules = Binder->MaxModules != 0 ? Binder->MaxModules * 2 : 64;
+		Modules = (PBIND_MODULE)realloc(Binder->Modules, MaxModules * sizeof(BIND_MODULE));
+		if (Modules == NULL)
+			return FALSE;
+		Binder->Modules = Modules;
+		Binder->MaxModules = MaxModules;
+	}
+	Module = &Binder->Modules[Binder->nModules];
+	Module->Name = Binder_CopyString(Binder, Normalized);
+	if (Module->Name == NULL)
+		return FALSE;
+	Module->Image = Image;
+	Module->Base = Base;
+	Module->TimeDateStamp = Image->NtHeaders->FileHeader.TimeDateStamp;
+	Module->bPreferredBase = Image->Traits->GetImageBase(Image) == Base;
+	Binder->nModules++;
+	return TRUE;
+}
+
+BOOL Binder_AddRedirection(PBINDER Binder, LPCSTR Source, LPCSTR Target)
+{
+	PBIND_REDIRECTION Redirections;
+	PBIND_REDIRECTION Redirection;
+	CHAR Normalized[BIND_MAX_NAME];
+	DWORD MaxRedirections;
+
+	if (Binder->nRedirections == Binder->MaxRedirections)
+	{
+		MaxRedirections = Binder->MaxRedirections != 0 ? Binder->MaxRedirections * 2 : 64;
+		Redirections = (PBIND_REDIRECTION)realloc(Binder->Redirections, MaxRedirections * sizeof(BIND_REDIRECTION));
+		if (Redirections == NULL)
+			return FALSE;
+		Binder->Redirections = Redirections;
+		Binder->MaxRedirections = MaxRedirections;
+	}
+	Redirection = &Binder->Redirections[Binder->nRedirections];
+	if (Binder_Normalize(Source, strlen(Source), Normalized) == 0)
+		return FALSE;
+	Binder_StripVersion(Normalized);
+	Redirection->Source = Binder_CopyString(Binder, Normalized);
+	if (Binder_Normalize(Target, strlen(Target), Normalized) == 0)
+		return FALSE;
+	Redirection->Target = Binder_CopyString(Binder, Normalized);
+	if (Redirection->Source == NULL || Redirection->Target == NULL)
+		return FALSE;
+	Binder->nRedirections++;
+	return TRUE;
+}
+
+/* slot of a normalized DLL name in the module map, empty if the name isn't there */
+static DWORD Binder_FindName(PBINDER Binder, LPCSTR Name)
+{
+	DWORD i;
+
+	for (i = Binder_HashString(Name) & Binder->ModuleMask; Binder->ModuleSlots[i] != 0; i = (i + 1) & Binder->ModuleMask)
+	{
+		if (strcmp(Binder->ModuleKeys[i], Name) == 0)
+			break;
+	}
+	return i;
+}
+
+/* index of a normalized name, redirections applied */
+static DWORD Binder_LookupName(PBINDER Binder, PCHAR Name)
+{
+	DWORD Slot = Binder_FindName(Binder, Name);
+
+	if (Binder->ModuleSlots[Slot] == 0)
+	{
+		/* another version of a redirected API set */
+		Binder_StripVersion(Name);
+		Slot = Binder_FindName(Binder, Name);
+	}
+	return Binder->ModuleSlots[Slot] != 0 ? Binder->ModuleSlots[Slot] - 1 : BIND_NO_MODULE;
+}
+
+/* add the exports of a module, its tables have been validated */
+static VOID Binder_AddExports(PBINDER Binder, DWORD Module)
+{
+	PPE_IMAGE Image = Binder->Modules[Module].Image;
+	PIMAGE_EXPORT_DIRECTORY lpExportDirectory = (PIMAGE_EXPORT_DIRECTORY)Image->Directories[IMAGE_DIRECTORY_ENTRY_EXPORT].Data;
+	DWORD ExportRVA = Image->Directories[IMAGE_DIRECTORY_ENTRY_EXPORT].VirtualAddress;
+	DWORD ExportSize = Image->Directories[IMAGE_DIRECTORY_ENTRY_EXPORT].Size;
+	PDWORD lpAddressOfFunctions = (PDWORD)PE32_RVAToPointer(Image, lpExportDirectory->AddressOfFunctions);
+	PDWORD lpAddressOfNames = (PDWORD)PE32_RVAToPointer(Image, lpExportDirectory->AddressOfNames);
+	PWORD lpAddressOfNameOrdinals = (PWORD)PE32_RVAToPointer(Image, lpExportDirectory->AddressOfNameOrdinals);
+	PBIND_SYMBOL Symbol;
+	DWORD Hash, RVA, Index, i;
+
+	/* every function by ordinal, then its names */
+	for (Index = 0; Index < lpExportDirectory->NumberOfFunctions + lpExportDirectory->NumberOfNames; Index++)
+	{
+		Symbol = &Binder->Symbols[Binder->nSymbols];
+		Symbol->Module = Module;
+		if (Index < lpExportDirectory->NumberOfFunctions)
+		{
+			RVA = lpAddressOfFunctions[Index];
+			if (RVA == 0)
+				continue;
+			Symbol->Name = NULL;
+			Symbol->Ordinal = lpExportDirectory->Base + Index;
+		}
+		else
+		{
+			i = Index - lpExportDirectory->NumberOfFunctions;
+			RVA = lpAddressOfFunctions[lpAddressOfNameOrdinals[i]];
+			Symbol->Name = (LPCSTR)PE32_RVAToPointer(Image, lpAddressOfNames[i]);
+			Symbol->Ordinal = lpExportDirectory->Base + lpAddressOfNameOrdinals[i];
+		}
+		Hash = Binder_HashSymbol(Module, Symbol->Name, Symbol->Ordinal);
+		/* a function RVA inside the export directory is a forwarder string */
+		if (RVA - ExportRVA < ExportSize)
+		{
+			Symbol->Forwarder = (LPCSTR)PE32_RVAToPointer(Image, RVA);
+			Symbol->RVA = 0;
+		}
+		else
+		{
+			Symbol->Forwarder = NULL;
+			Symbol->RVA = RVA;
+		}
+
+		/* the first of two identical names wins */
+		for (i = Hash & Binder->Mask; Binder->Slots[i].Symbol != 0; i = (i + 1) & Binder->Mask)
+		{
+			PBIND_SYMBOL Other = &Binder->Symbols[Binder->Slots[i].Symbol - 1];
+			if (Binder->Slots[i].Hash == Hash && Other->Module == Module && (Other->Name == NULL) == (Symbol->Name == NULL)
+				&& (Symbol->Name == NULL ? Other->Ordinal == Symbol->Ordinal : strcmp(Other->Name, Symbol->Name) == 0))
+				break;
+		}
+		if (Binder->Slots[i].Symbol == 0)
+		{
+			Binder->Slots[i].Hash = Hash;
+			Binder->Slots[i].Symbol = ++Binder->nSymbols;
+		}
+	}
+}
+
+/* power of two at least twice Count */
+static DWORD Binder_GetCapacity(ULONGLONG Count)
+{
+	DWORD Capacity = 16;
+	while (Capacity < Count * 2)
+		Capacity *= 2;
+	return Capacity;
+}
+
+BOOL Binder_Build(PBINDER Binder)
+{
+	PIMAGE_EXPORT_DIRECTORY lpExportDirectory;
+	ULONGLONG nSymbols = 0;
+	DWORD Capacity, Slot, Target;
+	CHAR Name[BIND_MAX_NAME];
+
+	for (DWORD i = 0; i < Binder->nModules; i++)
+	{
+		if (Binder->Modules[i].Image->Directories[IMAGE_DIRECTORY_ENTRY_EXPORT].VirtualAddress == 0 || !PE32_IsTableSafe(Binder->Modules[i].Image, PE_TABLE_EXPORTS))
+			continue;
+		lpExportDirectory = (PIMAGE_EXPORT_DIRECTORY)Binder->Modules[i].Image->Directories[IMAGE_DIRECTORY_ENTRY_EXPORT].Data;
+		nSymbols += (ULONGLONG)lpExportDirectory->NumberOfFunctions + lpExportDirectory->NumberOfNames;
+	}
+	if (nSymbols >= 0x40000000)
+		return FALSE;
+
+	/* names of the modules, then redirections to them */
+	Capacity = Binder_GetCapacity((ULONGLONG)Binder->nModules + Binder->nRedirections);
+	Binder->ModuleKeys = (LPCSTR*)MemArenaAlloc(&Binder->Arena, Capacity * sizeof(LPCSTR));
+	Binder->ModuleSlots = (PDWORD)MemArenaAlloc(&Binder->Arena, Capacity * sizeof(DWORD));
+	if (Binder->ModuleKeys == NULL || Binder->ModuleSlots == NULL)
+		return FALSE;
+	Binder->ModuleMask = Capacity - 1;
+	for (DWORD i = 0; i < Binder->nModules; i++)
+	{
+		Slot = Binder_FindName(Binder, Binder->Modules[i].Name);
+		if (Binder->ModuleSlots[Slot] != 0)
+			continue;
+		Binder->ModuleKeys[Slot] = Binder->Modules[i].Name;
+		Binder->ModuleSlots[Slot] = i + 1;
+	}
+	for (DWORD i = 0; i < Binder->nRedirections; i++)
+	{
+		strcpy(Name, Binder->Redirections[i].Target);
+		Target = Binder_LookupName(Binder, Name);
+		if (Target == BIND_NO_MODULE)
+			continue;
+		Slot = Binder_FindName(Binder, Binder->Redirections[i].Source);
+		Binder->ModuleKeys[Slot] = Binder->Redirections[i].Source;
+		Binder->ModuleSlots[Slot] = Target + 1;
+	}
+
+	Capacity = Binder_GetCapacity(nSymbols);
+	Binder->Symbols = (PBIND_SYMBOL)MemArenaAlloc(&Binder->Arena, (SIZE_T)nSymbols * sizeof(BIND_SYMBOL) + sizeof(BIND_SYMBOL));
+	Binder->Slots = (PBIND_SLOT)MemArenaAlloc(&Binder->Arena, Capacity * sizeof(BIND_SLOT));
+	if (Binder->Symbols == NULL || Binder->Slots == NULL)
+		return FALSE;
+	Binder->Mask = Capacity - 1;
+	Binder->nSymbols = 0;
+	for (DWORD i = 0; i < Binder->nModules; i++)
+	{
+		if (Binder->Modules[i].Image->Directories[IMAGE_DIRECTORY_ENTRY_EXPORT].VirtualAddress != 0 && PE32_IsTableSafe(Binder->Modules[i].Image, PE_TABLE_EXPORTS))
+			Binder_AddExports(Binder, i);
+	}
+	return TRUE;
+}
+
+DWORD Binder_FindModule(PBINDER Binder, LPCSTR DllName)
+{
+	CHAR Name[BIND_MAX_NAME];
+
+	if (Binder->ModuleSlots == NULL || Binder_Normalize(DllName, strlen(DllName), Name) == 0)
+		return BIND_NO_MODULE;
+	return Binder_LookupName(Binder, Name);
+}
+
+static PBIND_SYMBOL Binder_LookupSymbol(PBINDER Binder, DWORD Hash, DWORD Module, LPCSTR Name, DWORD Ordinal)
+{
+	PBIND_SYMBOL Symbol;
+
+	for (DWORD i = Hash & Binder->Mask; Binder->Slots[i].Symbol != 0; i = (i + 1) & Binder->Mask)
+	{
+		if (Binder->Slots[i].Hash != Hash)
+			continue;
+		Symbol = &Binder->Symbols[Binder->Slots[i].Symbol - 1];
+		if (Symbol->Module != Module)
+			continue;
+		if (Name == NULL ? Symbol->Name == NULL && Symbol->Ordinal == Ordinal : Symbol->Name != NULL && strcmp(Symbol->Name, Name) == 0)
+			return Symbol;
+	}
+	return NULL;
+}
+
+/* resolve an export of a module, forwarders followed, Hash is the hash of the export */
+static BOOL Binder_ResolveIn(PBINDER Binder, DWORD Module, LPCSTR Name, DWORD Ordinal, DWORD Hash, PBIND_RESULT Result)
+{
+	CHAR DllName[BIND_MAX_NAME];
+	PBIND_SYMBOL Symbol;
+	LPCSTR Dot;
+
+	for (Result->nForwards = 0; Module != BIND_NO_MODULE; Result->nForwards++)
+	{
+		Symbol = Binder_LookupSymbol(Binder, Hash, Module, Name, Ordinal);
+		if (Symbol == NULL)
+			return FALSE;
+		if (Symbol->Forwarder == NULL)
+		{
+			Result->Module = Module;
+			Result->Symbol = Symbol;
+			Result->Address = Binder->Modules[Module].Base + Symbol->RVA;
+			return TRUE;
+		}
+		if (Result->nForwards == BIND_MAX_FORWARDS)
+			return FALSE;
+
+		/* "DLL.Name" or "DLL.#Ordinal", the DLL name may contain dots */
+		Dot = strrchr(Symbol->Forwarder, '.');
+		if (Dot == NULL || Dot == Symbol->Forwarder || Binder_Normalize(Symbol->Forwarder, Dot - Symbol->Forwarder, DllName) == 0)
+			return FALSE;
+		if (Dot[1] == '#')
+		{
+			Name = NULL;
+			Ordinal = strtoul(Dot + 2, NULL, 10);
+		}
+		else
+			Name = Dot + 1;
+		Module = Binder_LookupName(Binder, DllName);
+		Hash = Binder_HashSymbol(Module, Name, Ordinal);
+	}
+	return FALSE;
+}
+
+BOOL Binder_Resolve(PBINDER Binder, LPCSTR DllName, LPCSTR Name, DWORD Ordinal, PBIND_RESULT Result)
+{
+	DWORD Module = Binder_FindModule(Binder, DllName);
+
+	if (Binder->Slots == NULL)
+		return FALSE;
+	return Binder_ResolveIn(Binder, Module, Name, Ordinal, Binder_HashSymbol(Module, Name, Ordinal), Result);
+}
+
+/* entry of a module in the bound import directory of an image, FALSE if it isn't there */
+static BOOL Binder_FindBoundModule(PBINDER Binder, PPE_IMAGE Image, DWORD Target, PIMAGE_BOUND_IMPORT_DESCRIPTOR* lpDescriptor)
+{
+	PBYTE Directory = Image->Directories[IMAGE_DIRECTORY_ENTRY_BOUND_IMPORT].Data;
+	DWORD Size = Image->Directories[IMAGE_DIRECTORY_ENTRY_BOUND_IMPORT].Size;
+	PIMAGE_BOUND_IMPORT_DESCRIPTOR Descriptor;
+	DWORD Offset = 0;
+	CHAR Name[BIND_MAX_NAME];
+	LPCSTR ModuleName;
+
+	if (Directory == NULL)
+		return FALSE;
+	/* each descriptor is followed by its forwarder references, the array ends with a null descriptor */
+	while (Offset + sizeof(IMAGE_BOUND_IMPORT_DESCRIPTOR) <= Size)
+	{
+		Descriptor = (PIMAGE_BOUND_IMPORT_DESCRIPTOR)(Directory + Offset);
+		if (Descriptor->OffsetModuleName == 0)
+			break;
+		if ((ULONGLONG)Offset + sizeof(IMAGE_BOUND_IMPORT_DESCRIPTOR) + (ULONGLONG)Descriptor->NumberOfModuleForwarderRefs * sizeof(IMAGE_BOUND_FORWARDER_REF) > Size)
+			break;
+		ModuleName = (LPCSTR)Directory + Descriptor->OffsetModuleName;
+		if (Descriptor->OffsetModuleName < Size && memchr(ModuleName, 0, Size - Descriptor->OffsetModuleName) != NULL
+			&& Binder_Normalize(ModuleName, strlen(ModuleName), Name) != 0 && Binder_LookupName(Binder, Name) == Target)
+		{
+			*lpDescriptor = Descriptor;
+			return TRUE;
+		}
+		Offset += sizeof(IMAGE_BOUND_IMPORT_DESCRIPTOR) + Descriptor->NumberOfModuleForwarderRefs * sizeof(IMAGE_BOUND_FORWARDER_REF);
+	}
+	return FALSE;
+}
+
+/* TRUE if the IAT of a descriptor bound at link time still holds the right addresses */
+static BOOL Binder_IsBindingValid(PBINDER Binder, PPE_IMAGE Image, PIMAGE_IMPORT_DESCRIPTOR Descriptor, DWORD Target)
+{
+	PIMAGE_BOUND_IMPORT_DESCRIPTOR Bound;
+	PIMAGE_BOUND_FORWARDER_REF References;
+	PBYTE Directory = Image->Directories[IMAGE_DIRECTORY_ENTRY_BOUND_IMPORT].Data;
+	DWORD Size = Image->Directories[IMAGE_DIRECTORY_ENTRY_BOUND_IMPORT].Size;
+	CHAR Name[BIND_MAX_NAME];
+	LPCSTR ModuleName;
+	DWORD Forwarded;
+
+	/* addresses were computed for the preferred base of the module */
+	if (Target == BIND_NO_MODULE || !Binder->Modules[Target].bPreferredBase)
+		return FALSE;
+	if (Descriptor->TimeDateStamp != BIND_NEW_STYLE)
+	{
+		/* old style: forwarded imports are chained in the IAT, they are bound again */
+		return Descriptor->ForwarderChain == BIND_NEW_STYLE && Descriptor->TimeDateStamp == Binder->Modules[Target].TimeDateStamp;
+	}
+
+	if (!Binder_FindBoundModule(Binder, Image, Target, &Bound) || Bound->TimeDateStamp != Binder->Modules[Target].TimeDateStamp)
+		return FALSE;
+	/* modules reached through forwarders must be unchanged too */
+	References = (PIMAGE_BOUND_FORWARDER_REF)(Bound + 1);
+	for (DWORD i = 0; i < Bound->NumberOfModuleForwarderRefs; i++)
+	{
+		ModuleName = (LPCSTR)Directory + References[i].OffsetModuleName;
+		if (References[i].OffsetModuleName >= Size || memchr(ModuleName, 0, Size - References[i].OffsetModuleName) == NULL)
+			return FALSE;
+		if (Binder_Normalize(ModuleName, strlen(ModuleName), Name) == 0)
+			return FALSE;
+		Forwarded = Binder_LookupName(Binder, Name);
+		if (Forwarded == BIND_NO_MODULE || !Binder->Modules[Forwarded].bPreferredBase || References[i].TimeDateStamp != Binder->Modules[Forwarded].TimeDateStamp)
+			return FALSE;
+	}
+	return TRUE;
+}
+
+BOOL Binder_BindModule(PBINDER Binder, DWORD Module, PBIND_STATS Stats)
+{
+	PBIND_MODULE Importer = &Binder->Modules[Module];
+	PPE_IMAGE Image = Importer->Image;
+	PCPE_TRAITS Traits = Image->Traits;
+	PIMAGE_IMPORT_DESCRIPTOR Descriptor;
+	PIMAGE_IMPORT_BY_NAME ImportByName;
+	BIND_RESULT Result;
+	PBYTE LookupTable, AddressTable, Limit;
+	LPCSTR DllName;
+	LPCSTR Names[BIND_BATCH];
+	DWORD Ordinals[BIND_BATCH];
+	DWORD Hashes[BIND_BATCH];
+	ULONGLONG Thunk, Address;
+	DWORD Target, nThunks, nBatch;
+	BOOL bLostNames = FALSE;
+	CHAR Normalized[BIND_MAX_NAME];
+
+	if (Image->Directories[IMAGE_DIRECTORY_ENTRY_IMPORT].VirtualAddress == 0 || Binder->Slots == NULL)
+		return TRUE;
+	/* thunk arrays and names are checked once, the loop below trusts them */
+	if (!PE32_IsTableSafe(Image, PE_TABLE_IMPORTS))
+	{
+		Stats->nMalformed++;
+		return FALSE;
+	}
+	Descriptor = (PIMAGE_IMPORT_DESCRIPTOR)Image->Directories[IMAGE_DIRECTORY_ENTRY_IMPORT].Data;
+	Limit = (PBYTE)Descriptor + Image->Directories[IMAGE_DIRECTORY_ENTRY_IMPORT].Size;
+	for (; (PBYTE)(Descriptor + 1) <= Limit && !MemIsNull(Descriptor, sizeof(IMAGE_IMPORT_DESCRIPTOR)); Descriptor++)
+	{
+		Stats->nDescriptors++;
+		DllName = (LPCSTR)PE32_RVAToPointer(Image, Descriptor->Name);
+		/* the module is looked up once for all the imports of the descriptor */
+		Target = BIND_NO_MODULE;
+		if (Binder_Normalize(DllName, strlen(DllName), Normalized) != 0)
+			Target = Binder_LookupName(Binder, Normalized);
+		if (Descriptor->TimeDateStamp != 0)
+		{
+			if (Binder_IsBindingValid(Binder, Image, Descriptor, Target))
+			{
+				Stats->nBoundValid++;
+				continue;
+			}
+			Stats->nBoundStale++;
+			/* the names were replaced by the bound addresses */
+			if (Descriptor->OriginalFirstThunk == 0)
+				continue;
+		}
+
+		LookupTable = (PBYTE)PE32_RVAToPointer(Image, Descriptor->OriginalFirstThunk != 0 ? Descriptor->OriginalFirstThunk : Descriptor->FirstThunk);
+		AddressTable = (PBYTE)PE32_RVAToPointer(Image, Descriptor->FirstThunk);
+		nThunks = Traits->CountThunks(Image, LookupTable);
+		bLostNames |= Descriptor->OriginalFirstThunk == 0;
+		for (DWORD Batch = 0; Batch < nThunks; Batch += BIND_BATCH)
+		{
+			nBatch = nThunks - Batch < BIND_BATCH ? nThunks - Batch : BIND_BATCH;
+			/* hashes of a batch first: the slots are loaded while the previous imports are resolved */
+			for (DWORD i = 0; i < nBatch; i++)
+			{
+				Thunk = 0;
+				memcpy(&Thunk, LookupTable + (SIZE_T)(Batch + i) * Traits->ThunkSize, Traits->ThunkSize);
+				if (Thunk & Traits->OrdinalFlag)
+				{
+					Names[i] = NULL;
+					Ordinals[i] = (DWORD)(Thunk & 0xFFFF);
+				}
+				else
+				{
+					ImportByName = (PIMAGE_IMPORT_BY_NAME)PE32_RVAToPointer(Image, (DWORD)Thunk);
+					Names[i] = (LPCSTR)ImportByName->Name;
+					Ordinals[i] = 0;
+				}
+				Hashes[i] = Binder_HashSymbol(Target, Names[i], Ordinals[i]);
+				CPU_PREFETCH(&Binder->Slots[Hashes[i] & Binder->Mask]);
+			}
+
+			for (DWORD i = 0; i < nBatch; i++)
+			{
+				if (Binder_ResolveIn(Binder, Target, Names[i], Ordinals[i], Hashes[i], &Result))
+				{
+					Address = Result.Address;
+					Stats->nForwarded += Result.nForwards != 0;
+				}
+				else
+				{
+					Stats->nUnresolved++;
+					Address = Binder->Unresolved != NULL ? Binder->Unresolved(Importer, DllName, Names[i], Ordinals[i], Binder->UserArgs) : 0;
+					if (Address == 0)
+						continue;
+				}
+				/* IAT entries are as wide as the thunks, little endian */
+				memcpy(AddressTable + (SIZE_T)(Batch + i) * Traits->ThunkSize, &Address, Traits->ThunkSize);
+				Stats->nImports++;
+			}
+		}
+	}
+
+	/* the lookup table was the IAT: the checked names have been overwritten */
+	if (bLostNames)
+	{
+		Image->CheckedTables &= ~PE_TABLE_IMPORTS;
+		Image->SafeTables &= ~PE_TABLE_IMPORTS;
+	}
+	return TRUE;
+}
+
+BOOL Binder_BindAll(PBINDER Binder, PBIND_STATS Stats)
+{
+	BOOL bSuccess = TRUE;
+
+	memset(Stats, 0, sizeof(BIND_STATS));
+	for (DWORD i = 0; i < Binder->nModules; i++)
+		bSuccess &= Binder_BindModule(Binder, i, Stats);
+	return bSuccess;
+}
+
+VOID Binder_Release(PBINDER Binder)
+{
+	MemArenaRelease(&Binder->Arena);
+	free(Binder->Modules);
+	free(Binder->Redirections);
+	memset(Binder, 0, sizeof(BINDER));
+}
@@ -0,0 +1,246 @@
+/**
+ * \file Binder.h
+ * \brief Binding of the imports of a set of images with one symbol table
+ * \author Tomtombinary
+ * \version 1.0
+ * \date 17 octobre 2026
+ * Exports of all the modules of a set are put in one hash table, keyed by
+ * (module, name) and (module, ordinal): an import is resolved by one lookup
+ * instead of an enumeration of the exports of its DLL. Forwarders are
+ * followed (chains included) and DLL names can be redirected, for API sets
+ * (api-ms-win-*, ext-ms-win-*) or renamed modules.
+ * Binding writes the address of each import in the IAT (FirstThunk) of the
+ * importer, whose buffer must be writable. Descriptors bound at link time
+ * whose timestamps still match their modules, loaded at their preferred
+ * base, are left untouched.
+ * Once Binder_Build has been called, Binder_Resolve and Binder_BindModule
+ * can be called from several threads (a module bound by one thread at a time).
+ */
+
+#pragma once
+#include "stdafx.h"
+#include "PEUtils.h"
+#include "MemUtils.h"
+
+#define BIND_MAX_FORWARDS 16 /* forwarders followed before a chain is considered a loop */
+#define BIND_NO_MODULE 0xFFFFFFFF
+#define BIND_MAX_NAME 256     /* longest DLL name */
+
+/**
+ * \struct BIND_MODULE
+ * \brief an image of the set
+ * Image: image description, its import table is rewritten by the binding
+ * Base: address of the image in the bound process, base of the addresses written in the IATs
+ * Name: normalized name (lowercase, without .dll), looked up by the import descriptors and forwarders
+ * TimeDateStamp: FileHeader.TimeDateStamp, compared to the timestamps of bound imports
+ * bPreferredBase: TRUE if Base is the ImageBase of the optional header
+ */
+typedef struct _BIND_MODULE
+{
+	PPE_IMAGE Image;
+	ULONGLONG Base;
+	LPCSTR Name;
+	DWORD TimeDateStamp;
+	BOOL bPreferredBase;
+}BIND_MODULE,*PBIND_MODULE;
+
+/**
+ * \struct BIND_SYMBOL
+ * \brief an export in the symbol table
+ * Module: index of the exporting module
+ * Name: exported name, NULL for the entry of an ordinal
+ * Ordinal: ordinal of the export, Base of the export directory included
+ * RVA: RVA of the function, 0 for a forwarder
+ * Forwarder: forwarder string ("DLL.Name" or "DLL.#Ordinal"), NULL if the export isn't forwarded
+ */
+typedef struct _BIND_SYMBOL
+{
+	DWORD Module;
+	LPCSTR Name;
+	DWORD Ordinal;
+	DWORD RVA;
+	LPCSTR Forwarder;
+}BIND_SYMBOL,*PBIND_SYMBOL;
+
+/**
+ * \struct BIND_SLOT
+ * \brief a slot of the symbol table, probes compare hashes without reading the symbols
+ * Hash: hash of (Module, Name) or (Module, Ordinal)
+ * Symbol: index in Symbols plus one, 0 for an empty slot
+ */
+typedef struct _BIND_SLOT
+{
+	DWORD Hash;
+	DWORD Symbol;
+}BIND_SLOT,*PBIND_SLOT;
+
+/**
+ * \struct BIND_REDIRECTION
+ * \brief a DLL name replaced by another one before the module is looked up
+ * Source, Target: normalized names, without version for an API set
+ */
+typedef struct _BIND_REDIRECTION
+{
+	LPCSTR Source;
+	LPCSTR Target;
+}BIND_REDIRECTION,*PBIND_REDIRECTION;
+
+/**
+ * \struct BIND_RESULT
+ * \brief a resolved import
+ * Module: index of the module which implements the function, after the forwarders
+ * Symbol: its export
+ * Address: Base of the module plus the RVA of the function
+ * nForwards: number of forwarders followed
+ */
+typedef struct _BIND_RESULT
+{
+	DWORD Module;
+	PBIND_SYMBOL Symbol;
+	ULONGLONG Address;
+	DWORD nForwards;
+}BIND_RESULT,*PBIND_RESULT;
+
+/**
+ * \struct BIND_STATS
+ * \brief counters of a binding, added to by each call
+ * nDescriptors: import descriptors seen
+ * nImports: IAT entries written
+ * nForwarded: imports resolved through at least one forwarder
+ * nUnresolved: imports whose module or export couldn't be found, IAT entry left unchanged or set by the callback
+ * nBoundValid: descriptors skipped because their binding is still valid
+ * nBoundStale: descriptors bound at link time but bound again (timestamp or base mismatch)
+ * nMalformed: modules whose import table is malformed, not bound
+ */
+typedef struct _BIND_STATS
+{
+	ULONGLONG nDescriptors;
+	ULONGLONG nImports;
+	ULONGLONG nForwarded;
+	ULONGLONG nUnresolved;
+	ULONGLONG nBoundValid;
+	ULONGLONG nBoundStale;
+	ULONGLONG nMalformed;
+}BIND_STATS,*PBIND_STATS;
+
+/**
+ * Callback for imports which couldn't be resolved: returns the address to write in the IAT, 0 to leave the entry unchanged
+ * Name is NULL for an import by ordinal.
+ */
+typedef ULONGLONG(*BindUnresolvedCallback)(PBIND_MODULE Importer, LPCSTR DllName, LPCSTR Name, DWORD Ordinal, LPVOID UserArgs);
+
+/**
+ * \struct BINDER
+ * \brief set of modules and its symbol table
+ * Modules, Redirections: arrays filled by Binder_AddModule and Binder_AddRedirection
+ * Symbols, Slots, Mask: symbol table built by Binder_Build, open addressing
+ * ModuleKeys, ModuleSlots, ModuleMask: module of each DLL name (names of the modules, then sources of the redirections), ModuleSlots[i] is the index of the module plus one
+ * Unresolved, UserArgs: [optional] callback for unresolved imports and its argument
+ * Arena: memory of the tables
+ */
+typedef struct _BINDER
+{
+	PBIND_MODULE Modules;
+	DWORD nModules;
+	DWORD MaxModules;
+	PBIND_REDIRECTION Redirections;
+	DWORD nRedirections;
+	DWORD MaxRedirections;
+	PBIND_SYMBOL Symbols;
+	DWORD nSymbols;
+	PBIND_SLOT Slots;
+	DWORD Mask;
+	LPCSTR* ModuleKeys;
+	PDWORD ModuleSlots;
+	DWORD ModuleMask;
+	BindUnresolvedCallback Unresolved;
+	LPVOID UserArgs;
+	MEM_ARENA Arena;
+}BINDER,*PBINDER;
+
+/**
+ * \fn VOID Binder_Init(PBINDER Binder);
+ * \brief initialize an empty set of modules
+ * \param Binder: binder, released by Binder_Release
+ */
+VOID Binder_Init(PBINDER Binder);
+
+/**
+ * \fn BOOL Binder_AddModule(PBINDER Binder, PPE_IMAGE Image, ULONGLONG Base, LPCSTR Name);
+ * \brief add an image to the set, before Binder_Build
+ * \param Binder: binder
+ * \param Image: image description, must stay valid until Binder_Release
+ * \param Base: address of the image in the bound process
+ * \param Name: [optional] name of the module (file name), NULL for the name of its export directory
+ * \return FALSE if the module has no name or memory couldn't be allocated
+ */
+BOOL Binder_AddModule(PBINDER Binder, PPE_IMAGE Image, ULONGLONG Base, LPCSTR Name);
+
+/**
+ * \fn BOOL Binder_AddRedirection(PBINDER Binder, LPCSTR Source, LPCSTR Target);
+ * \brief resolve the imports and forwarders of a DLL in another one, before Binder_Build
+ * The version of an API set name is ignored: api-ms-win-core-synch-l1-2-0 also redirects api-ms-win-core-synch-l1-2-1.
+ * \param Binder: binder
+ * \param Source: DLL name found in the images
+ * \param Target: name of the module which implements it
+ * \return FALSE if memory couldn't be allocated
+ */
+BOOL Binder_AddRedirection(PBINDER Binder, LPCSTR Source, LPCSTR Target);
+
+/**
+ * \fn BOOL Binder_Build(PBINDER Binder);
+ * \brief build the symbol table of all the exports of the set
+ * Modules with a malformed export table are kept without exports.
+ * \param Binder: binder
+ * \return FALSE if memory couldn't be allocated
+ */
+BOOL Binder_Build(PBINDER Binder);
+
+/**
+ * \fn DWORD Binder_FindModule(PBINDER Binder, LPCSTR DllName);
+ * \brief find a module by name, redirections applied
+ * \param Binder: binder built by Binder_Build
+ * \param DllName: name of a DLL, case and .dll extension ignored
+ * \return index of the module, BIND_NO_MODULE if it isn't in the set
+ */
+DWORD Binder_FindModule(PBINDER Binder, LPCSTR DllName);
+
+/**
+ * \fn BOOL Binder_Resolve(PBINDER Binder, LPCSTR DllName, LPCSTR Name, DWORD Ordinal, PBIND_RESULT Result);
+ * \brief resolve an import, following forwarders
+ * \param Binder: binder built by Binder_Build
+ * \param DllName: DLL of the import
+ * \param Name: [optional] name of the import, NULL for an import by ordinal
+ * \param Ordinal: ordinal of the import when Name is NULL
+ * \param Result: [out] implementation of the import
+ * \return FALSE if a module or an export is missing, or a forwarder chain is longer than BIND_MAX_FORWARDS
+ */
+BOOL Binder_Resolve(PBINDER Binder, LPCSTR DllName, LPCSTR Name, DWORD Ordinal, PBIND_RESULT Result);
+
+/**
+ * \fn BOOL Binder_BindModule(PBINDER Binder, DWORD Module, PBIND_STATS Stats);
+ * \brief write the IAT of a module of the set
+ * Descriptors without import lookup table (OriginalFirstThunk) lose their names:
+ * the import table of the image is validated again before its next enumeration.
+ * \param Binder: binder built by Binder_Build
+ * \param Module: index of the importing module
+ * \param Stats: [in, out] counters, added to
+ * \return FALSE if the import table of the module is malformed
+ */
+BOOL Binder_BindModule(PBINDER Binder, DWORD Module, PBIND_STATS Stats);
+
+/**
+ * \fn BOOL Binder_BindAll(PBINDER Binder, PBIND_STATS Stats);
+ * \brief write the IATs of all the modules of the set
+ * \param Binder: binder built by Binder_Build
+ * \param Stats: [out] counters
+ * \return FALSE if the import table of a module is malformed (the others are bound)
+ */
+BOOL Binder_BindAll(PBINDER Binder, PBIND_STATS Stats);
+
+/**
+ * \fn VOID Binder_Release(PBINDER Binder);
+ * \brief release the tables of a binder, images aren't closed
+ * \param Binder: binder
+ */
+VOID Binder_Release(PBINDER Binder);
@@ -0,0 +1,119 @@
+/**
+ * \file BulkEnum.c
+ * \brief Defines function described in file BulkEnum.h
+ * \author Tomtombinary
+ * \version 1.0
+ * \date 17 octobre 2026
+ */
+
+#include "stdafx.h"
+#include "BulkEnum.h"
+#include "MemUtils.h"
+#include "Validate.h"
+#include "PETraits.h"
+
+VOID PE32_InitRelocCursor(PPE_IMAGE Image, PRELOC_CURSOR Cursor)
+{
+	PPE_DIRECTORY lpDirectory = &Image->Directories[IMAGE_DIRECTORY_ENTRY_BASERELOC];
+
+	Cursor->Block = NULL;
+	Cursor->Limit = NULL;
+	Cursor->Item = 0;
+	if (PE32_IsTableSafe(Image, PE_TABLE_RELOCS))
+	{
+		Cursor->Block = (PIMAGE_BASE_RELOCATION)lpDirectory->Data;
+		Cursor->Limit = (PBYTE)lpDirectory->Data + lpDirectory->Size;
+	}
+}
+
+DWORD PE32_GetRelocations(PPE_IMAGE Image, PRELOC_CURSOR Cursor, PDWORD lpRVAs, PBYTE lpTypes, DWORD nMax)
+{
+	PIMAGE_BASE_RELOCATION BaseRelocation = Cursor->Block;
+	PWORD Items;
+	DWORD nItems, nCopy, dwPage, i;
+	DWORD nCount = 0;
+
+	/* bounds were taken from the image by PE32_InitRelocCursor */
+	UNREFERENCED_PARAMETER(Image);
+	while (nCount < nMax && BaseRelocation != NULL)
+	{
+		/* end of table or null block */
+		if ((PBYTE)BaseRelocation + sizeof(IMAGE_BASE_RELOCATION) > Cursor->Limit
+			|| MemIsNull(BaseRelocation, sizeof(IMAGE_BASE_RELOCATION)))
+		{
+			BaseRelocation = NULL;
+			break;
+		}
+
+		Items = (PWORD)((PBYTE)BaseRelocation + sizeof(IMAGE_BASE_RELOCATION)) + Cursor->Item;
+		nItems = (BaseRelocation->SizeOfBlock - sizeof(IMAGE_BASE_RELOCATION)) / sizeof(WORD) - Cursor->Item;
+		nCopy = nItems < nMax - nCount ? nItems : nMax - nCount;
+		dwPage = BaseRelocation->VirtualAddress;
+
+		if (lpRVAs != NULL)
+		{
+			for (i = 0; i < nCopy; i++)
+				lpRVAs[nCount + i] = dwPage + (Items[i] & 0xFFF);
+		}
+		if (lpTypes != NULL)
+		{
+			for (i = 0; i < nCopy; i++)
+				lpTypes[nCount + i] = (BYTE)(Items[i] >> 12);
+		}
+		nCount += nCopy;
+
+		if (nCopy == nItems)
+		{
+			BaseRelocation = (PIMAGE_BASE_RELOCATION)((PBYTE)BaseRelocation + BaseRelocation->SizeOfBlock);
+			Cursor->Item = 0;
+		}
+		else
+			Cursor->Item += nCopy;
+	}
+	Cursor->Block = BaseRelocation;
+	return nCount;
+}
+
+VOID PE32_InitImportCursor(PPE_IMAGE Image, PIMPORT_CURSOR Cursor)
+{
+	PPE_DIRECTORY lpDirectory = &Image->Directories[IMAGE_DIRECTORY_ENTRY_IMPORT];
+
+	Cursor->Descriptor = NULL;
+	Cursor->Limit = NULL;
+	Cursor->Thunk = 0;
+	if (PE32_IsTableSafe(Image, PE_TABLE_IMPORTS))
+	{
+		Cursor->Descriptor = (PIMAGE_IMPORT_DESCRIPTOR)lpDirectory->Data;
+		Cursor->Limit = (PBYTE)lpDirectory->Data + lpDirectory->Size;
+	}
+}
+
+DWORD PE32_GetImports(PPE_IMAGE Image, PIMPORT_CURSOR Cursor, PIMPORT_ARRAYS Arrays, DWORD nMax)
+{
+	PIMAGE_IMPORT_DESCRIPTOR lpImportDesc = Cursor->Descriptor;
+	DWORD nThunks;
+	BOOL bEnd;
+	DWORD nCount = 0;
+
+	while (nCount < nMax && lpImportDesc != NULL)
+	{
+		if ((PBYTE)(lpImportDesc + 1) > Cursor->Limit || MemIsNull(lpImportDesc, sizeof(IMAGE_IMPORT_DESCRIPTOR)))
+		{
+			lpImportDesc = NULL;
+			break;
+		}
+
+		/* thunks of the descriptor from the cursor, 32 or 64 bits wide */
+		nThunks = Image->Traits->GetThunks(Image, lpImportDesc, Cursor->Thunk, Arrays, nCount, nMax, &bEnd);
+		nCount += nThunks;
+		Cursor->Thunk += nThunks;
+
+		if (bEnd)
+		{
+			lpImportDesc += 1;
+			Cursor->Thunk = 0;
+		}
+	}
+	Cursor->Descriptor = lpImportDesc;
+	return nCount;
+}
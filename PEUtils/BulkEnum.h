@@ -0,0 +1,89 @@
+/**
+ * \file BulkEnum.h
+ * \brief Extraction of relocations and imports in caller arrays, chunk by chunk
+ * \author Tomtombinary
+ * \version 1.0
+ * \date 17 octobre 2026
+ * Instead of calling a callback for each entry, these functions fill arrays
+ * (one array per field) and keep their position in a cursor, so big tables
+ * can be drained in fixed-size chunks.
+ */
+
+#pragma once
+#include "stdafx.h"
+#include "PEUtils.h"
+
+/**
+ * \struct RELOC_CURSOR
+ * \brief position in the relocation table, initialized by PE32_InitRelocCursor
+ */
+typedef struct _RELOC_CURSOR
+{
+	PIMAGE_BASE_RELOCATION Block;
+	PBYTE Limit;
+	DWORD Item;
+}RELOC_CURSOR,*PRELOC_CURSOR;
+
+/**
+ * \struct IMPORT_CURSOR
+ * \brief position in the import table, initialized by PE32_InitImportCursor
+ */
+typedef struct _IMPORT_CURSOR
+{
+	PIMAGE_IMPORT_DESCRIPTOR Descriptor;
+	PBYTE Limit;
+	DWORD Thunk;
+}IMPORT_CURSOR,*PIMPORT_CURSOR;
+
+/**
+ * \struct IMPORT_ARRAYS
+ * \brief arrays filled by PE32_GetImports, each array is optional (NULL)
+ * DllNames: name of the imported module
+ * Names: name of the imported function, NULL for an import by ordinal
+ * Hints: hint of the import by name, or ordinal of the import by ordinal
+ * Thunks: value of the IAT entry (FirstThunk)
+ */
+typedef struct _IMPORT_ARRAYS
+{
+	LPCSTR* DllNames;
+	LPCSTR* Names;
+	PWORD Hints;
+	PULONGLONG Thunks;
+}IMPORT_ARRAYS,*PIMPORT_ARRAYS;
+
+/**
+ * \fn VOID PE32_InitRelocCursor(PPE_IMAGE Image, PRELOC_CURSOR Cursor);
+ * \brief place a cursor on the first relocation of an image
+ * The cursor is empty if the relocation table is malformed (see PE32_ValidateImage).
+ */
+VOID PE32_InitRelocCursor(PPE_IMAGE Image, PRELOC_CURSOR Cursor);
+
+/**
+ * \fn DWORD PE32_GetRelocations(PPE_IMAGE Image, PRELOC_CURSOR Cursor, PDWORD lpRVAs, PBYTE lpTypes, DWORD nMax);
+ * \brief extract the next relocations
+ * \param Image: image description
+ * \param Cursor: [in, out] position in the relocation table
+ * \param lpRVAs: [out, optional] RVAs of the relocated slots
+ * \param lpTypes: [out, optional] types of the relocations
+ * \param nMax: capacity of the arrays
+ * \return number of relocations extracted, 0 when the table has been drained
+ */
+DWORD PE32_GetRelocations(PPE_IMAGE Image, PRELOC_CURSOR Cursor, PDWORD lpRVAs, PBYTE lpTypes, DWORD nMax);
+
+/**
+ * \fn VOID PE32_InitImportCursor(PPE_IMAGE Image, PIMPORT_CURSOR Cursor);
+ * \brief place a cursor on the first import of an image
+ * The cursor is empty if the import table is malformed (see PE32_ValidateImage).
+ */
+VOID PE32_InitImportCursor(PPE_IMAGE Image, PIMPORT_CURSOR Cursor);
+
+/**
+ * \fn DWORD PE32_GetImports(PPE_IMAGE Image, PIMPORT_CURSOR Cursor, PIMPORT_ARRAYS Arrays, DWORD nMax);
+ * \brief extract the next imports
+ * \param Image: image description
+ * \param Cursor: [in, out] position in the import table
+ * \param Arrays: [out] arrays to fill
+ * \param nMax: capacity of the arrays
+ * \return number of imports extracted, 0 when the table has been drained
+ */
+DWORD PE32_GetImports(PPE_IMAGE Image, PIMPORT_CURSOR Cursor, PIMPORT_ARRAYS Arrays, DWORD nMax);
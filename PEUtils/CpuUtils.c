@@ -0,0 +1,79 @@
+/**
+ * \file CpuUtils.c
+ * \brief Defines function described in file CpuUtils.h
+ * \author Tomtombinary
+ * \version 1.0
+ * \date 17 octobre 2026
+ */
+
+#include "stdafx.h"
+#include "CpuUtils.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#elif defined(CPU_X86)
+#include <cpuid.h>
+#endif
+
+#define CPU_FEATURES_UNKNOWN 0x80000000
+
+static volatile DWORD CpuFeatures = CPU_FEATURES_UNKNOWN;
+
+static DWORD CpuUtils_Detect(VOID)
+{
+	DWORD Features = 0;
+#if defined(CPU_X86) && defined(__GNUC__)
+	unsigned int Eax, Ebx, Ecx, Edx;
+
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("sse2"))
+		Features |= CPU_FEATURE_SSE2;
+	if (__builtin_cpu_supports("ssse3"))
+		Features |= CPU_FEATURE_SSSE3;
+	if (__builtin_cpu_supports("sse4.1"))
+		Features |= CPU_FEATURE_SSE41;
+	if (__builtin_cpu_supports("avx2"))
+		Features |= CPU_FEATURE_AVX2;
+	/* SHA extensions: leaf 7, EBX bit 29 */
+	if (__get_cpuid_count(7, 0, &Eax, &Ebx, &Ecx, &Edx) && (Ebx & (1 << 29)))
+		Features |= CPU_FEATURE_SHA;
+#elif defined(CPU_X86)
+	int Info[4];
+
+	__cpuid(Info, 1);
+	if (Info[3] & (1 << 26))
+		Features |= CPU_FEATURE_SSE2;
+	if (Info[2] & (1 << 9))
+		Features |= CPU_FEATURE_SSSE3;
+	if (Info[2] & (1 << 19))
+		Features |= CPU_FEATURE_SSE41;
+	/* AVX registers must also be saved by the system (OSXSAVE, XCR0) */
+	if ((Info[2] & (1 << 27)) && (Info[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6)
+	{
+		__cpuidex(Info, 7, 0);
+		if (Info[1] & (1 << 5))
+			Features |= CPU_FEATURE_AVX2;
+	}
+	__cpuidex(Info, 7, 0);
+	if (Info[1] & (1 << 29))
+		Features |= CPU_FEATURE_SHA;
+#endif
+	return Features;
+}
+
+DWORD CpuUtils_GetFeatures(VOID)
+{
+	DWORD Features = CpuFeatures;
+	LPCSTR Mask;
+
+	/* concurrent first calls compute the same value */
+	if (Features == CPU_FEATURES_UNKNOWN)
+	{
+		Features = CpuUtils_Detect();
+		Mask = getenv("PEUTILS_CPU_FEATURES");
+		if (Mask != NULL)
+			Features &= (DWORD)strtoul(Mask, NULL, 16);
+		CpuFeatures = Features;
+	}
+	return Features;
+}
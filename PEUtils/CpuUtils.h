@@ -0,0 +1,48 @@
+/**
+ * \file CpuUtils.h
+ * \brief Detection of the instruction sets usable by the vectorized kernels
+ * \author Tomtombinary
+ * \version 1.0
+ * \date 17 octobre 2026
+ * Kernels are compiled for every instruction set the compiler knows
+ * (CPU_TARGET enables one on a single function with GCC and clang, MSVC
+ * needs nothing) and one of them is chosen at run time with CpuUtils_GetFeatures.
+ */
+
+#pragma once
+#include "stdafx.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CPU_X86
+#define CPU_TARGET(x) __attribute__((target(x)))
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define CPU_X86
+#define CPU_TARGET(x)
+#endif
+
+#ifdef CPU_X86
+#include <immintrin.h>
+#endif
+
+/* hint to load a cache line which will be read soon */
+#if defined(__GNUC__)
+#define CPU_PREFETCH(Address) __builtin_prefetch(Address)
+#elif defined(CPU_X86)
+#define CPU_PREFETCH(Address) _mm_prefetch((const char*)(Address), _MM_HINT_T0)
+#else
+#define CPU_PREFETCH(Address) ((void)(Address))
+#endif
+
+#define CPU_FEATURE_SSE2 0x1
+#define CPU_FEATURE_SSSE3 0x2
+#define CPU_FEATURE_SSE41 0x4
+#define CPU_FEATURE_AVX2 0x8
+#define CPU_FEATURE_SHA 0x10
+
+/**
+ * \fn DWORD CpuUtils_GetFeatures(VOID);
+ * \brief instruction sets supported by the processor and the operating system
+ * The environment variable PEUTILS_CPU_FEATURES (hexadecimal mask) restricts them, to test the fallbacks.
+ * \return CPU_FEATURE_* flags, 0 on other architectures
+ */
+DWORD CpuUtils_GetFeatures(VOID);
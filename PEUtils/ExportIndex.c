@@ -0,0 +1,181 @@
+/**
+ * \file ExportIndex.c
+ * \brief Defines function described in file ExportIndex.h
+ * \author Tomtombinary
+ * \version 1.0
+ * \date 17 octobre 2026
+ */
+
+#include "stdafx.h"
+#include "ExportIndex.h"
+#include "Validate.h"
+
+/**
+ * \struct EXPORT_TABLES
+ * \brief pointers on the export directory and its tables
+ */
+typedef struct _EXPORT_TABLES
+{
+	PIMAGE_EXPORT_DIRECTORY Directory;
+	DWORD DirectoryRVA;
+	DWORD DirectorySize;
+	PDWORD AddressOfFunctions;
+	PDWORD AddressOfNames;
+	PWORD AddressOfNameOrdinals;
+}EXPORT_TABLES,*PEXPORT_TABLES;
+
+static BOOL ExportIndex_GetTables(PPE_IMAGE Image, PEXPORT_TABLES Tables)
+{
+	PPE_DIRECTORY lpDirectory = &Image->Directories[IMAGE_DIRECTORY_ENTRY_EXPORT];
+
+	if (lpDirectory->VirtualAddress == 0 || !PE32_IsTableSafe(Image, PE_TABLE_EXPORTS))
+		return FALSE;
+	Tables->DirectoryRVA = lpDirectory->VirtualAddress;
+	Tables->DirectorySize = lpDirectory->Size;
+	Tables->Directory = (PIMAGE_EXPORT_DIRECTORY)lpDirectory->Data;
+	Tables->AddressOfFunctions = (PDWORD)PE32_RVAToPointer(Image, Tables->Directory->AddressOfFunctions);
+	Tables->AddressOfNames = (PDWORD)PE32_RVAToPointer(Image, Tables->Directory->AddressOfNames);
+	Tables->AddressOfNameOrdinals = (PWORD)PE32_RVAToPointer(Image, Tables->Directory->AddressOfNameOrdinals);
+	return TRUE;
+}
+
+/* describe the function at index dwIndex of AddressOfFunctions */
+static BOOL ExportIndex_FillEntry(PPE_IMAGE Image, PEXPORT_TABLES Tables, DWORD dwIndex, PEXPORT_ENTRY Entry)
+{
+	if (dwIndex >= Tables->Directory->NumberOfFunctions)
+		return FALSE;
+	Entry->Ordinal = (WORD)dwIndex;
+	Entry->RVAFunction = Tables->AddressOfFunctions[dwIndex];
+	if (Entry->RVAFunction == 0)
+		return FALSE;
+	/* a function RVA inside the export directory is a forwarder string */
+	if (Entry->RVAFunction - Tables->DirectoryRVA < Tables->DirectorySize)
+	{
+		Entry->Forwarder = (LPCSTR)PE32_RVAToPointer(Image, Entry->RVAFunction);
+		Entry->pFunction = NULL;
+	}
+	else
+	{
+		Entry->Forwarder = NULL;
+		Entry->pFunction = PE32_RVAToPointer(Image, Entry->RVAFunction);
+	}
+	return TRUE;
+}
+
+/* FNV-1a */
+static DWORD ExportIndex_Hash(LPCSTR Name)
+{
+	DWORD Hash = 0x811c9dc5;
+	while (*Name != '\0')
+	{
+		Hash ^= (BYTE)*Name++;
+		Hash *= 0x01000193;
+	}
+	return Hash;
+}
+
+static BOOL ExportIndex_FillNamedEntry(PPE_IMAGE Image, PEXPORT_TABLES Tables, DWORD dwName, PEXPORT_ENTRY Entry)
+{
+	if (!ExportIndex_FillEntry(Image, Tables, Tables->AddressOfNameOrdinals[dwName], Entry))
+		return FALSE;
+	Entry->RVAName = Tables->AddressOfNames[dwName];
+	Entry->Name = (LPCSTR)PE32_RVAToPointer(Image, Entry->RVAName);
+	return TRUE;
+}
+
+BOOL PE32_FindExportByName(PPE_IMAGE Image, LPCSTR Name, PEXPORT_ENTRY Entry)
+{
+	EXPORT_TABLES Tables;
+	PEXPORT_INDEX Index = Image->ExportIndex;
+	LPCSTR CurrentName;
+	DWORD Low, High, Middle, Slot, Hash;
+	int Compare;
+
+	if (!ExportIndex_GetTables(Image, &Tables))
+		return FALSE;
+
+	if (Index != NULL)
+	{
+		Hash = ExportIndex_Hash(Name);
+		for (Slot = Hash & Index->Mask; Index->Slots[Slot] != 0; Slot = (Slot + 1) & Index->Mask)
+		{
+			if (Index->Hashes[Slot] != Hash)
+				continue;
+			CurrentName = (LPCSTR)PE32_RVAToPointer(Image, Tables.AddressOfNames[Index->Slots[Slot] - 1]);
+			if (strcmp(CurrentName, Name) == 0)
+				return ExportIndex_FillNamedEntry(Image, &Tables, Index->Slots[Slot] - 1, Entry);
+		}
+		return FALSE;
+	}
+
+	Low = 0;
+	High = Tables.Directory->NumberOfNames;
+	while (Low < High)
+	{
+		Middle = (Low + High) / 2;
+		CurrentName = (LPCSTR)PE32_RVAToPointer(Image, Tables.AddressOfNames[Middle]);
+		Compare = strcmp(CurrentName, Name);
+		if (Compare == 0)
+			return ExportIndex_FillNamedEntry(Image, &Tables, Middle, Entry);
+		if (Compare < 0)
+			Low = Middle + 1;
+		else
+			High = Middle;
+	}
+	return FALSE;
+}
+
+BOOL PE32_FindExportByOrdinal(PPE_IMAGE Image, DWORD Ordinal, PEXPORT_ENTRY Entry)
+{
+	EXPORT_TABLES Tables;
+
+	if (!ExportIndex_GetTables(Image, &Tables))
+		return FALSE;
+	if (Ordinal < Tables.Directory->Base)
+		return FALSE;
+	if (!ExportIndex_FillEntry(Image, &Tables, Ordinal - Tables.Directory->Base, Entry))
+		return FALSE;
+	Entry->RVAName = 0;
+	Entry->Name = NULL;
+	return TRUE;
+}
+
+BOOL PE32_BuildExportIndex(PPE_IMAGE Image)
+{
+	EXPORT_TABLES Tables;
+	PEXPORT_INDEX Index;
+	LPCSTR Name;
+	DWORD nSlots, Slot, Hash;
+
+	if (Image->ExportIndex != NULL)
+		return TRUE;
+	if (!ExportIndex_GetTables(Image, &Tables))
+		return FALSE;
+
+	/* load factor <= 1/2 keeps probe sequences short */
+	nSlots = 16;
+	while (nSlots < 2 * Tables.Directory->NumberOfNames && nSlots < 0x80000000)
+		nSlots *= 2;
+
+	Index = (PEXPORT_INDEX)MemArenaAlloc(&Image->Arena, sizeof(EXPORT_INDEX));
+	if (Index == NULL)
+		return FALSE;
+	Index->Mask = nSlots - 1;
+	Index->Slots = (PDWORD)MemArenaAlloc(&Image->Arena, nSlots * sizeof(DWORD));
+	Index->Hashes = (PDWORD)MemArenaAlloc(&Image->Arena, nSlots * sizeof(DWORD));
+	if (Index->Slots == NULL || Index->Hashes == NULL)
+		return FALSE;
+
+	for (DWORD i = 0; i < Tables.Directory->NumberOfNames; i++)
+	{
+		Name = (LPCSTR)PE32_RVAToPointer(Image, Tables.AddressOfNames[i]);
+		Hash = ExportIndex_Hash(Name);
+		for (Slot = Hash & Index->Mask; Index->Slots[Slot] != 0; Slot = (Slot + 1) & Index->Mask)
+			;
+		Index->Slots[Slot] = i + 1;
+		Index->Hashes[Slot] = Hash;
+	}
+
+	Image->ExportIndex = Index;
+	return TRUE;
+}
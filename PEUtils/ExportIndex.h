@@ -0,0 +1,56 @@
+/**
+ * \file ExportIndex.h
+ * \brief Lookup of exports by name and by ordinal
+ * \author Tomtombinary
+ * \version 1.0
+ * \date 17 octobre 2026
+ */
+
+#pragma once
+#include "stdafx.h"
+#include "PEUtils.h"
+
+/**
+ * \struct EXPORT_INDEX
+ * \brief open addressing hash table of exported names
+ * Slots[i] is 0 for an empty slot, else the index in AddressOfNames plus one.
+ * Hashes[i] keeps the hash of the name to skip most string comparisons.
+ */
+typedef struct _EXPORT_INDEX
+{
+	DWORD Mask;
+	PDWORD Slots;
+	PDWORD Hashes;
+}EXPORT_INDEX,*PEXPORT_INDEX;
+
+/**
+ * \fn BOOL PE32_FindExportByName(PPE_IMAGE Image, LPCSTR Name, PEXPORT_ENTRY Entry);
+ * \brief find an export by name
+ * Binary search over AddressOfNames (sorted by the linker), or the hash index if it has been built.
+ * A forwarded export has its Forwarder field set and a NULL pFunction.
+ * \param Image: image description
+ * \param Name: name of the exported function
+ * \param Entry: [out] export description
+ * \return FALSE if the export couldn't be found
+ */
+BOOL PE32_FindExportByName(PPE_IMAGE Image, LPCSTR Name, PEXPORT_ENTRY Entry);
+
+/**
+ * \fn BOOL PE32_FindExportByOrdinal(PPE_IMAGE Image, DWORD Ordinal, PEXPORT_ENTRY Entry);
+ * \brief find an export by ordinal (as found in an import thunk, Base included)
+ * Entry->Name is NULL: the name table isn't searched.
+ * \param Image: image description
+ * \param Ordinal: biased ordinal of the export
+ * \param Entry: [out] export description
+ * \return FALSE if the ordinal isn't exported
+ */
+BOOL PE32_FindExportByOrdinal(PPE_IMAGE Image, DWORD Ordinal, PEXPORT_ENTRY Entry);
+
+/**
+ * \fn BOOL PE32_BuildExportIndex(PPE_IMAGE Image);
+ * \brief build the hash index of exported names for hot modules, nothing is done if it already exists
+ * The index lives in the image arena and is released by PE32_CloseImage.
+ * \param Image: image description
+ * \return FALSE if export directory is invalid or memory couldn't be allocated
+ */
+BOOL PE32_BuildExportIndex(PPE_IMAGE Image);
@@ -0,0 +1,745 @@
+/**
+ * \file FileUtils.c
+ * \brief Defines function described in file FileUtils.h
+ * \author Tomtombinary
+ * \version 1.0
+ * \date 17 octobre 2026
+ */
+
+#include "stdafx.h"
+#include "FileUtils.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <errno.h>
+#endif
+#ifdef FILEUTILS_IO_URING
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#endif
+
+/* clip a segment to the file and to the view, returns FALSE for an empty segment */
+static BOOL FileUtils_ClipSegment(ULONGLONG FileSize, SIZE_T Size, PFILE_SEGMENT Segment, PFILE_SEGMENT Clipped)
+{
+	if (Segment->Offset >= FileSize || Segment->Address >= Size)
+		return FALSE;
+	*Clipped = *Segment;
+	if (Clipped->Size > FileSize - Clipped->Offset)
+		Clipped->Size = (SIZE_T)(FileSize - Clipped->Offset);
+	if (Clipped->Size > Size - Clipped->Address)
+		Clipped->Size = Size - Clipped->Address;
+	return Clipped->Size != 0;
+}
+
+/* clip ranges to the file, returns FALSE for an empty range */
+static BOOL FileUtils_ClipRange(PFILE_VIEW View, PFILE_RANGE Range, PFILE_RANGE Clipped)
+{
+	if (Range->Offset >= View->Size)
+		return FALSE;
+	Clipped->Offset = Range->Offset;
+	Clipped->Size = Range->Size < View->Size - Range->Offset ? Range->Size : (SIZE_T)(View->Size - Range->Offset);
+	return Clipped->Size != 0;
+}
+
+#ifdef _WIN32
+BOOL FileUtils_MapFile(LPCSTR Path, PFILE_VIEW View)
+{
+	LARGE_INTEGER FileSize;
+
+	View->Data = NULL;
+	View->Size = 0;
+	View->hMapping = NULL;
+	View->hFile = CreateFileA(Path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (View->hFile == INVALID_HANDLE_VALUE)
+		return FALSE;
+
+	if (GetFileSizeEx(View->hFile, &FileSize) && FileSize.QuadPart != 0)
+	{
+		View->hMapping = CreateFileMappingA(View->hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (View->hMapping != NULL)
+		{
+			View->Data = (PBYTE)MapViewOfFile(View->hMapping, FILE_MAP_READ, 0, 0, 0);
+			View->Size = (SIZE_T)FileSize.QuadPart;
+		}
+	}
+
+	if (View->Data == NULL)
+	{
+		FileUtils_UnmapFile(View);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+VOID FileUtils_UnmapFile(PFILE_VIEW View)
+{
+	if (View->Data != NULL)
+		UnmapViewOfFile(View->Data);
+	if (View->hMapping != NULL)
+		CloseHandle(View->hMapping);
+	if (View->hFile != INVALID_HANDLE_VALUE && View->hFile != NULL)
+		CloseHandle(View->hFile);
+	View->Data = NULL;
+	View->Size = 0;
+	View->hMapping = NULL;
+	View->hFile = NULL;
+}
+
+BOOL FileUtils_InitReader(PFILE_READER Reader)
+{
+	Reader->Reserved = 0;
+	return FALSE;
+}
+
+VOID FileUtils_CloseReader(PFILE_READER Reader)
+{
+}
+
+BOOL FileUtils_OpenSparseView(LPCSTR Path, PFILE_VIEW View)
+{
+	LARGE_INTEGER FileSize;
+
+	View->Data = NULL;
+	View->Size = 0;
+	View->hMapping = NULL;
+	View->hFile = CreateFileA(Path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (View->hFile == INVALID_HANDLE_VALUE)
+		return FALSE;
+
+	if (GetFileSizeEx(View->hFile, &FileSize) && FileSize.QuadPart != 0)
+	{
+		/* pagefile backed section: demand-zero pages, released by UnmapViewOfFile like a file view */
+		View->hMapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, FileSize.HighPart, FileSize.LowPart, NULL);
+		if (View->hMapping != NULL)
+		{
+			View->Data = (PBYTE)MapViewOfFile(View->hMapping, FILE_MAP_WRITE, 0, 0, 0);
+			View->Size = (SIZE_T)FileSize.QuadPart;
+		}
+	}
+
+	if (View->Data == NULL)
+	{
+		FileUtils_UnmapFile(View);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+BOOL FileUtils_ReadView(PFILE_READER Reader, PFILE_VIEW View, PFILE_RANGE Ranges, DWORD nRanges)
+{
+	FILE_RANGE Range;
+	OVERLAPPED Overlapped;
+	DWORD dwRead;
+
+	for (DWORD i = 0; i < nRanges; i++)
+	{
+		if (!FileUtils_ClipRange(View, &Ranges[i], &Range))
+			continue;
+		while (Range.Size != 0)
+		{
+			memset(&Overlapped, 0, sizeof(OVERLAPPED));
+			Overlapped.Offset = (DWORD)Range.Offset;
+			Overlapped.OffsetHigh = (DWORD)(Range.Offset >> 32);
+			if (!ReadFile(View->hFile, View->Data + Range.Offset, Range.Size < 0x40000000 ? (DWORD)Range.Size : 0x40000000, &dwRead, &Overlapped) || dwRead == 0)
+				return FALSE;
+			Range.Offset += dwRead;
+			Range.Size -= dwRead;
+		}
+	}
+	return TRUE;
+}
+
+BOOL FileUtils_MapSegments(LPCSTR Path, SIZE_T Size, PFILE_SEGMENT Segments, DWORD nSegments, PFILE_VIEW View, PULONGLONG lpCopiedBytes)
+{
+	LARGE_INTEGER FileSize;
+	FILE_SEGMENT Segment;
+	OVERLAPPED Overlapped;
+	DWORD dwRead;
+	BOOL bSuccess = FALSE;
+
+	if (lpCopiedBytes != NULL)
+		*lpCopiedBytes = 0;
+	View->Data = NULL;
+	View->Size = 0;
+	View->hMapping = NULL;
+	View->hFile = CreateFileA(Path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (View->hFile == INVALID_HANDLE_VALUE)
+		return FALSE;
+
+	if (GetFileSizeEx(View->hFile, &FileSize) && Size != 0)
+	{
+		View->hMapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, (DWORD)((ULONGLONG)Size >> 32), (DWORD)Size, NULL);
+		if (View->hMapping != NULL)
+		{
+			View->Data = (PBYTE)MapViewOfFile(View->hMapping, FILE_MAP_WRITE, 0, 0, 0);
+			View->Size = Size;
+		}
+	}
+
+	bSuccess = View->Data != NULL;
+	for (DWORD i = 0; i < nSegments && bSuccess; i++)
+	{
+		if (!FileUtils_ClipSegment((ULONGLONG)FileSize.QuadPart, Size, &Segments[i], &Segment))
+			continue;
+		if (lpCopiedBytes != NULL)
+			*lpCopiedBytes += Segment.Size;
+		while (Segment.Size != 0 && bSuccess)
+		{
+			memset(&Overlapped, 0, sizeof(OVERLAPPED));
+			Overlapped.Offset = (DWORD)Segment.Offset;
+			Overlapped.OffsetHigh = (DWORD)(Segment.Offset >> 32);
+			bSuccess = ReadFile(View->hFile, View->Data + Segment.Address, Segment.Size < 0x40000000 ? (DWORD)Segment.Size : 0x40000000, &dwRead, &Overlapped) && dwRead != 0;
+			Segment.Offset += dwRead;
+			Segment.Address += dwRead;
+			Segment.Size -= dwRead;
+		}
+	}
+
+	if (!bSuccess)
+	{
+		FileUtils_UnmapFile(View);
+		return FALSE;
+	}
+	CloseHandle(View->hFile);
+	View->hFile = NULL;
+	return TRUE;
+}
+
+BOOL FileUtils_EnumDirectory(LPCSTR Path, EnumDirectoryCallback pFuncCallback, LPVOID UserArgs)
+{
+	WIN32_FIND_DATAA FindData;
+	HANDLE hFind;
+	CHAR Pattern[MAX_PATH];
+	BOOL bDirectory;
+	BOOL bEnumTerminated = TRUE;
+
+	if (snprintf(Pattern, sizeof(Pattern), "%s\\*", Path) >= (int)sizeof(Pattern))
+		return FALSE;
+	hFind = FindFirstFileA(Pattern, &FindData);
+	if (hFind == INVALID_HANDLE_VALUE)
+		return FALSE;
+	do
+	{
+		if (strcmp(FindData.cFileName, ".") == 0 || strcmp(FindData.cFileName, "..") == 0)
+			continue;
+		bDirectory = (FindData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+		/* junctions and symbolic links to directories */
+		if (bDirectory && (FindData.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT))
+			continue;
+		if (!pFuncCallback(FindData.cFileName, bDirectory, UserArgs))
+		{
+			bEnumTerminated = FALSE;
+			break;
+		}
+	} while (FindNextFileA(hFind, &FindData));
+	FindClose(hFind);
+	return bEnumTerminated;
+}
+#else
+BOOL FileUtils_MapFile(LPCSTR Path, PFILE_VIEW View)
+{
+	struct stat st;
+	void* lpMapping;
+	int fd;
+
+	View->Data = NULL;
+	View->Size = 0;
+	View->File = -1;
+
+	fd = open(Path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		return FALSE;
+
+	if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0)
+	{
+		close(fd);
+		return FALSE;
+	}
+
+	lpMapping = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	/* the mapping keeps its own reference on the file */
+	close(fd);
+	if (lpMapping == MAP_FAILED)
+		return FALSE;
+
+	View->Data = (PBYTE)lpMapping;
+	View->Size = (SIZE_T)st.st_size;
+	return TRUE;
+}
+
+VOID FileUtils_UnmapFile(PFILE_VIEW View)
+{
+	if (View->Data != NULL)
+		munmap(View->Data, View->Size);
+	if (View->File >= 0)
+		close(View->File);
+	View->Data = NULL;
+	View->Size = 0;
+	View->File = -1;
+}
+
+BOOL FileUtils_OpenSparseView(LPCSTR Path, PFILE_VIEW View)
+{
+	struct stat st;
+	void* lpMapping;
+
+	View->Data = NULL;
+	View->Size = 0;
+	View->File = open(Path, O_RDONLY | O_CLOEXEC);
+	if (View->File < 0)
+		return FALSE;
+
+	if (fstat(View->File, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0)
+	{
+		FileUtils_UnmapFile(View);
+		return FALSE;
+	}
+
+	/* untouched pages stay shared zero pages */
+	lpMapping = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	if (lpMapping == MAP_FAILED)
+	{
+		FileUtils_UnmapFile(View);
+		return FALSE;
+	}
+	View->Data = (PBYTE)lpMapping;
+	View->Size = (SIZE_T)st.st_size;
+	return TRUE;
+}
+
+static BOOL FileUtils_ReadAt(int File, PBYTE Buffer, ULONGLONG Offset, SIZE_T Size)
+{
+	ssize_t nRead;
+
+	while (Size != 0)
+	{
+		nRead = pread(File, Buffer, Size, (off_t)Offset);
+		if (nRead < 0 && errno == EINTR)
+			continue;
+		if (nRead <= 0)
+			return FALSE;
+		Buffer += nRead;
+		Offset += nRead;
+		Size -= nRead;
+	}
+	return TRUE;
+}
+
+static BOOL FileUtils_ReadRange(PFILE_VIEW View, PFILE_RANGE Range)
+{
+	return FileUtils_ReadAt(View->File, View->Data + Range->Offset, Range->Offset, Range->Size);
+}
+
+BOOL FileUtils_MapSegments(LPCSTR Path, SIZE_T Size, PFILE_SEGMENT Segments, DWORD nSegments, PFILE_VIEW View, PULONGLONG lpCopiedBytes)
+{
+	struct stat st;
+	FILE_SEGMENT Segment;
+	SIZE_T PageSize = (SIZE_T)sysconf(_SC_PAGESIZE);
+	SIZE_T First, Last;
+	void* lpMapping;
+	BOOL bSuccess = TRUE;
+
+	if (lpCopiedBytes != NULL)
+		*lpCopiedBytes = 0;
+	View->Data = NULL;
+	View->Size = 0;
+	View->File = open(Path, O_RDONLY | O_CLOEXEC);
+	if (View->File < 0)
+		return FALSE;
+	if (fstat(View->File, &st) != 0 || !S_ISREG(st.st_mode) || Size == 0)
+	{
+		FileUtils_UnmapFile(View);
+		return FALSE;
+	}
+
+	lpMapping = mmap(NULL, Size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	if (lpMapping == MAP_FAILED)
+	{
+		FileUtils_UnmapFile(View);
+		return FALSE;
+	}
+	View->Data = (PBYTE)lpMapping;
+	View->Size = Size;
+
+	for (DWORD i = 0; i < nSegments && bSuccess; i++)
+	{
+		if (!FileUtils_ClipSegment((ULONGLONG)st.st_size, Size, &Segments[i], &Segment))
+			continue;
+		/* whole pages of the segment, when file and view agree on the offset in the page */
+		First = Last = Segment.Address;
+		if (Segment.Offset % PageSize == Segment.Address % PageSize)
+		{
+			First = (Segment.Address + PageSize - 1) / PageSize * PageSize;
+			Last = (Segment.Address + Segment.Size) / PageSize * PageSize;
+			if (Last <= First)
+				First = Last = Segment.Address;
+			else if (mmap(View->Data + First, Last - First, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, View->File, (off_t)(Segment.Offset + (First - Segment.Address))) == MAP_FAILED)
+				bSuccess = FALSE;
+		}
+		/* bytes around the mapped pages (or the whole segment) are read */
+		if (bSuccess && First > Segment.Address)
+			bSuccess = FileUtils_ReadAt(View->File, View->Data + Segment.Address, Segment.Offset, First - Segment.Address);
+		if (bSuccess && Segment.Address + Segment.Size > Last)
+			bSuccess = FileUtils_ReadAt(View->File, View->Data + Last, Segment.Offset + (Last - Segment.Address), Segment.Address + Segment.Size - Last);
+		if (lpCopiedBytes != NULL)
+			*lpCopiedBytes += Segment.Size - (Last - First);
+	}
+
+	/* mapped pages keep their own reference on the file */
+	close(View->File);
+	View->File = -1;
+	if (!bSuccess)
+	{
+		FileUtils_UnmapFile(View);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+#ifdef FILEUTILS_IO_URING
+BOOL FileUtils_InitReader(PFILE_READER Reader)
+{
+	struct io_uring_params Params;
+	void* lpMapping;
+
+	memset(Reader, 0, sizeof(FILE_READER));
+	memset(&Params, 0, sizeof(Params));
+	Reader->Ring = (int)syscall(__NR_io_uring_setup, 64, &Params);
+	if (Reader->Ring < 0)
+		return FALSE;
+
+	Reader->nEntries = Params.sq_entries;
+	Reader->SubmissionRingSize = Params.sq_off.array + Params.sq_entries * sizeof(DWORD);
+	Reader->CompletionRingSize = Params.cq_off.cqes + Params.cq_entries * sizeof(struct io_uring_cqe);
+	if (Params.features & IORING_FEAT_SINGLE_MMAP)
+	{
+		if (Reader->CompletionRingSize > Reader->SubmissionRingSize)
+			Reader->SubmissionRingSize = Reader->CompletionRingSize;
+		Reader->CompletionRingSize = 0;
+	}
+
+	lpMapping = mmap(NULL, Reader->SubmissionRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, Reader->Ring, IORING_OFF_SQ_RING);
+	if (lpMapping == MAP_FAILED)
+		goto Fail;
+	Reader->SubmissionRing = (PBYTE)lpMapping;
+	if (Reader->CompletionRingSize != 0)
+	{
+		lpMapping = mmap(NULL, Reader->CompletionRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, Reader->Ring, IORING_OFF_CQ_RING);
+		if (lpMapping == MAP_FAILED)
+			goto Fail;
+		Reader->CompletionRing = (PBYTE)lpMapping;
+	}
+	else
+		Reader->CompletionRing = Reader->SubmissionRing;
+	lpMapping = mmap(NULL, Params.sq_entries * sizeof(struct io_uring_sqe), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, Reader->Ring, IORING_OFF_SQES);
+	if (lpMapping == MAP_FAILED)
+		goto Fail;
+	Reader->Entries = (struct io_uring_sqe*)lpMapping;
+
+	Reader->SubmissionHead = (volatile DWORD*)(Reader->SubmissionRing + Params.sq_off.head);
+	Reader->SubmissionTail = (volatile DWORD*)(Reader->SubmissionRing + Params.sq_off.tail);
+	Reader->SubmissionMask = *(PDWORD)(Reader->SubmissionRing + Params.sq_off.ring_mask);
+	Reader->SubmissionArray = (PDWORD)(Reader->SubmissionRing + Params.sq_off.array);
+	Reader->CompletionHead = (volatile DWORD*)(Reader->CompletionRing + Params.cq_off.head);
+	Reader->CompletionTail = (volatile DWORD*)(Reader->CompletionRing + Params.cq_off.tail);
+	Reader->CompletionMask = *(PDWORD)(Reader->CompletionRing + Params.cq_off.ring_mask);
+	Reader->Completions = (struct io_uring_cqe*)(Reader->CompletionRing + Params.cq_off.cqes);
+	return TRUE;
+
+Fail:
+	FileUtils_CloseReader(Reader);
+	return FALSE;
+}
+
+VOID FileUtils_CloseReader(PFILE_READER Reader)
+{
+	if (Reader->Entries != NULL)
+		munmap(Reader->Entries, Reader->nEntries * sizeof(struct io_uring_sqe));
+	if (Reader->CompletionRing != NULL && Reader->CompletionRing != Reader->SubmissionRing)
+		munmap(Reader->CompletionRing, Reader->CompletionRingSize);
+	if (Reader->SubmissionRing != NULL)
+		munmap(Reader->SubmissionRing, Reader->SubmissionRingSize);
+	if (Reader->Ring >= 0)
+		close(Reader->Ring);
+	memset(Reader, 0, sizeof(FILE_READER));
+	Reader->Ring = -1;
+}
+
+/* submit at most nEntries reads and wait for all of them */
+static BOOL FileUtils_ReadBatch(PFILE_READER Reader, PFILE_VIEW View, PFILE_RANGE Ranges, DWORD nRanges)
+{
+	struct io_uring_sqe* Entry;
+	struct io_uring_cqe* Completion;
+	FILE_RANGE Remainder;
+	DWORD Tail = *Reader->SubmissionTail;
+	DWORD Head, Index, nCompleted;
+	DWORD nSubmitted = 0;
+	BOOL bSuccess = TRUE;
+	long Result;
+
+	for (DWORD i = 0; i < nRanges; i++, Tail++)
+	{
+		Index = Tail & Reader->SubmissionMask;
+		Entry = &Reader->Entries[Index];
+		memset(Entry, 0, sizeof(struct io_uring_sqe));
+		Entry->opcode = IORING_OP_READ;
+		Entry->fd = View->File;
+		Entry->off = Ranges[i].Offset;
+		Entry->addr = (ULONG_PTR)(View->Data + Ranges[i].Offset);
+		Entry->len = (DWORD)Ranges[i].Size;
+		Entry->user_data = i;
+		Reader->SubmissionArray[Index] = Index;
+	}
+	__atomic_store_n(Reader->SubmissionTail, Tail, __ATOMIC_RELEASE);
+
+	/* the kernel may accept fewer entries than given (then it doesn't wait): submit the rest again */
+	while (nSubmitted < nRanges)
+	{
+		do
+			Result = syscall(__NR_io_uring_enter, Reader->Ring, nRanges - nSubmitted, nRanges - nSubmitted, IORING_ENTER_GETEVENTS, NULL, 0);
+		while (Result < 0 && errno == EINTR);
+		if (Result <= 0)
+			break;
+		nSubmitted += (DWORD)Result;
+	}
+	if (nSubmitted < nRanges)
+	{
+		/* entries not consumed by the kernel are withdrawn and read directly */
+		*Reader->SubmissionTail = Tail - (nRanges - nSubmitted);
+		for (DWORD i = nSubmitted; i < nRanges; i++)
+		{
+			if (!FileUtils_ReadRange(View, &Ranges[i]))
+				bSuccess = FALSE;
+		}
+	}
+
+	/* completions of the submitted entries only */
+	for (nCompleted = 0; nCompleted < nSubmitted; )
+	{
+		Head = *Reader->CompletionHead;
+		if (Head == __atomic_load_n(Reader->CompletionTail, __ATOMIC_ACQUIRE))
+		{
+			syscall(__NR_io_uring_enter, Reader->Ring, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+			continue;
+		}
+		Completion = &Reader->Completions[Head & Reader->CompletionMask];
+		Remainder = Ranges[Completion->user_data];
+		/* failed (old kernel without IORING_OP_READ...) or short read: read the rest directly */
+		if (Completion->res < 0 || (SIZE_T)Completion->res < Remainder.Size)
+		{
+			if (Completion->res > 0)
+			{
+				Remainder.Offset += Completion->res;
+				Remainder.Size -= Completion->res;
+			}
+			if (!FileUtils_ReadRange(View, &Remainder))
+				bSuccess = FALSE;
+		}
+		__atomic_store_n(Reader->CompletionHead, Head + 1, __ATOMIC_RELEASE);
+		nCompleted++;
+	}
+	return bSuccess;
+}
+#else
+BOOL FileUtils_InitReader(PFILE_READER Reader)
+{
+	Reader->Reserved = 0;
+	return FALSE;
+}
+
+VOID FileUtils_CloseReader(PFILE_READER Reader)
+{
+	UNREFERENCED_PARAMETER(Reader);
+}
+#endif
+
+BOOL FileUtils_ReadView(PFILE_READER Reader, PFILE_VIEW View, PFILE_RANGE Ranges, DWORD nRanges)
+{
+	FILE_RANGE Batch[64];
+	DWORD nBatch = 0;
+	BOOL bSuccess = TRUE;
+
+#ifndef FILEUTILS_IO_URING
+	UNREFERENCED_PARAMETER(Reader);
+#endif
+	for (DWORD i = 0; i < nRanges && bSuccess; i++)
+	{
+		if (!FileUtils_ClipRange(View, &Ranges[i], &Batch[nBatch]))
+			continue;
+#ifdef FILEUTILS_IO_URING
+		if (Reader != NULL && Reader->Ring >= 0 && Batch[nBatch].Size < 0x40000000)
+		{
+			if (++nBatch == (Reader->nEntries < 64 ? Reader->nEntries : 64))
+			{
+				bSuccess = FileUtils_ReadBatch(Reader, View, Batch, nBatch);
+				nBatch = 0;
+			}
+			continue;
+		}
+#endif
+		bSuccess = FileUtils_ReadRange(View, &Batch[nBatch]);
+	}
+#ifdef FILEUTILS_IO_URING
+	if (nBatch != 0 && bSuccess)
+		bSuccess = FileUtils_ReadBatch(Reader, View, Batch, nBatch);
+#endif
+	return bSuccess;
+}
+
+BOOL FileUtils_EnumDirectory(LPCSTR Path, EnumDirectoryCallback pFuncCallback, LPVOID UserArgs)
+{
+	DIR* lpDirectory;
+	struct dirent* lpEntry;
+	struct stat st;
+	BOOL bDirectory;
+	BOOL bEnumTerminated = TRUE;
+
+	lpDirectory = opendir(Path);
+	if (lpDirectory == NULL)
+		return FALSE;
+	while ((lpEntry = readdir(lpDirectory)) != NULL)
+	{
+		if (strcmp(lpEntry->d_name, ".") == 0 || strcmp(lpEntry->d_name, "..") == 0)
+			continue;
+		switch (lpEntry->d_type)
+		{
+		case DT_REG:
+			bDirectory = FALSE;
+			break;
+		case DT_DIR:
+			bDirectory = TRUE;
+			break;
+		case DT_LNK:
+		case DT_UNKNOWN:
+			/* links are followed to files only, some file systems don't fill d_type */
+			if (fstatat(dirfd(lpDirectory), lpEntry->d_name, &st, lpEntry->d_type == DT_LNK ? 0 : AT_SYMLINK_NOFOLLOW) != 0)
+				continue;
+			if (S_ISREG(st.st_mode))
+				bDirectory = FALSE;
+			else if (S_ISDIR(st.st_mode) && lpEntry->d_type == DT_UNKNOWN)
+				bDirectory = TRUE;
+			else
+				continue;
+			break;
+		default:
+			continue;
+		}
+		if (!pFuncCallback(lpEntry->d_name, bDirectory, UserArgs))
+		{
+			bEnumTerminated = FALSE;
+			break;
+		}
+	}
+	closedir(lpDirectory);
+	return bEnumTerminated;
+}
+#endif
+
+#ifdef _WIN32
+BOOL FileUtils_GetFileStamp(LPCSTR Path, PULONGLONG lpSize, PULONGLONG lpModified)
+{
+	WIN32_FILE_ATTRIBUTE_DATA Attributes;
+
+	if (!GetFileAttributesExA(Path, GetFileExInfoStandard, &Attributes) || (Attributes.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+		return FALSE;
+	*lpSize = ((ULONGLONG)Attributes.nFileSizeHigh << 32) | Attributes.nFileSizeLow;
+	*lpModified = ((ULONGLONG)Attributes.ftLastWriteTime.dwHighDateTime << 32) | Attributes.ftLastWriteTime.dwLowDateTime;
+	return TRUE;
+}
+
+BOOL FileUtils_WriteFile(LPCSTR Path, LPCVOID Data, SIZE_T Size)
+{
+	char TempPath[MAX_PATH];
+	char Directory[MAX_PATH];
+	LPCSTR Separator;
+	HANDLE hFile;
+	DWORD nWritten;
+	BOOL bSuccess;
+
+	Separator = strrchr(Path, '\\');
+	if (Separator == NULL)
+		Separator = strrchr(Path, '/');
+	if (Separator == NULL)
+		strcpy_s(Directory, sizeof(Directory), ".");
+	else if ((SIZE_T)(Separator - Path) >= sizeof(Directory))
+		return FALSE;
+	else
+	{
+		memcpy(Directory, Path, Separator - Path);
+		Directory[Separator - Path] = '\0';
+	}
+	if (GetTempFileNameA(Directory, "pe", 0, TempPath) == 0)
+		return FALSE;
+
+	hFile = CreateFileA(TempPath, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (hFile == INVALID_HANDLE_VALUE)
+	{
+		DeleteFileA(TempPath);
+		return FALSE;
+	}
+	bSuccess = WriteFile(hFile, Data, (DWORD)Size, &nWritten, NULL) && nWritten == Size;
+	CloseHandle(hFile);
+	/* readers see the old file or the new one, never a partial write */
+	if (!bSuccess || !MoveFileExA(TempPath, Path, MOVEFILE_REPLACE_EXISTING))
+	{
+		DeleteFileA(TempPath);
+		return FALSE;
+	}
+	return TRUE;
+}
+#else
+BOOL FileUtils_GetFileStamp(LPCSTR Path, PULONGLONG lpSize, PULONGLONG lpModified)
+{
+	struct stat st;
+
+	if (stat(Path, &st) != 0 || !S_ISREG(st.st_mode))
+		return FALSE;
+	*lpSize = (ULONGLONG)st.st_size;
+	*lpModified = (ULONGLONG)st.st_mtim.tv_sec * 1000000000ULL + (ULONGLONG)st.st_mtim.tv_nsec;
+	return TRUE;
+}
+
+BOOL FileUtils_WriteFile(LPCSTR Path, LPCVOID Data, SIZE_T Size)
+{
+	SIZE_T PathLength = strlen(Path);
+	PCHAR TempPath = (PCHAR)malloc(PathLength + 8);
+	SIZE_T Offset = 0;
+	ssize_t nWritten;
+	int fd;
+
+	if (TempPath == NULL)
+		return FALSE;
+	memcpy(TempPath, Path, PathLength);
+	memcpy(TempPath + PathLength, ".XXXXXX", 8);
+	fd = mkstemp(TempPath);
+	if (fd < 0)
+	{
+		free(TempPath);
+		return FALSE;
+	}
+	while (Offset < Size)
+	{
+		nWritten = write(fd, (const BYTE*)Data + Offset, Size - Offset);
+		if (nWritten < 0 && errno == EINTR)
+			continue;
+		if (nWritten <= 0)
+			break;
+		Offset += (SIZE_T)nWritten;
+	}
+	/* mkstemp creates the file with mode 0600 */
+	fchmod(fd, 0644);
+	/* readers see the old file or the new one, never a partial write */
+	if (close(fd) != 0 || Offset != Size || rename(TempPath, Path) != 0)
+	{
+		unlink(TempPath);
+		free(TempPath);
+		return FALSE;
+	}
+	free(TempPath);
+	return TRUE;
+}
+#endif
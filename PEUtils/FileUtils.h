@@ -0,0 +1,193 @@
+/**
+ * \file FileUtils.h
+ * \brief Utility functions to map or partially read a file in memory and to list directories
+ * \author Tomtombinary
+ * \version 1.0
+ * \date 17 octobre 2026
+ */
+
+#pragma once
+#include "stdafx.h"
+
+#if defined(__linux__) && !defined(PEUTILS_NO_IO_URING)
+#define FILEUTILS_IO_URING
+#endif
+
+/**
+ * \struct FILE_VIEW
+ * \brief view of a whole file
+ * Data: first byte of the file in memory
+ * Size: file size in bytes
+ * For a sparse view (FileUtils_OpenSparseView), the file stays open and Data
+ * is zero-filled memory, only ranges read by FileUtils_ReadView hold file data.
+ */
+typedef struct _FILE_VIEW
+{
+	PBYTE Data;
+	SIZE_T Size;
+#ifdef _WIN32
+	HANDLE hFile;
+	HANDLE hMapping;
+#else
+	int File;
+#endif
+}FILE_VIEW,*PFILE_VIEW;
+
+/**
+ * \struct FILE_RANGE
+ * \brief range of bytes of a file
+ */
+typedef struct _FILE_RANGE
+{
+	ULONGLONG Offset;
+	SIZE_T Size;
+}FILE_RANGE,*PFILE_RANGE;
+
+/**
+ * \struct FILE_SEGMENT
+ * \brief bytes of a file placed at an offset of a view
+ * Offset: offset in the file
+ * Address: offset in the view
+ * Size: size in bytes
+ */
+typedef struct _FILE_SEGMENT
+{
+	ULONGLONG Offset;
+	SIZE_T Address;
+	SIZE_T Size;
+}FILE_SEGMENT,*PFILE_SEGMENT;
+
+/**
+ * \struct FILE_READER
+ * \brief batches the reads of FileUtils_ReadView, can be reused for many files (one reader per thread)
+ * On Linux, the reads of a batch are submitted together to an io_uring. Without
+ * io_uring (old kernel, seccomp...), or with a NULL reader, each range is read by pread.
+ */
+typedef struct _FILE_READER
+{
+#ifdef FILEUTILS_IO_URING
+	int Ring;
+	DWORD nEntries;
+	PBYTE SubmissionRing;
+	SIZE_T SubmissionRingSize;
+	PBYTE CompletionRing;
+	SIZE_T CompletionRingSize;
+	struct io_uring_sqe* Entries;
+	volatile DWORD* SubmissionHead;
+	volatile DWORD* SubmissionTail;
+	DWORD SubmissionMask;
+	PDWORD SubmissionArray;
+	volatile DWORD* CompletionHead;
+	volatile DWORD* CompletionTail;
+	DWORD CompletionMask;
+	struct io_uring_cqe* Completions;
+#else
+	DWORD Reserved;
+#endif
+}FILE_READER,*PFILE_READER;
+
+/**
+ * \fn BOOL FileUtils_MapFile(LPCSTR Path, PFILE_VIEW View);
+ * \brief map a file in memory without copying it (mmap/MapViewOfFile, read-only, private)
+ * \param Path: path of the file to map
+ * \param View: [out] view of the file
+ * \return FALSE if the file couldn't be opened, is empty or couldn't be mapped
+ */
+BOOL FileUtils_MapFile(LPCSTR Path, PFILE_VIEW View);
+
+/**
+ * \fn VOID FileUtils_UnmapFile(PFILE_VIEW View);
+ * \brief release a view created by FileUtils_MapFile
+ * \param View: view to release
+ */
+VOID FileUtils_UnmapFile(PFILE_VIEW View);
+
+/**
+ * Callback function type for FileUtils_EnumDirectory
+ * Name: name of the entry (without the directory path)
+ * bDirectory: TRUE for a sub-directory, FALSE for a regular file
+ */
+typedef BOOL(*EnumDirectoryCallback)(LPCSTR Name, BOOL bDirectory, LPVOID UserArgs);
+
+/**
+ * \fn BOOL FileUtils_EnumDirectory(LPCSTR Path, EnumDirectoryCallback pFuncCallback, LPVOID UserArgs);
+ * \brief enumerate regular files and sub-directories of a directory
+ * "." and "..", special files and links to directories are skipped, so a tree walk can't loop.
+ * \param Path: path of the directory
+ * \param pFuncCallback: callback function called for each entry
+ * \param UserArgs: [optional] extras arguments for callback function
+ * \return TRUE if all entries have been enumerated, FALSE if the directory couldn't be opened or callback stopped the enumeration
+ */
+BOOL FileUtils_EnumDirectory(LPCSTR Path, EnumDirectoryCallback pFuncCallback, LPVOID UserArgs);
+
+/**
+ * \fn BOOL FileUtils_InitReader(PFILE_READER Reader);
+ * \brief prepare a reader (io_uring when the kernel provides it)
+ * \param Reader: [out] reader, must be released by FileUtils_CloseReader
+ * \return TRUE if reads will be batched, FALSE if the reader falls back to one read per range (it is still usable)
+ */
+BOOL FileUtils_InitReader(PFILE_READER Reader);
+
+/**
+ * \fn VOID FileUtils_CloseReader(PFILE_READER Reader);
+ * \brief release a reader
+ */
+VOID FileUtils_CloseReader(PFILE_READER Reader);
+
+/**
+ * \fn BOOL FileUtils_OpenSparseView(LPCSTR Path, PFILE_VIEW View);
+ * \brief open a file and reserve zero-filled memory of its size, without reading anything
+ * Pages of the view are only committed when ranges are read in them.
+ * \param Path: path of the file
+ * \param View: [out] sparse view, released by FileUtils_UnmapFile
+ * \return FALSE if the file couldn't be opened, is empty or memory couldn't be reserved
+ */
+BOOL FileUtils_OpenSparseView(LPCSTR Path, PFILE_VIEW View);
+
+/**
+ * \fn BOOL FileUtils_ReadView(PFILE_READER Reader, PFILE_VIEW View, PFILE_RANGE Ranges, DWORD nRanges);
+ * \brief read ranges of the file of a sparse view at the same offsets in the view
+ * \param Reader: [optional] reader batching the reads
+ * \param View: sparse view
+ * \param Ranges: ranges to read, clipped to the file size
+ * \param nRanges: number of ranges
+ * \return FALSE if a read failed
+ */
+BOOL FileUtils_ReadView(PFILE_READER Reader, PFILE_VIEW View, PFILE_RANGE Ranges, DWORD nRanges);
+
+/**
+ * \fn BOOL FileUtils_MapSegments(LPCSTR Path, SIZE_T Size, PFILE_SEGMENT Segments, DWORD nSegments, PFILE_VIEW View, PULONGLONG lpCopiedBytes);
+ * \brief build a writable view of zero-filled memory holding segments of a file
+ * On Linux, the pages of a segment whose file offset and address are equal
+ * modulo the page size are mapped from the file (private, copy on write),
+ * the other bytes are read. On Windows, all segments are read.
+ * Segments are placed in order, a segment overwrites the previous ones.
+ * \param Path: path of the file
+ * \param Size: size of the view
+ * \param Segments: segments to place, clipped to the file and to the view
+ * \param nSegments: number of segments
+ * \param View: [out] view, released by FileUtils_UnmapFile
+ * \param lpCopiedBytes: [out, optional] number of bytes read instead of mapped
+ * \return FALSE if the file couldn't be opened or read, or memory couldn't be reserved
+ */
+BOOL FileUtils_MapSegments(LPCSTR Path, SIZE_T Size, PFILE_SEGMENT Segments, DWORD nSegments, PFILE_VIEW View, PULONGLONG lpCopiedBytes);
+
+/**
+ * \fn BOOL FileUtils_GetFileStamp(LPCSTR Path, PULONGLONG lpSize, PULONGLONG lpModified);
+ * \brief read the size and the last write time of a file without opening it
+ * \param Path: path of the file
+ * \param lpSize: [out] size in bytes
+ * \param lpModified: [out] last write time (nanoseconds on Linux, FILETIME on Windows), only to compare stamps of a same system
+ * \return FALSE if the file doesn't exist or isn't a regular file
+ */
+BOOL FileUtils_GetFileStamp(LPCSTR Path, PULONGLONG lpSize, PULONGLONG lpModified);
+
+/**
+ * \fn BOOL FileUtils_WriteFile(LPCSTR Path, LPCVOID Data, SIZE_T Size);
+ * \brief create or replace a file atomically: data is written in a temporary file of the same directory, renamed to Path
+ * \param Path: path of the file
+ * \param Data: content of the file
+ * \param Size: size of the content
+ * \return FALSE if the file couldn't be written
+ */
+BOOL FileUtils_WriteFile(LPCSTR Path, LPCVOID Data, SIZE_T Size);
@@ -0,0 +1,433 @@
+/**
+ * \file HashUtils.c
+ * \brief Defines function described in file HashUtils.h
+ * \author Tomtombinary
+ * \version 1.0
+ * \date 17 octobre 2026
+ */
+
+#include "stdafx.h"
+#include "HashUtils.h"
+#include "CpuUtils.h"
+
+/**
+ * Hash nBlocks blocks of 64 bytes
+ */
+typedef VOID(*HashBlocksFunction)(PDWORD State, const BYTE* Data, SIZE_T nBlocks);
+
+#define MD5_ROTATE(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+#define MD5_STEP(f, a, b, c, d, x, t, s) \
+	(a) += f((b), (c), (d)) + (x) + (t); \
+	(a) = MD5_ROTATE((a), (s)) + (b);
+#define MD5_F(x, y, z) ((z) ^ ((x) & ((y) ^ (z))))
+#define MD5_G(x, y, z) ((y) ^ ((z) & ((x) ^ (y))))
+#define MD5_H(x, y, z) ((x) ^ (y) ^ (z))
+#define MD5_I(x, y, z) ((y) ^ ((x) | ~(z)))
+
+/* RFC 1321, one 64 bytes block */
+static VOID HashUtils_Md5Block(PDWORD State, const BYTE* Block)
+{
+	DWORD X[16];
+	DWORD a = State[0], b = State[1], c = State[2], d = State[3];
+
+	for (DWORD i = 0; i < 16; i++)
+		X[i] = (DWORD)Block[i * 4] | ((DWORD)Block[i * 4 + 1] << 8) | ((DWORD)Block[i * 4 + 2] << 16) | ((DWORD)Block[i * 4 + 3] << 24);
+
+	MD5_STEP(MD5_F, a, b, c, d, X[0], 0xd76aa478, 7)
+	MD5_STEP(MD5_F, d, a, b, c, X[1], 0xe8c7b756, 12)
+	MD5_STEP(MD5_F, c, d, a, b, X[2], 0x242070db, 17)
+	MD5_STEP(MD5_F, b, c, d, a, X[3], 0xc1bdceee, 22)
+	MD5_STEP(MD5_F, a, b, c, d, X[4], 0xf57c0faf, 7)
+	MD5_STEP(MD5_F, d, a, b, c, X[5], 0x4787c62a, 12)
+	MD5_STEP(MD5_F, c, d, a, b, X[6], 0xa8304613, 17)
+	MD5_STEP(MD5_F, b, c, d, a, X[7], 0xfd469501, 22)
+	MD5_STEP(MD5_F, a, b, c, d, X[8], 0x698098d8, 7)
+	MD5_STEP(MD5_F, d, a, b, c, X[9], 0x8b44f7af, 12)
+	MD5_STEP(MD5_F, c, d, a, b, X[10], 0xffff5bb1, 17)
+	MD5_STEP(MD5_F, b, c, d, a, X[11], 0x895cd7be, 22)
+	MD5_STEP(MD5_F, a, b, c, d, X[12], 0x6b901122, 7)
+	MD5_STEP(MD5_F, d, a, b, c, X[13], 0xfd987193, 12)
+	MD5_STEP(MD5_F, c, d, a, b, X[14], 0xa679438e, 17)
+	MD5_STEP(MD5_F, b, c, d, a, X[15], 0x49b40821, 22)
+
+	MD5_STEP(MD5_G, a, b, c, d, X[1], 0xf61e2562, 5)
+	MD5_STEP(MD5_G, d, a, b, c, X[6], 0xc040b340, 9)
+	MD5_STEP(MD5_G, c, d, a, b, X[11], 0x265e5a51, 14)
+	MD5_STEP(MD5_G, b, c, d, a, X[0], 0xe9b6c7aa, 20)
+	MD5_STEP(MD5_G, a, b, c, d, X[5], 0xd62f105d, 5)
+	MD5_STEP(MD5_G, d, a, b, c, X[10], 0x02441453, 9)
+	MD5_STEP(MD5_G, c, d, a, b, X[15], 0xd8a1e681, 14)
+	MD5_STEP(MD5_G, b, c, d, a, X[4], 0xe7d3fbc8, 20)
+	MD5_STEP(MD5_G, a, b, c, d, X[9], 0x21e1cde6, 5)
+	MD5_STEP(MD5_G, d, a, b, c, X[14], 0xc33707d6, 9)
+	MD5_STEP(MD5_G, c, d, a, b, X[3], 0xf4d50d87, 14)
+	MD5_STEP(MD5_G, b, c, d, a, X[8], 0x455a14ed, 20)
+	MD5_STEP(MD5_G, a, b, c, d, X[13], 0xa9e3e905, 5)
+	MD5_STEP(MD5_G, d, a, b, c, X[2], 0xfcefa3f8, 9)
+	MD5_STEP(MD5_G, c, d, a, b, X[7], 0x676f02d9, 14)
+	MD5_STEP(MD5_G, b, c, d, a, X[12], 0x8d2a4c8a, 20)
+
+	MD5_STEP(MD5_H, a, b, c, d, X[5], 0xfffa3942, 4)
+	MD5_STEP(MD5_H, d, a, b, c, X[8], 0x8771f681, 11)
+	MD5_STEP(MD5_H, c, d, a, b, X[11], 0x6d9d6122, 16)
+	MD5_STEP(MD5_H, b, c, d, a, X[14], 0xfde5380c, 23)
+	MD5_STEP(MD5_H, a, b, c, d, X[1], 0xa4beea44, 4)
+	MD5_STEP(MD5_H, d, a, b, c, X[4], 0x4bdecfa9, 11)
+	MD5_STEP(MD5_H, c, d, a, b, X[7], 0xf6bb4b60, 16)
+	MD5_STEP(MD5_H, b, c, d, a, X[10], 0xbebfbc70, 23)
+	MD5_STEP(MD5_H, a, b, c, d, X[13], 0x289b7ec6, 4)
+	MD5_STEP(MD5_H, d, a, b, c, X[0], 0xeaa127fa, 11)
+	MD5_STEP(MD5_H, c, d, a, b, X[3], 0xd4ef3085, 16)
+	MD5_STEP(MD5_H, b, c, d, a, X[6], 0x04881d05, 23)
+	MD5_STEP(MD5_H, a, b, c, d, X[9], 0xd9d4d039, 4)
+	MD5_STEP(MD5_H, d, a, b, c, X[12], 0xe6db99e5, 11)
+	MD5_STEP(MD5_H, c, d, a, b, X[15], 0x1fa27cf8, 16)
+	MD5_STEP(MD5_H, b, c, d, a, X[2], 0xc4ac5665, 23)
+
+	MD5_STEP(MD5_I, a, b, c, d, X[0], 0xf4292244, 6)
+	MD5_STEP(MD5_I, d, a, b, c, X[7], 0x432aff97, 10)
+	MD5_STEP(MD5_I, c, d, a, b, X[14], 0xab9423a7, 15)
+	MD5_STEP(MD5_I, b, c, d, a, X[5], 0xfc93a039, 21)
+	MD5_STEP(MD5_I, a, b, c, d, X[12], 0x655b59c3, 6)
+	MD5_STEP(MD5_I, d, a, b, c, X[3], 0x8f0ccc92, 10)
+	MD5_STEP(MD5_I, c, d, a, b, X[10], 0xffeff47d, 15)
+	MD5_STEP(MD5_I, b, c, d, a, X[1], 0x85845dd1, 21)
+	MD5_STEP(MD5_I, a, b, c, d, X[8], 0x6fa87e4f, 6)
+	MD5_STEP(MD5_I, d, a, b, c, X[15], 0xfe2ce6e0, 10)
+	MD5_STEP(MD5_I, c, d, a, b, X[6], 0xa3014314, 15)
+	MD5_STEP(MD5_I, b, c, d, a, X[13], 0x4e0811a1, 21)
+	MD5_STEP(MD5_I, a, b, c, d, X[4], 0xf7537e82, 6)
+	MD5_STEP(MD5_I, d, a, b, c, X[11], 0xbd3af235, 10)
+	MD5_STEP(MD5_I, c, d, a, b, X[2], 0x2ad7d2bb, 15)
+	MD5_STEP(MD5_I, b, c, d, a, X[9], 0xeb86d391, 21)
+
+	State[0] += a;
+	State[1] += b;
+	State[2] += c;
+	State[3] += d;
+}
+
+static VOID HashUtils_Md5Blocks(PDWORD State, const BYTE* Data, SIZE_T nBlocks)
+{
+	for (; nBlocks != 0; nBlocks--, Data += 64)
+		HashUtils_Md5Block(State, Data);
+}
+
+#define SHA_ROTL(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+#define SHA_ROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+static const DWORD HashUtils_Sha256K[64] =
+{
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static DWORD HashUtils_LoadBigEndian(const BYTE* Data)
+{
+	return ((DWORD)Data[0] << 24) | ((DWORD)Data[1] << 16) | ((DWORD)Data[2] << 8) | (DWORD)Data[3];
+}
+
+/* FIPS 180-4 */
+static VOID HashUtils_Sha1Blocks(PDWORD State, const BYTE* Data, SIZE_T nBlocks)
+{
+	DWORD W[80];
+	DWORD a, b, c, d, e, f, k, t;
+
+	for (; nBlocks != 0; nBlocks--, Data += 64)
+	{
+		for (DWORD i = 0; i < 16; i++)
+			W[i] = HashUtils_LoadBigEndian(Data + i * 4);
+		for (DWORD i = 16; i < 80; i++)
+			W[i] = SHA_ROTL(W[i - 3] ^ W[i - 8] ^ W[i - 14] ^ W[i - 16], 1);
+
+		a = State[0]; b = State[1]; c = State[2]; d = State[3]; e = State[4];
+		for (DWORD i = 0; i < 80; i++)
+		{
+			if (i < 20)
+			{
+				f = d ^ (b & (c ^ d));
+				k = 0x5a827999;
+			}
+			else if (i < 40)
+			{
+				f = b ^ c ^ d;
+				k = 0x6ed9eba1;
+			}
+			else if (i < 60)
+			{
+				f = (b & c) | (d & (b | c));
+				k = 0x8f1bbcdc;
+			}
+			else
+			{
+				f = b ^ c ^ d;
+				k = 0xca62c1d6;
+			}
+			t = SHA_ROTL(a, 5) + f + e + k + W[i];
+			e = d; d = c; c = SHA_ROTL(b, 30); b = a; a = t;
+		}
+		State[0] += a; State[1] += b; State[2] += c; State[3] += d; State[4] += e;
+	}
+}
+
+static VOID HashUtils_Sha256Blocks(PDWORD State, const BYTE* Data, SIZE_T nBlocks)
+{
+	DWORD W[64];
+	DWORD a, b, c, d, e, f, g, h, t1, t2;
+
+	for (; nBlocks != 0; nBlocks--, Data += 64)
+	{
+		for (DWORD i = 0; i < 16; i++)
+			W[i] = HashUtils_LoadBigEndian(Data + i * 4);
+		for (DWORD i = 16; i < 64; i++)
+			W[i] = W[i - 16] + (SHA_ROTR(W[i - 15], 7) ^ SHA_ROTR(W[i - 15], 18) ^ (W[i - 15] >> 3)) +
+				W[i - 7] + (SHA_ROTR(W[i - 2], 17) ^ SHA_ROTR(W[i - 2], 19) ^ (W[i - 2] >> 10));
+
+		a = State[0]; b = State[1]; c = State[2]; d = State[3];
+		e = State[4]; f = State[5]; g = State[6]; h = State[7];
+		for (DWORD i = 0; i < 64; i++)
+		{
+			t1 = h + (SHA_ROTR(e, 6) ^ SHA_ROTR(e, 11) ^ SHA_ROTR(e, 25)) + (g ^ (e & (f ^ g))) + HashUtils_Sha256K[i] + W[i];
+			t2 = (SHA_ROTR(a, 2) ^ SHA_ROTR(a, 13) ^ SHA_ROTR(a, 22)) + ((a & b) | (c & (a | b)));
+			h = g; g = f; f = e; e = d + t1;
+			d = c; c = b; b = a; a = t1 + t2;
+		}
+		State[0] += a; State[1] += b; State[2] += c; State[3] += d;
+		State[4] += e; State[5] += f; State[6] += g; State[7] += h;
+	}
+}
+
+#ifdef CPU_X86
+/* 4 rounds of SHA-1, message schedule of the next groups interleaved */
+#define SHA1_NI_GROUP(g, Func) \
+	if ((g) == 0) \
+		E[0] = _mm_add_epi32(E[0], M[0]); \
+	else \
+		E[(g) & 1] = _mm_sha1nexte_epu32(E[(g) & 1], M[(g) & 3]); \
+	E[((g) + 1) & 1] = Abcd; \
+	if ((g) >= 3 && (g) <= 18) \
+		M[((g) + 1) & 3] = _mm_sha1msg2_epu32(M[((g) + 1) & 3], M[(g) & 3]); \
+	Abcd = _mm_sha1rnds4_epu32(Abcd, E[(g) & 1], Func); \
+	if ((g) >= 1 && (g) <= 16) \
+		M[((g) - 1) & 3] = _mm_sha1msg1_epu32(M[((g) - 1) & 3], M[(g) & 3]); \
+	if ((g) >= 2 && (g) <= 17) \
+		M[((g) - 2) & 3] = _mm_xor_si128(M[((g) - 2) & 3], M[(g) & 3]);
+
+CPU_TARGET("sha,sse4.1")
+static VOID HashUtils_Sha1BlocksNI(PDWORD State, const BYTE* Data, SIZE_T nBlocks)
+{
+	const __m128i Mask = _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+	__m128i Abcd, AbcdSave, E0Save;
+	__m128i E[2];
+	__m128i M[4];
+
+	Abcd = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)State), 0x1B);
+	E[0] = _mm_set_epi32((int)State[4], 0, 0, 0);
+	for (; nBlocks != 0; nBlocks--, Data += 64)
+	{
+		AbcdSave = Abcd;
+		E0Save = E[0];
+		for (DWORD i = 0; i < 4; i++)
+			M[i] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(Data + i * 16)), Mask);
+
+		SHA1_NI_GROUP(0, 0) SHA1_NI_GROUP(1, 0) SHA1_NI_GROUP(2, 0) SHA1_NI_GROUP(3, 0) SHA1_NI_GROUP(4, 0)
+		SHA1_NI_GROUP(5, 1) SHA1_NI_GROUP(6, 1) SHA1_NI_GROUP(7, 1) SHA1_NI_GROUP(8, 1) SHA1_NI_GROUP(9, 1)
+		SHA1_NI_GROUP(10, 2) SHA1_NI_GROUP(11, 2) SHA1_NI_GROUP(12, 2) SHA1_NI_GROUP(13, 2) SHA1_NI_GROUP(14, 2)
+		SHA1_NI_GROUP(15, 3) SHA1_NI_GROUP(16, 3) SHA1_NI_GROUP(17, 3) SHA1_NI_GROUP(18, 3) SHA1_NI_GROUP(19, 3)
+
+		E[0] = _mm_sha1nexte_epu32(E[0], E0Save);
+		Abcd = _mm_add_epi32(Abcd, AbcdSave);
+	}
+	_mm_storeu_si128((__m128i*)State, _mm_shuffle_epi32(Abcd, 0x1B));
+	State[4] = (DWORD)_mm_extract_epi32(E[0], 3);
+}
+
+CPU_TARGET("sha,sse4.1")
+static VOID HashUtils_Sha256BlocksNI(PDWORD State, const BYTE* Data, SIZE_T nBlocks)
+{
+	const __m128i Mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+	__m128i State0, State1, AbefSave, CdghSave, Msg, Tmp;
+	__m128i M[4];
+
+	/* state words in the order of the instructions: ABEF and CDGH */
+	Tmp = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)&State[0]), 0xB1);
+	State1 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)&State[4]), 0x1B);
+	State0 = _mm_alignr_epi8(Tmp, State1, 8);
+	State1 = _mm_blend_epi16(State1, Tmp, 0xF0);
+
+	for (; nBlocks != 0; nBlocks--, Data += 64)
+	{
+		AbefSave = State0;
+		CdghSave = State1;
+		for (DWORD g = 0; g < 16; g++)
+		{
+			if (g < 4)
+				M[g] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(Data + g * 16)), Mask);
+			else
+				M[g & 3] = _mm_sha256msg2_epu32(_mm_add_epi32(_mm_sha256msg1_epu32(M[g & 3], M[(g + 1) & 3]),
+					_mm_alignr_epi8(M[(g + 3) & 3], M[(g + 2) & 3], 4)), M[(g + 3) & 3]);
+			Msg = _mm_add_epi32(M[g & 3], _mm_loadu_si128((const __m128i*)&HashUtils_Sha256K[g * 4]));
+			State1 = _mm_sha256rnds2_epu32(State1, State0, Msg);
+			State0 = _mm_sha256rnds2_epu32(State0, State1, _mm_shuffle_epi32(Msg, 0x0E));
+		}
+		State0 = _mm_add_epi32(State0, AbefSave);
+		State1 = _mm_add_epi32(State1, CdghSave);
+	}
+
+	Tmp = _mm_shuffle_epi32(State0, 0x1B);
+	State1 = _mm_shuffle_epi32(State1, 0xB1);
+	_mm_storeu_si128((__m128i*)&State[0], _mm_blend_epi16(Tmp, State1, 0xF0));
+	_mm_storeu_si128((__m128i*)&State[4], _mm_alignr_epi8(State1, Tmp, 8));
+}
+#endif
+
+static HashBlocksFunction HashUtils_GetSha1Blocks()
+{
+#ifdef CPU_X86
+	if ((CpuUtils_GetFeatures() & (CPU_FEATURE_SHA | CPU_FEATURE_SSE41)) == (CPU_FEATURE_SHA | CPU_FEATURE_SSE41))
+		return HashUtils_Sha1BlocksNI;
+#endif
+	return HashUtils_Sha1Blocks;
+}
+
+static HashBlocksFunction HashUtils_GetSha256Blocks()
+{
+#ifdef CPU_X86
+	if ((CpuUtils_GetFeatures() & (CPU_FEATURE_SHA | CPU_FEATURE_SSE41)) == (CPU_FEATURE_SHA | CPU_FEATURE_SSE41))
+		return HashUtils_Sha256BlocksNI;
+#endif
+	return HashUtils_Sha256Blocks;
+}
+
+/* buffering shared by all digests: pending bytes are completed into a block, whole blocks hashed in place */
+static VOID HashUtils_Update(PDWORD State, PBYTE Buffer, PULONGLONG lpLength, LPCVOID Data, SIZE_T SizeInBytes, HashBlocksFunction Blocks)
+{
+	const BYTE* lpData = (const BYTE*)Data;
+	SIZE_T Used = (SIZE_T)(*lpLength & 63);
+	SIZE_T Free = 64 - Used;
+
+	*lpLength += SizeInBytes;
+	if (Used != 0)
+	{
+		if (SizeInBytes < Free)
+		{
+			memcpy(Buffer + Used, lpData, SizeInBytes);
+			return;
+		}
+		memcpy(Buffer + Used, lpData, Free);
+		Blocks(State, Buffer, 1);
+		lpData += Free;
+		SizeInBytes -= Free;
+	}
+	if (SizeInBytes >= 64)
+	{
+		Blocks(State, lpData, SizeInBytes / 64);
+		lpData += SizeInBytes & ~(SIZE_T)63;
+		SizeInBytes &= 63;
+	}
+	memcpy(Buffer, lpData, SizeInBytes);
+}
+
+/* padding and length in bits, little endian for MD5 and big endian for SHA */
+static VOID HashUtils_Pad(PDWORD State, PBYTE Buffer, PULONGLONG lpLength, BOOL bBigEndian, HashBlocksFunction Blocks)
+{
+	static const BYTE Padding[64] = { 0x80 };
+	BYTE Length[8];
+	ULONGLONG nBits = *lpLength * 8;
+	SIZE_T Used = (SIZE_T)(*lpLength & 63);
+
+	for (DWORD i = 0; i < 8; i++)
+		Length[bBigEndian ? 7 - i : i] = (BYTE)(nBits >> (i * 8));
+	HashUtils_Update(State, Buffer, lpLength, Padding, Used < 56 ? 56 - Used : 120 - Used, Blocks);
+	HashUtils_Update(State, Buffer, lpLength, Length, sizeof(Length), Blocks);
+}
+
+static VOID HashUtils_StoreBigEndian(PDWORD State, DWORD nWords, PBYTE Digest)
+{
+	for (DWORD i = 0; i < nWords * 4; i++)
+		Digest[i] = (BYTE)(State[i / 4] >> ((3 - i % 4) * 8));
+}
+
+VOID HashUtils_Md5Init(PMD5_CONTEXT Context)
+{
+	Context->State[0] = 0x67452301;
+	Context->State[1] = 0xefcdab89;
+	Context->State[2] = 0x98badcfe;
+	Context->State[3] = 0x10325476;
+	Context->Length = 0;
+}
+
+VOID HashUtils_Md5Update(PMD5_CONTEXT Context, LPCVOID Data, SIZE_T SizeInBytes)
+{
+	HashUtils_Update(Context->State, Context->Buffer, &Context->Length, Data, SizeInBytes, HashUtils_Md5Blocks);
+}
+
+VOID HashUtils_Md5Final(PMD5_CONTEXT Context, PBYTE Digest)
+{
+	HashUtils_Pad(Context->State, Context->Buffer, &Context->Length, FALSE, HashUtils_Md5Blocks);
+	for (DWORD i = 0; i < 16; i++)
+		Digest[i] = (BYTE)(Context->State[i / 4] >> ((i % 4) * 8));
+}
+
+VOID HashUtils_Sha1Init(PSHA_CONTEXT Context)
+{
+	Context->State[0] = 0x67452301;
+	Context->State[1] = 0xefcdab89;
+	Context->State[2] = 0x98badcfe;
+	Context->State[3] = 0x10325476;
+	Context->State[4] = 0xc3d2e1f0;
+	Context->Length = 0;
+}
+
+VOID HashUtils_Sha1Update(PSHA_CONTEXT Context, LPCVOID Data, SIZE_T SizeInBytes)
+{
+	HashUtils_Update(Context->State, Context->Buffer, &Context->Length, Data, SizeInBytes, HashUtils_GetSha1Blocks());
+}
+
+VOID HashUtils_Sha1Final(PSHA_CONTEXT Context, PBYTE Digest)
+{
+	HashUtils_Pad(Context->State, Context->Buffer, &Context->Length, TRUE, HashUtils_GetSha1Blocks());
+	HashUtils_StoreBigEndian(Context->State, 5, Digest);
+}
+
+VOID HashUtils_Sha256Init(PSHA_CONTEXT Context)
+{
+	Context->State[0] = 0x6a09e667;
+	Context->State[1] = 0xbb67ae85;
+	Context->State[2] = 0x3c6ef372;
+	Context->State[3] = 0xa54ff53a;
+	Context->State[4] = 0x510e527f;
+	Context->State[5] = 0x9b05688c;
+	Context->State[6] = 0x1f83d9ab;
+	Context->State[7] = 0x5be0cd19;
+	Context->Length = 0;
+}
+
+VOID HashUtils_Sha256Update(PSHA_CONTEXT Context, LPCVOID Data, SIZE_T SizeInBytes)
+{
+	HashUtils_Update(Context->State, Context->Buffer, &Context->Length, Data, SizeInBytes, HashUtils_GetSha256Blocks());
+}
+
+VOID HashUtils_Sha256Final(PSHA_CONTEXT Context, PBYTE Digest)
+{
+	HashUtils_Pad(Context->State, Context->Buffer, &Context->Length, TRUE, HashUtils_GetSha256Blocks());
+	HashUtils_StoreBigEndian(Context->State, 8, Digest);
+}
+VOID HashUtils_ToHex(LPCVOID Digest, DWORD SizeInBytes, PCHAR Hex)
+{
+	static const CHAR Digits[] = "0123456789abcdef";
+	const BYTE* lpDigest = (const BYTE*)Digest;
+
+	for (DWORD i = 0; i < SizeInBytes; i++)
+	{
+		Hex[i * 2] = Digits[lpDigest[i] >> 4];
+		Hex[i * 2 + 1] = Digits[lpDigest[i] & 0xF];
+	}
+	Hex[SizeInBytes * 2] = '\0';
+}
@@ -0,0 +1,109 @@
+/**
+ * \file HashUtils.h
+ * \brief Streaming message digests (MD5, SHA-1, SHA-256)
+ * \author Tomtombinary
+ * \version 1.0
+ * \date 17 octobre 2026
+ * Data is given piece by piece to the Update functions, nothing is allocated.
+ * SHA-1 and SHA-256 blocks are hashed with the SHA extensions of x86
+ * processors when they are available (see CpuUtils_GetFeatures).
+ */
+
+#pragma once
+#include "stdafx.h"
+
+#define MD5_DIGEST_SIZE 16
+#define SHA1_DIGEST_SIZE 20
+#define SHA256_DIGEST_SIZE 32
+
+/**
+ * \struct MD5_CONTEXT
+ * \brief state of an MD5 computation, see HashUtils_Md5Init
+ */
+typedef struct _MD5_CONTEXT
+{
+	DWORD State[4];
+	ULONGLONG Length;
+	BYTE Buffer[64];
+}MD5_CONTEXT,*PMD5_CONTEXT;
+
+/**
+ * \fn VOID HashUtils_Md5Init(PMD5_CONTEXT Context);
+ * \brief start an MD5 computation
+ */
+VOID HashUtils_Md5Init(PMD5_CONTEXT Context);
+
+/**
+ * \fn VOID HashUtils_Md5Update(PMD5_CONTEXT Context, LPCVOID Data, SIZE_T SizeInBytes);
+ * \brief add data to an MD5 computation
+ * \param Context: MD5 state
+ * \param Data: data to hash
+ * \param SizeInBytes: size of the data
+ */
+VOID HashUtils_Md5Update(PMD5_CONTEXT Context, LPCVOID Data, SIZE_T SizeInBytes);
+
+/**
+ * \fn VOID HashUtils_Md5Final(PMD5_CONTEXT Context, PBYTE Digest);
+ * \brief end an MD5 computation
+ * \param Context: MD5 state, must be initialized again to be reused
+ * \param Digest: [out] MD5_DIGEST_SIZE bytes
+ */
+VOID HashUtils_Md5Final(PMD5_CONTEXT Context, PBYTE Digest);
+
+/**
+ * \struct SHA_CONTEXT
+ * \brief state of a SHA-1 (5 words) or SHA-256 (8 words) computation
+ */
+typedef struct _SHA_CONTEXT
+{
+	DWORD State[8];
+	ULONGLONG Length;
+	BYTE Buffer[64];
+}SHA_CONTEXT,*PSHA_CONTEXT;
+
+/**
+ * \fn VOID HashUtils_Sha1Init(PSHA_CONTEXT Context);
+ * \brief start a SHA-1 computation
+ */
+VOID HashUtils_Sha1Init(PSHA_CONTEXT Context);
+
+/**
+ * \fn VOID HashUtils_Sha1Update(PSHA_CONTEXT Context, LPCVOID Data, SIZE_T SizeInBytes);
+ * \brief add data to a SHA-1 computation
+ */
+VOID HashUtils_Sha1Update(PSHA_CONTEXT Context, LPCVOID Data, SIZE_T SizeInBytes);
+
+/**
+ * \fn VOID HashUtils_Sha1Final(PSHA_CONTEXT Context, PBYTE Digest);
+ * \brief end a SHA-1 computation
+ * \param Digest: [out] SHA1_DIGEST_SIZE bytes
+ */
+VOID HashUtils_Sha1Final(PSHA_CONTEXT Context, PBYTE Digest);
+
+/**
+ * \fn VOID HashUtils_Sha256Init(PSHA_CONTEXT Context);
+ * \brief start a SHA-256 computation
+ */
+VOID HashUtils_Sha256Init(PSHA_CONTEXT Context);
+
+/**
+ * \fn VOID HashUtils_Sha256Update(PSHA_CONTEXT Context, LPCVOID Data, SIZE_T SizeInBytes);
+ * \brief add data to a SHA-256 computation
+ */
+VOID HashUtils_Sha256Update(PSHA_CONTEXT Context, LPCVOID Data, SIZE_T SizeInBytes);
+
+/**
+ * \fn VOID HashUtils_Sha256Final(PSHA_CONTEXT Context, PBYTE Digest);
+ * \brief end a SHA-256 computation
+ * \param Digest: [out] SHA256_DIGEST_SIZE bytes
+ */
+VOID HashUtils_Sha256Final(PSHA_CONTEXT Context, PBYTE Digest);
+
+/**
+ * \fn VOID HashUtils_ToHex(LPCVOID Digest, DWORD SizeInBytes, PCHAR Hex);
+ * \brief write a digest in lowercase hexadecimal
+ * \param Digest: digest
+ * \param SizeInBytes: size of the digest
+ * \param Hex: [out] 2 * SizeInBytes + 1 characters, null terminated
+ */
+VOID HashUtils_ToHex(LPCVOID Digest, DWORD SizeInBytes, PCHAR Hex);
@@ -0,0 +1,80 @@
+/**
+ * \file ImageMapper.c
+ * \brief Defines function described in file ImageMapper.h
+ * \author Tomtombinary
+ * \version 1.0
+ * \date 17 octobre 2026
+ */
+
+#include "stdafx.h"
+#include "ImageMapper.h"
+
+BOOL PE32_MapImageFile(LPCSTR Path, PPE_IMAGE Image, PULONGLONG lpCopiedBytes)
+{
+	PE_IMAGE File;
+	FILE_VIEW View;
+	PFILE_SEGMENT Segments;
+	PIMAGE_SECTION_HEADER lpSectionHeader;
+	SIZE_T SizeOfImage;
+	DWORD nSegments = 0;
+	DWORD dwSize;
+	BOOL bSuccess;
+
+	if (lpCopiedBytes != NULL)
+		*lpCopiedBytes = 0;
+	/* headers and section table are read from a plain mapping of the file */
+	if (!PE32_OpenFile(Path, &File))
+	{
+		*Image = File;
+		return FALSE;
+	}
+
+	SizeOfImage = File.NtHeaders->OptionalHeader.SizeOfImage;
+	Segments = (PFILE_SEGMENT)malloc((File.nSections + 1) * sizeof(FILE_SEGMENT));
+	if (Segments == NULL || SizeOfImage == 0)
+	{
+		free(Segments);
+		PE32_CloseImage(&File);
+		memset(Image, 0, sizeof(PE_IMAGE));
+		Image->Error = PE_ERROR_NT_HEADERS;
+		return FALSE;
+	}
+
+	Segments[nSegments].Offset = 0;
+	Segments[nSegments].Address = 0;
+	Segments[nSegments].Size = File.NtHeaders->OptionalHeader.SizeOfHeaders;
+	nSegments++;
+
+	/* the part of a section beyond its raw data (BSS) stays zero-filled */
+	lpSectionHeader = File.SectionHeaders;
+	for (DWORD i = 0; i < File.nSections; i++, lpSectionHeader++)
+	{
+		dwSize = lpSectionHeader->SizeOfRawData;
+		if (lpSectionHeader->Misc.VirtualSize != 0 && lpSectionHeader->Misc.VirtualSize < dwSize)
+			dwSize = lpSectionHeader->Misc.VirtualSize;
+		if (dwSize == 0)
+			continue;
+		Segments[nSegments].Offset = lpSectionHeader->PointerToRawData;
+		Segments[nSegments].Address = lpSectionHeader->VirtualAddress;
+		Segments[nSegments].Size = dwSize;
+		nSegments++;
+	}
+	PE32_CloseImage(&File);
+
+	bSuccess = FileUtils_MapSegments(Path, SizeOfImage, Segments, nSegments, &View, lpCopiedBytes);
+	free(Segments);
+	if (!bSuccess)
+	{
+		memset(Image, 0, sizeof(PE_IMAGE));
+		Image->Error = PE_ERROR_FILE;
+		return FALSE;
+	}
+	if (!PE32_InitImage(Image, View.Data, View.Size, PE_LAYOUT_IMAGE))
+	{
+		FileUtils_UnmapFile(&View);
+		return FALSE;
+	}
+	/* the image owns the view, as with PE32_OpenFile */
+	Image->View = View;
+	return TRUE;
+}
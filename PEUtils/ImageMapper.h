@@ -0,0 +1,28 @@
+/**
+ * \file ImageMapper.h
+ * \brief Mapping of a PE file with its memory layout (PE_LAYOUT_IMAGE)
+ * \author Tomtombinary
+ * \version 1.0
+ * \date 17 octobre 2026
+ * Headers and sections are placed at their RVA in SizeOfImage bytes of
+ * zero-filled memory, as the Windows loader does, without running anything:
+ * no import resolution and no relocation (see PE32_RebaseImage). Sections
+ * whose raw data and RVA have the same offset in a page are mapped from the
+ * file, only the other ones are copied.
+ */
+
+#pragma once
+#include "stdafx.h"
+#include "PEUtils.h"
+
+/**
+ * \fn BOOL PE32_MapImageFile(LPCSTR Path, PPE_IMAGE Image, PULONGLONG lpCopiedBytes);
+ * \brief map a PE file in memory with the layout of a loaded module
+ * The image is writable (private copy on write) and released by PE32_CloseImage.
+ * Image->Base can be used as the HMODULE of the PE32_Enum* functions.
+ * \param Path: path of the PE file
+ * \param Image: [out] image description
+ * \param lpCopiedBytes: [out, optional] number of bytes which couldn't be mapped and were copied
+ * \return FALSE if the file couldn't be read or isn't a valid PE, Image->Error gives the reason
+ */
+BOOL PE32_MapImageFile(LPCSTR Path, PPE_IMAGE Image, PULONGLONG lpCopiedBytes);
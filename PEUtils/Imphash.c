@@ -0,0 +1,196 @@
+/**
+ * \file Imphash.c
+ * \brief Defines function described in file Imphash.h
+ * \author Tomtombinary
+ * \version 1.0
+ * \date 17 octobre 2026
+ */
+
+#include "stdafx.h"
+#include "Imphash.h"
+#include "NameTable.h"
+#include "BulkEnum.h"
+#include "Validate.h"
+
+#define IMPHASH_CHUNK 64
+
+/**
+ * \struct ORDINAL_NAME
+ * \brief export of a system DLL known by its ordinal
+ */
+typedef struct _ORDINAL_NAME
+{
+	WORD Ordinal;
+	LPCSTR Name;
+}ORDINAL_NAME,*PORDINAL_NAME;
+
+/**
+ * \struct ORDINAL_TABLE
+ * \brief exports of a DLL sorted by ordinal
+ */
+typedef struct _ORDINAL_TABLE
+{
+	LPCSTR DllName;
+	const ORDINAL_NAME* Names;
+	DWORD nNames;
+}ORDINAL_TABLE,*PORDINAL_TABLE;
+
+/* Windows Sockets 1.1, same ordinals in ws2_32 and wsock32 */
+static const ORDINAL_NAME Imphash_Winsock[] =
+{
+	{ 1, "accept" }, { 2, "bind" }, { 3, "closesocket" }, { 4, "connect" },
+	{ 5, "getpeername" }, { 6, "getsockname" }, { 7, "getsockopt" }, { 8, "htonl" },
+	{ 9, "htons" }, { 10, "ioctlsocket" }, { 11, "inet_addr" }, { 12, "inet_ntoa" },
+	{ 13, "listen" }, { 14, "ntohl" }, { 15, "ntohs" }, { 16, "recv" },
+	{ 17, "recvfrom" }, { 18, "select" }, { 19, "send" }, { 20, "sendto" },
+	{ 21, "setsockopt" }, { 22, "shutdown" }, { 23, "socket" },
+	{ 51, "gethostbyaddr" }, { 52, "gethostbyname" }, { 53, "getprotobyname" }, { 54, "getprotobynumber" },
+	{ 55, "getservbyname" }, { 56, "getservbyport" }, { 57, "gethostname" },
+	{ 101, "WSAAsyncSelect" }, { 102, "WSAAsyncGetHostByAddr" }, { 103, "WSAAsyncGetHostByName" }, { 104, "WSAAsyncGetProtoByNumber" },
+	{ 105, "WSAAsyncGetProtoByName" }, { 106, "WSAAsyncGetServByPort" }, { 107, "WSAAsyncGetServByName" }, { 108, "WSACancelAsyncRequest" },
+	{ 109, "WSASetBlockingHook" }, { 110, "WSAUnhookBlockingHook" }, { 111, "WSAGetLastError" }, { 112, "WSASetLastError" },
+	{ 113, "WSACancelBlockingCall" }, { 114, "WSAIsBlocking" }, { 115, "WSAStartup" }, { 116, "WSACleanup" },
+	{ 151, "__WSAFDIsSet" }, { 500, "WEP" }
+};
+
+static const ORDINAL_NAME Imphash_Oleaut32[] =
+{
+	{ 2, "SysAllocString" }, { 3, "SysReAllocString" }, { 4, "SysAllocStringLen" }, { 5, "SysReAllocStringLen" },
+	{ 6, "SysFreeString" }, { 7, "SysStringLen" }, { 8, "VariantInit" }, { 9, "VariantClear" },
+	{ 10, "VariantCopy" }, { 11, "VariantCopyInd" }, { 12, "VariantChangeType" }, { 13, "VariantTimeToDosDateTime" },
+	{ 14, "DosDateTimeToVariantTime" }, { 15, "SafeArrayCreate" }, { 16, "SafeArrayDestroy" }, { 17, "SafeArrayGetDim" },
+	{ 18, "SafeArrayGetElemsize" }, { 19, "SafeArrayGetUBound" }, { 20, "SafeArrayGetLBound" }, { 21, "SafeArrayLock" },
+	{ 22, "SafeArrayUnlock" }, { 23, "SafeArrayAccessData" }, { 24, "SafeArrayUnaccessData" }, { 25, "SafeArrayGetElement" },
+	{ 26, "SafeArrayPutElement" }, { 27, "SafeArrayCopy" }, { 28, "DispGetParam" }, { 29, "DispGetIDsOfNames" },
+	{ 30, "DispInvoke" }, { 31, "CreateDispTypeInfo" }, { 32, "CreateStdDispatch" }, { 33, "RegisterActiveObject" },
+	{ 34, "RevokeActiveObject" }, { 35, "GetActiveObject" }, { 36, "SafeArrayAllocDescriptor" }, { 37, "SafeArrayAllocData" },
+	{ 38, "SafeArrayDestroyDescriptor" }, { 39, "SafeArrayDestroyData" }, { 40, "SafeArrayRedim" },
+	{ 147, "VariantChangeTypeEx" }, { 148, "SafeArrayPtrOfIndex" }, { 149, "SysStringByteLen" }, { 150, "SysAllocStringByteLen" }
+};
+
+static const ORDINAL_TABLE Imphash_OrdinalTables[] =
+{
+	{ "ws2_32.dll", Imphash_Winsock, sizeof(Imphash_Winsock) / sizeof(ORDINAL_NAME) },
+	{ "wsock32.dll", Imphash_Winsock, sizeof(Imphash_Winsock) / sizeof(ORDINAL_NAME) },
+	{ "oleaut32.dll", Imphash_Oleaut32, sizeof(Imphash_Oleaut32) / sizeof(ORDINAL_NAME) }
+};
+
+static BOOL Imphash_EqualsNoCase(LPCSTR Name, LPCSTR LowerName)
+{
+	CHAR c;
+
+	for (; *LowerName != '\0'; Name++, LowerName++)
+	{
+		c = *Name;
+		if (c >= 'A' && c <= 'Z')
+			c = c - 'A' + 'a';
+		if (c != *LowerName)
+			return FALSE;
+	}
+	return *Name == '\0';
+}
+
+static const ORDINAL_TABLE* Imphash_FindOrdinalTable(LPCSTR DllName)
+{
+	for (DWORD i = 0; i < sizeof(Imphash_OrdinalTables) / sizeof(ORDINAL_TABLE); i++)
+	{
+		if (Imphash_EqualsNoCase(DllName, Imphash_OrdinalTables[i].DllName))
+			return &Imphash_OrdinalTables[i];
+	}
+	return NULL;
+}
+
+static LPCSTR Imphash_FindOrdinal(const ORDINAL_TABLE* Table, WORD Ordinal)
+{
+	DWORD dwLow = 0, dwHigh = Table->nNames, dwMiddle;
+
+	while (dwLow < dwHigh)
+	{
+		dwMiddle = (dwLow + dwHigh) / 2;
+		if (Table->Names[dwMiddle].Ordinal == Ordinal)
+			return Table->Names[dwMiddle].Name;
+		if (Table->Names[dwMiddle].Ordinal < Ordinal)
+			dwLow = dwMiddle + 1;
+		else
+			dwHigh = dwMiddle;
+	}
+	return NULL;
+}
+
+LPCSTR PE32_ResolveImportOrdinal(LPCSTR DllName, WORD Ordinal)
+{
+	const ORDINAL_TABLE* Table = Imphash_FindOrdinalTable(DllName);
+
+	return Table != NULL ? Imphash_FindOrdinal(Table, Ordinal) : NULL;
+}
+
+BOOL PE32_GetImportFingerprint(PPE_IMAGE Image, PIMPORT_FINGERPRINT Fingerprint)
+{
+	LPCSTR DllNames[IMPHASH_CHUNK];
+	LPCSTR Names[IMPHASH_CHUNK];
+	WORD Hints[IMPHASH_CHUNK];
+	IMPORT_ARRAYS Arrays = { DllNames, Names, Hints, NULL };
+	IMPORT_CURSOR Cursor;
+	MD5_CONTEXT Md5;
+	LPCSTR CurrentDll = NULL;
+	PCINTERNED_NAME Dll = NULL;
+	PCINTERNED_NAME Function;
+	const ORDINAL_TABLE* Ordinals = NULL;
+	LPCSTR OrdinalName;
+	CHAR Buffer[16];
+	DWORD nImports;
+
+	memset(Fingerprint, 0, sizeof(IMPORT_FINGERPRINT));
+	if (Image->Directories[IMAGE_DIRECTORY_ENTRY_IMPORT].VirtualAddress == 0 || !PE32_IsTableSafe(Image, PE_TABLE_IMPORTS))
+		return FALSE;
+
+	HashUtils_Md5Init(&Md5);
+	PE32_InitImportCursor(Image, &Cursor);
+	while ((nImports = PE32_GetImports(Image, &Cursor, &Arrays, IMPHASH_CHUNK)) != 0)
+	{
+		for (DWORD i = 0; i < nImports; i++)
+		{
+			/* the DLL only changes between descriptors */
+			if (DllNames[i] != CurrentDll)
+			{
+				CurrentDll = DllNames[i];
+				Dll = NameTable_Intern(CurrentDll, NAME_KIND_DLL);
+				Ordinals = Imphash_FindOrdinalTable(CurrentDll);
+				Fingerprint->nDlls++;
+			}
+
+			if (Names[i] != NULL)
+				Function = NameTable_Intern(Names[i], NAME_KIND_FUNCTION);
+			else
+			{
+				Fingerprint->nOrdinals++;
+				OrdinalName = Ordinals != NULL ? Imphash_FindOrdinal(Ordinals, Hints[i]) : NULL;
+				if (OrdinalName != NULL)
+					Fingerprint->nResolvedOrdinals++;
+				else
+				{
+					snprintf(Buffer, sizeof(Buffer), "ord%u", (unsigned int)Hints[i]);
+					OrdinalName = Buffer;
+				}
+				Function = NameTable_Intern(OrdinalName, NAME_KIND_FUNCTION);
+			}
+			if (Dll == NULL || Function == NULL)
+			{
+				memset(Fingerprint, 0, sizeof(IMPORT_FINGERPRINT));
+				return FALSE;
+			}
+
+			/* "dll.function" entries separated by commas */
+			if (Fingerprint->nImports != 0)
+				HashUtils_Md5Update(&Md5, ",", 1);
+			HashUtils_Md5Update(&Md5, Dll->Name, Dll->Length);
+			HashUtils_Md5Update(&Md5, ".", 1);
+			HashUtils_Md5Update(&Md5, Function->Name, Function->Length);
+			Fingerprint->nImports++;
+		}
+	}
+
+	HashUtils_Md5Final(&Md5, Fingerprint->Imphash);
+	HashUtils_ToHex(Fingerprint->Imphash, MD5_DIGEST_SIZE, Fingerprint->ImphashString);
+	return TRUE;
+}
@@ -0,0 +1,57 @@
+/**
+ * \file Imphash.h
+ * \brief Import hash (imphash) and fingerprint of the import table
+ * \author Tomtombinary
+ * \version 1.0
+ * \date 17 octobre 2026
+ * The imphash is the MD5 of the lowercase "dll.function" list of the imports,
+ * separated by commas, without the .dll, .ocx or .sys extension. Imports are
+ * extracted chunk by chunk (see PE32_GetImports) and hashed as they come:
+ * the list is never built. Names go through the process-wide name table
+ * (see NameTable.h), so a name already seen in another file is not
+ * lowercased again. Imports by ordinal of ws2_32, wsock32 and oleaut32 are
+ * named from a built-in table, the other ones are hashed as "ordN".
+ */
+
+#pragma once
+#include "stdafx.h"
+#include "PEUtils.h"
+#include "HashUtils.h"
+
+/**
+ * \struct IMPORT_FINGERPRINT
+ * \brief result of PE32_GetImportFingerprint
+ * Imphash: MD5 digest of the import list
+ * ImphashString: Imphash in lowercase hexadecimal
+ * nDlls: number of import descriptors with at least one import
+ * nImports: number of imports
+ * nOrdinals: number of imports by ordinal
+ * nResolvedOrdinals: imports by ordinal named from the built-in table
+ */
+typedef struct _IMPORT_FINGERPRINT
+{
+	BYTE Imphash[MD5_DIGEST_SIZE];
+	CHAR ImphashString[MD5_DIGEST_SIZE * 2 + 1];
+	DWORD nDlls;
+	DWORD nImports;
+	DWORD nOrdinals;
+	DWORD nResolvedOrdinals;
+}IMPORT_FINGERPRINT,*PIMPORT_FINGERPRINT;
+
+/**
+ * \fn BOOL PE32_GetImportFingerprint(PPE_IMAGE Image, PIMPORT_FINGERPRINT Fingerprint);
+ * \brief compute the imphash and counters of the import table, safe to call from several threads
+ * \param Image: image description
+ * \param Fingerprint: [out] fingerprint, zeroed on failure
+ * \return FALSE if the image has no import, if the import table is malformed (see PE32_ValidateImage) or memory couldn't be allocated
+ */
+BOOL PE32_GetImportFingerprint(PPE_IMAGE Image, PIMPORT_FINGERPRINT Fingerprint);
+
+/**
+ * \fn LPCSTR PE32_ResolveImportOrdinal(LPCSTR DllName, WORD Ordinal);
+ * \brief name of an import by ordinal from the built-in table
+ * \param DllName: name of the DLL with its extension (case insensitive)
+ * \param Ordinal: ordinal of the import
+ * \return name of the function, NULL if the DLL or the ordinal isn't in the table
+ */
+LPCSTR PE32_ResolveImportOrdinal(LPCSTR DllName, WORD Ordinal);
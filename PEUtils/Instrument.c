@@ -0,0 +1,246 @@
+/**
+ * \file Instrument.c
+ * \brief Defines function described in file Instrument.h
+ * \author Tomtombinary
+ * \version 1.0
+ * \date 17 octobre 2026
+ */
+
+#include "stdafx.h"
+#include "Instrument.h"
+#include "ThreadUtils.h"
+#include "CpuUtils.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#define INSTRUMENT_TLS __declspec(thread)
+#else
+#if defined(CPU_X86)
+#include <x86intrin.h>
+#endif
+#define INSTRUMENT_TLS __thread
+#endif
+
+/* Next of a block being pushed, readers wait for the real value */
+#define INSTRUMENT_PENDING ((PINSTRUMENT_THREAD)1)
+
+/* counters of a thread, written by this thread only, kept after its end */
+typedef struct _INSTRUMENT_THREAD
+{
+	INSTRUMENT_COUNTERS Probes[INSTRUMENT_PROBE_COUNT];
+	ULONGLONG Events[INSTRUMENT_EVENT_COUNT];
+	struct _INSTRUMENT_THREAD* volatile Next;
+}INSTRUMENT_THREAD,*PINSTRUMENT_THREAD;
+
+static INSTRUMENT_TLS PINSTRUMENT_THREAD CurrentThread = NULL;
+static LPVOID volatile Threads = NULL;
+static volatile LONG nThreads = 0;
+
+static volatile InstrumentHook BeginHook = NULL;
+static volatile InstrumentHook EndHook = NULL;
+static LPVOID volatile HookArgs = NULL;
+
+/* both clocks read by the first instrumented thread, to convert cycles */
+static volatile ULONGLONG CalibrationCycles = 0;
+static volatile ULONGLONG CalibrationTime = 0;
+
+static const LPCSTR ProbeNames[INSTRUMENT_PROBE_COUNT] = {
+	"enum_sections", "enum_exports", "enum_imports", "enum_relocations",
+	"rva_to_file_offset", "search_relocation", "enum_modules"
+};
+
+static const LPCSTR EventNames[INSTRUMENT_EVENT_COUNT] = {
+	"no_export_directory", "no_import_directory", "bad_exports", "bad_imports", "bad_relocs", "bad_headers"
+};
+
+BOOL Instrument_IsEnabled(VOID)
+{
+#ifdef PEUTILS_INSTRUMENT
+	return TRUE;
+#else
+	return FALSE;
+#endif
+}
+
+ULONGLONG Instrument_ReadCycles(VOID)
+{
+#ifdef CPU_X86
+	return __rdtsc();
+#else
+	return ThreadUtils_GetTime() * 1000;
+#endif
+}
+
+/* counters of the calling thread, allocated and published on its first call */
+static PINSTRUMENT_THREAD Instrument_GetThread(VOID)
+{
+	PINSTRUMENT_THREAD Thread = CurrentThread;
+	LPVOID Previous;
+
+	if (Thread != NULL)
+		return Thread;
+	Thread = (PINSTRUMENT_THREAD)calloc(1, sizeof(INSTRUMENT_THREAD));
+	if (Thread == NULL)
+		return NULL;
+	Thread->Next = INSTRUMENT_PENDING;
+	Previous = ThreadUtils_AtomicExchangePointer(&Threads, Thread);
+	ThreadUtils_AtomicExchangePointer((LPVOID volatile*)&Thread->Next, Previous);
+	CurrentThread = Thread;
+	if (ThreadUtils_AtomicAdd(&nThreads, 1) == 1)
+	{
+		CalibrationTime = ThreadUtils_GetTime();
+		CalibrationCycles = Instrument_ReadCycles();
+	}
+	return Thread;
+}
+
+static VOID Instrument_AddThread(PINSTRUMENT_SNAPSHOT Snapshot, PINSTRUMENT_THREAD Thread)
+{
+	for (DWORD i = 0; i < INSTRUMENT_PROBE_COUNT; i++)
+	{
+		Snapshot->Probes[i].nCalls += Thread->Probes[i].nCalls;
+		Snapshot->Probes[i].nEntries += Thread->Probes[i].nEntries;
+		Snapshot->Probes[i].nBytes += Thread->Probes[i].nBytes;
+		Snapshot->Probes[i].nTerminated += Thread->Probes[i].nTerminated;
+		Snapshot->Probes[i].nMalformed += Thread->Probes[i].nMalformed;
+		Snapshot->Probes[i].Cycles += Thread->Probes[i].Cycles;
+	}
+	for (DWORD i = 0; i < INSTRUMENT_EVENT_COUNT; i++)
+		Snapshot->Events[i] += Thread->Events[i];
+	Snapshot->nThreads++;
+}
+
+/* next block of the list, once its publication is finished */
+static PINSTRUMENT_THREAD Instrument_GetNext(PINSTRUMENT_THREAD Thread)
+{
+	PINSTRUMENT_THREAD Next;
+
+	while ((Next = (PINSTRUMENT_THREAD)ThreadUtils_AtomicLoadPointer((LPVOID volatile*)&Thread->Next)) == INSTRUMENT_PENDING)
+		ThreadUtils_Yield();
+	return Next;
+}
+
+static VOID Instrument_SetRate(PINSTRUMENT_SNAPSHOT Snapshot)
+{
+	ULONGLONG Time = ThreadUtils_GetTime();
+
+	if (Snapshot->nThreads != 0 && CalibrationTime != 0 && Time > CalibrationTime)
+		Snapshot->CyclesPerMicrosecond = (double)(Instrument_ReadCycles() - CalibrationCycles) / (double)(Time - CalibrationTime);
+}
+
+VOID Instrument_SetHooks(InstrumentHook Begin, InstrumentHook End, LPVOID UserArgs)
+{
+	HookArgs = UserArgs;
+	BeginHook = Begin;
+	EndHook = End;
+}
+
+VOID Instrument_GetSnapshot(PINSTRUMENT_SNAPSHOT Snapshot)
+{
+	PINSTRUMENT_THREAD Thread = (PINSTRUMENT_THREAD)ThreadUtils_AtomicLoadPointer(&Threads);
+
+	memset(Snapshot, 0, sizeof(INSTRUMENT_SNAPSHOT));
+	for (; Thread != NULL; Thread = Instrument_GetNext(Thread))
+		Instrument_AddThread(Snapshot, Thread);
+	Instrument_SetRate(Snapshot);
+}
+
+VOID Instrument_GetThreadSnapshot(PINSTRUMENT_SNAPSHOT Snapshot)
+{
+	memset(Snapshot, 0, sizeof(INSTRUMENT_SNAPSHOT));
+	if (CurrentThread != NULL)
+		Instrument_AddThread(Snapshot, CurrentThread);
+	Instrument_SetRate(Snapshot);
+}
+
+VOID Instrument_Reset(VOID)
+{
+	PINSTRUMENT_THREAD Thread = (PINSTRUMENT_THREAD)ThreadUtils_AtomicLoadPointer(&Threads);
+
+	for (; Thread != NULL; Thread = Instrument_GetNext(Thread))
+	{
+		memset(Thread->Probes, 0, sizeof(Thread->Probes));
+		memset(Thread->Events, 0, sizeof(Thread->Events));
+	}
+}
+
+LPCSTR Instrument_GetProbeName(DWORD Probe)
+{
+	return Probe < INSTRUMENT_PROBE_COUNT ? ProbeNames[Probe] : "unknown";
+}
+
+LPCSTR Instrument_GetEventName(DWORD Event)
+{
+	return Event < INSTRUMENT_EVENT_COUNT ? EventNames[Event] : "unknown";
+}
+
+VOID Instrument_PrintSnapshot(FILE* Output, PINSTRUMENT_SNAPSHOT Snapshot)
+{
+	PINSTRUMENT_COUNTERS Counters;
+	double Rate = Snapshot->CyclesPerMicrosecond;
+
+	for (DWORD i = 0; i < INSTRUMENT_PROBE_COUNT; i++)
+	{
+		Counters = &Snapshot->Probes[i];
+		if (Counters->nCalls == 0)
+			continue;
+		fprintf(Output, "%-20s calls %llu entries %llu bytes %llu stopped %llu malformed %llu cycles %llu",
+			ProbeNames[i], (unsigned long long)Counters->nCalls, (unsigned long long)Counters->nEntries, (unsigned long long)Counters->nBytes,
+			(unsigned long long)Counters->nTerminated, (unsigned long long)Counters->nMalformed, (unsigned long long)Counters->Cycles);
+		if (Rate > 0.0)
+			fprintf(Output, " (%.0f us)", (double)Counters->Cycles / Rate);
+		fprintf(Output, "\n");
+	}
+	for (DWORD i = 0; i < INSTRUMENT_EVENT_COUNT; i++)
+	{
+		if (Snapshot->Events[i] != 0)
+			fprintf(Output, "%-20s %llu\n", EventNames[i], (unsigned long long)Snapshot->Events[i]);
+	}
+}
+
+VOID Instrument_Begin(PINSTRUMENT_CALL Call, DWORD Probe)
+{
+	InstrumentHook Hook = BeginHook;
+
+	Call->Probe = Probe;
+	Call->Cycles = 0;
+	Call->nEntries = 0;
+	Call->nBytes = 0;
+	Call->bTerminated = FALSE;
+	Call->bMalformed = FALSE;
+	if (Hook != NULL)
+	{
+		Call->Start = Instrument_ReadCycles();
+		Hook(Call, HookArgs);
+	}
+	Call->Start = Instrument_ReadCycles();
+}
+
+VOID Instrument_End(PINSTRUMENT_CALL Call)
+{
+	PINSTRUMENT_THREAD Thread;
+	PINSTRUMENT_COUNTERS Counters;
+	InstrumentHook Hook = EndHook;
+
+	Call->Cycles = Instrument_ReadCycles() - Call->Start;
+	if (Hook != NULL)
+		Hook(Call, HookArgs);
+	Thread = Instrument_GetThread();
+	if (Thread == NULL || Call->Probe >= INSTRUMENT_PROBE_COUNT)
+		return;
+	Counters = &Thread->Probes[Call->Probe];
+	Counters->nCalls++;
+	Counters->nEntries += Call->nEntries;
+	Counters->nBytes += Call->nBytes;
+	Counters->nTerminated += Call->bTerminated != FALSE;
+	Counters->nMalformed += Call->bMalformed != FALSE;
+	Counters->Cycles += Call->Cycles;
+}
+
+VOID Instrument_Event(DWORD Event)
+{
+	PINSTRUMENT_THREAD Thread = Instrument_GetThread();
+
+	if (Thread != NULL && Event < INSTRUMENT_EVENT_COUNT)
+		Thread->Events[Event]++;
+}
@@ -0,0 +1,187 @@
+/**
+ * \file Instrument.h
+ * \brief Counters, timings and trace hooks of the enumerators and lookups
+ * \author Tomtombinary
+ * \version 1.0
+ * \date 17 octobre 2026
+ * Instrumentation is compiled in when PEUTILS_INSTRUMENT is defined: each
+ * probe (PE32_Enum*Ex, PE32_RVAToFileOffset, PE32_SearchRelocationEx,
+ * PEBUtils_EnumModules) then adds its calls, entries, bytes and cycles to
+ * counters owned by the calling thread, and calls the trace hooks. Without
+ * PEUTILS_INSTRUMENT the INSTRUMENT_* macros expand to nothing and the
+ * snapshots stay empty.
+ * Probes nest: PE32_RVAToFileOffset also counts in PE32_EnumSections, its
+ * cycles include those of the enumeration.
+ */
+
+#pragma once
+#include "stdafx.h"
+
+#define INSTRUMENT_ENUM_SECTIONS 0
+#define INSTRUMENT_ENUM_EXPORTS 1
+#define INSTRUMENT_ENUM_IMPORTS 2
+#define INSTRUMENT_ENUM_RELOCATIONS 3
+#define INSTRUMENT_RVA_TO_FILE_OFFSET 4
+#define INSTRUMENT_SEARCH_RELOCATION 5
+#define INSTRUMENT_ENUM_MODULES 6
+#define INSTRUMENT_PROBE_COUNT 7
+
+#define INSTRUMENT_EVENT_NO_EXPORT_DIRECTORY 0  /* PE32_EnumExports on an image without export directory */
+#define INSTRUMENT_EVENT_NO_IMPORT_DIRECTORY 1  /* PE32_EnumImports on an image without import directory */
+#define INSTRUMENT_EVENT_BAD_EXPORTS 2          /* export table rejected by PE32_IsTableSafe */
+#define INSTRUMENT_EVENT_BAD_IMPORTS 3          /* import table rejected by PE32_IsTableSafe */
+#define INSTRUMENT_EVENT_BAD_RELOCS 4           /* relocation table rejected by PE32_IsTableSafe */
+#define INSTRUMENT_EVENT_BAD_HEADERS 5          /* HMODULE given to a PE32_* function without valid headers */
+#define INSTRUMENT_EVENT_COUNT 6
+
+/**
+ * \struct INSTRUMENT_COUNTERS
+ * \brief accumulated counters of a probe
+ * nEntries: entries given to the callback (enumerators), results found (lookups)
+ * nBytes: bytes of the tables read (section headers, export arrays, thunks and descriptors, relocation blocks), strings excluded
+ * nTerminated: enumerations stopped by the callback
+ * nMalformed: calls which failed on a malformed table or invalid headers
+ * Cycles: time spent in the calls, see Instrument_ReadCycles
+ */
+typedef struct _INSTRUMENT_COUNTERS
+{
+	ULONGLONG nCalls;
+	ULONGLONG nEntries;
+	ULONGLONG nBytes;
+	ULONGLONG nTerminated;
+	ULONGLONG nMalformed;
+	ULONGLONG Cycles;
+}INSTRUMENT_COUNTERS,*PINSTRUMENT_COUNTERS;
+
+/**
+ * \struct INSTRUMENT_CALL
+ * \brief a call in progress, given to the trace hooks
+ * Probe: INSTRUMENT_* probe of the function
+ * Start: value of Instrument_ReadCycles when the call began
+ * Cycles, nEntries, nBytes, bTerminated, bMalformed: result of the call (end hook only)
+ */
+typedef struct _INSTRUMENT_CALL
+{
+	DWORD Probe;
+	ULONGLONG Start;
+	ULONGLONG Cycles;
+	ULONGLONG nEntries;
+	ULONGLONG nBytes;
+	BOOL bTerminated;
+	BOOL bMalformed;
+}INSTRUMENT_CALL,*PINSTRUMENT_CALL;
+
+/**
+ * \struct INSTRUMENT_SNAPSHOT
+ * \brief copy of the counters
+ * Probes: counters of each INSTRUMENT_* probe
+ * Events: number of each INSTRUMENT_EVENT_*
+ * nThreads: threads which have been instrumented
+ * CyclesPerMicrosecond: rate of Instrument_ReadCycles, measured since the first instrumented call (0 before)
+ */
+typedef struct _INSTRUMENT_SNAPSHOT
+{
+	INSTRUMENT_COUNTERS Probes[INSTRUMENT_PROBE_COUNT];
+	ULONGLONG Events[INSTRUMENT_EVENT_COUNT];
+	DWORD nThreads;
+	double CyclesPerMicrosecond;
+}INSTRUMENT_SNAPSHOT,*PINSTRUMENT_SNAPSHOT;
+
+/**
+ * Trace hook, called by the thread of the probe at the beginning and at the end of each call
+ */
+typedef VOID(*InstrumentHook)(PINSTRUMENT_CALL Call, LPVOID UserArgs);
+
+#ifdef PEUTILS_INSTRUMENT
+#define INSTRUMENT_DECLARE(Call) INSTRUMENT_CALL Call
+#define INSTRUMENT_BEGIN(Call, Probe) Instrument_Begin(&(Call), (Probe))
+#define INSTRUMENT_END(Call, Entries, Bytes, bStopped) ((Call).nEntries = (Entries), (Call).nBytes = (Bytes), (Call).bTerminated = (bStopped), Instrument_End(&(Call)))
+#define INSTRUMENT_MALFORMED(Call, Event) ((Call).bMalformed = TRUE, Instrument_Event(Event))
+#define INSTRUMENT_EVENT(Event) Instrument_Event(Event)
+#else
+#define INSTRUMENT_DECLARE(Call)
+#define INSTRUMENT_BEGIN(Call, Probe) ((void)0)
+/* operands aren't evaluated, counters computed for the probe stay "used" */
+#define INSTRUMENT_END(Call, Entries, Bytes, bStopped) ((void)sizeof((Entries) + (Bytes)))
+#define INSTRUMENT_MALFORMED(Call, Event) ((void)0)
+#define INSTRUMENT_EVENT(Event) ((void)0)
+#endif
+
+/**
+ * \fn BOOL Instrument_IsEnabled(VOID);
+ * \return TRUE if the library has been compiled with PEUTILS_INSTRUMENT
+ */
+BOOL Instrument_IsEnabled(VOID);
+
+/**
+ * \fn ULONGLONG Instrument_ReadCycles(VOID);
+ * \brief clock of the timings: time stamp counter on x86, nanoseconds elsewhere
+ */
+ULONGLONG Instrument_ReadCycles(VOID);
+
+/**
+ * \fn VOID Instrument_SetHooks(InstrumentHook Begin, InstrumentHook End, LPVOID UserArgs);
+ * \brief set the trace hooks, to be called while no probe runs
+ * Hooks run inside the probes: their time isn't counted in Cycles but slows the caller.
+ * \param Begin: [optional] hook called before the work of the probe
+ * \param End: [optional] hook called with the result of the probe, before its counters are updated
+ * \param UserArgs: [optional] argument of the hooks
+ */
+VOID Instrument_SetHooks(InstrumentHook Begin, InstrumentHook End, LPVOID UserArgs);
+
+/**
+ * \fn VOID Instrument_GetSnapshot(PINSTRUMENT_SNAPSHOT Snapshot);
+ * \brief sum of the counters of all threads, threads which have exited included
+ * Counters of running threads are read without synchronization: the sum is approximate while probes run.
+ * \param Snapshot: [out] counters
+ */
+VOID Instrument_GetSnapshot(PINSTRUMENT_SNAPSHOT Snapshot);
+
+/**
+ * \fn VOID Instrument_GetThreadSnapshot(PINSTRUMENT_SNAPSHOT Snapshot);
+ * \brief counters of the calling thread
+ * \param Snapshot: [out] counters, nThreads is 1 if the thread has been instrumented
+ */
+VOID Instrument_GetThreadSnapshot(PINSTRUMENT_SNAPSHOT Snapshot);
+
+/**
+ * \fn VOID Instrument_Reset(VOID);
+ * \brief set the counters of all threads to 0, to be called while no probe runs
+ */
+VOID Instrument_Reset(VOID);
+
+/**
+ * \fn LPCSTR Instrument_GetProbeName(DWORD Probe);
+ * \return name of an INSTRUMENT_* probe, "unknown" for another value
+ */
+LPCSTR Instrument_GetProbeName(DWORD Probe);
+
+/**
+ * \fn LPCSTR Instrument_GetEventName(DWORD Event);
+ * \return name of an INSTRUMENT_EVENT_* event, "unknown" for another value
+ */
+LPCSTR Instrument_GetEventName(DWORD Event);
+
+/**
+ * \fn VOID Instrument_PrintSnapshot(FILE* Output, PINSTRUMENT_SNAPSHOT Snapshot);
+ * \brief print the probes which have been called and the events which happened, one per line
+ */
+VOID Instrument_PrintSnapshot(FILE* Output, PINSTRUMENT_SNAPSHOT Snapshot);
+
+/**
+ * \fn VOID Instrument_Begin(PINSTRUMENT_CALL Call, DWORD Probe);
+ * \brief start a call of a probe (INSTRUMENT_BEGIN)
+ */
+VOID Instrument_Begin(PINSTRUMENT_CALL Call, DWORD Probe);
+
+/**
+ * \fn VOID Instrument_End(PINSTRUMENT_CALL Call);
+ * \brief end a call of a probe and add it to the counters of the thread (INSTRUMENT_END)
+ */
+VOID Instrument_End(PINSTRUMENT_CALL Call);
+
+/**
+ * \fn VOID Instrument_Event(DWORD Event);
+ * \brief count an INSTRUMENT_EVENT_* event in the counters of the thread (INSTRUMENT_EVENT)
+ */
+VOID Instrument_Event(DWORD Event);
@@ -8,18 +8,379 @@
 
 #include "stdafx.h"
 #include "MemUtils.h"
+#include "CpuUtils.h"
+#include "Instrument.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+typedef BOOL(*MemIsNullRoutine)(PBYTE Buffer, DWORD SizeInBytes);
+typedef DWORD(*MemFindNullRoutine)(LPVOID Array, DWORD nMax);
+typedef ULONGLONG(*MemSumWordsRoutine)(PBYTE Buffer, SIZE_T SizeInBytes);
+
+/* 32 bits lanes receive at most 2 * 0xFFFF per vector, widened to 64 bits before they can overflow */
+#define MEM_SUM_FLUSH 0x4000
+
+/* kernels chosen by MemUtils_InitKernels for the running processor */
+static volatile MemIsNullRoutine MemIsNull_Kernel = NULL;
+static volatile MemFindNullRoutine MemFindNullDword_Kernel = NULL;
+static volatile MemFindNullRoutine MemFindNullQword_Kernel = NULL;
+static volatile MemSumWordsRoutine MemSumWords_Kernel = NULL;
+
+/* index of the lowest bit set in a non null mask */
+static DWORD MemUtils_LowestBit(DWORD Mask)
+{
+#ifdef _MSC_VER
+	unsigned long Index;
+	_BitScanForward(&Index, Mask);
+	return Index;
+#else
+	return (DWORD)__builtin_ctz(Mask);
+#endif
+}
+
+static BOOL MemIsNull_Scalar(PBYTE Buffer, DWORD SizeInBytes)
+{
+	ULONGLONG Word;
+
+	for (; SizeInBytes >= sizeof(ULONGLONG); SizeInBytes -= sizeof(ULONGLONG), Buffer += sizeof(ULONGLONG))
+	{
+		memcpy(&Word, Buffer, sizeof(ULONGLONG));
+		if (Word != 0)
+			return FALSE;
+	}
+	for (; SizeInBytes > 0; SizeInBytes--, Buffer++)
+	{
+		if (*Buffer != 0)
+			return FALSE;
+	}
+	return TRUE;
+}
+
+static DWORD MemFindNullDword_Scalar(LPVOID Array, DWORD nMax)
+{
+	DWORD Value;
+	DWORD i;
+
+	for (i = 0; i < nMax; i++)
+	{
+		memcpy(&Value, (PBYTE)Array + i * sizeof(DWORD), sizeof(DWORD));
+		if (Value == 0)
+			break;
+	}
+	return i;
+}
+
+static DWORD MemFindNullQword_Scalar(LPVOID Array, DWORD nMax)
+{
+	ULONGLONG Value;
+	DWORD i;
+
+	for (i = 0; i < nMax; i++)
+	{
+		memcpy(&Value, (PBYTE)Array + (SIZE_T)i * sizeof(ULONGLONG), sizeof(ULONGLONG));
+		if (Value == 0)
+			break;
+	}
+	return i;
+}
+
+static ULONGLONG MemSumWords_Scalar(PBYTE Buffer, SIZE_T SizeInBytes)
+{
+	ULONGLONG Sum = 0;
+	ULONGLONG Word;
+
+	for (; SizeInBytes >= sizeof(ULONGLONG); SizeInBytes -= sizeof(ULONGLONG), Buffer += sizeof(ULONGLONG))
+	{
+		memcpy(&Word, Buffer, sizeof(ULONGLONG));
+		Sum += (Word & 0xFFFF) + ((Word >> 16) & 0xFFFF) + ((Word >> 32) & 0xFFFF) + (Word >> 48);
+	}
+	for (; SizeInBytes >= sizeof(WORD); SizeInBytes -= sizeof(WORD), Buffer += sizeof(WORD))
+		Sum += (WORD)(Buffer[0] | (Buffer[1] << 8));
+	/* an odd last byte is the low byte of a word */
+	if (SizeInBytes != 0)
+		Sum += Buffer[0];
+	return Sum;
+}
+
+#ifdef CPU_X86
+CPU_TARGET("sse2") static BOOL MemIsNull_SSE2(PBYTE Buffer, DWORD SizeInBytes)
+{
+	__m128i Zero = _mm_setzero_si128();
+	DWORD i;
+
+	if (SizeInBytes < 16)
+		return MemIsNull_Scalar(Buffer, SizeInBytes);
+	for (i = 0; i + 16 <= SizeInBytes; i += 16)
+	{
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(Buffer + i)), Zero)) != 0xFFFF)
+			return FALSE;
+	}
+	/* the last block overlaps the previous one */
+	if (i < SizeInBytes)
+		return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(Buffer + SizeInBytes - 16)), Zero)) == 0xFFFF;
+	return TRUE;
+}
+
+CPU_TARGET("avx2") static BOOL MemIsNull_AVX2(PBYTE Buffer, DWORD SizeInBytes)
+{
+	__m256i Zero = _mm256_setzero_si256();
+	DWORD i;
+
+	if (SizeInBytes < 32)
+		return MemIsNull_SSE2(Buffer, SizeInBytes);
+	for (i = 0; i + 32 <= SizeInBytes; i += 32)
+	{
+		if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(Buffer + i)), Zero)) != -1)
+			return FALSE;
+	}
+	if (i < SizeInBytes)
+		return _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(Buffer + SizeInBytes - 32)), Zero)) == -1;
+	return TRUE;
+}
+
+CPU_TARGET("sse2") static DWORD MemFindNullDword_SSE2(LPVOID Array, DWORD nMax)
+{
+	__m128i Zero = _mm_setzero_si128();
+	PBYTE Items = (PBYTE)Array;
+	DWORD Mask, i;
+
+	for (i = 0; i + 4 <= nMax; i += 4)
+	{
+		Mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(Items + i * sizeof(DWORD))), Zero)));
+		if (Mask != 0)
+			return i + MemUtils_LowestBit(Mask);
+	}
+	return i + MemFindNullDword_Scalar(Items + i * sizeof(DWORD), nMax - i);
+}
+
+CPU_TARGET("avx2") static DWORD MemFindNullDword_AVX2(LPVOID Array, DWORD nMax)
+{
+	__m256i Zero = _mm256_setzero_si256();
+	PBYTE Items = (PBYTE)Array;
+	DWORD Mask, i;
+
+	for (i = 0; i + 8 <= nMax; i += 8)
+	{
+		Mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*)(Items + i * sizeof(DWORD))), Zero)));
+		if (Mask != 0)
+			return i + MemUtils_LowestBit(Mask);
+	}
+	return i + MemFindNullDword_Scalar(Items + i * sizeof(DWORD), nMax - i);
+}
+
+CPU_TARGET("sse2") static DWORD MemFindNullQword_SSE2(LPVOID Array, DWORD nMax)
+{
+	__m128i Zero = _mm_setzero_si128();
+	__m128i Equal;
+	PBYTE Items = (PBYTE)Array;
+	DWORD Mask, i;
+
+	for (i = 0; i + 2 <= nMax; i += 2)
+	{
+		/* no 64 bits comparison in SSE2: both halves must be null */
+		Equal = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(Items + (SIZE_T)i * sizeof(ULONGLONG))), Zero);
+		Equal = _mm_and_si128(Equal, _mm_shuffle_epi32(Equal, _MM_SHUFFLE(2, 3, 0, 1)));
+		Mask = _mm_movemask_pd(_mm_castsi128_pd(Equal));
+		if (Mask != 0)
+			return i + MemUtils_LowestBit(Mask);
+	}
+	return i + MemFindNullQword_Scalar(Items + (SIZE_T)i * sizeof(ULONGLONG), nMax - i);
+}
+
+CPU_TARGET("avx2") static DWORD MemFindNullQword_AVX2(LPVOID Array, DWORD nMax)
+{
+	__m256i Zero = _mm256_setzero_si256();
+	PBYTE Items = (PBYTE)Array;
+	DWORD Mask, i;
+
+	for (i = 0; i + 4 <= nMax; i += 4)
+	{
+		Mask = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(_mm256_loadu_si256((const __m256i*)(Items + (SIZE_T)i * sizeof(ULONGLONG))), Zero)));
+		if (Mask != 0)
+			return i + MemUtils_LowestBit(Mask);
+	}
+	return i + MemFindNullQword_Scalar(Items + (SIZE_T)i * sizeof(ULONGLONG), nMax - i);
+}
+
+CPU_TARGET("sse2") static ULONGLONG MemSumWords_SSE2(PBYTE Buffer, SIZE_T SizeInBytes)
+{
+	__m128i LowMask = _mm_set1_epi32(0xFFFF);
+	__m128i Zero = _mm_setzero_si128();
+	__m128i Sum64 = Zero;
+	__m128i Sum32, Words;
+	ULONGLONG Lanes[2];
+	SIZE_T i = 0, End;
+
+	while (i + 16 <= SizeInBytes)
+	{
+		Sum32 = Zero;
+		End = i + (SIZE_T)MEM_SUM_FLUSH * 16;
+		if (End > SizeInBytes)
+			End = SizeInBytes;
+		for (; i + 16 <= End; i += 16)
+		{
+			Words = _mm_loadu_si128((const __m128i*)(Buffer + i));
+			Sum32 = _mm_add_epi32(Sum32, _mm_add_epi32(_mm_and_si128(Words, LowMask), _mm_srli_epi32(Words, 16)));
+		}
+		Sum64 = _mm_add_epi64(Sum64, _mm_add_epi64(_mm_unpacklo_epi32(Sum32, Zero), _mm_unpackhi_epi32(Sum32, Zero)));
+	}
+	_mm_storeu_si128((__m128i*)Lanes, Sum64);
+	return Lanes[0] + Lanes[1] + MemSumWords_Scalar(Buffer + i, SizeInBytes - i);
+}
+
+CPU_TARGET("avx2") static ULONGLONG MemSumWords_AVX2(PBYTE Buffer, SIZE_T SizeInBytes)
+{
+	__m256i LowMask = _mm256_set1_epi32(0xFFFF);
+	__m256i Zero = _mm256_setzero_si256();
+	__m256i Sum64 = Zero;
+	__m256i Sum32, Sum32Next, Words, WordsNext;
+	ULONGLONG Lanes[4];
+	SIZE_T i = 0, End;
+
+	while (i + 64 <= SizeInBytes)
+	{
+		/* two accumulators to hide the latency of the additions */
+		Sum32 = Zero;
+		Sum32Next = Zero;
+		End = i + (SIZE_T)MEM_SUM_FLUSH * 64;
+		if (End > SizeInBytes)
+			End = SizeInBytes;
+		for (; i + 64 <= End; i += 64)
+		{
+			Words = _mm256_loadu_si256((const __m256i*)(Buffer + i));
+			WordsNext = _mm256_loadu_si256((const __m256i*)(Buffer + i + 32));
+			Sum32 = _mm256_add_epi32(Sum32, _mm256_add_epi32(_mm256_and_si256(Words, LowMask), _mm256_srli_epi32(Words, 16)));
+			Sum32Next = _mm256_add_epi32(Sum32Next, _mm256_add_epi32(_mm256_and_si256(WordsNext, LowMask), _mm256_srli_epi32(WordsNext, 16)));
+		}
+		Sum64 = _mm256_add_epi64(Sum64, _mm256_add_epi64(_mm256_unpacklo_epi32(Sum32, Zero), _mm256_unpackhi_epi32(Sum32, Zero)));
+		Sum64 = _mm256_add_epi64(Sum64, _mm256_add_epi64(_mm256_unpacklo_epi32(Sum32Next, Zero), _mm256_unpackhi_epi32(Sum32Next, Zero)));
+	}
+	_mm256_storeu_si256((__m256i*)Lanes, Sum64);
+	return Lanes[0] + Lanes[1] + Lanes[2] + Lanes[3] + MemSumWords_SSE2(Buffer + i, SizeInBytes - i);
+}
+#endif
+
+static VOID MemUtils_InitKernels(VOID)
+{
+	MemIsNullRoutine IsNull = MemIsNull_Scalar;
+	MemFindNullRoutine FindNullDword = MemFindNullDword_Scalar;
+	MemFindNullRoutine FindNullQword = MemFindNullQword_Scalar;
+	MemSumWordsRoutine SumWords = MemSumWords_Scalar;
+#ifdef CPU_X86
+	DWORD Features = CpuUtils_GetFeatures();
+
+	if (Features & CPU_FEATURE_AVX2)
+	{
+		IsNull = MemIsNull_AVX2;
+		FindNullDword = MemFindNullDword_AVX2;
+		FindNullQword = MemFindNullQword_AVX2;
+		SumWords = MemSumWords_AVX2;
+	}
+	else if (Features & CPU_FEATURE_SSE2)
+	{
+		IsNull = MemIsNull_SSE2;
+		FindNullDword = MemFindNullDword_SSE2;
+		FindNullQword = MemFindNullQword_SSE2;
+		SumWords = MemSumWords_SSE2;
+	}
+#endif
+	MemFindNullDword_Kernel = FindNullDword;
+	MemFindNullQword_Kernel = FindNullQword;
+	MemSumWords_Kernel = SumWords;
+	MemIsNull_Kernel = IsNull;
+}
 
 BOOL MemIsNull(LPVOID Buffer, DWORD SizeInBytes) 
 {
-	PBYTE BytesBuff = (PBYTE)Buffer;
-	while (*BytesBuff == '\0' && SizeInBytes > 0)
+	/* block headers and descriptors are too small for vectors */
+	if (SizeInBytes < 32)
+		return MemIsNull_Scalar((PBYTE)Buffer, SizeInBytes);
+	if (MemIsNull_Kernel == NULL)
+		MemUtils_InitKernels();
+	return MemIsNull_Kernel((PBYTE)Buffer, SizeInBytes);
+}
+
+DWORD MemFindNullDword(LPVOID Array, DWORD nMax)
+{
+	if (MemFindNullDword_Kernel == NULL)
+		MemUtils_InitKernels();
+	return MemFindNullDword_Kernel(Array, nMax);
+}
+
+DWORD MemFindNullQword(LPVOID Array, DWORD nMax)
+{
+	if (MemFindNullQword_Kernel == NULL)
+		MemUtils_InitKernels();
+	return MemFindNullQword_Kernel(Array, nMax);
+}
+
+ULONGLONG MemSumWords(LPVOID Buffer, SIZE_T SizeInBytes)
+{
+	if (MemSumWords_Kernel == NULL)
+		MemUtils_InitKernels();
+	return MemSumWords_Kernel((PBYTE)Buffer, SizeInBytes);
+}
+
+#define MEM_ARENA_BLOCK_SIZE 0x10000
+#define MEM_ARENA_ALIGN(x) (((x) + 15) & ~(SIZE_T)15)
+
+typedef struct _MEM_ARENA_BLOCK
+{
+	struct _MEM_ARENA_BLOCK* Next;
+	SIZE_T Size;
+	SIZE_T Used;
+	SIZE_T Reserved;
+}MEM_ARENA_BLOCK,*PMEM_ARENA_BLOCK;
+
+LPVOID MemArenaAlloc(PMEM_ARENA Arena, SIZE_T SizeInBytes)
+{
+	PMEM_ARENA_BLOCK Block = Arena->Blocks;
+	SIZE_T BlockSize;
+	LPVOID Memory;
+
+	SizeInBytes = SizeInBytes != 0 ? MEM_ARENA_ALIGN(SizeInBytes) : 16;
+	if (Block == NULL || Block->Size - Block->Used < SizeInBytes)
+	{
+		/* big allocations get their own block */
+		BlockSize = SizeInBytes > MEM_ARENA_BLOCK_SIZE / 4 ? SizeInBytes : MEM_ARENA_BLOCK_SIZE;
+		Block = (PMEM_ARENA_BLOCK)calloc(1, sizeof(MEM_ARENA_BLOCK) + BlockSize);
+		if (Block == NULL)
+			return NULL;
+		Block->Size = BlockSize;
+		if (Arena->Blocks != NULL && BlockSize != MEM_ARENA_BLOCK_SIZE)
+		{
+			/* keep filling the current block */
+			Block->Next = Arena->Blocks->Next;
+			Arena->Blocks->Next = Block;
+		}
+		else
+		{
+			Block->Next = Arena->Blocks;
+			Arena->Blocks = Block;
+		}
+	}
+	Memory = (PBYTE)(Block + 1) + Block->Used;
+	Block->Used += SizeInBytes;
+	return Memory;
+}
+
+VOID MemArenaRelease(PMEM_ARENA Arena)
+{
+	PMEM_ARENA_BLOCK Block = Arena->Blocks;
+	PMEM_ARENA_BLOCK Next;
+
+	while (Block != NULL)
 	{
-		BytesBuff++;
-		SizeInBytes--;
+		Next = Block->Next;
+		free(Block);
+		Block = Next;
 	}
-	return SizeInBytes == 0;
+	Arena->Blocks = NULL;
 }
 
+#ifdef _WIN32
 BOOL PEBUtils_EnumModules(EnumModulesCallback Callback,PVOID UserArgs)
 {
 	PPEB Peb;
@@ -27,7 +388,10 @@ BOOL PEBUtils_EnumModules(EnumModulesCallback Callback,PVOID UserArgs)
 	PROCESS_BASIC_INFORMATION ProcBasicInfo;
 	ULONG ReturnLength;
 	BOOL bEnumTerminated = TRUE;
+	ULONGLONG nModules = 0;
+	INSTRUMENT_DECLARE(Call);
 
+	INSTRUMENT_BEGIN(Call, INSTRUMENT_ENUM_MODULES);
 	Status = NtQueryInformationProcess(GetCurrentProcess(), ProcessBasicInformation, &ProcBasicInfo, sizeof(PROCESS_BASIC_INFORMATION), &ReturnLength);
 	if(NT_SUCCESS(Status))
 	{ 
@@ -37,6 +401,7 @@ BOOL PEBUtils_EnumModules(EnumModulesCallback Callback,PVOID UserArgs)
 		do
 		{
 			PLDR_DATA_TABLE_ENTRY pDllEntry = (PLDR_DATA_TABLE_ENTRY)((DWORD)CurrentEntry - (DWORD)offsetof(LDR_DATA_TABLE_ENTRY,InMemoryOrderLinks));
+			nModules++;
 			if (!Callback(pDllEntry,UserArgs))
 			{
 				bEnumTerminated = FALSE;
@@ -45,5 +410,7 @@ BOOL PEBUtils_EnumModules(EnumModulesCallback Callback,PVOID UserArgs)
 			CurrentEntry = CurrentEntry->Flink;
 		} while (CurrentEntry != FirstEntry);
 	}
+	INSTRUMENT_END(Call, nModules, nModules * sizeof(LDR_DATA_TABLE_ENTRY), !bEnumTerminated);
 	return bEnumTerminated;
-}
\ No newline at end of file
+}
+#endif
\ No newline at end of file
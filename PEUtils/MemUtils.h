@@ -8,8 +8,9 @@
 
 #pragma once
 #include "stdafx.h"
-#include <winternl.h>
 
+#ifdef _WIN32
+#include <winternl.h>
 
 /**
  * callback prototype for PEBUtils_EnumModules
@@ -24,12 +25,66 @@ typedef BOOL(*EnumModulesCallback)(PLDR_DATA_TABLE_ENTRY pLdrDataEntry,LPVOID Us
  * \return TRUE if all modules have been enumerated
  */
 BOOL PEBUtils_EnumModules(EnumModulesCallback Callback, PVOID UserArgs);
+#endif
 
 /**
  * \fn BOOL MemIsNull(LPVOID Buffer, DWORD SizeInBytes);
- * \brief Check if a memory zone is null
+ * \brief Check if a memory zone is null (SSE2 or AVX2 for zones of 32 bytes and more)
  * \param Buffer: pointer to a buffer
  * \param SizeInBytes: buffer size in bytes
  * \return TRUE if memory is filled with zeros
  */
 BOOL MemIsNull(LPVOID Buffer, DWORD SizeInBytes);
+
+/**
+ * \fn DWORD MemFindNullDword(LPVOID Array, DWORD nMax);
+ * \brief find the first null DWORD of an array (terminator of a thunk array), with SSE2 or AVX2 when available
+ * \param Array: pointer to the array, no alignment required
+ * \param nMax: number of DWORDs which can be read
+ * \return index of the first null DWORD, nMax if there is none
+ */
+DWORD MemFindNullDword(LPVOID Array, DWORD nMax);
+
+/**
+ * \fn DWORD MemFindNullQword(LPVOID Array, DWORD nMax);
+ * \brief find the first null QWORD of an array (terminator of a 64 bits thunk array), with SSE2 or AVX2 when available
+ * \param Array: pointer to the array, no alignment required
+ * \param nMax: number of QWORDs which can be read
+ * \return index of the first null QWORD, nMax if there is none
+ */
+DWORD MemFindNullQword(LPVOID Array, DWORD nMax);
+
+/**
+ * \fn ULONGLONG MemSumWords(LPVOID Buffer, SIZE_T SizeInBytes);
+ * \brief sum of the little endian 16 bits words of a buffer, without carry folding (SSE2 or AVX2 when available)
+ * \param Buffer: pointer to the buffer, no alignment required
+ * \param SizeInBytes: buffer size in bytes, an odd last byte is the low byte of a word
+ * \return exact sum of the words
+ */
+ULONGLONG MemSumWords(LPVOID Buffer, SIZE_T SizeInBytes);
+
+/**
+ * \struct MEM_ARENA
+ * \brief bump allocator: many small allocations released in a single call
+ * A zeroed MEM_ARENA is a valid empty arena.
+ */
+typedef struct _MEM_ARENA
+{
+	struct _MEM_ARENA_BLOCK* Blocks;
+}MEM_ARENA,*PMEM_ARENA;
+
+/**
+ * \fn LPVOID MemArenaAlloc(PMEM_ARENA Arena, SIZE_T SizeInBytes);
+ * \brief allocate zeroed memory from an arena, aligned on 16 bytes
+ * \param Arena: arena
+ * \param SizeInBytes: size of the allocation
+ * \return pointer to the memory, NULL if memory couldn't be allocated
+ */
+LPVOID MemArenaAlloc(PMEM_ARENA Arena, SIZE_T SizeInBytes);
+
+/**
+ * \fn VOID MemArenaRelease(PMEM_ARENA Arena);
+ * \brief release all allocations of an arena, the arena can be reused
+ * \param Arena: arena
+ */
+VOID MemArenaRelease(PMEM_ARENA Arena);
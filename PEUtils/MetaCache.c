@@ -0,0 +1,606 @@
+/**
+ * \file MetaCache.c
+ * \brief Defines function described in file MetaCache.h
+ * \author Tomtombinary
+ * \version 1.0
+ * \date 17 octobre 2026
+ */
+
+#include "stdafx.h"
+#include "MetaCache.h"
+#include "BulkEnum.h"
+#include "PETraits.h"
+#include "Validate.h"
+
+#define META_CHUNK 256
+#define META_ALIGN(x) (((x) + 7) & ~(ULONGLONG)7)
+
+/* reference file of a path: stamp of the file when its digest was computed */
+typedef struct _META_CACHE_REF
+{
+	DWORD Magic;
+	DWORD Version;
+	ULONGLONG FileSize;
+	ULONGLONG Modified;
+	BYTE Digest[SHA256_DIGEST_SIZE];
+}META_CACHE_REF,*PMETA_CACHE_REF;
+
+/* tables collected before the entry is laid out */
+typedef struct _META_BUILDER
+{
+	PCHAR Strings;
+	DWORD StringsSize;
+	DWORD StringsCapacity;
+	PMETA_IMPORT Imports;
+	DWORD nImports;
+	PMETA_EXPORT Exports;
+	LPCSTR* ExportNames;
+	DWORD nExports;
+	DWORD ExportsCapacity;
+	PMETA_RELOC_PAGE RelocPages;
+	DWORD nRelocPages;
+	DWORD RelocPagesCapacity;
+	DWORD nRelocations;
+	DWORD RelocTypes[16];
+	BOOL bFailed;
+}META_BUILDER,*PMETA_BUILDER;
+
+static BOOL MetaCache_Grow(LPVOID* lpArray, PDWORD lpCapacity, DWORD nNeeded, SIZE_T ElementSize)
+{
+	DWORD Capacity = *lpCapacity != 0 ? *lpCapacity : 64;
+	LPVOID Array;
+
+	if (nNeeded <= *lpCapacity)
+		return TRUE;
+	while (Capacity < nNeeded)
+	{
+		if (Capacity > 0x7FFFFFFF)
+			return FALSE;
+		Capacity *= 2;
+	}
+	Array = realloc(*lpArray, (SIZE_T)Capacity * ElementSize);
+	if (Array == NULL)
+		return FALSE;
+	*lpArray = Array;
+	*lpCapacity = Capacity;
+	return TRUE;
+}
+
+/* copy a string in the pool, offset 0 is the empty string and stands for NULL */
+static DWORD MetaCache_AddString(PMETA_BUILDER Builder, LPCSTR String)
+{
+	SIZE_T Length;
+	DWORD Offset;
+
+	if (String == NULL || Builder->bFailed)
+		return 0;
+	Length = strlen(String) + 1;
+	if (Length > 0x7FFFFFFF - Builder->StringsSize || !MetaCache_Grow((LPVOID*)&Builder->Strings, &Builder->StringsCapacity, Builder->StringsSize + (DWORD)Length, 1))
+	{
+		Builder->bFailed = TRUE;
+		return 0;
+	}
+	Offset = Builder->StringsSize;
+	memcpy(Builder->Strings + Offset, String, Length);
+	Builder->StringsSize += (DWORD)Length;
+	return Offset;
+}
+
+static BOOL MetaCache_CallbackExport(PEXPORT_ENTRY lpExportEntry, LPVOID UserArgs)
+{
+	PMETA_BUILDER Builder = (PMETA_BUILDER)UserArgs;
+	DWORD Capacity = Builder->ExportsCapacity;
+	PMETA_EXPORT Export;
+
+	if (!MetaCache_Grow((LPVOID*)&Builder->Exports, &Capacity, Builder->nExports + 1, sizeof(META_EXPORT))
+		|| !MetaCache_Grow((LPVOID*)&Builder->ExportNames, &Builder->ExportsCapacity, Builder->nExports + 1, sizeof(LPCSTR)))
+	{
+		Builder->bFailed = TRUE;
+		return FALSE;
+	}
+	Export = &Builder->Exports[Builder->nExports];
+	Export->RVA = lpExportEntry->RVAFunction;
+	Export->Name = MetaCache_AddString(Builder, lpExportEntry->Name);
+	Export->Forwarder = MetaCache_AddString(Builder, lpExportEntry->Forwarder);
+	Export->Ordinal = lpExportEntry->Ordinal;
+	Export->Reserved = 0;
+	Builder->ExportNames[Builder->nExports] = lpExportEntry->Name != NULL ? lpExportEntry->Name : "";
+	Builder->nExports++;
+	return !Builder->bFailed;
+}
+
+static VOID MetaCache_CollectImports(PPE_IMAGE Image, PMETA_BUILDER Builder)
+{
+	IMPORT_CURSOR Cursor;
+	IMPORT_ARRAYS Arrays;
+	LPCSTR DllNames[META_CHUNK];
+	LPCSTR Names[META_CHUNK];
+	WORD Hints[META_CHUNK];
+	ULONGLONG Thunks[META_CHUNK];
+	LPCSTR LastDllName = NULL;
+	DWORD LastDllOffset = 0;
+	DWORD Capacity = 0;
+	DWORD nCount;
+
+	Arrays.DllNames = DllNames;
+	Arrays.Names = Names;
+	Arrays.Hints = Hints;
+	Arrays.Thunks = Thunks;
+	PE32_InitImportCursor(Image, &Cursor);
+	while (!Builder->bFailed && (nCount = PE32_GetImports(Image, &Cursor, &Arrays, META_CHUNK)) != 0)
+	{
+		if (!MetaCache_Grow((LPVOID*)&Builder->Imports, &Capacity, Builder->nImports + nCount, sizeof(META_IMPORT)))
+		{
+			Builder->bFailed = TRUE;
+			break;
+		}
+		for (DWORD i = 0; i < nCount; i++)
+		{
+			PMETA_IMPORT Import = &Builder->Imports[Builder->nImports + i];
+			/* imports of a module are consecutive: its name is stored once */
+			if (DllNames[i] != LastDllName)
+			{
+				LastDllName = DllNames[i];
+				LastDllOffset = MetaCache_AddString(Builder, LastDllName);
+			}
+			Import->DllName = LastDllOffset;
+			Import->Name = MetaCache_AddString(Builder, Names[i]);
+			Import->Thunk = Thunks[i];
+			Import->Hint = Hints[i];
+			memset(Import->Reserved, 0, sizeof(Import->Reserved));
+		}
+		Builder->nImports += nCount;
+	}
+}
+
+static VOID MetaCache_CollectRelocations(PPE_IMAGE Image, PMETA_BUILDER Builder)
+{
+	RELOC_CURSOR Cursor;
+	DWORD RVAs[META_CHUNK];
+	BYTE Types[META_CHUNK];
+	DWORD nCount;
+	DWORD PageRVA;
+
+	PE32_InitRelocCursor(Image, &Cursor);
+	while (!Builder->bFailed && (nCount = PE32_GetRelocations(Image, &Cursor, RVAs, Types, META_CHUNK)) != 0)
+	{
+		for (DWORD i = 0; i < nCount; i++)
+		{
+			Builder->RelocTypes[Types[i] & 15]++;
+			if (Types[i] == IMAGE_REL_BASED_ABSOLUTE)
+				continue;
+			Builder->nRelocations++;
+			PageRVA = RVAs[i] & ~0xFFFu;
+			if (Builder->nRelocPages == 0 || Builder->RelocPages[Builder->nRelocPages - 1].PageRVA != PageRVA)
+			{
+				if (!MetaCache_Grow((LPVOID*)&Builder->RelocPages, &Builder->RelocPagesCapacity, Builder->nRelocPages + 1, sizeof(META_RELOC_PAGE)))
+				{
+					Builder->bFailed = TRUE;
+					return;
+				}
+				Builder->RelocPages[Builder->nRelocPages].PageRVA = PageRVA;
+				Builder->RelocPages[Builder->nRelocPages].Count = 0;
+				Builder->nRelocPages++;
+			}
+			Builder->RelocPages[Builder->nRelocPages - 1].Count++;
+		}
+	}
+}
+
+static int MetaCache_ComparePages(const void* a, const void* b)
+{
+	DWORD PageA = ((PMETA_RELOC_PAGE)a)->PageRVA;
+	DWORD PageB = ((PMETA_RELOC_PAGE)b)->PageRVA;
+	return PageA < PageB ? -1 : PageA > PageB;
+}
+
+/* blocks of a page aren't always consecutive: sort then merge the pages */
+static VOID MetaCache_MergePages(PMETA_BUILDER Builder)
+{
+	DWORD nPages = 0;
+
+	if (Builder->nRelocPages == 0)
+		return;
+	qsort(Builder->RelocPages, Builder->nRelocPages, sizeof(META_RELOC_PAGE), MetaCache_ComparePages);
+	for (DWORD i = 1; i < Builder->nRelocPages; i++)
+	{
+		if (Builder->RelocPages[i].PageRVA == Builder->RelocPages[nPages].PageRVA)
+			Builder->RelocPages[nPages].Count += Builder->RelocPages[i].Count;
+		else
+			Builder->RelocPages[++nPages] = Builder->RelocPages[i];
+	}
+	Builder->nRelocPages = nPages + 1;
+}
+
+/* export names sorted with their index, qsort has no context argument */
+typedef struct _META_SORTED_NAME
+{
+	LPCSTR Name;
+	DWORD Index;
+}META_SORTED_NAME,*PMETA_SORTED_NAME;
+
+static int MetaCache_CompareExportNames(const void* a, const void* b)
+{
+	return strcmp(((PMETA_SORTED_NAME)a)->Name, ((PMETA_SORTED_NAME)b)->Name);
+}
+
+static PDWORD MetaCache_SortExports(PMETA_BUILDER Builder)
+{
+	PMETA_SORTED_NAME Sorted = (PMETA_SORTED_NAME)malloc(Builder->nExports * sizeof(META_SORTED_NAME));
+	PDWORD ExportsByName = (PDWORD)malloc(Builder->nExports * sizeof(DWORD));
+
+	if (Sorted == NULL || ExportsByName == NULL)
+	{
+		free(Sorted);
+		free(ExportsByName);
+		return NULL;
+	}
+	for (DWORD i = 0; i < Builder->nExports; i++)
+	{
+		Sorted[i].Name = Builder->ExportNames[i];
+		Sorted[i].Index = i;
+	}
+	qsort(Sorted, Builder->nExports, sizeof(META_SORTED_NAME), MetaCache_CompareExportNames);
+	for (DWORD i = 0; i < Builder->nExports; i++)
+		ExportsByName[i] = Sorted[i].Index;
+	free(Sorted);
+	return ExportsByName;
+}
+
+static VOID MetaCache_ReleaseBuilder(PMETA_BUILDER Builder)
+{
+	free(Builder->Strings);
+	free(Builder->Imports);
+	free(Builder->Exports);
+	free(Builder->ExportNames);
+	free(Builder->RelocPages);
+}
+
+/* place a table after the previous ones, 8-byte aligned */
+static BOOL MetaCache_PlaceTable(PMETA_TABLE Table, PULONGLONG lpOffset, DWORD Count, SIZE_T ElementSize)
+{
+	*lpOffset = META_ALIGN(*lpOffset);
+	Table->Offset = (DWORD)*lpOffset;
+	Table->Count = Count;
+	*lpOffset += (ULONGLONG)Count * ElementSize;
+	return *lpOffset <= 0xFFFFFFFF;
+}
+
+BOOL MetaCache_Build(PPE_IMAGE Image, const BYTE* Digest, ULONGLONG FileSize, PBYTE* lpBuffer, PDWORD lpSize)
+{
+	META_BUILDER Builder;
+	META_CACHE_HEADER Header;
+	PIMAGE_EXPORT_DIRECTORY Directory;
+	PDWORD ExportsByName = NULL;
+	PBYTE Buffer;
+	ULONGLONG Offset;
+	BOOL bPlaced;
+
+	*lpBuffer = NULL;
+	*lpSize = 0;
+	memset(&Builder, 0, sizeof(Builder));
+	memset(&Header, 0, sizeof(Header));
+	MetaCache_AddString(&Builder, "");
+
+	Header.Magic = META_CACHE_MAGIC;
+	Header.Version = META_CACHE_VERSION;
+	memcpy(Header.Digest, Digest, SHA256_DIGEST_SIZE);
+	Header.FileSize = FileSize;
+	Header.ImageBase = Image->Traits->GetImageBase(Image);
+	Header.Machine = Image->NtHeaders->FileHeader.Machine;
+	Header.Characteristics = Image->NtHeaders->FileHeader.Characteristics;
+	Header.TimeDateStamp = Image->NtHeaders->FileHeader.TimeDateStamp;
+	/* fields before ImageBase and after it have the same offsets in PE32 and PE32+ */
+	Header.OptionalMagic = Image->NtHeaders->OptionalHeader.Magic;
+	Header.Subsystem = Image->NtHeaders->OptionalHeader.Subsystem;
+	Header.DllCharacteristics = Image->NtHeaders->OptionalHeader.DllCharacteristics;
+	Header.SizeOfImage = Image->NtHeaders->OptionalHeader.SizeOfImage;
+	Header.AddressOfEntryPoint = Image->NtHeaders->OptionalHeader.AddressOfEntryPoint;
+	Header.CheckSum = Image->NtHeaders->OptionalHeader.CheckSum;
+
+	MetaCache_CollectImports(Image, &Builder);
+	Directory = (PIMAGE_EXPORT_DIRECTORY)Image->Directories[IMAGE_DIRECTORY_ENTRY_EXPORT].Data;
+	if (Directory != NULL && Image->Directories[IMAGE_DIRECTORY_ENTRY_EXPORT].VirtualAddress != 0 && PE32_IsTableSafe(Image, PE_TABLE_EXPORTS))
+	{
+		Header.ExportOrdinalBase = Directory->Base;
+		Header.ExportName = MetaCache_AddString(&Builder, (LPCSTR)PE32_RVAToPointer(Image, Directory->Name));
+		PE32_EnumExportsEx(Image, MetaCache_CallbackExport, &Builder);
+	}
+	MetaCache_CollectRelocations(Image, &Builder);
+	MetaCache_MergePages(&Builder);
+	Header.Error = Image->Error;
+
+	if (!Builder.bFailed && Builder.nExports != 0)
+	{
+		ExportsByName = MetaCache_SortExports(&Builder);
+		if (ExportsByName == NULL)
+			Builder.bFailed = TRUE;
+	}
+
+	Offset = sizeof(META_CACHE_HEADER);
+	bPlaced = MetaCache_PlaceTable(&Header.Sections, &Offset, Image->nSections, sizeof(META_SECTION))
+		&& MetaCache_PlaceTable(&Header.Imports, &Offset, Builder.nImports, sizeof(META_IMPORT))
+		&& MetaCache_PlaceTable(&Header.Exports, &Offset, Builder.nExports, sizeof(META_EXPORT))
+		&& MetaCache_PlaceTable(&Header.ExportsByName, &Offset, Builder.nExports, sizeof(DWORD))
+		&& MetaCache_PlaceTable(&Header.RelocPages, &Offset, Builder.nRelocPages, sizeof(META_RELOC_PAGE))
+		&& MetaCache_PlaceTable(&Header.Strings, &Offset, Builder.StringsSize, 1);
+	Header.nRelocations = Builder.nRelocations;
+	memcpy(Header.RelocTypes, Builder.RelocTypes, sizeof(Header.RelocTypes));
+	Offset = META_ALIGN(Offset);
+	Header.TotalSize = (DWORD)Offset;
+
+	Buffer = NULL;
+	if (!Builder.bFailed && bPlaced && Offset <= 0xFFFFFFFF)
+		Buffer = (PBYTE)calloc(1, (SIZE_T)Offset);
+	if (Buffer != NULL)
+	{
+		memcpy(Buffer, &Header, sizeof(Header));
+		for (DWORD i = 0; i < Image->nSections; i++)
+		{
+			PMETA_SECTION Section = (PMETA_SECTION)(Buffer + Header.Sections.Offset) + i;
+			memcpy(Section->Name, Image->SectionHeaders[i].Name, IMAGE_SIZEOF_SHORT_NAME);
+			Section->VirtualAddress = Image->SectionHeaders[i].VirtualAddress;
+			Section->VirtualSize = Image->SectionHeaders[i].Misc.VirtualSize;
+			Section->PointerToRawData = Image->SectionHeaders[i].PointerToRawData;
+			Section->SizeOfRawData = Image->SectionHeaders[i].SizeOfRawData;
+			Section->Characteristics = Image->SectionHeaders[i].Characteristics;
+		}
+		if (Builder.nImports != 0)
+			memcpy(Buffer + Header.Imports.Offset, Builder.Imports, Builder.nImports * sizeof(META_IMPORT));
+		if (Builder.nExports != 0)
+		{
+			memcpy(Buffer + Header.Exports.Offset, Builder.Exports, Builder.nExports * sizeof(META_EXPORT));
+			memcpy(Buffer + Header.ExportsByName.Offset, ExportsByName, Builder.nExports * sizeof(DWORD));
+		}
+		if (Builder.nRelocPages != 0)
+			memcpy(Buffer + Header.RelocPages.Offset, Builder.RelocPages, Builder.nRelocPages * sizeof(META_RELOC_PAGE));
+		memcpy(Buffer + Header.Strings.Offset, Builder.Strings, Builder.StringsSize);
+		*lpBuffer = Buffer;
+		*lpSize = Header.TotalSize;
+	}
+	free(ExportsByName);
+	MetaCache_ReleaseBuilder(&Builder);
+	return Buffer != NULL;
+}
+
+static BOOL MetaCache_IsTableInside(PMETA_TABLE Table, SIZE_T ElementSize, DWORD TotalSize)
+{
+	return (Table->Offset & 7) == 0 && (ULONGLONG)Table->Offset + (ULONGLONG)Table->Count * ElementSize <= TotalSize;
+}
+
+BOOL MetaCache_Attach(LPCVOID Buffer, SIZE_T Size, PMETA_CACHE Cache)
+{
+	PMETA_CACHE_HEADER Header = (PMETA_CACHE_HEADER)Buffer;
+	PBYTE Base = (PBYTE)Buffer;
+
+	if (Size < sizeof(META_CACHE_HEADER) || Header->Magic != META_CACHE_MAGIC || Header->Version != META_CACHE_VERSION || Header->TotalSize > Size)
+		return FALSE;
+	/* a truncated or corrupted file must not make a query read out of the mapping */
+	if (!MetaCache_IsTableInside(&Header->Sections, sizeof(META_SECTION), Header->TotalSize)
+		|| !MetaCache_IsTableInside(&Header->Imports, sizeof(META_IMPORT), Header->TotalSize)
+		|| !MetaCache_IsTableInside(&Header->Exports, sizeof(META_EXPORT), Header->TotalSize)
+		|| !MetaCache_IsTableInside(&Header->ExportsByName, sizeof(DWORD), Header->TotalSize)
+		|| !MetaCache_IsTableInside(&Header->RelocPages, sizeof(META_RELOC_PAGE), Header->TotalSize)
+		|| !MetaCache_IsTableInside(&Header->Strings, 1, Header->TotalSize)
+		|| Header->ExportsByName.Count != Header->Exports.Count
+		|| Header->Strings.Count == 0 || Base[Header->Strings.Offset + Header->Strings.Count - 1] != '\0')
+		return FALSE;
+
+	Cache->Header = Header;
+	Cache->Sections = (PMETA_SECTION)(Base + Header->Sections.Offset);
+	Cache->Imports = (PMETA_IMPORT)(Base + Header->Imports.Offset);
+	Cache->Exports = (PMETA_EXPORT)(Base + Header->Exports.Offset);
+	Cache->ExportsByName = (PDWORD)(Base + Header->ExportsByName.Offset);
+	Cache->RelocPages = (PMETA_RELOC_PAGE)(Base + Header->RelocPages.Offset);
+	Cache->Strings = (LPCSTR)(Base + Header->Strings.Offset);
+	return TRUE;
+}
+
+/* <directory>/<hex of Digest><Extension>, released by free */
+static PCHAR MetaCache_MakePath(LPCSTR CacheDirectory, const BYTE* Digest, LPCSTR Extension)
+{
+	SIZE_T Length = strlen(CacheDirectory);
+	PCHAR Path = (PCHAR)malloc(Length + 2 * SHA256_DIGEST_SIZE + strlen(Extension) + 2);
+
+	if (Path == NULL)
+		return NULL;
+	memcpy(Path, CacheDirectory, Length);
+	Path[Length] = '/';
+	HashUtils_ToHex(Digest, SHA256_DIGEST_SIZE, Path + Length + 1);
+	strcpy(Path + Length + 1 + 2 * SHA256_DIGEST_SIZE, Extension);
+	return Path;
+}
+
+static PCHAR MetaCache_MakeRefPath(LPCSTR CacheDirectory, LPCSTR Path)
+{
+	SHA_CONTEXT Context;
+	BYTE PathDigest[SHA256_DIGEST_SIZE];
+
+	HashUtils_Sha256Init(&Context);
+	HashUtils_Sha256Update(&Context, Path, strlen(Path));
+	HashUtils_Sha256Final(&Context, PathDigest);
+	return MetaCache_MakePath(CacheDirectory, PathDigest, ".ref");
+}
+
+static BOOL MetaCache_ReadRef(LPCSTR CacheDirectory, LPCSTR Path, PMETA_CACHE_REF Ref)
+{
+	PCHAR RefPath = MetaCache_MakeRefPath(CacheDirectory, Path);
+	FILE* File;
+	BOOL bSuccess = FALSE;
+
+	if (RefPath == NULL)
+		return FALSE;
+	File = fopen(RefPath, "rb");
+	if (File != NULL)
+	{
+		bSuccess = fread(Ref, sizeof(META_CACHE_REF), 1, File) == 1 && Ref->Magic == META_CACHE_MAGIC && Ref->Version == META_CACHE_VERSION;
+		fclose(File);
+	}
+	free(RefPath);
+	return bSuccess;
+}
+
+static BOOL MetaCache_WriteRef(LPCSTR CacheDirectory, LPCSTR Path, ULONGLONG FileSize, ULONGLONG Modified, const BYTE* Digest)
+{
+	PCHAR RefPath = MetaCache_MakeRefPath(CacheDirectory, Path);
+	META_CACHE_REF Ref;
+	BOOL bSuccess;
+
+	if (RefPath == NULL)
+		return FALSE;
+	memset(&Ref, 0, sizeof(Ref));
+	Ref.Magic = META_CACHE_MAGIC;
+	Ref.Version = META_CACHE_VERSION;
+	Ref.FileSize = FileSize;
+	Ref.Modified = Modified;
+	memcpy(Ref.Digest, Digest, SHA256_DIGEST_SIZE);
+	bSuccess = FileUtils_WriteFile(RefPath, &Ref, sizeof(Ref));
+	free(RefPath);
+	return bSuccess;
+}
+
+static BOOL MetaCache_WriteEntry(LPCSTR CacheDirectory, const BYTE* Digest, PBYTE Buffer, DWORD Size)
+{
+	PCHAR EntryPath = MetaCache_MakePath(CacheDirectory, Digest, ".pemc");
+	BOOL bSuccess;
+
+	if (EntryPath == NULL)
+		return FALSE;
+	bSuccess = FileUtils_WriteFile(EntryPath, Buffer, Size);
+	free(EntryPath);
+	return bSuccess;
+}
+
+BOOL MetaCache_OpenDigest(LPCSTR CacheDirectory, const BYTE* Digest, PMETA_CACHE Cache)
+{
+	PCHAR EntryPath = MetaCache_MakePath(CacheDirectory, Digest, ".pemc");
+	BOOL bSuccess = FALSE;
+
+	memset(Cache, 0, sizeof(META_CACHE));
+	if (EntryPath == NULL)
+		return FALSE;
+	if (FileUtils_MapFile(EntryPath, &Cache->View))
+	{
+		bSuccess = MetaCache_Attach(Cache->View.Data, Cache->View.Size, Cache) && memcmp(Cache->Header->Digest, Digest, SHA256_DIGEST_SIZE) == 0;
+		if (!bSuccess)
+			MetaCache_Close(Cache);
+	}
+	free(EntryPath);
+	Cache->Source = META_SOURCE_DIGEST;
+	return bSuccess;
+}
+
+/* digest of the file, then its entry from the cache or from a parse (written in the cache, *lpbStored tells if it has been) */
+static BOOL MetaCache_OpenFile(LPCSTR CacheDirectory, LPCSTR Path, PMETA_CACHE_REF Stamp, BOOL bForce, PMETA_CACHE Cache, BOOL* lpbStored)
+{
+	PE_IMAGE Image;
+	SHA_CONTEXT Context;
+	BYTE Digest[SHA256_DIGEST_SIZE];
+	PBYTE Buffer;
+	DWORD Size;
+	BOOL bBuilt;
+
+	*lpbStored = FALSE;
+	memset(Cache, 0, sizeof(META_CACHE));
+	if (!PE32_OpenFile(Path, &Image))
+		return FALSE;
+	HashUtils_Sha256Init(&Context);
+	HashUtils_Sha256Update(&Context, Image.View.Data, Image.View.Size);
+	HashUtils_Sha256Final(&Context, Digest);
+
+	if (!bForce && CacheDirectory != NULL && MetaCache_OpenDigest(CacheDirectory, Digest, Cache))
+	{
+		PE32_CloseImage(&Image);
+		*lpbStored = Stamp != NULL && MetaCache_WriteRef(CacheDirectory, Path, Stamp->FileSize, Stamp->Modified, Digest);
+		return TRUE;
+	}
+
+	bBuilt = MetaCache_Build(&Image, Digest, Image.View.Size, &Buffer, &Size);
+	PE32_CloseImage(&Image);
+	memset(Cache, 0, sizeof(META_CACHE));
+	if (!bBuilt)
+		return FALSE;
+	if (!MetaCache_Attach(Buffer, Size, Cache))
+	{
+		free(Buffer);
+		return FALSE;
+	}
+	Cache->Buffer = Buffer;
+	Cache->Source = META_SOURCE_PARSED;
+	if (CacheDirectory != NULL && MetaCache_WriteEntry(CacheDirectory, Digest, Buffer, Size))
+		*lpbStored = Stamp != NULL && MetaCache_WriteRef(CacheDirectory, Path, Stamp->FileSize, Stamp->Modified, Digest);
+	return TRUE;
+}
+
+BOOL MetaCache_Populate(LPCSTR CacheDirectory, LPCSTR Path)
+{
+	META_CACHE Cache;
+	META_CACHE_REF Stamp;
+	BOOL bStored = FALSE;
+
+	/* stamp taken before the read: a file modified meanwhile is parsed again next time */
+	if (!FileUtils_GetFileStamp(Path, &Stamp.FileSize, &Stamp.Modified))
+		return FALSE;
+	if (MetaCache_OpenFile(CacheDirectory, Path, &Stamp, TRUE, &Cache, &bStored))
+		MetaCache_Close(&Cache);
+	return bStored;
+}
+
+BOOL MetaCache_Open(LPCSTR CacheDirectory, LPCSTR Path, PMETA_CACHE Cache)
+{
+	META_CACHE_REF Ref;
+	META_CACHE_REF Stamp;
+	BOOL bStamped = FALSE;
+	BOOL bStored;
+
+	if (CacheDirectory != NULL)
+	{
+		bStamped = FileUtils_GetFileStamp(Path, &Stamp.FileSize, &Stamp.Modified);
+		if (bStamped && MetaCache_ReadRef(CacheDirectory, Path, &Ref) && Ref.FileSize == Stamp.FileSize && Ref.Modified == Stamp.Modified
+			&& MetaCache_OpenDigest(CacheDirectory, Ref.Digest, Cache))
+		{
+			Cache->Source = META_SOURCE_PATH;
+			return TRUE;
+		}
+	}
+	return MetaCache_OpenFile(CacheDirectory, Path, bStamped ? &Stamp : NULL, FALSE, Cache, &bStored);
+}
+
+VOID MetaCache_Close(PMETA_CACHE Cache)
+{
+	if (Cache->View.Data != NULL)
+		FileUtils_UnmapFile(&Cache->View);
+	free(Cache->Buffer);
+	Cache->Buffer = NULL;
+	Cache->Header = NULL;
+}
+
+LPCSTR MetaCache_GetString(PMETA_CACHE Cache, DWORD Offset)
+{
+	if (Offset >= Cache->Header->Strings.Count)
+		return "";
+	return Cache->Strings + Offset;
+}
+
+PMETA_EXPORT MetaCache_FindExport(PMETA_CACHE Cache, LPCSTR Name)
+{
+	DWORD Low = 0, High = Cache->Header->Exports.Count;
+	DWORD Middle, Index;
+	int Compare;
+
+	while (Low < High)
+	{
+		Middle = Low + (High - Low) / 2;
+		Index = Cache->ExportsByName[Middle];
+		if (Index >= Cache->Header->Exports.Count)
+			return NULL;
+		Compare = strcmp(MetaCache_GetString(Cache, Cache->Exports[Index].Name), Name);
+		if (Compare == 0)
+			return &Cache->Exports[Index];
+		if (Compare < 0)
+			Low = Middle + 1;
+		else
+			High = Middle;
+	}
+	return NULL;
+}
@@ -0,0 +1,231 @@
+/**
+ * \file MetaCache.h
+ * \brief Persistent cache of the parsed tables of PE files, keyed by their SHA-256
+ * \author Tomtombinary
+ * \version 1.0
+ * \date 17 octobre 2026
+ * A cache file holds the sections, imports, exports and a relocation summary
+ * of a PE file in fixed-width arrays followed by a string pool. Strings are
+ * referenced by their offset in the pool, so a mapped cache file is queried
+ * in place, without deserialization.
+ * Cache files are named <sha256>.pemc. A reference file per path
+ * (<sha256 of the path>.ref) keeps the size, the last write time and the
+ * digest of the file: while they match, the PE file isn't read at all.
+ */
+
+#pragma once
+#include "stdafx.h"
+#include "PEUtils.h"
+#include "HashUtils.h"
+#include "FileUtils.h"
+
+#define META_CACHE_MAGIC 0x434D4550 /* "PEMC" */
+#define META_CACHE_VERSION 1
+
+#define META_SOURCE_PATH 1    /* found by the reference of the path, the PE file wasn't read */
+#define META_SOURCE_DIGEST 2  /* found by the digest of the file (file renamed, copied or touched) */
+#define META_SOURCE_PARSED 3  /* not in the cache: the file has been parsed */
+
+/**
+ * \struct META_TABLE
+ * \brief array of a cache file: offset from the start of the file and number of entries (bytes for the string pool)
+ */
+typedef struct _META_TABLE
+{
+	DWORD Offset;
+	DWORD Count;
+}META_TABLE,*PMETA_TABLE;
+
+/**
+ * \struct META_CACHE_HEADER
+ * \brief first bytes of a cache file, all integers are little endian
+ * Error: PE_ERROR_* code of the first malformed table, its entries are missing
+ * ExportName: module name of the export directory in the string pool
+ * ExportsByName: indexes of Exports sorted by name
+ * nRelocations: number of relocations, padding entries (IMAGE_REL_BASED_ABSOLUTE) excluded
+ * RelocTypes: number of entries of each type
+ */
+typedef struct _META_CACHE_HEADER
+{
+	DWORD Magic;
+	DWORD Version;
+	DWORD TotalSize;
+	DWORD Error;
+	BYTE Digest[SHA256_DIGEST_SIZE];
+	ULONGLONG FileSize;
+	ULONGLONG ImageBase;
+	WORD Machine;
+	WORD Characteristics;
+	WORD OptionalMagic;
+	WORD Subsystem;
+	WORD DllCharacteristics;
+	WORD Reserved;
+	DWORD TimeDateStamp;
+	DWORD SizeOfImage;
+	DWORD AddressOfEntryPoint;
+	DWORD CheckSum;
+	DWORD ExportOrdinalBase;
+	DWORD ExportName;
+	META_TABLE Sections;
+	META_TABLE Imports;
+	META_TABLE Exports;
+	META_TABLE ExportsByName;
+	META_TABLE RelocPages;
+	DWORD nRelocations;
+	DWORD RelocTypes[16];
+	META_TABLE Strings;
+}META_CACHE_HEADER,*PMETA_CACHE_HEADER;
+
+/**
+ * \struct META_SECTION
+ * \brief a section header, as enumerated by PE32_EnumSections
+ */
+typedef struct _META_SECTION
+{
+	BYTE Name[IMAGE_SIZEOF_SHORT_NAME];
+	DWORD VirtualAddress;
+	DWORD VirtualSize;
+	DWORD PointerToRawData;
+	DWORD SizeOfRawData;
+	DWORD Characteristics;
+}META_SECTION,*PMETA_SECTION;
+
+/**
+ * \struct META_IMPORT
+ * \brief an import, as enumerated by PE32_EnumImports
+ * DllName, Name: offsets in the string pool, Name is 0 for an import by ordinal
+ * Hint: hint of the import by name, or ordinal of the import by ordinal
+ * Thunk: value of the IAT entry
+ */
+typedef struct _META_IMPORT
+{
+	DWORD DllName;
+	DWORD Name;
+	ULONGLONG Thunk;
+	WORD Hint;
+	WORD Reserved[3];
+}META_IMPORT,*PMETA_IMPORT;
+
+/**
+ * \struct META_EXPORT
+ * \brief an export by name, as enumerated by PE32_EnumExports
+ * Name, Forwarder: offsets in the string pool, Forwarder is 0 when the export isn't forwarded
+ * Ordinal: index in AddressOfFunctions (add ExportOrdinalBase of the header for the ordinal)
+ */
+typedef struct _META_EXPORT
+{
+	DWORD RVA;
+	DWORD Name;
+	DWORD Forwarder;
+	WORD Ordinal;
+	WORD Reserved;
+}META_EXPORT,*PMETA_EXPORT;
+
+/**
+ * \struct META_RELOC_PAGE
+ * \brief number of relocations of a page of 4 KB, pages sorted by RVA
+ */
+typedef struct _META_RELOC_PAGE
+{
+	DWORD PageRVA;
+	DWORD Count;
+}META_RELOC_PAGE,*PMETA_RELOC_PAGE;
+
+/**
+ * \struct META_CACHE
+ * \brief an opened cache entry, arrays point in the mapped cache file (or in Buffer after a parse)
+ * Source: META_SOURCE_* value telling how the entry has been found
+ */
+typedef struct _META_CACHE
+{
+	PMETA_CACHE_HEADER Header;
+	PMETA_SECTION Sections;
+	PMETA_IMPORT Imports;
+	PMETA_EXPORT Exports;
+	PDWORD ExportsByName;
+	PMETA_RELOC_PAGE RelocPages;
+	LPCSTR Strings;
+	DWORD Source;
+	FILE_VIEW View;
+	PBYTE Buffer;
+}META_CACHE,*PMETA_CACHE;
+
+/**
+ * \fn BOOL MetaCache_Build(PPE_IMAGE Image, const BYTE* Digest, ULONGLONG FileSize, PBYTE* lpBuffer, PDWORD lpSize);
+ * \brief parse the tables of an image and write them in the cache format
+ * Malformed tables are left empty and their error is stored in the header.
+ * \param Image: image of a file (PE_LAYOUT_FILE)
+ * \param Digest: SHA-256 of the file
+ * \param FileSize: size of the file
+ * \param lpBuffer: [out] cache entry, released by free
+ * \param lpSize: [out] size of the cache entry
+ * \return FALSE if memory couldn't be allocated or the entry would exceed 4 GB
+ */
+BOOL MetaCache_Build(PPE_IMAGE Image, const BYTE* Digest, ULONGLONG FileSize, PBYTE* lpBuffer, PDWORD lpSize);
+
+/**
+ * \fn BOOL MetaCache_Attach(LPCVOID Buffer, SIZE_T Size, PMETA_CACHE Cache);
+ * \brief check a cache entry in memory and set the arrays of Cache on it (nothing is copied)
+ * \param Buffer: cache entry
+ * \param Size: size of the buffer
+ * \param Cache: [out] cache entry, Source, View and Buffer aren't modified
+ * \return FALSE if the entry is malformed or has another version
+ */
+BOOL MetaCache_Attach(LPCVOID Buffer, SIZE_T Size, PMETA_CACHE Cache);
+
+/**
+ * \fn BOOL MetaCache_Populate(LPCSTR CacheDirectory, LPCSTR Path);
+ * \brief parse a PE file and write its cache entry and the reference of its path
+ * \param CacheDirectory: existing directory of the cache
+ * \param Path: path of the PE file
+ * \return FALSE if the file couldn't be read or isn't a PE, or the cache couldn't be written
+ */
+BOOL MetaCache_Populate(LPCSTR CacheDirectory, LPCSTR Path);
+
+/**
+ * \fn BOOL MetaCache_OpenDigest(LPCSTR CacheDirectory, const BYTE* Digest, PMETA_CACHE Cache);
+ * \brief map the cache entry of a digest
+ * \param CacheDirectory: directory of the cache
+ * \param Digest: SHA-256 of a PE file
+ * \param Cache: [out] cache entry, released by MetaCache_Close
+ * \return FALSE if there is no valid entry for this digest
+ */
+BOOL MetaCache_OpenDigest(LPCSTR CacheDirectory, const BYTE* Digest, PMETA_CACHE Cache);
+
+/**
+ * \fn BOOL MetaCache_Open(LPCSTR CacheDirectory, LPCSTR Path, PMETA_CACHE Cache);
+ * \brief get the cache entry of a PE file, parsing the file on a miss
+ * The reference of the path is tried first (no read of the PE file), then the
+ * digest of the file. On a miss the file is parsed and the entry is written
+ * in the cache, a failed write doesn't fail the call.
+ * \param CacheDirectory: [optional] existing directory of the cache, NULL to always parse
+ * \param Path: path of the PE file
+ * \param Cache: [out] cache entry, released by MetaCache_Close
+ * \return FALSE if the file couldn't be read or isn't a PE
+ */
+BOOL MetaCache_Open(LPCSTR CacheDirectory, LPCSTR Path, PMETA_CACHE Cache);
+
+/**
+ * \fn VOID MetaCache_Close(PMETA_CACHE Cache);
+ * \brief unmap or release a cache entry
+ * \param Cache: cache entry
+ */
+VOID MetaCache_Close(PMETA_CACHE Cache);
+
+/**
+ * \fn LPCSTR MetaCache_GetString(PMETA_CACHE Cache, DWORD Offset);
+ * \brief get a string of the pool
+ * \param Cache: cache entry
+ * \param Offset: offset in the string pool
+ * \return the string, "" for an offset out of the pool
+ */
+LPCSTR MetaCache_GetString(PMETA_CACHE Cache, DWORD Offset);
+
+/**
+ * \fn PMETA_EXPORT MetaCache_FindExport(PMETA_CACHE Cache, LPCSTR Name);
+ * \brief find an export by name (binary search in ExportsByName)
+ * \param Cache: cache entry
+ * \param Name: name of the export
+ * \return the export, NULL if not found
+ */
+PMETA_EXPORT MetaCache_FindExport(PMETA_CACHE Cache, LPCSTR Name);
@@ -0,0 +1,200 @@
+/**
+ * \file NameTable.c
+ * \brief Defines function described in file NameTable.h
+ * \author Tomtombinary
+ * \version 1.0
+ * \date 17 octobre 2026
+ */
+
+#include "stdafx.h"
+#include "NameTable.h"
+#include "MemUtils.h"
+#include "ThreadUtils.h"
+
+#define NAME_TABLE_SHARDS 64
+#define NAME_TABLE_MIN_SLOTS 256
+
+/**
+ * \struct NAME_ENTRY
+ * \brief interned name, followed by the raw name and the normalized name
+ */
+typedef struct _NAME_ENTRY
+{
+	INTERNED_NAME Value;
+	DWORD Hash;
+	DWORD Kind;
+	DWORD RawLength;
+	CHAR Raw[1];
+}NAME_ENTRY,*PNAME_ENTRY;
+
+/**
+ * \struct NAME_SHARD
+ * \brief open addressing table of a part of the hashes, entries allocated in its arena
+ */
+typedef struct _NAME_SHARD
+{
+	THREAD_LOCK Lock;
+	PNAME_ENTRY* Slots;
+	DWORD Mask;
+	DWORD nEntries;
+	MEM_ARENA Arena;
+}NAME_SHARD,*PNAME_SHARD;
+
+static NAME_SHARD NameTable_Shards[NAME_TABLE_SHARDS];
+/* the first thread to increment Starting initializes the locks, then sets Ready */
+static volatile LONG NameTable_Starting;
+static volatile LONG NameTable_Ready;
+
+static VOID NameTable_Init()
+{
+	if (ThreadUtils_AtomicAdd(&NameTable_Ready, 0) != 0)
+		return;
+	if (ThreadUtils_AtomicAdd(&NameTable_Starting, 1) == 1)
+	{
+		for (DWORD i = 0; i < NAME_TABLE_SHARDS; i++)
+			ThreadUtils_InitLock(&NameTable_Shards[i].Lock);
+		ThreadUtils_AtomicAdd(&NameTable_Ready, 1);
+		return;
+	}
+	while (ThreadUtils_AtomicAdd(&NameTable_Ready, 0) == 0)
+		ThreadUtils_Yield();
+}
+
+/* FNV-1a of the raw name and its kind, the length is computed on the way */
+static DWORD NameTable_Hash(LPCSTR Name, DWORD Kind, PDWORD lpLength)
+{
+	DWORD Hash = 0x811c9dc5 ^ Kind;
+	LPCSTR lpChar = Name;
+
+	while (*lpChar != '\0')
+	{
+		Hash ^= (BYTE)*lpChar++;
+		Hash *= 0x01000193;
+	}
+	*lpLength = (DWORD)(lpChar - Name);
+	return Hash;
+}
+
+static BOOL NameTable_Grow(PNAME_SHARD Shard)
+{
+	DWORD nSlots = Shard->Slots == NULL ? NAME_TABLE_MIN_SLOTS : (Shard->Mask + 1) * 2;
+	PNAME_ENTRY* Slots = (PNAME_ENTRY*)calloc(nSlots, sizeof(PNAME_ENTRY));
+	DWORD j;
+
+	if (Slots == NULL)
+		return FALSE;
+	if (Shard->Slots != NULL)
+	{
+		for (DWORD i = 0; i <= Shard->Mask; i++)
+		{
+			if (Shard->Slots[i] == NULL)
+				continue;
+			for (j = Shard->Slots[i]->Hash & (nSlots - 1); Slots[j] != NULL; j = (j + 1) & (nSlots - 1));
+			Slots[j] = Shard->Slots[i];
+		}
+		free(Shard->Slots);
+	}
+	Shard->Slots = Slots;
+	Shard->Mask = nSlots - 1;
+	return TRUE;
+}
+
+static PNAME_ENTRY NameTable_NewEntry(PNAME_SHARD Shard, LPCSTR Name, DWORD Length, DWORD Kind, DWORD Hash)
+{
+	PNAME_ENTRY Entry = (PNAME_ENTRY)MemArenaAlloc(&Shard->Arena, sizeof(NAME_ENTRY) + (SIZE_T)Length * 2 + 1);
+	PCHAR Normalized;
+	DWORD nNormalized = Length;
+	CHAR c;
+
+	if (Entry == NULL)
+		return NULL;
+	Entry->Hash = Hash;
+	Entry->Kind = Kind;
+	Entry->RawLength = Length;
+	memcpy(Entry->Raw, Name, Length);
+
+	Normalized = Entry->Raw + Length + 1;
+	for (DWORD i = 0; i < Length; i++)
+	{
+		c = Name[i];
+		Normalized[i] = (c >= 'A' && c <= 'Z') ? c - 'A' + 'a' : c;
+	}
+	/* "kernel32.dll" is hashed as "kernel32" */
+	if (Kind == NAME_KIND_DLL && Length > 4 && Normalized[Length - 4] == '.' &&
+		(memcmp(Normalized + Length - 3, "dll", 3) == 0 || memcmp(Normalized + Length - 3, "ocx", 3) == 0 || memcmp(Normalized + Length - 3, "sys", 3) == 0))
+		nNormalized = Length - 4;
+	Normalized[nNormalized] = '\0';
+	Entry->Value.Name = Normalized;
+	Entry->Value.Length = nNormalized;
+	return Entry;
+}
+
+PCINTERNED_NAME NameTable_Intern(LPCSTR Name, DWORD Kind)
+{
+	PNAME_SHARD Shard;
+	PNAME_ENTRY Entry;
+	DWORD Length;
+	DWORD Hash = NameTable_Hash(Name, Kind, &Length);
+	DWORD i;
+
+	NameTable_Init();
+	/* high bits choose the shard, low bits the slot */
+	Shard = &NameTable_Shards[Hash >> 26];
+	ThreadUtils_Lock(&Shard->Lock);
+	if (Shard->Slots == NULL && !NameTable_Grow(Shard))
+	{
+		ThreadUtils_Unlock(&Shard->Lock);
+		return NULL;
+	}
+	for (i = Hash & Shard->Mask; (Entry = Shard->Slots[i]) != NULL; i = (i + 1) & Shard->Mask)
+	{
+		if (Entry->Hash == Hash && Entry->Kind == Kind && Entry->RawLength == Length && memcmp(Entry->Raw, Name, Length) == 0)
+		{
+			ThreadUtils_Unlock(&Shard->Lock);
+			return &Entry->Value;
+		}
+	}
+
+	Entry = NameTable_NewEntry(Shard, Name, Length, Kind, Hash);
+	if (Entry != NULL)
+	{
+		Shard->Slots[i] = Entry;
+		/* load factor kept under 1/2 */
+		if (++Shard->nEntries * 2 > Shard->Mask + 1)
+			NameTable_Grow(Shard);
+	}
+	ThreadUtils_Unlock(&Shard->Lock);
+	return Entry != NULL ? &Entry->Value : NULL;
+}
+
+DWORD NameTable_GetCount()
+{
+	DWORD nEntries = 0;
+
+	NameTable_Init();
+	for (DWORD i = 0; i < NAME_TABLE_SHARDS; i++)
+	{
+		ThreadUtils_Lock(&NameTable_Shards[i].Lock);
+		nEntries += NameTable_Shards[i].nEntries;
+		ThreadUtils_Unlock(&NameTable_Shards[i].Lock);
+	}
+	return nEntries;
+}
+
+VOID NameTable_Release()
+{
+	PNAME_SHARD Shard;
+
+	if (ThreadUtils_AtomicAdd(&NameTable_Ready, 0) == 0)
+		return;
+	/* the locks stay initialized, the table can be filled again */
+	for (DWORD i = 0; i < NAME_TABLE_SHARDS; i++)
+	{
+		Shard = &NameTable_Shards[i];
+		free(Shard->Slots);
+		Shard->Slots = NULL;
+		Shard->Mask = 0;
+		Shard->nEntries = 0;
+		MemArenaRelease(&Shard->Arena);
+	}
+}
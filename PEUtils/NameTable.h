@@ -0,0 +1,52 @@
+/**
+ * \file NameTable.h
+ * \brief Process-wide table of interned DLL and function names
+ * \author Tomtombinary
+ * \version 1.0
+ * \date 17 octobre 2026
+ * A name is normalized (lowercased, DLL extension removed) the first time it
+ * is seen, later lookups of the same bytes return the same entry. The table
+ * is split in shards, each with its own lock, so scanning threads rarely
+ * wait for each other. Entries live until NameTable_Release.
+ */
+
+#pragma once
+#include "stdafx.h"
+
+#define NAME_KIND_FUNCTION 0
+#define NAME_KIND_DLL 1
+
+/**
+ * \struct INTERNED_NAME
+ * \brief normalized form of a name
+ * Name: lowercase name, without its .dll, .ocx or .sys extension for a DLL (null terminated)
+ * Length: length of Name
+ */
+typedef struct _INTERNED_NAME
+{
+	LPCSTR Name;
+	DWORD Length;
+}INTERNED_NAME,*PINTERNED_NAME;
+
+typedef const INTERNED_NAME* PCINTERNED_NAME;
+
+/**
+ * \fn PCINTERNED_NAME NameTable_Intern(LPCSTR Name, DWORD Kind);
+ * \brief find or add a name, safe to call from several threads
+ * \param Name: name as found in the image (null terminated)
+ * \param Kind: NAME_KIND_FUNCTION or NAME_KIND_DLL
+ * \return entry of the name, valid until NameTable_Release. NULL if memory couldn't be allocated
+ */
+PCINTERNED_NAME NameTable_Intern(LPCSTR Name, DWORD Kind);
+
+/**
+ * \fn DWORD NameTable_GetCount();
+ * \brief number of names in the table
+ */
+DWORD NameTable_GetCount();
+
+/**
+ * \fn VOID NameTable_Release();
+ * \brief release every entry of the table, no other thread may use it during the call
+ */
+VOID NameTable_Release();
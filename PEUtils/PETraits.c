@@ -0,0 +1,82 @@
+/**
+ * \file PETraits.c
+ * \brief Defines function described in file PETraits.h
+ * \author Tomtombinary
+ * \version 1.0
+ * \date 17 octobre 2026
+ */
+
+#include "stdafx.h"
+#include "PETraits.h"
+#include "MemUtils.h"
+
+/* PE32 */
+#define PE_TPL(Name) Name##32
+#define PE_TPL_NT_HEADERS IMAGE_NT_HEADERS32
+#define PE_TPL_THUNK DWORD
+#define PE_TPL_ORDINAL_FLAG IMAGE_ORDINAL_FLAG32
+#define PE_TPL_FIND_NULL MemFindNullDword
+#include "PETraits.inl"
+#undef PE_TPL
+#undef PE_TPL_NT_HEADERS
+#undef PE_TPL_THUNK
+#undef PE_TPL_ORDINAL_FLAG
+#undef PE_TPL_FIND_NULL
+
+/* PE32+ */
+#define PE_TPL(Name) Name##64
+#define PE_TPL_NT_HEADERS IMAGE_NT_HEADERS64
+#define PE_TPL_THUNK ULONGLONG
+#define PE_TPL_ORDINAL_FLAG IMAGE_ORDINAL_FLAG64
+#define PE_TPL_FIND_NULL MemFindNullQword
+#include "PETraits.inl"
+#undef PE_TPL
+#undef PE_TPL_NT_HEADERS
+#undef PE_TPL_THUNK
+#undef PE_TPL_ORDINAL_FLAG
+#undef PE_TPL_FIND_NULL
+
+static const PE_TRAITS PE_Traits32 =
+{
+	IMAGE_NT_OPTIONAL_HDR32_MAGIC,
+	sizeof(DWORD),
+	IMAGE_ORDINAL_FLAG32,
+	sizeof(IMAGE_NT_HEADERS32),
+	0xFFFFFFFF,
+	Traits_GetImageBase32,
+	Traits_SetImageBase32,
+	Traits_GetDirectories32,
+	Traits_CountThunks32,
+	Traits_ValidateThunks32,
+	Traits_EnumThunks32,
+	Traits_GetThunks32
+};
+
+static const PE_TRAITS PE_Traits64 =
+{
+	IMAGE_NT_OPTIONAL_HDR64_MAGIC,
+	sizeof(ULONGLONG),
+	IMAGE_ORDINAL_FLAG64,
+	sizeof(IMAGE_NT_HEADERS64),
+	0xFFFFFFFFFFFFFFFFULL,
+	Traits_GetImageBase64,
+	Traits_SetImageBase64,
+	Traits_GetDirectories64,
+	Traits_CountThunks64,
+	Traits_ValidateThunks64,
+	Traits_EnumThunks64,
+	Traits_GetThunks64
+};
+
+PCPE_TRAITS PE32_GetTraits(WORD Magic)
+{
+	switch (Magic)
+	{
+	case IMAGE_NT_OPTIONAL_HDR32_MAGIC:
+		return &PE_Traits32;
+	case IMAGE_NT_OPTIONAL_HDR64_MAGIC:
+		return &PE_Traits64;
+	default:
+		return NULL;
+	}
+}
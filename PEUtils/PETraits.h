@@ -0,0 +1,58 @@
+/**
+ * \file PETraits.h
+ * \brief Functions specialized for PE32 and PE32+ images
+ * \author Tomtombinary
+ * \version 1.0
+ * \date 17 octobre 2026
+ * The parts of the format which depend on the width of the image (optional
+ * header, thunks, ordinal flag) are written once in PETraits.inl and compiled
+ * twice, for 32 and 64 bits. PE32_InitImage chooses the specialization from
+ * OptionalHeader.Magic and stores it in Image->Traits, so loops over thunks
+ * never test the width of the image.
+ */
+
+#pragma once
+#include "stdafx.h"
+#include "PEUtils.h"
+#include "BulkEnum.h"
+
+/**
+ * \struct PE_TRAITS
+ * \brief constants and functions of one width of image
+ * Magic: IMAGE_NT_OPTIONAL_HDR32_MAGIC or IMAGE_NT_OPTIONAL_HDR64_MAGIC
+ * ThunkSize: size of an import thunk (4 or 8 bytes)
+ * OrdinalFlag: IMAGE_ORDINAL_FLAG32 or IMAGE_ORDINAL_FLAG64
+ * NtHeadersSize: sizeof(IMAGE_NT_HEADERS32) or sizeof(IMAGE_NT_HEADERS64)
+ * MaxImageBase: highest base address of the image
+ * GetImageBase, SetImageBase: read or write OptionalHeader.ImageBase
+ * GetDirectories: data directories of the optional header and their number (NumberOfRvaAndSizes, bounded by SizeOfOptionalHeader)
+ * CountThunks: entries of a thunk array before its null terminator, bounded by the end of the image
+ * ValidateThunks: check thunk arrays and names of an import descriptor
+ * EnumThunks: call a callback for each import of a descriptor (validated table)
+ * GetThunks: fill arrays with the imports of a descriptor, starting at import nFirst (validated table)
+ */
+typedef struct _PE_TRAITS
+{
+	WORD Magic;
+	DWORD ThunkSize;
+	ULONGLONG OrdinalFlag;
+	DWORD NtHeadersSize;
+	ULONGLONG MaxImageBase;
+	ULONGLONG(*GetImageBase)(PPE_IMAGE Image);
+	VOID(*SetImageBase)(PPE_IMAGE Image, ULONGLONG ImageBase);
+	PIMAGE_DATA_DIRECTORY(*GetDirectories)(PIMAGE_NT_HEADERS32 NtHeaders, PDWORD lpnDirectories);
+	DWORD(*CountThunks)(PPE_IMAGE Image, LPVOID ThunkArray);
+	BOOL(*ValidateThunks)(PPE_IMAGE Image, PIMAGE_IMPORT_DESCRIPTOR Descriptor);
+	BOOL(*EnumThunks)(PPE_IMAGE Image, PIMAGE_IMPORT_DESCRIPTOR Descriptor, EnumImportsCallback pFuncCallback, LPVOID UserArgs);
+	DWORD(*GetThunks)(PPE_IMAGE Image, PIMAGE_IMPORT_DESCRIPTOR Descriptor, DWORD nFirst, PIMPORT_ARRAYS Arrays, DWORD nOffset, DWORD nMax, BOOL* lpbEnd);
+}PE_TRAITS,*PPE_TRAITS;
+
+typedef const PE_TRAITS* PCPE_TRAITS;
+
+/**
+ * \fn PCPE_TRAITS PE32_GetTraits(WORD Magic);
+ * \brief specialization for an optional header magic
+ * \param Magic: OptionalHeader.Magic
+ * \return traits of PE32 or PE32+ images, NULL for an unknown magic
+ */
+PCPE_TRAITS PE32_GetTraits(WORD Magic);
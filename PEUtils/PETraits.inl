@@ -0,0 +1,145 @@
+/**
+ * \file PETraits.inl
+ * \brief Template of the functions of PE_TRAITS, included by PETraits.c for each width
+ * \author Tomtombinary
+ * \version 1.0
+ * \date 17 octobre 2026
+ * Parameters, defined before inclusion:
+ * PE_TPL(Name): name of the specialization (Name32 or Name64)
+ * PE_TPL_NT_HEADERS: IMAGE_NT_HEADERS32 or IMAGE_NT_HEADERS64
+ * PE_TPL_THUNK: DWORD or ULONGLONG
+ * PE_TPL_ORDINAL_FLAG: IMAGE_ORDINAL_FLAG32 or IMAGE_ORDINAL_FLAG64
+ * PE_TPL_FIND_NULL: MemFindNullDword or MemFindNullQword
+ */
+
+static ULONGLONG PE_TPL(Traits_GetImageBase)(PPE_IMAGE Image)
+{
+	return ((PE_TPL_NT_HEADERS*)Image->NtHeaders)->OptionalHeader.ImageBase;
+}
+
+static VOID PE_TPL(Traits_SetImageBase)(PPE_IMAGE Image, ULONGLONG ImageBase)
+{
+	((PE_TPL_NT_HEADERS*)Image->NtHeaders)->OptionalHeader.ImageBase = (PE_TPL_THUNK)ImageBase;
+}
+
+static PIMAGE_DATA_DIRECTORY PE_TPL(Traits_GetDirectories)(PIMAGE_NT_HEADERS32 NtHeaders, PDWORD lpnDirectories)
+{
+	PE_TPL_NT_HEADERS* lpNtHeaders = (PE_TPL_NT_HEADERS*)NtHeaders;
+	SIZE_T SizeOfOptionalHeader = lpNtHeaders->FileHeader.SizeOfOptionalHeader;
+	SIZE_T DirectoriesOffset = offsetof(PE_TPL_NT_HEADERS, OptionalHeader.DataDirectory) - offsetof(PE_TPL_NT_HEADERS, OptionalHeader);
+	DWORD nDirectories = lpNtHeaders->OptionalHeader.NumberOfRvaAndSizes;
+
+	/* directories beyond NumberOfRvaAndSizes or beyond the optional header don't exist */
+	if (nDirectories > IMAGE_NUMBEROF_DIRECTORY_ENTRIES)
+		nDirectories = IMAGE_NUMBEROF_DIRECTORY_ENTRIES;
+	if (SizeOfOptionalHeader < DirectoriesOffset)
+		nDirectories = 0;
+	else if (nDirectories > (SizeOfOptionalHeader - DirectoriesOffset) / sizeof(IMAGE_DATA_DIRECTORY))
+		nDirectories = (DWORD)((SizeOfOptionalHeader - DirectoriesOffset) / sizeof(IMAGE_DATA_DIRECTORY));
+	*lpnDirectories = nDirectories;
+	return lpNtHeaders->OptionalHeader.DataDirectory;
+}
+
+static DWORD PE_TPL(Traits_CountThunks)(PPE_IMAGE Image, LPVOID ThunkArray)
+{
+	SIZE_T nMax = (Image->Base + Image->Size - (PBYTE)ThunkArray) / sizeof(PE_TPL_THUNK);
+
+	return PE_TPL_FIND_NULL(ThunkArray, nMax < 0xFFFFFFFF ? (DWORD)nMax : 0xFFFFFFFF);
+}
+
+static BOOL PE_TPL(Traits_ValidateThunks)(PPE_IMAGE Image, PIMAGE_IMPORT_DESCRIPTOR Descriptor)
+{
+	PBYTE BufferLimit = Image->Base + Image->Size;
+	PIMAGE_IMPORT_BY_NAME pImportByName;
+	PE_TPL_THUNK* HintNameRVAArray;
+	PBYTE ThunkArray;
+	DWORD nThunks;
+
+	/* without import lookup table, the IAT holds the names on disk */
+	HintNameRVAArray = (PE_TPL_THUNK*)PE32_RVAToPointer(Image, Descriptor->OriginalFirstThunk != 0 ? Descriptor->OriginalFirstThunk : Descriptor->FirstThunk);
+	ThunkArray = (PBYTE)PE32_RVAToPointer(Image, Descriptor->FirstThunk);
+	if (HintNameRVAArray == NULL || ThunkArray == NULL)
+		return FALSE;
+
+	/* the lookup table ends with a null entry, the IAT has as many entries */
+	nThunks = PE_TPL(Traits_CountThunks)(Image, HintNameRVAArray);
+	if (nThunks == (SIZE_T)(BufferLimit - (PBYTE)HintNameRVAArray) / sizeof(PE_TPL_THUNK))
+		return FALSE;
+	for (DWORD i = 0; i < nThunks; i++, HintNameRVAArray++)
+	{
+		if (*HintNameRVAArray & PE_TPL_ORDINAL_FLAG)
+			continue;
+		pImportByName = (PIMAGE_IMPORT_BY_NAME)PE32_RVAToPointerRange(Image, (DWORD)*HintNameRVAArray, sizeof(WORD));
+		if (pImportByName == NULL || memchr(pImportByName->Name, 0, BufferLimit - (PBYTE)pImportByName->Name) == NULL)
+			return FALSE;
+	}
+	return (ULONGLONG)(BufferLimit - ThunkArray) >= (ULONGLONG)nThunks * sizeof(PE_TPL_THUNK);
+}
+
+static BOOL PE_TPL(Traits_EnumThunks)(PPE_IMAGE Image, PIMAGE_IMPORT_DESCRIPTOR Descriptor, EnumImportsCallback pFuncCallback, LPVOID UserArgs)
+{
+	IMPORT_ENTRY ImportEntry;
+	PE_TPL_THUNK* HintNameRVAArray;
+	PE_TPL_THUNK* ThunkArray;
+	DWORD nThunks;
+
+	ImportEntry.pImportDesc = Descriptor;
+	HintNameRVAArray = (PE_TPL_THUNK*)PE32_RVAToPointer(Image, Descriptor->OriginalFirstThunk != 0 ? Descriptor->OriginalFirstThunk : Descriptor->FirstThunk);
+	ThunkArray = (PE_TPL_THUNK*)PE32_RVAToPointer(Image, Descriptor->FirstThunk);
+
+	nThunks = PE_TPL(Traits_CountThunks)(Image, HintNameRVAArray);
+	for (DWORD i = 0; i < nThunks; i++)
+	{
+		/* no IMAGE_IMPORT_BY_NAME for an import by ordinal */
+		if (HintNameRVAArray[i] & PE_TPL_ORDINAL_FLAG)
+			ImportEntry.pImportByName = NULL;
+		else
+			ImportEntry.pImportByName = (PIMAGE_IMPORT_BY_NAME)PE32_RVAToPointer(Image, (DWORD)HintNameRVAArray[i]);
+		ImportEntry.Thunk.u1.Function = (DWORD)ThunkArray[i];
+		ImportEntry.Thunk64 = ThunkArray[i];
+		if (!pFuncCallback(&ImportEntry, UserArgs))
+			return FALSE;
+	}
+	return TRUE;
+}
+
+static DWORD PE_TPL(Traits_GetThunks)(PPE_IMAGE Image, PIMAGE_IMPORT_DESCRIPTOR Descriptor, DWORD nFirst, PIMPORT_ARRAYS Arrays, DWORD nOffset, DWORD nMax, BOOL* lpbEnd)
+{
+	PIMAGE_IMPORT_BY_NAME pImportByName;
+	PE_TPL_THUNK* HintNameRVAArray;
+	PE_TPL_THUNK* ThunkArray;
+	LPCSTR DllName;
+	DWORD nThunks, i;
+
+	DllName = (LPCSTR)PE32_RVAToPointer(Image, Descriptor->Name);
+	HintNameRVAArray = (PE_TPL_THUNK*)PE32_RVAToPointer(Image, Descriptor->OriginalFirstThunk != 0 ? Descriptor->OriginalFirstThunk : Descriptor->FirstThunk) + nFirst;
+	ThunkArray = (PE_TPL_THUNK*)PE32_RVAToPointer(Image, Descriptor->FirstThunk) + nFirst;
+	nThunks = PE_TPL(Traits_CountThunks)(Image, HintNameRVAArray);
+	*lpbEnd = nThunks <= nMax - nOffset;
+	if (nThunks > nMax - nOffset)
+		nThunks = nMax - nOffset;
+
+	for (i = 0; i < nThunks; i++)
+	{
+		if (Arrays->DllNames != NULL)
+			Arrays->DllNames[nOffset + i] = DllName;
+		if (HintNameRVAArray[i] & PE_TPL_ORDINAL_FLAG)
+		{
+			if (Arrays->Names != NULL)
+				Arrays->Names[nOffset + i] = NULL;
+			if (Arrays->Hints != NULL)
+				Arrays->Hints[nOffset + i] = (WORD)(HintNameRVAArray[i] & 0xFFFF);
+		}
+		else
+		{
+			pImportByName = (PIMAGE_IMPORT_BY_NAME)PE32_RVAToPointer(Image, (DWORD)HintNameRVAArray[i]);
+			if (Arrays->Names != NULL)
+				Arrays->Names[nOffset + i] = (LPCSTR)pImportByName->Name;
+			if (Arrays->Hints != NULL)
+				Arrays->Hints[nOffset + i] = pImportByName->Hint;
+		}
+		if (Arrays->Thunks != NULL)
+			Arrays->Thunks[nOffset + i] = ThunkArray[i];
+	}
+	return nThunks;
+}
@@ -9,6 +9,12 @@
 #include "stdafx.h"
 #include "PEUtils.h"
 #include "MemUtils.h"
+#include "SectionIndex.h"
+#include "RelocIndex.h"
+#include "ExportIndex.h"
+#include "Validate.h"
+#include "PETraits.h"
+#include "Instrument.h"
 
 PIMAGE_NT_HEADERS32 PE32_GetNtHeaders(HMODULE hMod)
 {
@@ -18,176 +24,511 @@ PIMAGE_NT_HEADERS32 PE32_GetNtHeaders(HMODULE hMod)
 	/* check if dos header is valid */
 	if (lpDOSHeader->e_magic == 0x5a4d)
 	{
-		lpNtHeaders32 = (PIMAGE_NT_HEADERS32)((DWORD)lpDOSHeader + (DWORD)lpDOSHeader->e_lfanew);
+		lpNtHeaders32 = (PIMAGE_NT_HEADERS32)((PBYTE)lpDOSHeader + lpDOSHeader->e_lfanew);
 		/* check if nt header is valid */
 		if (lpNtHeaders32->Signature != 0x00004550)
 			lpNtHeaders32 = NULL;
-		/* check if nt header is a 32 bits nt header */
-		else if (lpNtHeaders32->FileHeader.Machine != IMAGE_FILE_MACHINE_I386)
+		/* check if optional header is a PE32 or PE32+ optional header */
+		else if (PE32_GetTraits(lpNtHeaders32->OptionalHeader.Magic) == NULL)
 			lpNtHeaders32 = NULL;
 	}
 	return lpNtHeaders32;
 }
 
-BOOL PE32_EnumSections(HMODULE hMod, EnumSectionsCallback pFuncCallback, LPVOID lpUserArgs)
+/* CheckSum field of the headers of a file, NULL if it isn't inside the buffer */
+static PDWORD PE32_GetChecksumField(LPVOID Buffer, SIZE_T Size)
 {
-	SECTION_ENTRY entry;
-	BOOL bEnumTerminated = TRUE;
-	
-	PIMAGE_NT_HEADERS32 lpNtHeaders = PE32_GetNtHeaders(hMod);
+	PIMAGE_DOS_HEADER lpDOSHeader = (PIMAGE_DOS_HEADER)Buffer;
+	PIMAGE_NT_HEADERS32 lpNtHeaders;
+
+	if (Size < sizeof(IMAGE_DOS_HEADER) || lpDOSHeader->e_magic != IMAGE_DOS_SIGNATURE || lpDOSHeader->e_lfanew < 0)
+		return NULL;
+	/* CheckSum has the same offset in both widths of optional header */
+	if ((SIZE_T)lpDOSHeader->e_lfanew + offsetof(IMAGE_NT_HEADERS32, OptionalHeader.CheckSum) + sizeof(DWORD) > Size)
+		return NULL;
+	lpNtHeaders = PE32_GetNtHeaders((HMODULE)Buffer);
 	if (lpNtHeaders == NULL)
+		return NULL;
+	return &lpNtHeaders->OptionalHeader.CheckSum;
+}
+
+DWORD PE32_ComputeChecksum(LPVOID Buffer, SIZE_T Size)
+{
+	PDWORD lpCheckSum = PE32_GetChecksumField(Buffer, Size);
+	SIZE_T Offset;
+	ULONGLONG Sum;
+
+	if (lpCheckSum == NULL)
+		return 0;
+	/* the sum is exact, the bytes of CheckSum are taken out afterwards (e_lfanew may be odd) */
+	Sum = MemSumWords(Buffer, Size);
+	Offset = (PBYTE)lpCheckSum - (PBYTE)Buffer;
+	for (DWORD i = 0; i < sizeof(DWORD); i++)
+		Sum -= (ULONGLONG)((PBYTE)lpCheckSum)[i] << (((Offset + i) & 1) * 8);
+
+	while (Sum >> 16)
+		Sum = (Sum & 0xFFFF) + (Sum >> 16);
+	return (DWORD)Sum + (DWORD)Size;
+}
+
+BOOL PE32_VerifyChecksum(LPVOID Buffer, SIZE_T Size, PDWORD lpComputed)
+{
+	PDWORD lpCheckSum = PE32_GetChecksumField(Buffer, Size);
+	DWORD dwComputed = PE32_ComputeChecksum(Buffer, Size);
+
+	if (lpComputed != NULL)
+		*lpComputed = dwComputed;
+	return lpCheckSum != NULL && *lpCheckSum != 0 && *lpCheckSum == dwComputed;
+}
+
+/* resolve a data directory, Data stays NULL if it isn't entirely backed by data */
+static VOID PE32_ResolveDirectory(PPE_IMAGE Image, DWORD dwEntry)
+{
+	PPE_DIRECTORY lpDirectory = &Image->Directories[dwEntry];
+	PBYTE lpData;
+
+	if (lpDirectory->VirtualAddress == 0)
+		return;
+	if (dwEntry == IMAGE_DIRECTORY_ENTRY_SECURITY)
+	{
+		/* certificates are referenced by file offset and aren't loaded in memory */
+		if (Image->Layout != PE_LAYOUT_FILE)
+			return;
+		lpData = Image->Base + lpDirectory->VirtualAddress;
+	}
+	else
+	{
+		lpData = (PBYTE)PE32_RVAToPointer(Image, lpDirectory->VirtualAddress);
+		if (lpData == NULL)
+			return;
+	}
+	if ((ULONGLONG)(lpData - Image->Base) + lpDirectory->Size > Image->Size)
+		return;
+	lpDirectory->Data = lpData;
+}
+
+BOOL PE32_InitImage(PPE_IMAGE Image, LPVOID Base, SIZE_T Size, DWORD Layout)
+{
+	PIMAGE_DOS_HEADER lpDOSHeader = (PIMAGE_DOS_HEADER)Base;
+	PIMAGE_NT_HEADERS32 lpNtHeaders;
+	PIMAGE_DATA_DIRECTORY lpDataDirectory;
+	PCPE_TRAITS Traits;
+	DWORD nDirectories;
+
+	memset(Image, 0, sizeof(PE_IMAGE));
+	Image->Base = (PBYTE)Base;
+	Image->Size = Size;
+	Image->Layout = Layout;
+
+	/* a file buffer must at least contain both headers */
+	if (Size != 0)
+	{
+		Image->Error = PE_ERROR_DOS_HEADER;
+		if (Size < sizeof(IMAGE_DOS_HEADER) || lpDOSHeader->e_lfanew < 0)
+			return FALSE;
+		if ((SIZE_T)lpDOSHeader->e_lfanew + sizeof(IMAGE_NT_HEADERS32) > Size)
+			return FALSE;
+	}
+
+	Image->Error = PE_ERROR_NT_HEADERS;
+	lpNtHeaders = PE32_GetNtHeaders((HMODULE)Base);
+	if (lpNtHeaders == NULL)
+		return FALSE;
+	/* the specialization is chosen once, every walk of the image goes through it */
+	Traits = PE32_GetTraits(lpNtHeaders->OptionalHeader.Magic);
+	if (Size != 0 && (SIZE_T)lpDOSHeader->e_lfanew + Traits->NtHeadersSize > Size)
+		return FALSE;
+	Image->Traits = Traits;
+	if (Image->Size == 0)
+		Image->Size = lpNtHeaders->OptionalHeader.SizeOfImage;
+
+	/* section table must be inside the buffer */
+	Image->Error = PE_ERROR_SECTION_TABLE;
+	Image->SectionHeaders = (PIMAGE_SECTION_HEADER)((PBYTE)&lpNtHeaders->OptionalHeader + lpNtHeaders->FileHeader.SizeOfOptionalHeader);
+	Image->nSections = lpNtHeaders->FileHeader.NumberOfSections;
+	if ((ULONGLONG)((PBYTE)Image->SectionHeaders - Image->Base) + (ULONGLONG)Image->nSections * sizeof(IMAGE_SECTION_HEADER) > Image->Size)
+		return FALSE;
+	Image->NtHeaders = lpNtHeaders;
+	Image->Error = PE_ERROR_SUCCESS;
+
+	lpDataDirectory = Traits->GetDirectories(lpNtHeaders, &nDirectories);
+	for (DWORD i = 0; i < nDirectories; i++)
+	{
+		Image->Directories[i].VirtualAddress = lpDataDirectory[i].VirtualAddress;
+		Image->Directories[i].Size = lpDataDirectory[i].Size;
+		PE32_ResolveDirectory(Image, i);
+	}
+	return TRUE;
+}
+
+BOOL PE32_OpenFile(LPCSTR Path, PPE_IMAGE Image)
+{
+	FILE_VIEW View;
+
+	if (!FileUtils_MapFile(Path, &View))
+	{
+		memset(Image, 0, sizeof(PE_IMAGE));
+		Image->Error = PE_ERROR_FILE;
+		return FALSE;
+	}
+
+	if (!PE32_InitImage(Image, View.Data, View.Size, PE_LAYOUT_FILE))
+	{
+		FileUtils_UnmapFile(&View);
 		return FALSE;
+	}
+	Image->View = View;
+	return TRUE;
+}
+
+VOID PE32_CloseImage(PPE_IMAGE Image)
+{
+	MemArenaRelease(&Image->Arena);
+	Image->SectionIndex = NULL;
+	Image->RelocIndex = NULL;
+	Image->ExportIndex = NULL;
+	Image->ResourceIndex = NULL;
+	Image->StringNames = NULL;
+	if (Image->View.Data != NULL)
+		FileUtils_UnmapFile(&Image->View);
+	Image->Base = NULL;
+	Image->NtHeaders = NULL;
+}
+
+LPVOID PE32_RVAToPointer(PPE_IMAGE Image, DWORD dwRVA)
+{
+	PIMAGE_SECTION_HEADER lpSectionHeader;
+	PSECTION_RANGE lpRange;
+	DWORD nSections;
+	DWORD dwFileOffset;
+	DWORD dwDelta;
+	DWORD dwSize;
 
-	DWORD lpOptionalHeader = (DWORD)&lpNtHeaders->OptionalHeader;
-	DWORD SizeOfOptionalHeader = lpNtHeaders->FileHeader.SizeOfOptionalHeader;
+	if (Image->Layout == PE_LAYOUT_IMAGE)
+	{
+		if (dwRVA >= Image->Size)
+			return NULL;
+		return Image->Base + dwRVA;
+	}
+
+	/* headers are at the same place in file and in memory */
+	if (dwRVA < Image->NtHeaders->OptionalHeader.SizeOfHeaders)
+		dwFileOffset = dwRVA;
+	else if (Image->SectionIndex != NULL)
+	{
+		lpRange = PE32_LookupSectionIndex(Image->SectionIndex, dwRVA);
+		if (lpRange == NULL)
+			return NULL;
+		dwDelta = dwRVA - Image->SectionIndex->Starts[lpRange - Image->SectionIndex->Ranges];
+		if (dwDelta >= lpRange->RawSize)
+			return NULL;
+		dwFileOffset = lpRange->RawOffset + dwDelta;
+	}
+	else
+	{
+		lpSectionHeader = Image->SectionHeaders;
+		for (nSections = Image->nSections; nSections > 0; nSections--, lpSectionHeader++)
+		{
+			dwDelta = dwRVA - lpSectionHeader->VirtualAddress;
+			dwSize = lpSectionHeader->Misc.VirtualSize != 0 ? lpSectionHeader->Misc.VirtualSize : lpSectionHeader->SizeOfRawData;
+			if (dwRVA >= lpSectionHeader->VirtualAddress && dwDelta < dwSize)
+				break;
+		}
+		/* RVA outside of any section or in the uninitialized part of a section */
+		if (nSections == 0 || dwDelta >= lpSectionHeader->SizeOfRawData)
+			return NULL;
+		dwFileOffset = lpSectionHeader->PointerToRawData + dwDelta;
+	}
+
+	if (dwFileOffset >= Image->Size)
+		return NULL;
+	return Image->Base + dwFileOffset;
+}
+
+LPVOID PE32_RVAToPointerRange(PPE_IMAGE Image, DWORD dwRVA, ULONGLONG Size)
+{
+	PBYTE lpData = (PBYTE)PE32_RVAToPointer(Image, dwRVA);
+
+	if (lpData == NULL || (ULONGLONG)(lpData - Image->Base) + Size > Image->Size)
+		return NULL;
+	return lpData;
+}
+
+BOOL PE32_EnumSectionsEx(PPE_IMAGE Image, EnumSectionsCallback pFuncCallback, LPVOID lpUserArgs)
+{
+	SECTION_ENTRY entry;
+	BOOL bEnumTerminated = TRUE;
+	DWORD dwSize;
+	DWORD i;
+	INSTRUMENT_DECLARE(Call);
 
-	PIMAGE_SECTION_HEADER lpSectionHeader = (PIMAGE_SECTION_HEADER)(lpOptionalHeader + SizeOfOptionalHeader);
-	DWORD nSections = lpNtHeaders->FileHeader.NumberOfSections;
-	for (unsigned int i = 0; i < nSections; i++)
+	PIMAGE_SECTION_HEADER lpSectionHeader = Image->SectionHeaders;
+	DWORD nSections = Image->nSections;
+	INSTRUMENT_BEGIN(Call, INSTRUMENT_ENUM_SECTIONS);
+	for (i = 0; i < nSections; i++)
 	{
 		entry.header = lpSectionHeader;
-		entry.SectionData = (PBYTE)((DWORD)hMod + lpSectionHeader->VirtualAddress);
-		entry.SectionLimit = (DWORD)hMod + lpSectionHeader->VirtualAddress + lpSectionHeader->Misc.VirtualSize;
+		if (Image->Layout == PE_LAYOUT_IMAGE)
+		{
+			entry.SectionData = Image->Base + lpSectionHeader->VirtualAddress;
+			dwSize = lpSectionHeader->Misc.VirtualSize;
+		}
+		else
+		{
+			entry.SectionData = Image->Base + lpSectionHeader->PointerToRawData;
+			dwSize = lpSectionHeader->SizeOfRawData;
+			/* truncated file */
+			if (lpSectionHeader->PointerToRawData > Image->Size)
+				dwSize = 0;
+			else if (dwSize > Image->Size - lpSectionHeader->PointerToRawData)
+				dwSize = (DWORD)(Image->Size - lpSectionHeader->PointerToRawData);
+		}
+		entry.SectionLimit = (ULONG_PTR)entry.SectionData + dwSize;
 		if (pFuncCallback(&entry, lpUserArgs))
 			lpSectionHeader += 1; 
 		else
 		{
 			bEnumTerminated = FALSE;
+			i++;
 			break;
 		}
 	}
+	INSTRUMENT_END(Call, i, (ULONGLONG)i * sizeof(IMAGE_SECTION_HEADER), !bEnumTerminated);
 	return bEnumTerminated;
 }
 
+BOOL PE32_EnumSections(HMODULE hMod, EnumSectionsCallback pFuncCallback, LPVOID lpUserArgs)
+{
+	PE_IMAGE Image;
+	if (!PE32_InitImage(&Image, hMod, 0, PE_LAYOUT_IMAGE))
+	{
+		INSTRUMENT_EVENT(INSTRUMENT_EVENT_BAD_HEADERS);
+		return FALSE;
+	}
+	return PE32_EnumSectionsEx(&Image, pFuncCallback, lpUserArgs);
+}
+
 
-BOOL PE32_EnumExports(HMODULE hMod, EnumExportsCallback pCallback, LPVOID UserArgs)
+BOOL PE32_EnumExportsEx(PPE_IMAGE Image, EnumExportsCallback pCallback, LPVOID UserArgs)
 {
 	EXPORT_ENTRY entry;
 	BOOL bEnumTerminated = TRUE;
-	PIMAGE_NT_HEADERS32 lpImageNtHeaders32 = PE32_GetNtHeaders(hMod);
-	if (lpImageNtHeaders32 == NULL)
-		return FALSE;
+	DWORD i = 0;
+	INSTRUMENT_DECLARE(Call);
 	
-	PIMAGE_EXPORT_DIRECTORY lpImageExportDirectory = NULL;
-	DWORD ImageExportDirectoryRVA = lpImageNtHeaders32->OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_EXPORT].VirtualAddress;
+	PIMAGE_EXPORT_DIRECTORY lpImageExportDirectory = (PIMAGE_EXPORT_DIRECTORY)Image->Directories[IMAGE_DIRECTORY_ENTRY_EXPORT].Data;
+	DWORD ImageExportDirectoryRVA = Image->Directories[IMAGE_DIRECTORY_ENTRY_EXPORT].VirtualAddress;
+	DWORD ImageExportDirectorySize = Image->Directories[IMAGE_DIRECTORY_ENTRY_EXPORT].Size;
 
 	PDWORD lpAddressOfFunctions = NULL;
 	PDWORD lpAddressOfNames = NULL;
 	PWORD lpAddressOfNamesOrdinals = NULL;
 
+	INSTRUMENT_BEGIN(Call, INSTRUMENT_ENUM_EXPORTS);
 	if (ImageExportDirectoryRVA != 0)
 	{
-		lpImageExportDirectory = (PIMAGE_EXPORT_DIRECTORY)((DWORD)hMod + ImageExportDirectoryRVA);
-		lpAddressOfFunctions = (PDWORD)((DWORD)hMod + lpImageExportDirectory->AddressOfFunctions);
-		lpAddressOfNames = (PDWORD)((DWORD)hMod + lpImageExportDirectory->AddressOfNames);
-		lpAddressOfNamesOrdinals = (PWORD)((DWORD)hMod + lpImageExportDirectory->AddressOfNameOrdinals);
-
+		/* tables, ordinals and names are checked once, the loop below trusts them */
+		if (!PE32_IsTableSafe(Image, PE_TABLE_EXPORTS))
+		{
+			INSTRUMENT_MALFORMED(Call, INSTRUMENT_EVENT_BAD_EXPORTS);
+			INSTRUMENT_END(Call, 0, 0, FALSE);
+			return FALSE;
+		}
+		lpAddressOfFunctions = (PDWORD)PE32_RVAToPointer(Image, lpImageExportDirectory->AddressOfFunctions);
+		lpAddressOfNames = (PDWORD)PE32_RVAToPointer(Image, lpImageExportDirectory->AddressOfNames);
+		lpAddressOfNamesOrdinals = (PWORD)PE32_RVAToPointer(Image, lpImageExportDirectory->AddressOfNameOrdinals);
 		
-		for (unsigned int i = 0; i < lpImageExportDirectory->NumberOfNames; i++)
+		for (i = 0; i < lpImageExportDirectory->NumberOfNames; i++)
 		{
 			entry.Ordinal = lpAddressOfNamesOrdinals[i];
 			entry.RVAName = lpAddressOfNames[i];
 			entry.RVAFunction = lpAddressOfFunctions[entry.Ordinal];
-			entry.Name =  (LPCSTR)((DWORD)hMod + lpAddressOfNames[i]);
-			entry.pFunction = (PVOID)((DWORD)hMod + lpAddressOfFunctions[entry.Ordinal]);
+			entry.Name = (LPCSTR)PE32_RVAToPointer(Image, lpAddressOfNames[i]);
+			/* a function RVA inside the export directory is a forwarder string */
+			if (entry.RVAFunction - ImageExportDirectoryRVA < ImageExportDirectorySize)
+			{
+				entry.Forwarder = (LPCSTR)PE32_RVAToPointer(Image, entry.RVAFunction);
+				entry.pFunction = NULL;
+			}
+			else
+			{
+				entry.Forwarder = NULL;
+				entry.pFunction = PE32_RVAToPointer(Image, entry.RVAFunction);
+			}
 
 			if (!pCallback(&entry, UserArgs))
 			{
 				bEnumTerminated = FALSE;
+				i++;
 				break;
 			}
 		}
 	}
 	else
-		fprintf(stderr, "no image export directory\n");
+		INSTRUMENT_EVENT(INSTRUMENT_EVENT_NO_EXPORT_DIRECTORY);
+	/* name RVA, name ordinal and function RVA of each entry */
+	INSTRUMENT_END(Call, i, (ULONGLONG)i * (2 * sizeof(DWORD) + sizeof(WORD)), !bEnumTerminated);
 	return bEnumTerminated;
 }
 
-BOOL PE32_EnumRelocations(HMODULE hMod, EnumRelocationsCallback pFuncCallback, LPVOID lpUserArgs)
+BOOL PE32_EnumExports(HMODULE hMod, EnumExportsCallback pCallback, LPVOID UserArgs)
+{
+	PE_IMAGE Image;
+	if (!PE32_InitImage(&Image, hMod, 0, PE_LAYOUT_IMAGE))
+	{
+		INSTRUMENT_EVENT(INSTRUMENT_EVENT_BAD_HEADERS);
+		return FALSE;
+	}
+	return PE32_EnumExportsEx(&Image, pCallback, UserArgs);
+}
+
+BOOL PE32_EnumRelocationsEx(PPE_IMAGE Image, EnumRelocationsCallback pFuncCallback, LPVOID lpUserArgs)
 {
-	PIMAGE_NT_HEADERS32 lpNtHeader = PE32_GetNtHeaders(hMod);
 	PIMAGE_BASE_RELOCATION BaseRelocation;
 	RELOC_ENTRY Entry;
+	PBYTE Limit;
 
 	PWORD Items;
 	DWORD nItems;
-	DWORD BaseRelocDescriptorRVA = lpNtHeader->OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_BASERELOC].VirtualAddress;
+	BOOL bEnumTerminated = TRUE;
+	ULONGLONG nEntries = 0;
+	ULONGLONG nBytes = 0;
+	INSTRUMENT_DECLARE(Call);
+	DWORD BaseRelocDescriptorRVA = Image->Directories[IMAGE_DIRECTORY_ENTRY_BASERELOC].VirtualAddress;
+	INSTRUMENT_BEGIN(Call, INSTRUMENT_ENUM_RELOCATIONS);
 	if(BaseRelocDescriptorRVA != 0)
 	{	
-		BaseRelocation = (PIMAGE_BASE_RELOCATION)((DWORD)hMod + BaseRelocDescriptorRVA);
-		while(!MemIsNull(BaseRelocation, sizeof(IMAGE_BASE_RELOCATION)))
+		/* every SizeOfBlock is checked once, the loop below trusts them */
+		if (!PE32_IsTableSafe(Image, PE_TABLE_RELOCS))
+		{
+			INSTRUMENT_MALFORMED(Call, INSTRUMENT_EVENT_BAD_RELOCS);
+			INSTRUMENT_END(Call, 0, 0, FALSE);
+			return FALSE;
+		}
+		BaseRelocation = (PIMAGE_BASE_RELOCATION)Image->Directories[IMAGE_DIRECTORY_ENTRY_BASERELOC].Data;
+		Limit = (PBYTE)BaseRelocation + Image->Directories[IMAGE_DIRECTORY_ENTRY_BASERELOC].Size;
+		while(bEnumTerminated && (PBYTE)BaseRelocation + sizeof(IMAGE_BASE_RELOCATION) <= Limit && !MemIsNull(BaseRelocation, sizeof(IMAGE_BASE_RELOCATION)))
 		{ 
-			Items = (PWORD)((DWORD)BaseRelocation + sizeof(IMAGE_BASE_RELOCATION));
+			Items = (PWORD)((PBYTE)BaseRelocation + sizeof(IMAGE_BASE_RELOCATION));
 			nItems = (BaseRelocation->SizeOfBlock - sizeof(IMAGE_BASE_RELOCATION)) / sizeof(WORD);
 			Entry.BaseRelocationBlock = BaseRelocation;
 			for (unsigned int i = 0; i < nItems; i++)
 			{
 				Entry.Type = (Items[i] >> 12) & 0xF;
 				Entry.Offset = Items[i] & 0xFFF;
-				Entry.RelocationVA = (DWORD)hMod + BaseRelocation->VirtualAddress + Entry.Offset;
+				Entry.RelocationVA = (ULONG_PTR)PE32_RVAToPointer(Image, BaseRelocation->VirtualAddress + Entry.Offset);
 				if (!pFuncCallback(&Entry, lpUserArgs))
-					return FALSE;
+				{
+					nItems = i + 1;
+					bEnumTerminated = FALSE;
+					break;
+				}
 			}
-			BaseRelocation = (PIMAGE_BASE_RELOCATION)((DWORD)BaseRelocation + BaseRelocation->SizeOfBlock);
+			nEntries += nItems;
+			nBytes += BaseRelocation->SizeOfBlock;
+			BaseRelocation = (PIMAGE_BASE_RELOCATION)((PBYTE)BaseRelocation + BaseRelocation->SizeOfBlock);
 		}
 	}
-	return TRUE;
+	INSTRUMENT_END(Call, nEntries, nBytes, !bEnumTerminated);
+	return bEnumTerminated;
 }
 
-BOOL PE32_EnumImports(HMODULE hMod, EnumImportsCallback pCallback, LPVOID UserArgs)
+BOOL PE32_EnumRelocations(HMODULE hMod, EnumRelocationsCallback pFuncCallback, LPVOID lpUserArgs)
+{
+	PE_IMAGE Image;
+	if (!PE32_InitImage(&Image, hMod, 0, PE_LAYOUT_IMAGE))
+	{
+		INSTRUMENT_EVENT(INSTRUMENT_EVENT_BAD_HEADERS);
+		return FALSE;
+	}
+	return PE32_EnumRelocationsEx(&Image, pFuncCallback, lpUserArgs);
+}
+
+#ifdef PEUTILS_INSTRUMENT
+/* callback of the caller and number of imports given to it */
+typedef struct _PE_COUNTED_IMPORTS
+{
+	EnumImportsCallback pCallback;
+	LPVOID UserArgs;
+	ULONGLONG nEntries;
+}PE_COUNTED_IMPORTS,*PPE_COUNTED_IMPORTS;
+
+static BOOL PE32_CallbackCountImport(PIMPORT_ENTRY lpImportEntry, LPVOID UserArgs)
+{
+	PPE_COUNTED_IMPORTS Counted = (PPE_COUNTED_IMPORTS)UserArgs;
+	Counted->nEntries++;
+	return Counted->pCallback(lpImportEntry, Counted->UserArgs);
+}
+#endif
+
+BOOL PE32_EnumImportsEx(PPE_IMAGE Image, EnumImportsCallback pCallback, LPVOID UserArgs)
 {
-	IMPORT_ENTRY ImportEntry;
 	LPVOID Limit = 0;
 	BOOL bEnumTerminated = TRUE;
 	PIMAGE_IMPORT_DESCRIPTOR lpCurrentImportDesc = NULL;
-	PIMAGE_NT_HEADERS32 lpNtHeaders = PE32_GetNtHeaders(hMod);
-	PDWORD HintNameRVAArray = NULL;
-	PIMAGE_IMPORT_BY_NAME pImportByName = NULL;
-	PIMAGE_THUNK_DATA32 ThunkArray = NULL;
-	if (lpNtHeaders == NULL)
-		return FALSE;
 	
-	DWORD FirstImageImportDescRVA = lpNtHeaders->OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_IMPORT].VirtualAddress;
+	DWORD FirstImageImportDescRVA = Image->Directories[IMAGE_DIRECTORY_ENTRY_IMPORT].VirtualAddress;
+#ifdef PEUTILS_INSTRUMENT
+	INSTRUMENT_CALL Call;
+	PE_COUNTED_IMPORTS Counted;
+
+	/* the thunk loops are left untouched, imports are counted by a callback in between */
+	Counted.pCallback = pCallback;
+	Counted.UserArgs = UserArgs;
+	Counted.nEntries = 0;
+	pCallback = PE32_CallbackCountImport;
+	UserArgs = &Counted;
+	INSTRUMENT_BEGIN(Call, INSTRUMENT_ENUM_IMPORTS);
+#endif
 		
 	if (FirstImageImportDescRVA != 0)
 	{
-		lpCurrentImportDesc = (PIMAGE_IMPORT_DESCRIPTOR)((PBYTE)hMod + FirstImageImportDescRVA);
-		Limit = (LPVOID)(lpNtHeaders->OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_IMPORT].Size + (DWORD)lpCurrentImportDesc);
+		/* thunk arrays and names are checked once, the loop below trusts them */
+		if (!PE32_IsTableSafe(Image, PE_TABLE_IMPORTS))
+		{
+			INSTRUMENT_MALFORMED(Call, INSTRUMENT_EVENT_BAD_IMPORTS);
+			INSTRUMENT_END(Call, 0, 0, FALSE);
+			return FALSE;
+		}
+		lpCurrentImportDesc = (PIMAGE_IMPORT_DESCRIPTOR)Image->Directories[IMAGE_DIRECTORY_ENTRY_IMPORT].Data;
+		Limit = (LPVOID)((PBYTE)lpCurrentImportDesc + Image->Directories[IMAGE_DIRECTORY_ENTRY_IMPORT].Size);
 		
-		while ((LPVOID)lpCurrentImportDesc < Limit)
+		while ((LPVOID)(lpCurrentImportDesc + 1) <= Limit)
 		{
 			if (MemIsNull(lpCurrentImportDesc, sizeof(IMAGE_IMPORT_DESCRIPTOR)))
 				break;
 
-			ImportEntry.pImportDesc = lpCurrentImportDesc;
-
-			LPCSTR Name = (LPCSTR)(lpCurrentImportDesc->Name + (PBYTE)hMod);
-
-			HintNameRVAArray = (PDWORD)((DWORD)hMod + lpCurrentImportDesc->OriginalFirstThunk);
-			ThunkArray = (PIMAGE_THUNK_DATA32)((DWORD)hMod + lpCurrentImportDesc->FirstThunk);
-			
-			while (*HintNameRVAArray != 0)
+			/* thunks of the descriptor, 32 or 64 bits wide */
+			if (!Image->Traits->EnumThunks(Image, lpCurrentImportDesc, pCallback, UserArgs))
 			{
-				pImportByName = (PIMAGE_IMPORT_BY_NAME)((DWORD)hMod + *(HintNameRVAArray));
-				ImportEntry.pImportByName = pImportByName;
-				ImportEntry.Thunk =  *(ThunkArray);
-
-				if (!pCallback(&ImportEntry, UserArgs))
-				{
-					bEnumTerminated = FALSE;
-					return bEnumTerminated;
-				}
-				HintNameRVAArray += 1;
-				ThunkArray += 1;
+				bEnumTerminated = FALSE;
+				break;
 			}
 			lpCurrentImportDesc += 1; // sizeof(IMAGE_IMPORT_DESCRIPTOR);
 		}
 	}
 	else
-		fprintf(stderr, "no image import directory\n");
+		INSTRUMENT_EVENT(INSTRUMENT_EVENT_NO_IMPORT_DIRECTORY);
+#ifdef PEUTILS_INSTRUMENT
+	/* descriptors, then lookup and address thunks of each import */
+	if (lpCurrentImportDesc != NULL)
+		Call.nBytes = (ULONGLONG)(lpCurrentImportDesc - (PIMAGE_IMPORT_DESCRIPTOR)Image->Directories[IMAGE_DIRECTORY_ENTRY_IMPORT].Data + !bEnumTerminated) * sizeof(IMAGE_IMPORT_DESCRIPTOR);
+	INSTRUMENT_END(Call, Counted.nEntries, Call.nBytes + Counted.nEntries * 2 * Image->Traits->ThunkSize, !bEnumTerminated);
+#endif
 	return bEnumTerminated;
 }
 
+BOOL PE32_EnumImports(HMODULE hMod, EnumImportsCallback pCallback, LPVOID UserArgs)
+{
+	PE_IMAGE Image;
+	if (!PE32_InitImage(&Image, hMod, 0, PE_LAYOUT_IMAGE))
+	{
+		INSTRUMENT_EVENT(INSTRUMENT_EVENT_BAD_HEADERS);
+		return FALSE;
+	}
+	return PE32_EnumImportsEx(&Image, pCallback, UserArgs);
+}
+
 BOOL PE32_IsRVAPointToSection(PSECTION_ENTRY entry, LPVOID lpUserArgs)
 {
 	BOOL bContinue = TRUE;
@@ -207,10 +548,13 @@ BOOL PE32_IsRVAPointToSection(PSECTION_ENTRY entry, LPVOID lpUserArgs)
 DWORD PE32_RVAToFileOffset(HMODULE hMod, DWORD dwRVA)
 {
 	FILE_OFFSET_RVA FileOffsetRVA;
+	INSTRUMENT_DECLARE(Call);
 	FileOffsetRVA.dwRVA = dwRVA;
 	FileOffsetRVA.dwFileOffset = 0;
 
+	INSTRUMENT_BEGIN(Call, INSTRUMENT_RVA_TO_FILE_OFFSET);
 	PE32_EnumSections(hMod, PE32_IsRVAPointToSection, &FileOffsetRVA);
+	INSTRUMENT_END(Call, FileOffsetRVA.dwFileOffset != 0, 0, FALSE);
 	return FileOffsetRVA.dwFileOffset;
 }
 
@@ -229,7 +573,26 @@ BOOL PE32_CallbackSearchRelocationByRVA(PRELOC_ENTRY Reloc,PRELOC_SEARCH UserArg
 	return bContinue;
 }
 
+BOOL PE32_SearchRelocationEx(PPE_IMAGE Image, PRELOC_SEARCH SearchArgs)
+{
+	BOOL bFound;
+	INSTRUMENT_DECLARE(Call);
+
+	INSTRUMENT_BEGIN(Call, INSTRUMENT_SEARCH_RELOCATION);
+	/* the enumeration also fails on a malformed table (validated once, then cached) */
+	bFound = !PE32_EnumRelocationsEx(Image, (EnumRelocationsCallback)PE32_CallbackSearchRelocationByRVA, SearchArgs)
+		&& PE32_IsTableSafe(Image, PE_TABLE_RELOCS);
+	INSTRUMENT_END(Call, bFound, 0, FALSE);
+	return bFound;
+}
+
 BOOL PE32_SearchRelocation(HMODULE hMod, PRELOC_SEARCH SearchArgs)
 {
-	return !PE32_EnumRelocations(hMod, PE32_CallbackSearchRelocationByRVA,SearchArgs);
+	PE_IMAGE Image;
+	if (!PE32_InitImage(&Image, hMod, 0, PE_LAYOUT_IMAGE))
+	{
+		INSTRUMENT_EVENT(INSTRUMENT_EVENT_BAD_HEADERS);
+		return FALSE;
+	}
+	return PE32_SearchRelocationEx(&Image, SearchArgs);
 }
\ No newline at end of file
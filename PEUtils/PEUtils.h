@@ -8,41 +8,133 @@
 
 #pragma once
 #include "stdafx.h"
+#include "FileUtils.h"
+#include "MemUtils.h"
 
 
 #define DUMP_FIELD(FieldName,Struct) \
 	printf("%s: %x\n",#FieldName,Struct->FieldName)
 
+/**
+ * Sections are mapped at their relative virtual address (module loaded by the Windows loader)
+ */
+#define PE_LAYOUT_IMAGE 0
+/**
+ * Sections are stored at their PointerToRawData (file read from disk)
+ */
+#define PE_LAYOUT_FILE 1
+
+/**
+ * Error codes stored in PE_IMAGE.Error
+ */
+#define PE_ERROR_SUCCESS 0
+#define PE_ERROR_FILE 1              /* file couldn't be opened or mapped */
+#define PE_ERROR_DOS_HEADER 2        /* buffer too small or e_lfanew out of the buffer */
+#define PE_ERROR_NT_HEADERS 3        /* bad signature or unknown optional header magic */
+#define PE_ERROR_SECTION_TABLE 4     /* section table out of the buffer */
+#define PE_ERROR_EXPORT_DIRECTORY 5  /* export directory or one of its tables/names out of the buffer */
+#define PE_ERROR_IMPORT_DIRECTORY 6  /* import descriptor, thunk array or name out of the buffer */
+#define PE_ERROR_RELOC_DIRECTORY 7   /* relocation directory out of the buffer or bad SizeOfBlock */
+#define PE_ERROR_RESOURCE_DIRECTORY 8 /* resource directory, entry, name or data entry out of the directory, or shared directories */
+
+/**
+ * Tables checked by PE32_ValidateImage, see PE_IMAGE.SafeTables
+ */
+#define PE_TABLE_EXPORTS 0x1
+#define PE_TABLE_IMPORTS 0x2
+#define PE_TABLE_RELOCS 0x4
+#define PE_TABLE_ALL (PE_TABLE_EXPORTS | PE_TABLE_IMPORTS | PE_TABLE_RELOCS)
+
+/**
+ * \struct PE_DIRECTORY
+ * \brief data directory of an image, resolved when the image is initialized
+ * Data: pointer to the directory in the image, NULL if the directory is empty or isn't entirely backed by data
+ * For IMAGE_DIRECTORY_ENTRY_SECURITY, VirtualAddress is a file offset (data only available in file layout).
+ */
+typedef struct _PE_DIRECTORY
+{
+	DWORD VirtualAddress;
+	DWORD Size;
+	LPVOID Data;
+}PE_DIRECTORY,*PPE_DIRECTORY;
+
+/**
+ * \struct PE_IMAGE
+ * \brief describes a PE in memory, either loaded by the loader or mapped from disk
+ * Headers are validated once by PE32_InitImage/PE32_OpenFile, then every function
+ * working on the image uses the cached section table and directories.
+ * Tables are validated once, on first use or by PE32_ValidateImage (see Validate.h).
+ * Base: first byte of the image (DOS header)
+ * Size: size of the memory zone in bytes (SizeOfImage for a loaded module)
+ * Layout: PE_LAYOUT_IMAGE or PE_LAYOUT_FILE
+ * NtHeaders: PE Header (IMAGE_NT_HEADERS64 for a PE32+ image, see PE32_GetNtHeaders)
+ * Traits: functions specialized for the width of the image, chosen from OptionalHeader.Magic (see PETraits.h)
+ * SectionHeaders: section table, nSections entries
+ * Directories: data directories
+ * View: file mapping owned by the image (only set by PE32_OpenFile)
+ * Error: PE_ERROR_* code of the first malformed structure found
+ * CheckedTables: PE_TABLE_* flags of tables already validated
+ * SafeTables: PE_TABLE_* flags of validated tables which can be walked without bounds checks
+ * Arena: memory of the indexes below, released by PE32_CloseImage
+ * SectionIndex: [optional] sorted section table, see SectionIndex.h
+ * RelocIndex: [optional] relocations grouped by page, see RelocIndex.h
+ * ExportIndex: [optional] hash table of exported names, see ExportIndex.h
+ * ResourceIndex: [optional] directories of the resource tree materialized so far, see Resource.h
+ * StringNames: [optional] names of the import and export tables looked up by the string extraction, see StringScan.h
+ */
+typedef struct _PE_IMAGE
+{
+	PBYTE Base;
+	SIZE_T Size;
+	DWORD Layout;
+	PIMAGE_NT_HEADERS32 NtHeaders;
+	const struct _PE_TRAITS* Traits;
+	PIMAGE_SECTION_HEADER SectionHeaders;
+	DWORD nSections;
+	PE_DIRECTORY Directories[IMAGE_NUMBEROF_DIRECTORY_ENTRIES];
+	DWORD Error;
+	DWORD CheckedTables;
+	DWORD SafeTables;
+	FILE_VIEW View;
+	MEM_ARENA Arena;
+	struct _SECTION_INDEX* SectionIndex;
+	struct _RELOC_INDEX* RelocIndex;
+	struct _EXPORT_INDEX* ExportIndex;
+	struct _RESOURCE_INDEX* ResourceIndex;
+	struct _STRING_NAMES* StringNames;
+}PE_IMAGE,*PPE_IMAGE;
+
 /** 
  * \brief each relocation in PE header is represented by this structure
  * BaseRelocationBlock: pointer to associated IMAGE_BASE_RELOCATION header
  * Type: type  of relocation (HIGHLOW, ...)
  * Offset: Offset to page VA
- * RelocationVA: Where the base relocation is to be applied
+ * RelocationVA: Where the base relocation is to be applied (address in the mapped view, 0 if not backed by file data)
  */
 typedef struct _RELOC_ENTRY
 {
 	PIMAGE_BASE_RELOCATION BaseRelocationBlock;
 	BYTE Type;
 	WORD Offset;
-	DWORD RelocationVA;
+	ULONG_PTR RelocationVA;
 }RELOC_ENTRY,*PRELOC_ENTRY;
 
 /**
  * \brief each sections found in PE Header is represented by this structure
- * SectionData points to section in memory
+ * SectionData points to section in memory (to its raw data for a file layout image)
  * SectionLimit points to the section end in memory
  */
 typedef struct _SECTION_ENTRY
 {
 	PIMAGE_SECTION_HEADER header;
 	PBYTE SectionData;
-	DWORD SectionLimit;
+	ULONG_PTR SectionLimit;
 }SECTION_ENTRY,*PSECTION_ENTRY;
 
 /**
  * \struct EXPORT_ENTRY
  * \brief each export found in export table is represented by this structure 
+ * Forwarder: "DLL.Function" string when export is forwarded to another module (pFunction is NULL), else NULL
  */
 typedef struct _EXPORT_ENTRY
 {
@@ -51,12 +143,15 @@ typedef struct _EXPORT_ENTRY
 	DWORD RVAName;
 	LPCSTR Name;
 	PVOID pFunction;
+	LPCSTR Forwarder;
 }EXPORT_ENTRY,*PEXPORT_ENTRY;
 
 /**
  * \struct IMPORT_ENTRY
  * \brief each import found in import table is represented by this structure
  * Thunk conatains the address of imported function.
+ * Thunk64 contains the whole IAT entry (Thunk keeps its low 32 bits for a PE32+ image).
+ * pImportByName is NULL for an import by ordinal.
  * pImportDesc describe the Dll associated with the import.
  */
 typedef struct _IMPORT_ENTRY
@@ -64,6 +159,7 @@ typedef struct _IMPORT_ENTRY
 	IMAGE_THUNK_DATA32 Thunk;
 	PIMAGE_IMPORT_BY_NAME pImportByName;
 	PIMAGE_IMPORT_DESCRIPTOR pImportDesc;
+	ULONGLONG Thunk64;
 }IMPORT_ENTRY,*PIMPORT_ENTRY;
 
 
@@ -89,7 +185,7 @@ typedef struct _SEARCH_RELOC
 	DWORD RVA;
 	BYTE Type;
 	WORD Offset;
-	DWORD RelocationVA;
+	ULONG_PTR RelocationVA;
 	IMAGE_BASE_RELOCATION BaseRelocationBlock;
 }RELOC_SEARCH,*PRELOC_SEARCH;
 
@@ -114,11 +210,35 @@ typedef BOOL(*EnumRelocationsCallback)(PRELOC_ENTRY lpRelocEntry, LPVOID UserArg
 /**
  * \fn PIMAGE_NT_HEADERS32 PE32_GetNtHeaders(HMODULE hMod);
  * \brief obtains address of PE Header in memory from a DOS Header
+ * For a PE32+ image, the header is an IMAGE_NT_HEADERS64: only FileHeader and the optional
+ * header fields from Magic to AddressOfEntryPoint and from SectionAlignment to DllCharacteristics
+ * have the same offsets in both widths, use Image->Traits for the others.
  * \param hMod: module image base
- * \return the PE Header address. NULL if PE Header has invalid signature or is not a 32 bits header
+ * \return the PE Header address. NULL if PE Header has invalid signature or an unknown optional header magic
  */
 PIMAGE_NT_HEADERS32 PE32_GetNtHeaders(HMODULE hMod);
 
+/**
+ * \fn DWORD PE32_ComputeChecksum(LPVOID Buffer, SIZE_T Size);
+ * \brief compute the checksum of a PE file as stored in OptionalHeader.CheckSum
+ * 16 bits words of the file, the CheckSum field excluded, are summed with SSE2 or AVX2
+ * when available, carries are folded once at the end and the file size is added.
+ * \param Buffer: content of the file (PE_LAYOUT_FILE)
+ * \param Size: size of the file in bytes
+ * \return the checksum, 0 if the buffer doesn't hold valid headers
+ */
+DWORD PE32_ComputeChecksum(LPVOID Buffer, SIZE_T Size);
+
+/**
+ * \fn BOOL PE32_VerifyChecksum(LPVOID Buffer, SIZE_T Size, PDWORD lpComputed);
+ * \brief compare the checksum of a PE file with OptionalHeader.CheckSum
+ * \param Buffer: content of the file (PE_LAYOUT_FILE)
+ * \param Size: size of the file in bytes
+ * \param lpComputed: [out, optional] computed checksum
+ * \return TRUE if the checksums are equal, FALSE if they differ, if CheckSum is 0 (not set) or if the headers are invalid
+ */
+BOOL PE32_VerifyChecksum(LPVOID Buffer, SIZE_T Size, PDWORD lpComputed);
+
 /**
  * \fn BOOL PE32_EnumExports(HMODULE hMod, EnumExportsCallback pFuncCallback, LPVOID UserArgs);
  * \brief enumerate exports from a given module image base
@@ -195,4 +315,87 @@ BOOL PE32_CallbackSearchRelocationByRVA(PRELOC_ENTRY Reloc, PRELOC_SEARCH UserAr
  *   - [out] search result
  * \return FALSE if relocation couldn't be found
  */
-BOOL PE32_SearchRelocation(HMODULE hMod, PRELOC_SEARCH SearchArgs);
\ No newline at end of file
+BOOL PE32_SearchRelocation(HMODULE hMod, PRELOC_SEARCH SearchArgs);
+
+/**
+ * \fn BOOL PE32_InitImage(PPE_IMAGE Image, LPVOID Base, SIZE_T Size, DWORD Layout);
+ * \brief describe a PE already present in memory
+ * Headers and section table are validated, directories are resolved.
+ * The image must be released with PE32_CloseImage.
+ * \param Image: [out] image description
+ * \param Base: first byte of the PE (module image base or start of a file buffer)
+ * \param Size: size of the buffer in bytes, 0 if unknown (SizeOfImage is used for PE_LAYOUT_IMAGE)
+ * \param Layout: PE_LAYOUT_IMAGE or PE_LAYOUT_FILE
+ * \return FALSE if PE Header is invalid, Image->Error gives the reason
+ */
+BOOL PE32_InitImage(PPE_IMAGE Image, LPVOID Base, SIZE_T Size, DWORD Layout);
+
+/**
+ * \fn BOOL PE32_OpenFile(LPCSTR Path, PPE_IMAGE Image);
+ * \brief map a PE file from disk (read-only, without copy) as a PE_LAYOUT_FILE image
+ * \param Path: path of the PE file
+ * \param Image: [out] image description, must be released with PE32_CloseImage
+ * \return FALSE if file couldn't be mapped or isn't a valid PE, Image->Error gives the reason
+ */
+BOOL PE32_OpenFile(LPCSTR Path, PPE_IMAGE Image);
+
+/**
+ * \fn VOID PE32_CloseImage(PPE_IMAGE Image);
+ * \brief release resources owned by an image (indexes, file mapping)
+ * \param Image: image description
+ */
+VOID PE32_CloseImage(PPE_IMAGE Image);
+
+/**
+ * \fn LPVOID PE32_RVAToPointer(PPE_IMAGE Image, DWORD dwRVA);
+ * \brief convert a relative virtual address to a pointer in the image memory
+ * For a file layout image, the RVA is translated through the section table
+ * (through the section index when it has been built by PE32_BuildSectionIndex).
+ * \param Image: image description
+ * \param dwRVA: relative virtual address from module image base
+ * \return pointer to the data, NULL if RVA isn't backed by data
+ */
+LPVOID PE32_RVAToPointer(PPE_IMAGE Image, DWORD dwRVA);
+
+/**
+ * \fn LPVOID PE32_RVAToPointerRange(PPE_IMAGE Image, DWORD dwRVA, ULONGLONG Size);
+ * \brief same as PE32_RVAToPointer, checking that Size bytes can be read from the pointer
+ * \param Image: image description
+ * \param dwRVA: relative virtual address from module image base
+ * \param Size: size of the data in bytes
+ * \return pointer to the data, NULL if the data isn't entirely inside the image buffer
+ */
+LPVOID PE32_RVAToPointerRange(PPE_IMAGE Image, DWORD dwRVA, ULONGLONG Size);
+
+/**
+ * \fn BOOL PE32_EnumSectionsEx(PPE_IMAGE Image, EnumSectionsCallback pFuncCallback, LPVOID lpUserArgs);
+ * \brief same as PE32_EnumSections for any image layout
+ */
+BOOL PE32_EnumSectionsEx(PPE_IMAGE Image, EnumSectionsCallback pFuncCallback, LPVOID lpUserArgs);
+
+/**
+ * \fn BOOL PE32_EnumExportsEx(PPE_IMAGE Image, EnumExportsCallback pFuncCallback, LPVOID UserArgs);
+ * \brief same as PE32_EnumExports for any image layout
+ * \return FALSE if the export table is malformed (see PE32_ValidateImage) or enumeration was stopped
+ */
+BOOL PE32_EnumExportsEx(PPE_IMAGE Image, EnumExportsCallback pFuncCallback, LPVOID UserArgs);
+
+/**
+ * \fn BOOL PE32_EnumImportsEx(PPE_IMAGE Image, EnumImportsCallback pFuncCallback, LPVOID UserArgs);
+ * \brief same as PE32_EnumImports for any image layout
+ * \return FALSE if the import table is malformed (see PE32_ValidateImage) or enumeration was stopped
+ */
+BOOL PE32_EnumImportsEx(PPE_IMAGE Image, EnumImportsCallback pFuncCallback, LPVOID UserArgs);
+
+/**
+ * \fn BOOL PE32_EnumRelocationsEx(PPE_IMAGE Image, EnumRelocationsCallback pFuncCallback, LPVOID lpUserArgs);
+ * \brief same as PE32_EnumRelocations for any image layout
+ * \return FALSE if the relocation table is malformed (see PE32_ValidateImage) or enumeration was stopped
+ */
+BOOL PE32_EnumRelocationsEx(PPE_IMAGE Image, EnumRelocationsCallback pFuncCallback, LPVOID lpUserArgs);
+
+/**
+ * \fn BOOL PE32_SearchRelocationEx(PPE_IMAGE Image, PRELOC_SEARCH SearchArgs);
+ * \brief same as PE32_SearchRelocation for any image layout
+ */
+BOOL PE32_SearchRelocationEx(PPE_IMAGE Image, PRELOC_SEARCH SearchArgs);
\ No newline at end of file
@@ -0,0 +1,489 @@
+/**
+ * \file Rebase.c
+ * \brief Defines function described in file Rebase.h
+ * \author Tomtombinary
+ * \version 1.0
+ * \date 17 octobre 2026
+ */
+
+#include "stdafx.h"
+#include "Rebase.h"
+#include "CpuUtils.h"
+#include "MemUtils.h"
+#include "ThreadUtils.h"
+#include "Validate.h"
+#include "PETraits.h"
+
+#define REBASE_PAGE_SIZE 0x1000
+/* the last slot of a page may overflow on the next one */
+#define REBASE_PAGE_SPAN (REBASE_PAGE_SIZE + sizeof(ULONGLONG))
+/* shorter runs of adjacent slots are patched one by one */
+#define REBASE_MIN_RUN 4
+/* below this number of relocations per thread, threads cost more than they save */
+#define REBASE_MIN_FIXUPS_PER_THREAD 0x10000
+
+typedef VOID(*RebaseAddRoutine)(PBYTE Slots, DWORD nSlots, ULONGLONG Delta);
+
+/* block header copied before patching: a slot may be inside the relocation table */
+typedef struct _REBASE_BLOCK
+{
+	DWORD VirtualAddress;
+	DWORD nItems;
+	PWORD Items;
+	/* RVA range of the slots, computed to share blocks between threads */
+	DWORD Start;
+	DWORD End;
+}REBASE_BLOCK,*PREBASE_BLOCK;
+
+typedef struct _REBASE_CONTEXT
+{
+	PPE_IMAGE Image;
+	ULONGLONG Delta;
+	PREBASE_BLOCK Blocks;
+	DWORD nBlocks;
+	ULONGLONG nItems;
+	RebaseAddRoutine AddDwords;
+	RebaseAddRoutine AddQwords;
+}REBASE_CONTEXT,*PREBASE_CONTEXT;
+
+typedef struct _REBASE_WORKER
+{
+	PREBASE_CONTEXT Context;
+	DWORD First;
+	DWORD Last;
+	BOOL bDense;
+	REBASE_STATS Stats;
+	THREAD_HANDLE Thread;
+}REBASE_WORKER,*PREBASE_WORKER;
+
+static VOID Rebase_AddDwords_Scalar(PBYTE Slots, DWORD nSlots, ULONGLONG Delta)
+{
+	DWORD Value;
+
+	for (DWORD i = 0; i < nSlots; i++, Slots += sizeof(DWORD))
+	{
+		memcpy(&Value, Slots, sizeof(DWORD));
+		Value += (DWORD)Delta;
+		memcpy(Slots, &Value, sizeof(DWORD));
+	}
+}
+
+static VOID Rebase_AddQwords_Scalar(PBYTE Slots, DWORD nSlots, ULONGLONG Delta)
+{
+	ULONGLONG Value;
+
+	for (DWORD i = 0; i < nSlots; i++, Slots += sizeof(ULONGLONG))
+	{
+		memcpy(&Value, Slots, sizeof(ULONGLONG));
+		Value += Delta;
+		memcpy(Slots, &Value, sizeof(ULONGLONG));
+	}
+}
+
+#ifdef CPU_X86
+CPU_TARGET("sse2") static VOID Rebase_AddDwords_SSE2(PBYTE Slots, DWORD nSlots, ULONGLONG Delta)
+{
+	__m128i vDelta = _mm_set1_epi32((int)(DWORD)Delta);
+	DWORD i;
+
+	for (i = 0; i + 4 <= nSlots; i += 4, Slots += 4 * sizeof(DWORD))
+		_mm_storeu_si128((__m128i*)Slots, _mm_add_epi32(_mm_loadu_si128((const __m128i*)Slots), vDelta));
+	Rebase_AddDwords_Scalar(Slots, nSlots - i, Delta);
+}
+
+CPU_TARGET("avx2") static VOID Rebase_AddDwords_AVX2(PBYTE Slots, DWORD nSlots, ULONGLONG Delta)
+{
+	__m256i vDelta = _mm256_set1_epi32((int)(DWORD)Delta);
+	DWORD i;
+
+	for (i = 0; i + 8 <= nSlots; i += 8, Slots += 8 * sizeof(DWORD))
+		_mm256_storeu_si256((__m256i*)Slots, _mm256_add_epi32(_mm256_loadu_si256((const __m256i*)Slots), vDelta));
+	Rebase_AddDwords_SSE2(Slots, nSlots - i, Delta);
+}
+
+CPU_TARGET("sse2") static VOID Rebase_AddQwords_SSE2(PBYTE Slots, DWORD nSlots, ULONGLONG Delta)
+{
+	__m128i vDelta = _mm_set1_epi64x((long long)Delta);
+	DWORD i;
+
+	for (i = 0; i + 2 <= nSlots; i += 2, Slots += 2 * sizeof(ULONGLONG))
+		_mm_storeu_si128((__m128i*)Slots, _mm_add_epi64(_mm_loadu_si128((const __m128i*)Slots), vDelta));
+	Rebase_AddQwords_Scalar(Slots, nSlots - i, Delta);
+}
+
+CPU_TARGET("avx2") static VOID Rebase_AddQwords_AVX2(PBYTE Slots, DWORD nSlots, ULONGLONG Delta)
+{
+	__m256i vDelta = _mm256_set1_epi64x((long long)Delta);
+	DWORD i;
+
+	for (i = 0; i + 4 <= nSlots; i += 4, Slots += 4 * sizeof(ULONGLONG))
+		_mm256_storeu_si256((__m256i*)Slots, _mm256_add_epi64(_mm256_loadu_si256((const __m256i*)Slots), vDelta));
+	Rebase_AddQwords_SSE2(Slots, nSlots - i, Delta);
+}
+#endif
+
+static DWORD Rebase_SlotSize(BYTE Type)
+{
+	switch (Type)
+	{
+	case IMAGE_REL_BASED_HIGH:
+	case IMAGE_REL_BASED_LOW:
+	case IMAGE_REL_BASED_HIGHADJ:
+		return sizeof(WORD);
+	case IMAGE_REL_BASED_HIGHLOW:
+		return sizeof(DWORD);
+	case IMAGE_REL_BASED_DIR64:
+		return sizeof(ULONGLONG);
+	default:
+		return 0;
+	}
+}
+
+/* apply one relocation, Param is the entry following a HIGHADJ one */
+static BOOL Rebase_ApplyEntry(PPE_IMAGE Image, DWORD dwRVA, BYTE Type, WORD Param, ULONGLONG Delta)
+{
+	DWORD dwSize = Rebase_SlotSize(Type);
+	PBYTE lpSlot;
+	WORD wValue;
+	DWORD dwValue;
+
+	if (dwSize == 0)
+		return FALSE;
+	lpSlot = (PBYTE)PE32_RVAToPointerRange(Image, dwRVA, dwSize);
+	if (lpSlot == NULL)
+		return FALSE;
+
+	switch (Type)
+	{
+	case IMAGE_REL_BASED_HIGH:
+		memcpy(&wValue, lpSlot, sizeof(WORD));
+		wValue += (WORD)(Delta >> 16);
+		memcpy(lpSlot, &wValue, sizeof(WORD));
+		break;
+	case IMAGE_REL_BASED_LOW:
+		memcpy(&wValue, lpSlot, sizeof(WORD));
+		wValue += (WORD)Delta;
+		memcpy(lpSlot, &wValue, sizeof(WORD));
+		break;
+	case IMAGE_REL_BASED_HIGHADJ:
+		/* high half of a 32 bits value whose low half is in the next entry, rounded */
+		memcpy(&wValue, lpSlot, sizeof(WORD));
+		dwValue = ((DWORD)wValue << 16) + (DWORD)(LONG)(SHORT)Param + (DWORD)Delta + 0x8000;
+		wValue = (WORD)(dwValue >> 16);
+		memcpy(lpSlot, &wValue, sizeof(WORD));
+		break;
+	case IMAGE_REL_BASED_HIGHLOW:
+		Rebase_AddDwords_Scalar(lpSlot, 1, Delta);
+		break;
+	case IMAGE_REL_BASED_DIR64:
+		Rebase_AddQwords_Scalar(lpSlot, 1, Delta);
+		break;
+	}
+	return TRUE;
+}
+
+static VOID Rebase_ApplyBlock(PREBASE_CONTEXT Context, PREBASE_BLOCK Block, BOOL bDense, PREBASE_STATS Stats)
+{
+	PPE_IMAGE Image = Context->Image;
+	PBYTE lpPage = NULL;
+	PWORD Items = Block->Items;
+	DWORD i, n, dwOffset, dwSize;
+	BYTE Type;
+
+	/* runs are patched in place only when the whole page is inside the buffer */
+	if (bDense && Image->Layout == PE_LAYOUT_IMAGE && Block->VirtualAddress < Image->Size && Image->Size - Block->VirtualAddress >= REBASE_PAGE_SPAN)
+		lpPage = Image->Base + Block->VirtualAddress;
+
+	for (i = 0; i < Block->nItems; i += n)
+	{
+		Type = (BYTE)(Items[i] >> 12);
+		dwOffset = Items[i] & 0xFFF;
+		n = 1;
+		if (Type == IMAGE_REL_BASED_ABSOLUTE)
+			continue;
+
+		if (lpPage != NULL && (Type == IMAGE_REL_BASED_HIGHLOW || Type == IMAGE_REL_BASED_DIR64))
+		{
+			dwSize = Rebase_SlotSize(Type);
+			while (i + n < Block->nItems && (Items[i + n] >> 12) == Type && (DWORD)(Items[i + n] & 0xFFF) == dwOffset + n * dwSize)
+				n++;
+			if (n >= REBASE_MIN_RUN)
+			{
+				if (Type == IMAGE_REL_BASED_HIGHLOW)
+					Context->AddDwords(lpPage + dwOffset, n, Context->Delta);
+				else
+					Context->AddQwords(lpPage + dwOffset, n, Context->Delta);
+				Stats->nDenseFixups += n;
+			}
+			else if (Type == IMAGE_REL_BASED_HIGHLOW)
+				Rebase_AddDwords_Scalar(lpPage + dwOffset, n, Context->Delta);
+			else
+				Rebase_AddQwords_Scalar(lpPage + dwOffset, n, Context->Delta);
+			Stats->nFixups += n;
+			continue;
+		}
+
+		if (Type == IMAGE_REL_BASED_HIGHADJ)
+		{
+			if (i + 1 >= Block->nItems)
+			{
+				Stats->nSkipped++;
+				continue;
+			}
+			n = 2;
+		}
+		if (Rebase_ApplyEntry(Image, Block->VirtualAddress + dwOffset, Type, n == 2 ? Items[i + 1] : 0, Context->Delta))
+			Stats->nFixups++;
+		else
+			Stats->nSkipped++;
+	}
+}
+
+/* copy block headers of a validated table */
+static BOOL Rebase_CollectBlocks(PREBASE_CONTEXT Context)
+{
+	PPE_DIRECTORY lpDirectory = &Context->Image->Directories[IMAGE_DIRECTORY_ENTRY_BASERELOC];
+	PIMAGE_BASE_RELOCATION BaseRelocation = (PIMAGE_BASE_RELOCATION)lpDirectory->Data;
+	PBYTE Limit = (PBYTE)BaseRelocation + lpDirectory->Size;
+	PREBASE_BLOCK Block;
+
+	Context->nBlocks = 0;
+	Context->nItems = 0;
+	Context->Blocks = (PREBASE_BLOCK)malloc((lpDirectory->Size / sizeof(IMAGE_BASE_RELOCATION) + 1) * sizeof(REBASE_BLOCK));
+	if (Context->Blocks == NULL)
+		return FALSE;
+	while ((PBYTE)BaseRelocation + sizeof(IMAGE_BASE_RELOCATION) <= Limit && !MemIsNull(BaseRelocation, sizeof(IMAGE_BASE_RELOCATION)))
+	{
+		Block = &Context->Blocks[Context->nBlocks++];
+		Block->VirtualAddress = BaseRelocation->VirtualAddress;
+		Block->Items = (PWORD)((PBYTE)BaseRelocation + sizeof(IMAGE_BASE_RELOCATION));
+		Block->nItems = (BaseRelocation->SizeOfBlock - sizeof(IMAGE_BASE_RELOCATION)) / sizeof(WORD);
+		Context->nItems += Block->nItems;
+		BaseRelocation = (PIMAGE_BASE_RELOCATION)((PBYTE)BaseRelocation + BaseRelocation->SizeOfBlock);
+	}
+	return TRUE;
+}
+
+/*
+ * split blocks in nThreads ranges of about the same number of relocations,
+ * a range ends only where all its slots are below the slots of the next ones
+ */
+static DWORD Rebase_SplitBlocks(PREBASE_CONTEXT Context, DWORD nThreads, PDWORD Cuts)
+{
+	PREBASE_BLOCK Block;
+	PDWORD SuffixStart;
+	DWORD dwSlot, dwEnd, PrefixEnd = 0;
+	ULONGLONG nDone = 0;
+	DWORD nRanges = 1;
+	DWORD i, j;
+
+	SuffixStart = (PDWORD)malloc((Context->nBlocks + 1) * sizeof(DWORD));
+	if (SuffixStart == NULL)
+		return 1;
+
+	for (i = 0; i < Context->nBlocks; i++)
+	{
+		Block = &Context->Blocks[i];
+		Block->Start = 0xFFFFFFFF;
+		Block->End = 0;
+		for (j = 0; j < Block->nItems; j++)
+		{
+			dwSlot = Block->VirtualAddress + (Block->Items[j] & 0xFFF);
+			dwEnd = dwSlot + Rebase_SlotSize((BYTE)(Block->Items[j] >> 12));
+			if (dwEnd == dwSlot)
+				continue;
+			/* a slot wrapping around 4 GB can't be ordered, keep the block alone */
+			if (dwEnd < dwSlot)
+				dwEnd = 0xFFFFFFFF;
+			if (dwSlot < Block->Start)
+				Block->Start = dwSlot;
+			if (dwEnd > Block->End)
+				Block->End = dwEnd;
+		}
+	}
+	SuffixStart[Context->nBlocks] = 0xFFFFFFFF;
+	for (i = Context->nBlocks; i > 0; i--)
+		SuffixStart[i - 1] = Context->Blocks[i - 1].Start < SuffixStart[i] ? Context->Blocks[i - 1].Start : SuffixStart[i];
+
+	Cuts[0] = 0;
+	for (i = 0; i < Context->nBlocks && nRanges < nThreads; i++)
+	{
+		Block = &Context->Blocks[i];
+		if (Block->End > PrefixEnd)
+			PrefixEnd = Block->End;
+		nDone += Block->nItems;
+		if (nDone * nThreads >= Context->nItems * nRanges && PrefixEnd <= SuffixStart[i + 1] && i + 1 < Context->nBlocks)
+			Cuts[nRanges++] = i + 1;
+	}
+	Cuts[nRanges] = Context->nBlocks;
+	free(SuffixStart);
+	return nRanges;
+}
+
+static VOID Rebase_Worker(LPVOID UserArgs)
+{
+	PREBASE_WORKER Worker = (PREBASE_WORKER)UserArgs;
+
+	for (DWORD i = Worker->First; i < Worker->Last; i++)
+		Rebase_ApplyBlock(Worker->Context, &Worker->Context->Blocks[i], Worker->bDense, &Worker->Stats);
+}
+
+/* apply all blocks, Stats receives the sum of the counters of the threads */
+static BOOL Rebase_Apply(PREBASE_CONTEXT Context, DWORD nThreads, BOOL bDense, PREBASE_STATS Stats)
+{
+	PREBASE_WORKER Workers;
+	PDWORD Cuts;
+	DWORD nWorkers = 1;
+	DWORD nStarted, i;
+
+	/* blocks of a file layout may alias each other through overlapping sections */
+	if (Context->Image->Layout != PE_LAYOUT_IMAGE || nThreads == 0)
+		nThreads = 1;
+	if (nThreads > 1 + Context->nItems / REBASE_MIN_FIXUPS_PER_THREAD)
+		nThreads = (DWORD)(1 + Context->nItems / REBASE_MIN_FIXUPS_PER_THREAD);
+
+	Workers = (PREBASE_WORKER)calloc(nThreads, sizeof(REBASE_WORKER));
+	Cuts = (PDWORD)malloc((nThreads + 1) * sizeof(DWORD));
+	if (Workers == NULL || Cuts == NULL)
+	{
+		free(Workers);
+		free(Cuts);
+		return FALSE;
+	}
+	if (nThreads > 1)
+		nWorkers = Rebase_SplitBlocks(Context, nThreads, Cuts);
+	else
+	{
+		Cuts[0] = 0;
+		Cuts[1] = Context->nBlocks;
+	}
+
+	for (i = 0; i < nWorkers; i++)
+	{
+		Workers[i].Context = Context;
+		Workers[i].First = Cuts[i];
+		Workers[i].Last = Cuts[i + 1];
+		Workers[i].bDense = bDense;
+	}
+	/* the calling thread is worker 0, ranges of threads which couldn't start are applied by it */
+	for (nStarted = 1; nStarted < nWorkers; nStarted++)
+	{
+		if (!ThreadUtils_CreateThread(&Workers[nStarted].Thread, Rebase_Worker, &Workers[nStarted]))
+			break;
+	}
+	Rebase_Worker(&Workers[0]);
+	for (i = nStarted; i < nWorkers; i++)
+		Rebase_Worker(&Workers[i]);
+	for (i = 1; i < nStarted; i++)
+		ThreadUtils_JoinThread(&Workers[i].Thread);
+
+	Stats->nBlocks += Context->nBlocks;
+	Stats->nThreads = nStarted;
+	for (i = 0; i < nWorkers; i++)
+	{
+		Stats->nFixups += Workers[i].Stats.nFixups;
+		Stats->nDenseFixups += Workers[i].Stats.nDenseFixups;
+		Stats->nSkipped += Workers[i].Stats.nSkipped;
+	}
+	free(Workers);
+	free(Cuts);
+	return TRUE;
+}
+
+static BOOL Rebase_InitContext(PREBASE_CONTEXT Context, PPE_IMAGE Image, ULONGLONG Delta)
+{
+#ifdef CPU_X86
+	DWORD Features = CpuUtils_GetFeatures();
+#endif
+
+	memset(Context, 0, sizeof(REBASE_CONTEXT));
+	Context->Image = Image;
+	Context->Delta = Delta;
+	Context->AddDwords = Rebase_AddDwords_Scalar;
+	Context->AddQwords = Rebase_AddQwords_Scalar;
+#ifdef CPU_X86
+	if (Features & CPU_FEATURE_AVX2)
+	{
+		Context->AddDwords = Rebase_AddDwords_AVX2;
+		Context->AddQwords = Rebase_AddQwords_AVX2;
+	}
+	else if (Features & CPU_FEATURE_SSE2)
+	{
+		Context->AddDwords = Rebase_AddDwords_SSE2;
+		Context->AddQwords = Rebase_AddQwords_SSE2;
+	}
+#endif
+	return Rebase_CollectBlocks(Context);
+}
+
+/* plain rebase of a copy of the image, one entry at a time */
+static PBYTE Rebase_Reference(PPE_IMAGE Image, ULONGLONG NewBase, ULONGLONG Delta)
+{
+	REBASE_CONTEXT Context;
+	REBASE_STATS Stats;
+	PE_IMAGE Reference;
+	PBYTE lpCopy;
+
+	lpCopy = (PBYTE)malloc(Image->Size);
+	if (lpCopy == NULL)
+		return NULL;
+	memcpy(lpCopy, Image->Base, Image->Size);
+	memset(&Stats, 0, sizeof(REBASE_STATS));
+	if (!PE32_InitImage(&Reference, lpCopy, Image->Size, Image->Layout)
+		|| !PE32_IsTableSafe(&Reference, PE_TABLE_RELOCS)
+		|| !Rebase_InitContext(&Context, &Reference, Delta))
+	{
+		PE32_CloseImage(&Reference);
+		free(lpCopy);
+		return NULL;
+	}
+	Rebase_Apply(&Context, 1, FALSE, &Stats);
+	Reference.Traits->SetImageBase(&Reference, NewBase);
+	free(Context.Blocks);
+	PE32_CloseImage(&Reference);
+	return lpCopy;
+}
+
+BOOL PE32_RebaseImage(PPE_IMAGE Image, ULONGLONG NewBase, DWORD nThreads, DWORD Flags, PREBASE_STATS Stats)
+{
+	REBASE_CONTEXT Context;
+	REBASE_STATS LocalStats;
+	PBYTE lpReference = NULL;
+	ULONGLONG Delta;
+	BOOL bSuccess;
+
+	if (Stats == NULL)
+		Stats = &LocalStats;
+	memset(Stats, 0, sizeof(REBASE_STATS));
+
+	Delta = NewBase - Image->Traits->GetImageBase(Image);
+	if (Delta == 0)
+		return TRUE;
+	if (NewBase > Image->Traits->MaxImageBase || (Image->NtHeaders->FileHeader.Characteristics & IMAGE_FILE_RELOCS_STRIPPED))
+		return FALSE;
+	if (Image->Directories[IMAGE_DIRECTORY_ENTRY_BASERELOC].VirtualAddress == 0 || !PE32_IsTableSafe(Image, PE_TABLE_RELOCS))
+		return FALSE;
+
+	if (Flags & REBASE_FLAG_VERIFY)
+	{
+		lpReference = Rebase_Reference(Image, NewBase, Delta);
+		if (lpReference == NULL)
+			return FALSE;
+	}
+
+	bSuccess = Rebase_InitContext(&Context, Image, Delta) && Rebase_Apply(&Context, nThreads, TRUE, Stats);
+	free(Context.Blocks);
+	if (bSuccess)
+		Image->Traits->SetImageBase(Image, NewBase);
+
+	if (lpReference != NULL)
+	{
+		for (SIZE_T i = 0; i < Image->Size; i++)
+		{
+			if (Image->Base[i] != lpReference[i])
+				Stats->nMismatches++;
+		}
+		free(lpReference);
+	}
+	return bSuccess && Stats->nSkipped == 0 && Stats->nMismatches == 0;
+}
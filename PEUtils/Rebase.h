@@ -0,0 +1,53 @@
+/**
+ * \file Rebase.h
+ * \brief Application of base relocations to move an image to a new base
+ * \author Tomtombinary
+ * \version 1.0
+ * \date 17 octobre 2026
+ * Blocks are applied as batches: in a mapped image (PE_LAYOUT_IMAGE), runs
+ * of adjacent HIGHLOW or DIR64 slots (pointer tables, vtables) are patched
+ * with SSE2/AVX2 additions, other entries one by one. Blocks of very large
+ * tables can be shared between threads when their slots don't overlap.
+ */
+
+#pragma once
+#include "stdafx.h"
+#include "PEUtils.h"
+
+/**
+ * verify the result against a plain rebase of a copy of the image (one entry at a time, one thread)
+ */
+#define REBASE_FLAG_VERIFY 0x1
+
+/**
+ * \struct REBASE_STATS
+ * \brief counters of a rebase
+ * nBlocks: relocation blocks
+ * nFixups: relocations applied
+ * nDenseFixups: relocations applied as runs of adjacent slots
+ * nSkipped: relocations of an unknown type or whose slot is outside the image
+ * nThreads: threads used
+ * nMismatches: bytes which differ from the reference rebase (REBASE_FLAG_VERIFY)
+ */
+typedef struct _REBASE_STATS
+{
+	DWORD nBlocks;
+	ULONGLONG nFixups;
+	ULONGLONG nDenseFixups;
+	ULONGLONG nSkipped;
+	DWORD nThreads;
+	ULONGLONG nMismatches;
+}REBASE_STATS,*PREBASE_STATS;
+
+/**
+ * \fn BOOL PE32_RebaseImage(PPE_IMAGE Image, ULONGLONG NewBase, DWORD nThreads, DWORD Flags, PREBASE_STATS Stats);
+ * \brief apply the relocations of an image for a new base address, and update OptionalHeader.ImageBase
+ * The image buffer must be writable. Nothing is done when the base doesn't change.
+ * \param Image: image description
+ * \param NewBase: new base address (at most 0xFFFFFFFF for a PE32 image)
+ * \param nThreads: maximum number of threads (0 or 1 to stay on the calling thread), only used for mapped images with large tables
+ * \param Flags: REBASE_FLAG_* flags
+ * \param Stats: [out, optional] counters
+ * \return FALSE if the relocation table is missing or malformed, a relocation was skipped or the verification failed
+ */
+BOOL PE32_RebaseImage(PPE_IMAGE Image, ULONGLONG NewBase, DWORD nThreads, DWORD Flags, PREBASE_STATS Stats);
@@ -0,0 +1,254 @@
+/**
+ * \file RelocIndex.c
+ * \brief Defines function described in file RelocIndex.h
+ * \author Tomtombinary
+ * \version 1.0
+ * \date 17 octobre 2026
+ */
+
+#include "stdafx.h"
+#include "RelocIndex.h"
+#include "MemUtils.h"
+#include "Validate.h"
+
+#define RELOC_PAGE_MASK 0xFFFFF000
+
+static int RelocIndex_CompareQword(const void* a, const void* b)
+{
+	ULONGLONG x = *(const ULONGLONG*)a;
+	ULONGLONG y = *(const ULONGLONG*)b;
+	return (x > y) - (x < y);
+}
+
+/* index of the first page >= dwPage */
+static DWORD RelocIndex_LowerPage(PRELOC_INDEX Index, DWORD dwPage)
+{
+	DWORD Low = 0;
+	DWORD High = Index->nPages;
+	DWORD Middle;
+
+	while (Low < High)
+	{
+		Middle = (Low + High) / 2;
+		if (Index->PageStarts[Middle] < dwPage)
+			Low = Middle + 1;
+		else
+			High = Middle;
+	}
+	return Low;
+}
+
+/* index of the first entry of a page with offset >= wOffset */
+static DWORD RelocIndex_LowerOffset(PRELOC_INDEX Index, DWORD dwPage, WORD wOffset)
+{
+	DWORD Low = Index->PageFirst[dwPage];
+	DWORD High = Index->PageFirst[dwPage + 1];
+	DWORD Middle;
+
+	while (Low < High)
+	{
+		Middle = (Low + High) / 2;
+		if (Index->Offsets[Middle] < wOffset)
+			Low = Middle + 1;
+		else
+			High = Middle;
+	}
+	return Low;
+}
+
+BOOL PE32_BuildRelocIndex(PPE_IMAGE Image)
+{
+	PRELOC_INDEX Index;
+	PIMAGE_BASE_RELOCATION BaseRelocation;
+	PBYTE Limit;
+	PWORD Items;
+	PULONGLONG Keys;
+	DWORD nItems, nKeys, nMaxKeys, i;
+	BOOL bSorted = TRUE;
+	PPE_DIRECTORY lpDirectory = &Image->Directories[IMAGE_DIRECTORY_ENTRY_BASERELOC];
+
+	if (Image->RelocIndex != NULL)
+		return TRUE;
+	if (!PE32_IsTableSafe(Image, PE_TABLE_RELOCS))
+		return FALSE;
+
+	/* a relocation entry takes 2 bytes in the directory */
+	nMaxKeys = lpDirectory->Size / sizeof(WORD);
+	Keys = (PULONGLONG)malloc((nMaxKeys + 1) * sizeof(ULONGLONG));
+	if (Keys == NULL)
+		return FALSE;
+
+	/* collect (RVA, Type) keys of all relocations */
+	nKeys = 0;
+	BaseRelocation = (PIMAGE_BASE_RELOCATION)lpDirectory->Data;
+	if (BaseRelocation != NULL)
+	{
+		Limit = (PBYTE)BaseRelocation + lpDirectory->Size;
+		while ((PBYTE)BaseRelocation + sizeof(IMAGE_BASE_RELOCATION) <= Limit && !MemIsNull(BaseRelocation, sizeof(IMAGE_BASE_RELOCATION)))
+		{
+			Items = (PWORD)((PBYTE)BaseRelocation + sizeof(IMAGE_BASE_RELOCATION));
+			nItems = (BaseRelocation->SizeOfBlock - sizeof(IMAGE_BASE_RELOCATION)) / sizeof(WORD);
+			for (i = 0; i < nItems; i++)
+			{
+				BYTE Type = (Items[i] >> 12) & 0xF;
+				DWORD dwRVA = BaseRelocation->VirtualAddress + (Items[i] & 0xFFF);
+				if (Type == IMAGE_REL_BASED_ABSOLUTE)
+					continue;
+				Keys[nKeys] = ((ULONGLONG)dwRVA << 4) | Type;
+				if (nKeys > 0 && Keys[nKeys - 1] > Keys[nKeys])
+					bSorted = FALSE;
+				nKeys++;
+				/* the next entry holds the low 16 bits of the adjustment, not a relocation */
+				if (Type == IMAGE_REL_BASED_HIGHADJ)
+					i++;
+			}
+			BaseRelocation = (PIMAGE_BASE_RELOCATION)((PBYTE)BaseRelocation + BaseRelocation->SizeOfBlock);
+		}
+	}
+	/* linkers emit sorted tables, sort only when needed */
+	if (!bSorted)
+		qsort(Keys, nKeys, sizeof(ULONGLONG), RelocIndex_CompareQword);
+
+	Index = (PRELOC_INDEX)MemArenaAlloc(&Image->Arena, sizeof(RELOC_INDEX));
+	if (Index == NULL)
+	{
+		free(Keys);
+		return FALSE;
+	}
+
+	/* count pages */
+	Index->nPages = 0;
+	for (i = 0; i < nKeys; i++)
+	{
+		if (i == 0 || ((Keys[i] >> 4) & RELOC_PAGE_MASK) != ((Keys[i - 1] >> 4) & RELOC_PAGE_MASK))
+			Index->nPages++;
+	}
+
+	Index->PageStarts = (PDWORD)MemArenaAlloc(&Image->Arena, (Index->nPages + 1) * sizeof(DWORD));
+	Index->PageFirst = (PDWORD)MemArenaAlloc(&Image->Arena, (Index->nPages + 1) * sizeof(DWORD));
+	Index->Offsets = (PWORD)MemArenaAlloc(&Image->Arena, (nKeys + 1) * sizeof(WORD));
+	Index->Types = (PBYTE)MemArenaAlloc(&Image->Arena, nKeys + 1);
+	if (Index->PageStarts == NULL || Index->PageFirst == NULL || Index->Offsets == NULL || Index->Types == NULL)
+	{
+		free(Keys);
+		return FALSE;
+	}
+
+	/* fill buckets, a slot relocated twice is only indexed once */
+	Index->nPages = 0;
+	Index->nEntries = 0;
+	for (i = 0; i < nKeys; i++)
+	{
+		DWORD dwRVA = (DWORD)(Keys[i] >> 4);
+		if (i > 0 && dwRVA == (DWORD)(Keys[i - 1] >> 4))
+			continue;
+		if (Index->nPages == 0 || (dwRVA & RELOC_PAGE_MASK) != Index->PageStarts[Index->nPages - 1])
+		{
+			Index->PageStarts[Index->nPages] = dwRVA & RELOC_PAGE_MASK;
+			Index->PageFirst[Index->nPages] = Index->nEntries;
+			Index->nPages++;
+		}
+		Index->Offsets[Index->nEntries] = (WORD)(dwRVA & ~RELOC_PAGE_MASK);
+		Index->Types[Index->nEntries] = (BYTE)(Keys[i] & 0xF);
+		Index->nEntries++;
+	}
+	Index->PageFirst[Index->nPages] = Index->nEntries;
+
+	free(Keys);
+	Image->RelocIndex = Index;
+	return TRUE;
+}
+
+BOOL PE32_LookupRelocation(PPE_IMAGE Image, DWORD dwRVA, PBYTE lpType)
+{
+	PRELOC_INDEX Index;
+	DWORD dwPage, dwEntry;
+
+	if (!PE32_BuildRelocIndex(Image))
+		return FALSE;
+	Index = Image->RelocIndex;
+
+	dwPage = RelocIndex_LowerPage(Index, dwRVA & RELOC_PAGE_MASK);
+	if (dwPage == Index->nPages || Index->PageStarts[dwPage] != (dwRVA & RELOC_PAGE_MASK))
+		return FALSE;
+	dwEntry = RelocIndex_LowerOffset(Index, dwPage, (WORD)(dwRVA & ~RELOC_PAGE_MASK));
+	if (dwEntry == Index->PageFirst[dwPage + 1] || Index->Offsets[dwEntry] != (WORD)(dwRVA & ~RELOC_PAGE_MASK))
+		return FALSE;
+	if (lpType != NULL)
+		*lpType = Index->Types[dwEntry];
+	return TRUE;
+}
+
+DWORD PE32_QueryRelocations(PPE_IMAGE Image, DWORD dwRVA, DWORD dwLength, PDWORD lpRVAs, PBYTE lpTypes, DWORD nMax)
+{
+	PRELOC_INDEX Index;
+	DWORD dwPage, dwEntry, dwEntryRVA;
+	DWORD nFound = 0;
+	ULONGLONG Limit = (ULONGLONG)dwRVA + dwLength;
+
+	if (dwLength == 0 || !PE32_BuildRelocIndex(Image))
+		return 0;
+	Index = Image->RelocIndex;
+
+	dwPage = RelocIndex_LowerPage(Index, dwRVA & RELOC_PAGE_MASK);
+	if (dwPage == Index->nPages)
+		return 0;
+	if (Index->PageStarts[dwPage] == (dwRVA & RELOC_PAGE_MASK))
+		dwEntry = RelocIndex_LowerOffset(Index, dwPage, (WORD)(dwRVA & ~RELOC_PAGE_MASK));
+	else
+		dwEntry = Index->PageFirst[dwPage];
+
+	/* entries are sorted across pages, walk them until the end of the range */
+	for (; dwPage < Index->nPages && Index->PageStarts[dwPage] < Limit; dwPage++)
+	{
+		for (; dwEntry < Index->PageFirst[dwPage + 1]; dwEntry++)
+		{
+			dwEntryRVA = Index->PageStarts[dwPage] + Index->Offsets[dwEntry];
+			if (dwEntryRVA >= Limit)
+				return nFound;
+			if (nFound < nMax)
+			{
+				if (lpRVAs != NULL)
+					lpRVAs[nFound] = dwEntryRVA;
+				if (lpTypes != NULL)
+					lpTypes[nFound] = Index->Types[dwEntry];
+			}
+			nFound++;
+		}
+	}
+	return nFound;
+}
+
+BOOL PE32_GetRelocBitmap(PPE_IMAGE Image, DWORD dwSection, PBYTE lpBitmap, DWORD cbBitmap)
+{
+	PIMAGE_SECTION_HEADER lpSectionHeader;
+	PRELOC_INDEX Index;
+	DWORD dwSize, dwPage, dwEntry, dwBit;
+	ULONGLONG Limit;
+
+	if (dwSection >= Image->nSections)
+		return FALSE;
+	lpSectionHeader = &Image->SectionHeaders[dwSection];
+	dwSize = lpSectionHeader->Misc.VirtualSize != 0 ? lpSectionHeader->Misc.VirtualSize : lpSectionHeader->SizeOfRawData;
+	if (cbBitmap < dwSize / 8 + (dwSize % 8 != 0))
+		return FALSE;
+	if (!PE32_BuildRelocIndex(Image))
+		return FALSE;
+	Index = Image->RelocIndex;
+
+	memset(lpBitmap, 0, cbBitmap);
+	Limit = (ULONGLONG)lpSectionHeader->VirtualAddress + dwSize;
+	dwPage = RelocIndex_LowerPage(Index, lpSectionHeader->VirtualAddress & RELOC_PAGE_MASK);
+	for (; dwPage < Index->nPages && Index->PageStarts[dwPage] < Limit; dwPage++)
+	{
+		for (dwEntry = Index->PageFirst[dwPage]; dwEntry < Index->PageFirst[dwPage + 1]; dwEntry++)
+		{
+			DWORD dwEntryRVA = Index->PageStarts[dwPage] + Index->Offsets[dwEntry];
+			if (dwEntryRVA < lpSectionHeader->VirtualAddress || dwEntryRVA >= Limit)
+				continue;
+			dwBit = dwEntryRVA - lpSectionHeader->VirtualAddress;
+			lpBitmap[dwBit / 8] |= (BYTE)(1 << (dwBit % 8));
+		}
+	}
+	return TRUE;
+}
@@ -0,0 +1,72 @@
+/**
+ * \file RelocIndex.h
+ * \brief Relocation index: per-page buckets of sorted offsets
+ * \author Tomtombinary
+ * \version 1.0
+ * \date 17 octobre 2026
+ */
+
+#pragma once
+#include "stdafx.h"
+#include "PEUtils.h"
+
+/**
+ * \struct RELOC_INDEX
+ * \brief relocations of an image grouped by 4K page
+ * PageStarts[i] is the RVA of the i-th page (sorted), its relocations are
+ * Offsets[PageFirst[i]] .. Offsets[PageFirst[i+1]-1], sorted, with the type in Types.
+ * IMAGE_REL_BASED_ABSOLUTE entries are padding and aren't indexed.
+ */
+typedef struct _RELOC_INDEX
+{
+	DWORD nPages;
+	PDWORD PageStarts;
+	PDWORD PageFirst;
+	DWORD nEntries;
+	PWORD Offsets;
+	PBYTE Types;
+}RELOC_INDEX,*PRELOC_INDEX;
+
+/**
+ * \fn BOOL PE32_BuildRelocIndex(PPE_IMAGE Image);
+ * \brief build the relocation index of an image, nothing is done if it already exists
+ * The index lives in the image arena and is released by PE32_CloseImage.
+ * \param Image: image description
+ * \return FALSE if relocation table is invalid or memory couldn't be allocated
+ */
+BOOL PE32_BuildRelocIndex(PPE_IMAGE Image);
+
+/**
+ * \fn BOOL PE32_LookupRelocation(PPE_IMAGE Image, DWORD dwRVA, PBYTE lpType);
+ * \brief check if a relocation is applied at a given RVA (index built if needed)
+ * \param Image: image description
+ * \param dwRVA: relative virtual address of the relocated slot
+ * \param lpType: [out, optional] type of the relocation
+ * \return FALSE if there is no relocation at dwRVA
+ */
+BOOL PE32_LookupRelocation(PPE_IMAGE Image, DWORD dwRVA, PBYTE lpType);
+
+/**
+ * \fn DWORD PE32_QueryRelocations(PPE_IMAGE Image, DWORD dwRVA, DWORD dwLength, PDWORD lpRVAs, PBYTE lpTypes, DWORD nMax);
+ * \brief list relocations in [dwRVA, dwRVA + dwLength) (index built if needed)
+ * \param Image: image description
+ * \param dwRVA: first relative virtual address of the range
+ * \param dwLength: length of the range in bytes
+ * \param lpRVAs: [out, optional] RVAs of the relocations, sorted
+ * \param lpTypes: [out, optional] types of the relocations
+ * \param nMax: capacity of lpRVAs and lpTypes
+ * \return number of relocations in the range (can be greater than nMax)
+ */
+DWORD PE32_QueryRelocations(PPE_IMAGE Image, DWORD dwRVA, DWORD dwLength, PDWORD lpRVAs, PBYTE lpTypes, DWORD nMax);
+
+/**
+ * \fn BOOL PE32_GetRelocBitmap(PPE_IMAGE Image, DWORD dwSection, PBYTE lpBitmap, DWORD cbBitmap);
+ * \brief bitmap of relocated slots in a section (index built if needed)
+ * Bit n (lpBitmap[n / 8] & (1 << (n % 8))) is set when a relocation is applied at VirtualAddress + n.
+ * \param Image: image description
+ * \param dwSection: index of the section in the section table
+ * \param lpBitmap: [out] bitmap
+ * \param cbBitmap: size of lpBitmap in bytes, at least (VirtualSize + 7) / 8
+ * \return FALSE if section doesn't exist or bitmap is too small
+ */
+BOOL PE32_GetRelocBitmap(PPE_IMAGE Image, DWORD dwSection, PBYTE lpBitmap, DWORD cbBitmap);
@@ -0,0 +1,386 @@
+/**
+ * \file Resource.c
+ * \brief Defines function described in file Resource.h
+ * \author Tomtombinary
+ * \version 1.0
+ * \date 17 octobre 2026
+ */
+
+#include "stdafx.h"
+#include "Resource.h"
+
+#define RESOURCE_LEAF_DEPTH 2
+#define RESOURCE_NOT_FOUND 0xFFFFFFFF
+
+/* child of an entry found malformed: not checked again */
+static RESOURCE_NODE Resource_Malformed;
+
+static VOID Resource_SetError(PPE_IMAGE Image)
+{
+	if (Image->Error == PE_ERROR_SUCCESS)
+		Image->Error = PE_ERROR_RESOURCE_DIRECTORY;
+}
+
+static WORD Resource_Upper(WORD Char)
+{
+	return Char >= 'a' && Char <= 'z' ? Char - 'a' + 'A' : Char;
+}
+
+/* string of a named entry, checked when its directory was materialized */
+static PIMAGE_RESOURCE_DIR_STRING_U Resource_GetString(PRESOURCE_INDEX Index, PIMAGE_RESOURCE_DIRECTORY_ENTRY Entry)
+{
+	return (PIMAGE_RESOURCE_DIR_STRING_U)(Index->Directory + (Entry->Name & ~IMAGE_RESOURCE_NAME_IS_STRING));
+}
+
+/* order of the resource compiler: UTF-16 units, ASCII case ignored, a prefix first */
+static int Resource_CompareStrings(PIMAGE_RESOURCE_DIR_STRING_U String, LPCSTR Name, PIMAGE_RESOURCE_DIR_STRING_U Other)
+{
+	DWORD Length = Name != NULL ? (DWORD)strlen(Name) : Other->Length;
+	WORD a, b;
+
+	for (DWORD i = 0; i < String->Length && i < Length; i++)
+	{
+		a = Resource_Upper(String->NameString[i]);
+		b = Resource_Upper(Name != NULL ? (BYTE)Name[i] : Other->NameString[i]);
+		if (a != b)
+			return a < b ? -1 : 1;
+	}
+	return String->Length < Length ? -1 : String->Length > Length;
+}
+
+/* check a directory and its entries, NULL if it is malformed */
+static PRESOURCE_NODE Resource_Materialize(PPE_IMAGE Image, PRESOURCE_INDEX Index, DWORD Offset, DWORD Depth)
+{
+	PIMAGE_RESOURCE_DIRECTORY Directory;
+	PIMAGE_RESOURCE_DIRECTORY_ENTRY Entry;
+	PIMAGE_RESOURCE_DIR_STRING_U String;
+	PRESOURCE_NODE Node;
+	DWORD nEntries, Name;
+
+	if ((ULONGLONG)Offset + sizeof(IMAGE_RESOURCE_DIRECTORY) > Index->Size)
+		return NULL;
+	Directory = (PIMAGE_RESOURCE_DIRECTORY)(Index->Directory + Offset);
+	nEntries = (DWORD)Directory->NumberOfNamedEntries + Directory->NumberOfIdEntries;
+	if ((ULONGLONG)Offset + sizeof(IMAGE_RESOURCE_DIRECTORY) + (ULONGLONG)nEntries * sizeof(IMAGE_RESOURCE_DIRECTORY_ENTRY) > Index->Size)
+		return NULL;
+	/* a tree has at most one entry per 8 bytes: more means a directory is shared by too many entries */
+	if (Index->nEntries + nEntries > Index->Size / sizeof(IMAGE_RESOURCE_DIRECTORY_ENTRY))
+		return NULL;
+
+	Node = (PRESOURCE_NODE)MemArenaAlloc(&Image->Arena, sizeof(RESOURCE_NODE));
+	if (Node == NULL)
+		return NULL;
+	Node->Entries = (PIMAGE_RESOURCE_DIRECTORY_ENTRY)(Directory + 1);
+	Node->nNamed = Directory->NumberOfNamedEntries;
+	Node->nIds = Directory->NumberOfIdEntries;
+	Node->Depth = Depth;
+	Node->bSorted = TRUE;
+	for (DWORD i = 0; i < nEntries; i++)
+	{
+		Entry = &Node->Entries[i];
+		/* named entries come first */
+		if (((Entry->Name & IMAGE_RESOURCE_NAME_IS_STRING) != 0) != (i < Node->nNamed))
+			return NULL;
+		if (i < Node->nNamed)
+		{
+			Name = Entry->Name & ~IMAGE_RESOURCE_NAME_IS_STRING;
+			if ((ULONGLONG)Name + sizeof(WORD) > Index->Size)
+				return NULL;
+			String = (PIMAGE_RESOURCE_DIR_STRING_U)(Index->Directory + Name);
+			if ((ULONGLONG)Name + sizeof(WORD) + (ULONGLONG)String->Length * sizeof(WORD) > Index->Size)
+				return NULL;
+			if (i > 0 && Resource_CompareStrings(Resource_GetString(Index, Entry - 1), NULL, String) >= 0)
+				Node->bSorted = FALSE;
+		}
+		else if (i > Node->nNamed && Entry[-1].Name >= Entry->Name)
+			Node->bSorted = FALSE;
+		/* directories down to the languages, then data entries */
+		if (((Entry->OffsetToData & IMAGE_RESOURCE_DATA_IS_DIRECTORY) != 0) != (Depth < RESOURCE_LEAF_DEPTH))
+			return NULL;
+		if (Depth == RESOURCE_LEAF_DEPTH && (ULONGLONG)Entry->OffsetToData + sizeof(IMAGE_RESOURCE_DATA_ENTRY) > Index->Size)
+			return NULL;
+	}
+	if (Depth < RESOURCE_LEAF_DEPTH)
+	{
+		Node->Children = (PRESOURCE_NODE*)MemArenaAlloc(&Image->Arena, (SIZE_T)nEntries * sizeof(PRESOURCE_NODE) + sizeof(PRESOURCE_NODE));
+		if (Node->Children == NULL)
+			return NULL;
+	}
+	Index->nEntries += nEntries;
+	Index->nNodes++;
+	return Node;
+}
+
+/* directory of an entry, materialized on first use, NULL if it is malformed */
+static PRESOURCE_NODE Resource_GetChild(PPE_IMAGE Image, PRESOURCE_INDEX Index, PRESOURCE_NODE Node, DWORD i)
+{
+	PRESOURCE_NODE Child = Node->Children[i];
+
+	if (Child == NULL)
+	{
+		Child = Resource_Materialize(Image, Index, Node->Entries[i].OffsetToData & ~IMAGE_RESOURCE_DATA_IS_DIRECTORY, Node->Depth + 1);
+		if (Child == NULL)
+		{
+			Resource_SetError(Image);
+			Child = &Resource_Malformed;
+		}
+		Node->Children[i] = Child;
+	}
+	return Child != &Resource_Malformed ? Child : NULL;
+}
+
+static PRESOURCE_INDEX Resource_GetIndex(PPE_IMAGE Image)
+{
+	PPE_DIRECTORY lpDirectory = &Image->Directories[IMAGE_DIRECTORY_ENTRY_RESOURCE];
+	PRESOURCE_INDEX Index = Image->ResourceIndex;
+
+	if (Index != NULL)
+		return Index->Root != NULL ? Index : NULL;
+	if (lpDirectory->VirtualAddress == 0 || lpDirectory->Data == NULL)
+		return NULL;
+	Index = (PRESOURCE_INDEX)MemArenaAlloc(&Image->Arena, sizeof(RESOURCE_INDEX));
+	if (Index == NULL)
+		return NULL;
+	Index->Directory = (PBYTE)lpDirectory->Data;
+	Index->Size = lpDirectory->Size;
+	Index->Root = Resource_Materialize(Image, Index, 0, 0);
+	if (Index->Root == NULL)
+		Resource_SetError(Image);
+	/* a malformed root is kept: the directory isn't checked again */
+	Image->ResourceIndex = Index;
+	return Index->Root != NULL ? Index : NULL;
+}
+
+/* entry of a type, a name or a language in a directory, RESOURCE_NOT_FOUND if it isn't there */
+static DWORD Resource_FindEntry(PRESOURCE_INDEX Index, PRESOURCE_NODE Node, LPCSTR Name, DWORD Id)
+{
+	DWORD Low, High, Middle;
+	int Order;
+
+	/* "#N" is the identifier N */
+	if (Name != NULL && Name[0] == '#')
+	{
+		Id = strtoul(Name + 1, NULL, 10);
+		Name = NULL;
+	}
+	if (Name == NULL)
+	{
+		Low = Node->nNamed;
+		High = Node->nNamed + Node->nIds;
+	}
+	else
+	{
+		Low = 0;
+		High = Node->nNamed;
+	}
+
+	if (!Node->bSorted)
+	{
+		for (; Low < High; Low++)
+		{
+			if (Name == NULL ? Node->Entries[Low].Name == Id : Resource_CompareStrings(Resource_GetString(Index, &Node->Entries[Low]), Name, NULL) == 0)
+				return Low;
+		}
+		return RESOURCE_NOT_FOUND;
+	}
+	while (Low < High)
+	{
+		Middle = Low + (High - Low) / 2;
+		if (Name == NULL)
+			Order = Node->Entries[Middle].Name < Id ? -1 : Node->Entries[Middle].Name > Id;
+		else
+			Order = Resource_CompareStrings(Resource_GetString(Index, &Node->Entries[Middle]), Name, NULL);
+		if (Order == 0)
+			return Middle;
+		if (Order < 0)
+			Low = Middle + 1;
+		else
+			High = Middle;
+	}
+	return RESOURCE_NOT_FOUND;
+}
+
+static VOID Resource_GetName(PRESOURCE_INDEX Index, PIMAGE_RESOURCE_DIRECTORY_ENTRY Entry, PRESOURCE_NAME Name)
+{
+	PIMAGE_RESOURCE_DIR_STRING_U String;
+
+	if (Entry->Name & IMAGE_RESOURCE_NAME_IS_STRING)
+	{
+		String = Resource_GetString(Index, Entry);
+		Name->Id = 0;
+		Name->Length = String->Length;
+		Name->String = String->NameString;
+	}
+	else
+	{
+		Name->Id = (WORD)Entry->Name;
+		Name->Length = 0;
+		Name->String = NULL;
+	}
+}
+
+/* leaf of a language entry: a view of the image buffer */
+static VOID Resource_GetLeaf(PPE_IMAGE Image, PRESOURCE_INDEX Index, PIMAGE_RESOURCE_DIRECTORY_ENTRY Entry, PRESOURCE_ENTRY Resource)
+{
+	PIMAGE_RESOURCE_DATA_ENTRY DataEntry = (PIMAGE_RESOURCE_DATA_ENTRY)(Index->Directory + Entry->OffsetToData);
+
+	Resource->Language = (WORD)Entry->Name;
+	Resource->RVA = DataEntry->OffsetToData;
+	Resource->Size = DataEntry->Size;
+	Resource->CodePage = DataEntry->CodePage;
+	Resource->Data = PE32_RVAToPointerRange(Image, DataEntry->OffsetToData, DataEntry->Size);
+}
+
+/* materialize the subtree of a directory, FALSE if part of it is malformed */
+static BOOL Resource_MaterializeAll(PPE_IMAGE Image, PRESOURCE_INDEX Index, PRESOURCE_NODE Node)
+{
+	PRESOURCE_NODE Child;
+	BOOL bSuccess = TRUE;
+
+	if (Node->Depth == RESOURCE_LEAF_DEPTH)
+		return TRUE;
+	for (DWORD i = 0; i < Node->nNamed + Node->nIds; i++)
+	{
+		Child = Resource_GetChild(Image, Index, Node, i);
+		bSuccess &= Child != NULL && Resource_MaterializeAll(Image, Index, Child);
+	}
+	return bSuccess;
+}
+
+BOOL PE32_BuildResourceIndex(PPE_IMAGE Image, BOOL bFull)
+{
+	PRESOURCE_INDEX Index = Resource_GetIndex(Image);
+
+	if (Index == NULL)
+		return FALSE;
+	return !bFull || Resource_MaterializeAll(Image, Index, Index->Root);
+}
+
+BOOL PE32_FindResource(PPE_IMAGE Image, LPCSTR Type, LPCSTR Name, DWORD Language, PRESOURCE_ENTRY Entry)
+{
+	PRESOURCE_INDEX Index = Resource_GetIndex(Image);
+	PRESOURCE_NODE Types, Names, Languages;
+	DWORD iType, iName, iLanguage;
+
+	if (Index == NULL)
+		return FALSE;
+	Types = Index->Root;
+	iType = Resource_FindEntry(Index, Types, IS_INTRESOURCE(Type) ? NULL : Type, (WORD)(ULONG_PTR)Type);
+	if (iType == RESOURCE_NOT_FOUND || (Names = Resource_GetChild(Image, Index, Types, iType)) == NULL)
+		return FALSE;
+	iName = Resource_FindEntry(Index, Names, IS_INTRESOURCE(Name) ? NULL : Name, (WORD)(ULONG_PTR)Name);
+	if (iName == RESOURCE_NOT_FOUND || (Languages = Resource_GetChild(Image, Index, Names, iName)) == NULL)
+		return FALSE;
+	if (Language == RESOURCE_ANY_LANGUAGE)
+		iLanguage = Languages->nNamed + Languages->nIds != 0 ? 0 : RESOURCE_NOT_FOUND;
+	else
+		iLanguage = Resource_FindEntry(Index, Languages, NULL, Language);
+	if (iLanguage == RESOURCE_NOT_FOUND)
+		return FALSE;
+
+	Resource_GetName(Index, &Types->Entries[iType], &Entry->Type);
+	Resource_GetName(Index, &Names->Entries[iName], &Entry->Name);
+	Resource_GetLeaf(Image, Index, &Languages->Entries[iLanguage], Entry);
+	return TRUE;
+}
+
+BOOL PE32_EnumResources(PPE_IMAGE Image, LPCSTR Type, EnumResourcesCallback pFuncCallback, LPVOID UserArgs)
+{
+	PRESOURCE_INDEX Index = Resource_GetIndex(Image);
+	PRESOURCE_NODE Types, Names, Languages;
+	RESOURCE_ENTRY Entry;
+	DWORD FirstType, LastType;
+	BOOL bSuccess = TRUE;
+
+	if (Index == NULL)
+		return Image->Directories[IMAGE_DIRECTORY_ENTRY_RESOURCE].VirtualAddress == 0;
+	Types = Index->Root;
+	FirstType = 0;
+	LastType = Types->nNamed + Types->nIds;
+	if (Type != NULL)
+	{
+		FirstType = Resource_FindEntry(Index, Types, IS_INTRESOURCE(Type) ? NULL : Type, (WORD)(ULONG_PTR)Type);
+		if (FirstType == RESOURCE_NOT_FOUND)
+			return TRUE;
+		LastType = FirstType + 1;
+	}
+
+	for (DWORD i = FirstType; i < LastType; i++)
+	{
+		Names = Resource_GetChild(Image, Index, Types, i);
+		if (Names == NULL)
+		{
+			bSuccess = FALSE;
+			continue;
+		}
+		Resource_GetName(Index, &Types->Entries[i], &Entry.Type);
+		for (DWORD j = 0; j < Names->nNamed + Names->nIds; j++)
+		{
+			Languages = Resource_GetChild(Image, Index, Names, j);
+			if (Languages == NULL)
+			{
+				bSuccess = FALSE;
+				continue;
+			}
+			Resource_GetName(Index, &Names->Entries[j], &Entry.Name);
+			for (DWORD k = 0; k < Languages->nNamed + Languages->nIds; k++)
+			{
+				Resource_GetLeaf(Image, Index, &Languages->Entries[k], &Entry);
+				if (!pFuncCallback(&Entry, UserArgs))
+					return FALSE;
+			}
+		}
+	}
+	return bSuccess;
+}
+
+DWORD PE32_GetResourceName(PRESOURCE_NAME Name, PCHAR Buffer, DWORD Size)
+{
+	BYTE Encoded[4];
+	DWORD Length = 0;
+	DWORD nEncoded, Char;
+
+	if (Name->String == NULL)
+		return (DWORD)snprintf(Buffer, Size, "#%u", Name->Id);
+	for (DWORD i = 0; i < Name->Length; i++)
+	{
+		Char = Name->String[i];
+		/* surrogate pair, a lone surrogate is written as is */
+		if (Char >= 0xD800 && Char < 0xDC00 && i + 1 < Name->Length && Name->String[i + 1] >= 0xDC00 && Name->String[i + 1] < 0xE000)
+			Char = 0x10000 + ((Char - 0xD800) << 10) + (Name->String[++i] - 0xDC00);
+		if (Char < 0x80)
+		{
+			Encoded[0] = (BYTE)Char;
+			nEncoded = 1;
+		}
+		else if (Char < 0x800)
+		{
+			Encoded[0] = (BYTE)(0xC0 | (Char >> 6));
+			Encoded[1] = (BYTE)(0x80 | (Char & 0x3F));
+			nEncoded = 2;
+		}
+		else if (Char < 0x10000)
+		{
+			Encoded[0] = (BYTE)(0xE0 | (Char >> 12));
+			Encoded[1] = (BYTE)(0x80 | ((Char >> 6) & 0x3F));
+			Encoded[2] = (BYTE)(0x80 | (Char & 0x3F));
+			nEncoded = 3;
+		}
+		else
+		{
+			Encoded[0] = (BYTE)(0xF0 | (Char >> 18));
+			Encoded[1] = (BYTE)(0x80 | ((Char >> 12) & 0x3F));
+			Encoded[2] = (BYTE)(0x80 | ((Char >> 6) & 0x3F));
+			Encoded[3] = (BYTE)(0x80 | (Char & 0x3F));
+			nEncoded = 4;
+		}
+		/* characters are never cut by the truncation */
+		if (Length + nEncoded < Size)
+			memcpy(Buffer + Length, Encoded, nEncoded);
+		else if (Length < Size)
+			Size = Length + 1;
+		Length += nEncoded;
+	}
+	Buffer[Length < Size ? Length : Size - 1] = '\0';
+	return Length;
+}
@@ -0,0 +1,152 @@
+/**
+ * \file Resource.h
+ * \brief Lookup and enumeration of the resources of an image
+ * \author Tomtombinary
+ * \version 1.0
+ * \date 17 octobre 2026
+ * The resource directory is a tree of three levels: type, name, language.
+ * Each directory is materialized on first use only: its entries are checked
+ * against the resource directory once (offsets, strings, order), then a
+ * lookup descends the tree with a binary search at each level, over the
+ * named entries (ASCII case ignored) or over the ID entries. Directories
+ * whose entries aren't sorted are searched linearly.
+ * Leaves are returned as views of the image buffer, translated through the
+ * section table: no data is copied.
+ * Materialized directories live in the image arena. A lookup can change the
+ * tree: PE32_BuildResourceIndex(Image, TRUE) materializes it entirely before
+ * the image is shared between threads.
+ */
+
+#pragma once
+#include "stdafx.h"
+#include "PEUtils.h"
+
+/* types of the resources (RT_* of winuser.h), given to the functions with MAKEINTRESOURCEA */
+#define RESOURCE_TYPE_CURSOR 1
+#define RESOURCE_TYPE_BITMAP 2
+#define RESOURCE_TYPE_ICON 3
+#define RESOURCE_TYPE_MENU 4
+#define RESOURCE_TYPE_DIALOG 5
+#define RESOURCE_TYPE_STRING 6
+#define RESOURCE_TYPE_RCDATA 10
+#define RESOURCE_TYPE_MESSAGETABLE 11
+#define RESOURCE_TYPE_GROUP_CURSOR 12
+#define RESOURCE_TYPE_GROUP_ICON 14
+#define RESOURCE_TYPE_VERSION 16
+#define RESOURCE_TYPE_MANIFEST 24
+
+#define RESOURCE_ANY_LANGUAGE 0xFFFFFFFF /* first language of a resource */
+
+/**
+ * \struct RESOURCE_NAME
+ * \brief type or name of a resource
+ * Id: identifier, 0 for a string
+ * String, Length: UTF-16LE name in the image (not null terminated, Length characters), NULL for an identifier
+ */
+typedef struct _RESOURCE_NAME
+{
+	WORD Id;
+	WORD Length;
+	PWORD String;
+}RESOURCE_NAME,*PRESOURCE_NAME;
+
+/**
+ * \struct RESOURCE_ENTRY
+ * \brief a resource: leaf of the tree
+ * Type, Name, Language: path of the leaf
+ * RVA, Size, CodePage: IMAGE_RESOURCE_DATA_ENTRY of the leaf
+ * Data: the Size bytes at RVA in the image buffer, NULL if they aren't in the buffer
+ */
+typedef struct _RESOURCE_ENTRY
+{
+	RESOURCE_NAME Type;
+	RESOURCE_NAME Name;
+	WORD Language;
+	DWORD RVA;
+	DWORD Size;
+	DWORD CodePage;
+	LPVOID Data;
+}RESOURCE_ENTRY,*PRESOURCE_ENTRY;
+
+/**
+ * \struct RESOURCE_NODE
+ * \brief a materialized directory of the tree
+ * Entries: nNamed named entries, then nIds ID entries
+ * Depth: 0 for the types, 1 for the names, 2 for the languages (entries are leaves)
+ * bSorted: TRUE if both kinds of entries are sorted, binary search allowed
+ * Children: [optional] directory of each entry, NULL until materialized (always NULL at depth 2)
+ */
+typedef struct _RESOURCE_NODE
+{
+	PIMAGE_RESOURCE_DIRECTORY_ENTRY Entries;
+	DWORD nNamed;
+	DWORD nIds;
+	DWORD Depth;
+	BOOL bSorted;
+	struct _RESOURCE_NODE** Children;
+}RESOURCE_NODE,*PRESOURCE_NODE;
+
+/**
+ * \struct RESOURCE_INDEX
+ * \brief root of the materialized tree
+ * Directory, Size: resource directory in the image buffer
+ * Root: directory of the types
+ * nNodes, nEntries: directories and entries materialized, at most one entry per 8 bytes of the directory, which bounds the directories shared by many entries
+ */
+typedef struct _RESOURCE_INDEX
+{
+	PBYTE Directory;
+	DWORD Size;
+	PRESOURCE_NODE Root;
+	DWORD nNodes;
+	DWORD nEntries;
+}RESOURCE_INDEX,*PRESOURCE_INDEX;
+
+/**
+ * Callback for PE32_EnumResources, returns FALSE to stop the enumeration
+ */
+typedef BOOL(*EnumResourcesCallback)(PRESOURCE_ENTRY lpResourceEntry, LPVOID UserArgs);
+
+/**
+ * \fn BOOL PE32_BuildResourceIndex(PPE_IMAGE Image, BOOL bFull);
+ * \brief materialize the directory of the types, or the whole tree
+ * Lookups and enumerations call it themselves: only needed to materialize the whole tree.
+ * \param Image: image description
+ * \param bFull: TRUE to materialize every directory
+ * \return FALSE if the image has no resource directory, a directory is malformed (Image->Error set to PE_ERROR_RESOURCE_DIRECTORY) or memory couldn't be allocated
+ */
+BOOL PE32_BuildResourceIndex(PPE_IMAGE Image, BOOL bFull);
+
+/**
+ * \fn BOOL PE32_FindResource(PPE_IMAGE Image, LPCSTR Type, LPCSTR Name, DWORD Language, PRESOURCE_ENTRY Entry);
+ * \brief find a resource by type, name and language
+ * Type and Name are strings (ASCII case ignored), identifiers made with MAKEINTRESOURCEA, or "#N" for the identifier N.
+ * \param Image: image description
+ * \param Type: type of the resource, e.g. MAKEINTRESOURCEA(RESOURCE_TYPE_VERSION)
+ * \param Name: name of the resource
+ * \param Language: language identifier, RESOURCE_ANY_LANGUAGE for the first one
+ * \param Entry: [out] the resource
+ * \return FALSE if the resource doesn't exist or its path is malformed
+ */
+BOOL PE32_FindResource(PPE_IMAGE Image, LPCSTR Type, LPCSTR Name, DWORD Language, PRESOURCE_ENTRY Entry);
+
+/**
+ * \fn BOOL PE32_EnumResources(PPE_IMAGE Image, LPCSTR Type, EnumResourcesCallback pFuncCallback, LPVOID UserArgs);
+ * \brief enumerate the resources in the order of the tree (type, name, language)
+ * \param Image: image description
+ * \param Type: [optional] type of the resources to enumerate (see PE32_FindResource), NULL for all
+ * \param pFuncCallback: function called for each resource
+ * \param UserArgs: [optional] argument of the callback
+ * \return FALSE if the enumeration was stopped by the callback or a directory is malformed (its resources are skipped)
+ */
+BOOL PE32_EnumResources(PPE_IMAGE Image, LPCSTR Type, EnumResourcesCallback pFuncCallback, LPVOID UserArgs);
+
+/**
+ * \fn DWORD PE32_GetResourceName(PRESOURCE_NAME Name, PCHAR Buffer, DWORD Size);
+ * \brief write a type or a name as a string: UTF-8 for a string, "#N" for an identifier
+ * \param Name: type or name of a resource
+ * \param Buffer: [out] null terminated string, truncated to Size - 1 bytes
+ * \param Size: size of Buffer in bytes, at least 1
+ * \return length of the string, without truncation
+ */
+DWORD PE32_GetResourceName(PRESOURCE_NAME Name, PCHAR Buffer, DWORD Size);
@@ -0,0 +1,450 @@
+/**
+ * \file Scanner.c
+ * \brief Defines function described in file Scanner.h
+ * \author Tomtombinary
+ * \version 1.0
+ * \date 17 octobre 2026
+ */
+
+#include "stdafx.h"
+#include "Scanner.h"
+#include "FileUtils.h"
+#include "ThreadUtils.h"
+#include "SparseLoader.h"
+#include "Validate.h"
+#include <stdarg.h>
+
+#ifdef _WIN32
+#define SCAN_PATH_SEPARATOR '\\'
+#else
+#define SCAN_PATH_SEPARATOR '/'
+#endif
+
+/* output buffers are written to the temporary file of their thread by chunks of this size */
+#define SCAN_OUTPUT_CHUNK 0x100000
+
+#define SCAN_TASK_FILE 0
+#define SCAN_TASK_DIRECTORY 1
+/* root of the scan: a directory, or a file if it can't be listed */
+#define SCAN_TASK_ROOT 2
+
+typedef struct _SCAN_TASK
+{
+	PCHAR Path;
+	DWORD Type;
+}SCAN_TASK,*PSCAN_TASK;
+
+/* ring of tasks, Tasks[Top] is stolen by other threads, Tasks[Bottom - 1] is popped by the owner */
+typedef struct _SCAN_DEQUE
+{
+	THREAD_LOCK Lock;
+	PSCAN_TASK Tasks;
+	SIZE_T Capacity;
+	SIZE_T Top;
+	SIZE_T Bottom;
+}SCAN_DEQUE,*PSCAN_DEQUE;
+
+typedef struct _SCAN_WORKER
+{
+	struct _SCANNER* Scanner;
+	DWORD Index;
+	DWORD Seed;
+	SCAN_DEQUE Deque;
+	SCAN_OUTPUT Output;
+	SCANNER_STATS Stats;
+	FILE_READER Reader;
+	THREAD_HANDLE Thread;
+}SCAN_WORKER,*PSCAN_WORKER;
+
+typedef struct _SCANNER
+{
+	PSCANNER_CONFIG Config;
+	ScanFileCallback Callback;
+	PSCAN_WORKER Workers;
+	DWORD nWorkers;
+	/* tasks pushed and not finished yet, the scan ends when it drops to 0 */
+	volatile LONG Pending;
+	volatile LONG Stop;
+}SCANNER,*PSCANNER;
+
+typedef struct _SCAN_DIRECTORY
+{
+	PSCAN_WORKER Worker;
+	LPCSTR Path;
+	SIZE_T PathLength;
+	/* entries pushed, counted here: the deque can be emptied by thieves meanwhile */
+	DWORD nEntries;
+}SCAN_DIRECTORY,*PSCAN_DIRECTORY;
+
+static BOOL Scanner_Push(PSCAN_WORKER Worker, PCHAR Path, DWORD Type)
+{
+	PSCAN_DEQUE Deque = &Worker->Deque;
+	PSCAN_TASK Tasks;
+	SIZE_T i;
+
+	ThreadUtils_Lock(&Deque->Lock);
+	if (Deque->Bottom - Deque->Top == Deque->Capacity)
+	{
+		Tasks = (PSCAN_TASK)malloc(2 * Deque->Capacity * sizeof(SCAN_TASK));
+		if (Tasks == NULL)
+		{
+			ThreadUtils_Unlock(&Deque->Lock);
+			return FALSE;
+		}
+		for (i = Deque->Top; i != Deque->Bottom; i++)
+			Tasks[i & (2 * Deque->Capacity - 1)] = Deque->Tasks[i & (Deque->Capacity - 1)];
+		free(Deque->Tasks);
+		Deque->Tasks = Tasks;
+		Deque->Capacity *= 2;
+	}
+	Deque->Tasks[Deque->Bottom & (Deque->Capacity - 1)].Path = Path;
+	Deque->Tasks[Deque->Bottom & (Deque->Capacity - 1)].Type = Type;
+	/* counted before a thief can see it: its end can't bring Pending to 0 while the parent runs */
+	ThreadUtils_AtomicAdd(&Worker->Scanner->Pending, 1);
+	Deque->Bottom++;
+	ThreadUtils_Unlock(&Deque->Lock);
+	return TRUE;
+}
+
+static BOOL Scanner_Pop(PSCAN_DEQUE Deque, PSCAN_TASK Task, BOOL bSteal)
+{
+	BOOL bFound = FALSE;
+
+	ThreadUtils_Lock(&Deque->Lock);
+	if (Deque->Bottom != Deque->Top)
+	{
+		if (bSteal)
+			*Task = Deque->Tasks[Deque->Top++ & (Deque->Capacity - 1)];
+		else
+			*Task = Deque->Tasks[--Deque->Bottom & (Deque->Capacity - 1)];
+		bFound = TRUE;
+	}
+	ThreadUtils_Unlock(&Deque->Lock);
+	return bFound;
+}
+
+static BOOL Scanner_Steal(PSCAN_WORKER Worker, PSCAN_TASK Task)
+{
+	PSCANNER Scanner = Worker->Scanner;
+	DWORD dwVictim;
+
+	if (Scanner->nWorkers < 2)
+		return FALSE;
+	/* xorshift, start from a random victim so thieves don't all hit the same deque */
+	Worker->Seed ^= Worker->Seed << 13;
+	Worker->Seed ^= Worker->Seed >> 17;
+	Worker->Seed ^= Worker->Seed << 5;
+	dwVictim = Worker->Seed % Scanner->nWorkers;
+	for (DWORD i = 0; i < Scanner->nWorkers; i++, dwVictim = (dwVictim + 1) % Scanner->nWorkers)
+	{
+		if (dwVictim == Worker->Index)
+			continue;
+		if (Scanner_Pop(&Scanner->Workers[dwVictim].Deque, Task, TRUE))
+		{
+			Worker->Stats.nSteals++;
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
+static VOID Scanner_Flush(PSCAN_OUTPUT Output)
+{
+	if (Output->Size != 0)
+	{
+		if (Output->Chunks != NULL)
+			fwrite(Output->Buffer, 1, Output->Size, Output->Chunks);
+		else if (Output->Stream != NULL)
+			fwrite(Output->Buffer, 1, Output->Size, Output->Stream);
+	}
+	Output->Size = 0;
+}
+
+/* after the join: append the chunks of a thread to the stream, the buffer is reused to copy them */
+static VOID Scanner_Merge(PSCAN_OUTPUT Output)
+{
+	SIZE_T Size;
+
+	Scanner_Flush(Output);
+	if (Output->Chunks == NULL)
+		return;
+	rewind(Output->Chunks);
+	while ((Size = fread(Output->Buffer, 1, Output->Capacity, Output->Chunks)) != 0)
+		fwrite(Output->Buffer, 1, Size, Output->Stream);
+	fclose(Output->Chunks);
+	Output->Chunks = NULL;
+}
+
+VOID Scanner_Printf(PSCAN_OUTPUT Output, LPCSTR Format, ...)
+{
+	va_list Args;
+	PCHAR Buffer;
+	SIZE_T Capacity;
+	int Length;
+
+	va_start(Args, Format);
+	Length = vsnprintf(Output->Buffer + Output->Size, Output->Capacity - Output->Size, Format, Args);
+	va_end(Args);
+	if (Length < 0)
+		return;
+	if ((SIZE_T)Length >= Output->Capacity - Output->Size)
+	{
+		Capacity = Output->Capacity;
+		while (Capacity - Output->Size <= (SIZE_T)Length)
+			Capacity *= 2;
+		Buffer = (PCHAR)realloc(Output->Buffer, Capacity);
+		if (Buffer == NULL)
+			return;
+		Output->Buffer = Buffer;
+		Output->Capacity = Capacity;
+		va_start(Args, Format);
+		vsnprintf(Output->Buffer + Output->Size, Output->Capacity - Output->Size, Format, Args);
+		va_end(Args);
+	}
+	Output->Size += Length;
+	if (Output->Size >= SCAN_OUTPUT_CHUNK)
+		Scanner_Flush(Output);
+}
+
+static BOOL Scanner_CallbackPushEntry(LPCSTR Name, BOOL bDirectory, LPVOID UserArgs)
+{
+	PSCAN_DIRECTORY Directory = (PSCAN_DIRECTORY)UserArgs;
+	SIZE_T NameLength = strlen(Name);
+	PCHAR Path = (PCHAR)malloc(Directory->PathLength + NameLength + 2);
+
+	if (Path == NULL)
+		return FALSE;
+	memcpy(Path, Directory->Path, Directory->PathLength);
+	Path[Directory->PathLength] = SCAN_PATH_SEPARATOR;
+	memcpy(Path + Directory->PathLength + 1, Name, NameLength + 1);
+	if (!Scanner_Push(Directory->Worker, Path, bDirectory ? SCAN_TASK_DIRECTORY : SCAN_TASK_FILE))
+	{
+		free(Path);
+		return FALSE;
+	}
+	Directory->nEntries++;
+	return TRUE;
+}
+
+static VOID Scanner_ScanFile(PSCAN_WORKER Worker, LPCSTR Path)
+{
+	PSCANNER Scanner = Worker->Scanner;
+	FILE_VIEW View;
+	PE_IMAGE Image;
+	SCAN_FILE File;
+	ULONGLONG nBytesRead;
+
+	File.Path = Path;
+	File.Image = NULL;
+	File.Error = PE_ERROR_FILE;
+	File.Worker = Worker->Index;
+	if (Scanner->Config->SparseTables != 0)
+	{
+		if (PE32_OpenFileSparse(Path, Scanner->Config->SparseTables, &Worker->Reader, &Image, &nBytesRead))
+			File.Image = &Image;
+		Worker->Stats.nBytes += nBytesRead;
+		File.Error = Image.Error;
+	}
+	else if (FileUtils_MapFile(Path, &View))
+	{
+		Worker->Stats.nBytes += View.Size;
+		if (PE32_InitImage(&Image, View.Data, View.Size, PE_LAYOUT_FILE))
+		{
+			/* the image owns the view, as with PE32_OpenFile */
+			Image.View = View;
+			File.Image = &Image;
+		}
+		else
+			FileUtils_UnmapFile(&View);
+		File.Error = Image.Error;
+	}
+	Worker->Stats.nFiles++;
+
+	if (!Scanner->Callback(&File, &Worker->Output, Scanner->Config->UserArgs))
+		ThreadUtils_AtomicAdd(&Scanner->Stop, 1);
+
+	if (File.Image != NULL)
+	{
+		File.Error = Image.Error;
+		PE32_CloseImage(&Image);
+	}
+	if (File.Error != PE_ERROR_SUCCESS)
+		Worker->Stats.nInvalid++;
+}
+
+static VOID Scanner_RunTask(PSCAN_WORKER Worker, PSCAN_TASK Task)
+{
+	SCAN_DIRECTORY Directory;
+
+	if (Task->Type == SCAN_TASK_FILE)
+	{
+		Scanner_ScanFile(Worker, Task->Path);
+		return;
+	}
+
+	Directory.Worker = Worker;
+	Directory.Path = Task->Path;
+	Directory.PathLength = strlen(Task->Path);
+	Directory.nEntries = 0;
+	while (Directory.PathLength > 1 && (Task->Path[Directory.PathLength - 1] == '/' || Task->Path[Directory.PathLength - 1] == SCAN_PATH_SEPARATOR))
+		Directory.PathLength--;
+	if (FileUtils_EnumDirectory(Task->Path, Scanner_CallbackPushEntry, &Directory))
+		Worker->Stats.nDirectories++;
+	else if (Task->Type == SCAN_TASK_ROOT && Directory.nEntries == 0)
+		Scanner_ScanFile(Worker, Task->Path);
+}
+
+static VOID Scanner_Worker(LPVOID UserArgs)
+{
+	PSCAN_WORKER Worker = (PSCAN_WORKER)UserArgs;
+	PSCANNER Scanner = Worker->Scanner;
+	SCAN_TASK Task;
+
+	for (;;)
+	{
+		if (Scanner_Pop(&Worker->Deque, &Task, FALSE) || Scanner_Steal(Worker, &Task))
+		{
+			/* once stopped, remaining tasks are only drained */
+			if (Scanner->Stop == 0)
+				Scanner_RunTask(Worker, &Task);
+			free(Task.Path);
+			/* children of a directory have been counted before its own end */
+			ThreadUtils_AtomicAdd(&Scanner->Pending, -1);
+			continue;
+		}
+		if (ThreadUtils_AtomicAdd(&Scanner->Pending, 0) == 0)
+			break;
+		ThreadUtils_Yield();
+	}
+}
+
+BOOL Scanner_Run(PSCANNER_CONFIG Config, PSCANNER_STATS Stats)
+{
+	SCANNER Scanner;
+	PSCAN_WORKER Worker;
+	PCHAR Root;
+	DWORD nStarted = 0;
+	DWORD i;
+	ULONGLONG Start;
+	BOOL bSuccess = TRUE;
+
+	if (Stats != NULL)
+		memset(Stats, 0, sizeof(SCANNER_STATS));
+	memset(&Scanner, 0, sizeof(SCANNER));
+	Scanner.Config = Config;
+	Scanner.Callback = Config->Callback != NULL ? Config->Callback : Scanner_SummaryCallback;
+	Scanner.nWorkers = Config->nThreads != 0 ? Config->nThreads : ThreadUtils_GetProcessorCount();
+	Scanner.Workers = (PSCAN_WORKER)calloc(Scanner.nWorkers, sizeof(SCAN_WORKER));
+	Root = (PCHAR)malloc(strlen(Config->Root) + 1);
+	if (Scanner.Workers == NULL || Root == NULL)
+	{
+		free(Scanner.Workers);
+		free(Root);
+		return FALSE;
+	}
+	strcpy(Root, Config->Root);
+
+	for (i = 0; i < Scanner.nWorkers; i++)
+	{
+		Worker = &Scanner.Workers[i];
+		Worker->Scanner = &Scanner;
+		Worker->Index = i;
+		Worker->Seed = 0x9E3779B9 * (i + 1);
+		ThreadUtils_InitLock(&Worker->Deque.Lock);
+		Worker->Deque.Capacity = 256;
+		Worker->Deque.Tasks = (PSCAN_TASK)malloc(Worker->Deque.Capacity * sizeof(SCAN_TASK));
+		Worker->Output.Capacity = 2 * SCAN_OUTPUT_CHUNK;
+		Worker->Output.Buffer = (PCHAR)malloc(Worker->Output.Capacity);
+		Worker->Output.Stream = Config->Output;
+		if (Config->Output != NULL)
+			Worker->Output.Chunks = tmpfile();
+		/* the reader is still usable when io_uring is missing */
+		if (Config->SparseTables != 0)
+			FileUtils_InitReader(&Worker->Reader);
+		if (Worker->Deque.Tasks == NULL || Worker->Output.Buffer == NULL)
+			bSuccess = FALSE;
+	}
+
+	Start = ThreadUtils_GetTime();
+	if (bSuccess && Scanner_Push(&Scanner.Workers[0], Root, SCAN_TASK_ROOT))
+	{
+		/* the calling thread is worker 0 */
+		for (nStarted = 1; nStarted < Scanner.nWorkers; nStarted++)
+		{
+			if (!ThreadUtils_CreateThread(&Scanner.Workers[nStarted].Thread, Scanner_Worker, &Scanner.Workers[nStarted]))
+				break;
+		}
+		Scanner_Worker(&Scanner.Workers[0]);
+		for (i = 1; i < nStarted; i++)
+			ThreadUtils_JoinThread(&Scanner.Workers[i].Thread);
+	}
+	else
+	{
+		free(Root);
+		bSuccess = FALSE;
+	}
+
+	for (i = 0; i < Scanner.nWorkers; i++)
+	{
+		Worker = &Scanner.Workers[i];
+		if (Worker->Output.Buffer != NULL)
+			Scanner_Merge(&Worker->Output);
+		else if (Worker->Output.Chunks != NULL)
+			fclose(Worker->Output.Chunks);
+		if (Stats != NULL)
+		{
+			Stats->nFiles += Worker->Stats.nFiles;
+			Stats->nBytes += Worker->Stats.nBytes;
+			Stats->nInvalid += Worker->Stats.nInvalid;
+			Stats->nDirectories += Worker->Stats.nDirectories;
+			Stats->nSteals += Worker->Stats.nSteals;
+		}
+		if (Config->SparseTables != 0)
+			FileUtils_CloseReader(&Worker->Reader);
+		free(Worker->Output.Buffer);
+		free(Worker->Deque.Tasks);
+		ThreadUtils_DeleteLock(&Worker->Deque.Lock);
+	}
+	if (Stats != NULL)
+		Stats->Microseconds = ThreadUtils_GetTime() - Start;
+	free(Scanner.Workers);
+	return bSuccess && Scanner.Stop == 0;
+}
+
+static BOOL Scanner_CallbackCount(LPVOID Entry, LPVOID UserArgs)
+{
+	UNREFERENCED_PARAMETER(Entry);
+	(*(PDWORD)UserArgs)++;
+	return TRUE;
+}
+
+BOOL Scanner_SummaryCallback(PSCAN_FILE File, PSCAN_OUTPUT Output, LPVOID UserArgs)
+{
+	DWORD nSections = 0;
+	DWORD nImports = 0;
+	DWORD nExports = 0;
+	DWORD nRelocations = 0;
+
+	UNREFERENCED_PARAMETER(UserArgs);
+	if (File->Image != NULL)
+	{
+		PE32_EnumSectionsEx(File->Image, (EnumSectionsCallback)Scanner_CallbackCount, &nSections);
+		PE32_EnumImportsEx(File->Image, (EnumImportsCallback)Scanner_CallbackCount, &nImports);
+		PE32_EnumExportsEx(File->Image, (EnumExportsCallback)Scanner_CallbackCount, &nExports);
+		PE32_EnumRelocationsEx(File->Image, (EnumRelocationsCallback)Scanner_CallbackCount, &nRelocations);
+		File->Error = File->Image->Error;
+	}
+	Scanner_Printf(Output, "%s\t%u\t%u\t%u\t%u\t%u\n", File->Path, File->Error, nSections, nImports, nExports, nRelocations);
+	return TRUE;
+}
+
+VOID Scanner_PrintStats(PSCANNER_STATS Stats, FILE* Stream)
+{
+	double Seconds = Stats->Microseconds > 0 ? Stats->Microseconds / 1e6 : 1e-6;
+
+	fprintf(Stream, "files: %llu (%llu invalid), directories: %llu, steals: %llu\n",
+		(unsigned long long)Stats->nFiles, (unsigned long long)Stats->nInvalid,
+		(unsigned long long)Stats->nDirectories, (unsigned long long)Stats->nSteals);
+	fprintf(Stream, "%.3f s, %.0f files/s, %.1f MB/s\n",
+		Seconds, Stats->nFiles / Seconds, Stats->nBytes / Seconds / (1024.0 * 1024.0));
+}
@@ -0,0 +1,127 @@
+/**
+ * \file Scanner.h
+ * \brief Multi-threaded scan of a directory tree of PE files
+ * \author Tomtombinary
+ * \version 1.0
+ * \date 17 octobre 2026
+ * Directories and files are tasks distributed over a pool of threads. Each
+ * thread owns a deque of tasks: it pushes and pops at the bottom (depth
+ * first, which keeps the deques small) and idle threads steal at the top of
+ * other deques (big subtrees close to the root). Each deque has its own
+ * lock, there is no lock shared by all threads.
+ * Each thread writes its results in its own output buffer, flushed by whole
+ * chunks to its own temporary file, and keeps its own counters. Temporary
+ * files are copied to the output stream in the order of the threads and
+ * counters are summed once the threads are joined: the threads never share
+ * the lock of the stream, unless a temporary file couldn't be created (the
+ * chunks of that thread are then written to the stream directly).
+ */
+
+#pragma once
+#include "stdafx.h"
+#include "PEUtils.h"
+
+/**
+ * \struct SCAN_OUTPUT
+ * \brief output buffer of a scanning thread, see Scanner_Printf
+ * Stream: output stream of the scan, NULL to discard the output
+ * Chunks: temporary file of the thread receiving the full buffers, copied to Stream after the scan
+ */
+typedef struct _SCAN_OUTPUT
+{
+	PCHAR Buffer;
+	SIZE_T Size;
+	SIZE_T Capacity;
+	FILE* Stream;
+	FILE* Chunks;
+}SCAN_OUTPUT,*PSCAN_OUTPUT;
+
+/**
+ * \struct SCAN_FILE
+ * \brief file given to the scan callback
+ * Path: path of the file
+ * Image: image mapped from the file, NULL if the file isn't a valid PE
+ * Error: PE_ERROR_* code (header error, or first malformed table once the callback has walked them)
+ * Worker: index of the thread scanning the file
+ */
+typedef struct _SCAN_FILE
+{
+	LPCSTR Path;
+	PPE_IMAGE Image;
+	DWORD Error;
+	DWORD Worker;
+}SCAN_FILE,*PSCAN_FILE;
+
+/**
+ * Callback function type for Scanner_Run, called by the scanning threads for each file
+ * Returning FALSE stops the scan.
+ */
+typedef BOOL(*ScanFileCallback)(PSCAN_FILE File, PSCAN_OUTPUT Output, LPVOID UserArgs);
+
+/**
+ * \struct SCANNER_CONFIG
+ * \brief parameters of a scan
+ * Root: directory to scan recursively (or a single file)
+ * nThreads: number of scanning threads, 0 for the number of processors
+ * Callback: function called for each file, NULL for Scanner_SummaryCallback
+ * UserArgs: [optional] extras arguments for callback function, shared by all threads
+ * Output: [optional] stream receiving the output buffers, NULL to discard them
+ * SparseTables: PE_TABLE_* flags of the tables to read with PE32_OpenFileSparse, 0 to map whole files
+ */
+typedef struct _SCANNER_CONFIG
+{
+	LPCSTR Root;
+	DWORD nThreads;
+	ScanFileCallback Callback;
+	LPVOID UserArgs;
+	FILE* Output;
+	DWORD SparseTables;
+}SCANNER_CONFIG,*PSCANNER_CONFIG;
+
+/**
+ * \struct SCANNER_STATS
+ * \brief counters of a scan
+ * nFiles: files scanned
+ * nBytes: bytes mapped, or read in sparse mode
+ * nInvalid: files which aren't valid PE or have a malformed table
+ * nDirectories: directories walked
+ * nSteals: tasks taken from the deque of another thread
+ * Microseconds: duration of the scan
+ */
+typedef struct _SCANNER_STATS
+{
+	ULONGLONG nFiles;
+	ULONGLONG nBytes;
+	ULONGLONG nInvalid;
+	ULONGLONG nDirectories;
+	ULONGLONG nSteals;
+	ULONGLONG Microseconds;
+}SCANNER_STATS,*PSCANNER_STATS;
+
+/**
+ * \fn BOOL Scanner_Run(PSCANNER_CONFIG Config, PSCANNER_STATS Stats);
+ * \brief scan all files of a directory tree with a pool of threads
+ * \param Config: parameters of the scan
+ * \param Stats: [out, optional] counters of the scan
+ * \return FALSE if the scan couldn't be started or has been stopped by the callback
+ */
+BOOL Scanner_Run(PSCANNER_CONFIG Config, PSCANNER_STATS Stats);
+
+/**
+ * \fn BOOL Scanner_SummaryCallback(PSCAN_FILE File, PSCAN_OUTPUT Output, LPVOID UserArgs);
+ * \brief default callback: walk sections, imports, exports and relocations of the file
+ * and write one line "path<TAB>error<TAB>sections<TAB>imports<TAB>exports<TAB>relocations"
+ */
+BOOL Scanner_SummaryCallback(PSCAN_FILE File, PSCAN_OUTPUT Output, LPVOID UserArgs);
+
+/**
+ * \fn VOID Scanner_Printf(PSCAN_OUTPUT Output, LPCSTR Format, ...);
+ * \brief append formatted text to the output buffer of the current thread
+ */
+VOID Scanner_Printf(PSCAN_OUTPUT Output, LPCSTR Format, ...);
+
+/**
+ * \fn VOID Scanner_PrintStats(PSCANNER_STATS Stats, FILE* Stream);
+ * \brief print counters and throughput (files/s, MB/s) of a scan
+ */
+VOID Scanner_PrintStats(PSCANNER_STATS Stats, FILE* Stream);
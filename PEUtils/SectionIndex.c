@@ -0,0 +1,257 @@
+/**
+ * \file SectionIndex.c
+ * \brief Defines function described in file SectionIndex.h
+ * \author Tomtombinary
+ * \version 1.0
+ * \date 17 octobre 2026
+ */
+
+#include "stdafx.h"
+#include "SectionIndex.h"
+
+/* span of a section in memory, a null VirtualSize means SizeOfRawData */
+static DWORD SectionIndex_VirtualSize(PIMAGE_SECTION_HEADER lpSectionHeader)
+{
+	if (lpSectionHeader->Misc.VirtualSize != 0)
+		return lpSectionHeader->Misc.VirtualSize;
+	return lpSectionHeader->SizeOfRawData;
+}
+
+static DWORD SectionIndex_VirtualLimit(PIMAGE_SECTION_HEADER lpSectionHeader)
+{
+	ULONGLONG Limit = (ULONGLONG)lpSectionHeader->VirtualAddress + SectionIndex_VirtualSize(lpSectionHeader);
+	return Limit > 0xFFFFFFFF ? 0xFFFFFFFF : (DWORD)Limit;
+}
+
+static int SectionIndex_CompareDword(const void* a, const void* b)
+{
+	DWORD x = *(const DWORD*)a;
+	DWORD y = *(const DWORD*)b;
+	return (x > y) - (x < y);
+}
+
+/* min-heap of section numbers: the first section of the table wins on overlaps */
+static VOID SectionIndex_HeapPush(PDWORD Heap, PDWORD nHeap, DWORD Section)
+{
+	DWORD i = (*nHeap)++;
+	while (i > 0 && Heap[(i - 1) / 2] > Section)
+	{
+		Heap[i] = Heap[(i - 1) / 2];
+		i = (i - 1) / 2;
+	}
+	Heap[i] = Section;
+}
+
+static VOID SectionIndex_HeapPop(PDWORD Heap, PDWORD nHeap)
+{
+	DWORD Last = Heap[--(*nHeap)];
+	DWORD i = 0;
+	DWORD Child;
+	while ((Child = 2 * i + 1) < *nHeap)
+	{
+		if (Child + 1 < *nHeap && Heap[Child + 1] < Heap[Child])
+			Child++;
+		if (Heap[Child] >= Last)
+			break;
+		Heap[i] = Heap[Child];
+		i = Child;
+	}
+	Heap[i] = Last;
+}
+
+static int SectionIndex_CompareQword(const void* a, const void* b)
+{
+	ULONGLONG x = *(const ULONGLONG*)a;
+	ULONGLONG y = *(const ULONGLONG*)b;
+	return (x > y) - (x < y);
+}
+
+/* index of the last range starting before dwRVA, (DWORD)-1 if there is none */
+static DWORD SectionIndex_Predecessor(PSECTION_INDEX Index, DWORD dwRVA)
+{
+	DWORD Low = 0;
+	DWORD High = Index->nRanges;
+	DWORD Middle;
+
+	while (Low < High)
+	{
+		Middle = (Low + High) / 2;
+		if (Index->Starts[Middle] <= dwRVA)
+			Low = Middle + 1;
+		else
+			High = Middle;
+	}
+	return Low - 1;
+}
+
+BOOL PE32_BuildSectionIndex(PPE_IMAGE Image)
+{
+	PSECTION_INDEX Index;
+	PIMAGE_SECTION_HEADER lpSectionHeaders;
+	PIMAGE_SECTION_HEADER lpSection;
+	PDWORD Bounds, Heap;
+	PULONGLONG Order;
+	DWORD nSections, nBounds, nHeap, nNext, i;
+
+	if (Image->SectionIndex != NULL)
+		return TRUE;
+
+	lpSectionHeaders = Image->SectionHeaders;
+	nSections = Image->nSections;
+
+	Index = (PSECTION_INDEX)MemArenaAlloc(&Image->Arena, sizeof(SECTION_INDEX));
+	Bounds = (PDWORD)malloc((2 * nSections + 1) * sizeof(DWORD));
+	Order = (PULONGLONG)malloc((nSections + 1) * sizeof(ULONGLONG));
+	Heap = (PDWORD)malloc((nSections + 1) * sizeof(DWORD));
+	/* at most one range between two consecutive bounds */
+	if (Index != NULL)
+	{
+		Index->Starts = (PDWORD)MemArenaAlloc(&Image->Arena, (2 * nSections + 1) * sizeof(DWORD));
+		Index->Ranges = (PSECTION_RANGE)MemArenaAlloc(&Image->Arena, (2 * nSections + 1) * sizeof(SECTION_RANGE));
+	}
+	if (Index == NULL || Bounds == NULL || Order == NULL || Heap == NULL || Index->Starts == NULL || Index->Ranges == NULL)
+	{
+		free(Bounds);
+		free(Order);
+		free(Heap);
+		return FALSE;
+	}
+
+	/* every start and end of a section is a bound of an elementary range */
+	nBounds = 0;
+	for (i = 0; i < nSections; i++)
+	{
+		lpSection = &lpSectionHeaders[i];
+		/* sort key: VirtualAddress, then position in the section table */
+		Order[i] = ((ULONGLONG)lpSection->VirtualAddress << 32) | i;
+		if (SectionIndex_VirtualSize(lpSection) == 0)
+			continue;
+		Bounds[nBounds++] = lpSection->VirtualAddress;
+		Bounds[nBounds++] = SectionIndex_VirtualLimit(lpSection);
+	}
+	qsort(Bounds, nBounds, sizeof(DWORD), SectionIndex_CompareDword);
+	qsort(Order, nSections, sizeof(ULONGLONG), SectionIndex_CompareQword);
+
+	/* sweep elementary ranges, keeping sections covering the current one in the heap */
+	nHeap = 0;
+	nNext = 0;
+	for (i = 0; i + 1 < nBounds; i++)
+	{
+		DWORD Start = Bounds[i];
+		DWORD Limit = Bounds[i + 1];
+		PSECTION_RANGE Range;
+
+		if (Start == Limit)
+			continue;
+		while (nNext < nSections && (DWORD)(Order[nNext] >> 32) <= Start)
+		{
+			if (SectionIndex_VirtualSize(&lpSectionHeaders[(DWORD)Order[nNext]]) != 0)
+				SectionIndex_HeapPush(Heap, &nHeap, (DWORD)Order[nNext]);
+			nNext++;
+		}
+		while (nHeap > 0 && SectionIndex_VirtualLimit(&lpSectionHeaders[Heap[0]]) <= Start)
+			SectionIndex_HeapPop(Heap, &nHeap);
+		if (nHeap == 0)
+			continue;
+
+		/* extend the previous range if it belongs to the same section */
+		if (Index->nRanges > 0)
+		{
+			Range = &Index->Ranges[Index->nRanges - 1];
+			if (Range->Section == Heap[0] && Range->Limit == Start)
+			{
+				Range->Limit = Limit;
+				continue;
+			}
+		}
+		Index->Starts[Index->nRanges] = Start;
+		Index->Ranges[Index->nRanges].Limit = Limit;
+		Index->Ranges[Index->nRanges].Section = Heap[0];
+		Index->nRanges++;
+	}
+
+	/* file data backing each range */
+	for (i = 0; i < Index->nRanges; i++)
+	{
+		PSECTION_RANGE Range = &Index->Ranges[i];
+		DWORD Delta;
+
+		lpSection = &lpSectionHeaders[Range->Section];
+		Delta = Index->Starts[i] - lpSection->VirtualAddress;
+		Range->RawOffset = lpSection->PointerToRawData + Delta;
+		Range->RawSize = lpSection->SizeOfRawData > Delta ? lpSection->SizeOfRawData - Delta : 0;
+		if (Range->RawSize > Range->Limit - Index->Starts[i])
+			Range->RawSize = Range->Limit - Index->Starts[i];
+	}
+
+	free(Bounds);
+	free(Order);
+	free(Heap);
+	Image->SectionIndex = Index;
+	return TRUE;
+}
+
+PSECTION_RANGE PE32_LookupSectionIndex(PSECTION_INDEX Index, DWORD dwRVA)
+{
+	DWORD i = SectionIndex_Predecessor(Index, dwRVA);
+	if (i == (DWORD)-1 || dwRVA >= Index->Ranges[i].Limit)
+		return NULL;
+	return &Index->Ranges[i];
+}
+
+DWORD PE32_RVAToFileOffsetEx(PPE_IMAGE Image, DWORD dwRVA)
+{
+	PSECTION_INDEX Index;
+	PSECTION_RANGE Range;
+
+	if (!PE32_BuildSectionIndex(Image))
+		return 0;
+	Index = Image->SectionIndex;
+	Range = PE32_LookupSectionIndex(Index, dwRVA);
+	if (Range == NULL)
+		return 0;
+	return Range->RawOffset + (dwRVA - Index->Starts[Range - Index->Ranges]);
+}
+
+BOOL PE32_RVAToFileOffsetBatch(PPE_IMAGE Image, const DWORD* lpRVAs, PDWORD lpFileOffsets, DWORD nCount)
+{
+	PSECTION_INDEX Index;
+	PSECTION_RANGE Range;
+	DWORD Current = 0;
+	DWORD Previous = 0;
+	DWORD dwRVA;
+
+	if (!PE32_BuildSectionIndex(Image))
+		return FALSE;
+	Index = Image->SectionIndex;
+
+	for (DWORD i = 0; i < nCount; i++)
+	{
+		dwRVA = lpRVAs[i];
+		if (Index->nRanges == 0)
+		{
+			lpFileOffsets[i] = 0;
+			continue;
+		}
+		if (dwRVA >= Previous)
+		{
+			/* sorted input: walk forward from the last range */
+			while (Current + 1 < Index->nRanges && Index->Starts[Current + 1] <= dwRVA)
+				Current++;
+		}
+		else
+		{
+			Current = SectionIndex_Predecessor(Index, dwRVA);
+			if (Current == (DWORD)-1)
+				Current = 0;
+		}
+		Previous = dwRVA;
+
+		Range = &Index->Ranges[Current];
+		if (dwRVA >= Index->Starts[Current] && dwRVA < Range->Limit)
+			lpFileOffsets[i] = Range->RawOffset + (dwRVA - Index->Starts[Current]);
+		else
+			lpFileOffsets[i] = 0;
+	}
+	return TRUE;
+}
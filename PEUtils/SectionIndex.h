@@ -0,0 +1,78 @@
+/**
+ * \file SectionIndex.h
+ * \brief Sorted section index to translate relative virtual addresses in O(log n)
+ * \author Tomtombinary
+ * \version 1.0
+ * \date 17 octobre 2026
+ */
+
+#pragma once
+#include "stdafx.h"
+#include "PEUtils.h"
+
+/**
+ * \struct SECTION_RANGE
+ * \brief contiguous range of relative virtual addresses owned by one section
+ * RawOffset: file offset of the first byte of the range
+ * RawSize: number of bytes of the range backed by file data
+ * Section: index of the section in the section table
+ */
+typedef struct _SECTION_RANGE
+{
+	DWORD RawOffset;
+	DWORD RawSize;
+	DWORD Limit;
+	DWORD Section;
+}SECTION_RANGE,*PSECTION_RANGE;
+
+/**
+ * \struct SECTION_INDEX
+ * \brief section table sorted by VirtualAddress, without overlap
+ * Starts[i] is the first RVA of Ranges[i], kept in its own array to keep the binary search in cache.
+ * When sections overlap, the first section of the section table owns the overlapping addresses
+ * (same result as a linear walk of the section table). A section with a null VirtualSize
+ * spans SizeOfRawData bytes, like for the Windows loader. Empty sections are not indexed.
+ */
+typedef struct _SECTION_INDEX
+{
+	DWORD nRanges;
+	PDWORD Starts;
+	PSECTION_RANGE Ranges;
+}SECTION_INDEX,*PSECTION_INDEX;
+
+/**
+ * \fn BOOL PE32_BuildSectionIndex(PPE_IMAGE Image);
+ * \brief build the section index of an image, nothing is done if it already exists
+ * The index lives in the image arena and is released by PE32_CloseImage.
+ * \param Image: image description
+ * \return FALSE if memory couldn't be allocated
+ */
+BOOL PE32_BuildSectionIndex(PPE_IMAGE Image);
+
+/**
+ * \fn PSECTION_RANGE PE32_LookupSectionIndex(PSECTION_INDEX Index, DWORD dwRVA);
+ * \brief binary search of the range containing a relative virtual address
+ * \param Index: section index
+ * \param dwRVA: relative virtual address from module image base
+ * \return the range containing dwRVA, NULL if dwRVA isn't in a section
+ */
+PSECTION_RANGE PE32_LookupSectionIndex(PSECTION_INDEX Index, DWORD dwRVA);
+
+/**
+ * \fn DWORD PE32_RVAToFileOffsetEx(PPE_IMAGE Image, DWORD dwRVA);
+ * \brief same as PE32_RVAToFileOffset, using the section index of the image (built if needed)
+ * \return module file offset, 0 if dwRVA isn't in a section
+ */
+DWORD PE32_RVAToFileOffsetEx(PPE_IMAGE Image, DWORD dwRVA);
+
+/**
+ * \fn BOOL PE32_RVAToFileOffsetBatch(PPE_IMAGE Image, const DWORD* lpRVAs, PDWORD lpFileOffsets, DWORD nCount);
+ * \brief convert an array of relative virtual addresses to file offsets
+ * Sorted runs of RVAs are translated by walking the index forward instead of searching it.
+ * \param Image: image description
+ * \param lpRVAs: relative virtual addresses to convert
+ * \param lpFileOffsets: [out] file offsets, 0 for RVAs outside of sections
+ * \param nCount: number of RVAs
+ * \return FALSE if the section index couldn't be built
+ */
+BOOL PE32_RVAToFileOffsetBatch(PPE_IMAGE Image, const DWORD* lpRVAs, PDWORD lpFileOffsets, DWORD nCount);
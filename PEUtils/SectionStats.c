@@ -0,0 +1,138 @@
+/**
+ * \file SectionStats.c
+ * \brief Defines function described in file SectionStats.h
+ * \author Tomtombinary
+ * \version 1.0
+ * \date 17 octobre 2026
+ */
+
+#include "stdafx.h"
+#include "SectionStats.h"
+#include <math.h>
+
+/* 32 bits counters of the interleaved tables are merged before they can overflow */
+#define STATS_CHUNK 0x40000000
+
+/* add the bytes of a buffer to a histogram */
+static VOID SectionStats_Count(const BYTE* Data, SIZE_T SizeInBytes, PULONGLONG Histogram)
+{
+	DWORD Tables[4][256];
+	ULONGLONG Word;
+	SIZE_T Chunk;
+
+	while (SizeInBytes != 0)
+	{
+		memset(Tables, 0, sizeof(Tables));
+		Chunk = SizeInBytes < STATS_CHUNK ? SizeInBytes : STATS_CHUNK;
+		SizeInBytes -= Chunk;
+
+		for (; Chunk >= sizeof(ULONGLONG); Chunk -= sizeof(ULONGLONG), Data += sizeof(ULONGLONG))
+		{
+			memcpy(&Word, Data, sizeof(ULONGLONG));
+			Tables[0][(BYTE)Word]++;
+			Tables[1][(BYTE)(Word >> 8)]++;
+			Tables[2][(BYTE)(Word >> 16)]++;
+			Tables[3][(BYTE)(Word >> 24)]++;
+			Tables[0][(BYTE)(Word >> 32)]++;
+			Tables[1][(BYTE)(Word >> 40)]++;
+			Tables[2][(BYTE)(Word >> 48)]++;
+			Tables[3][(BYTE)(Word >> 56)]++;
+		}
+		for (; Chunk != 0; Chunk--, Data++)
+			Tables[0][*Data]++;
+
+		for (DWORD i = 0; i < 256; i++)
+			Histogram[i] += (ULONGLONG)Tables[0][i] + Tables[1][i] + Tables[2][i] + Tables[3][i];
+	}
+}
+
+VOID PE32_ComputeByteStats(LPCVOID Buffer, SIZE_T SizeInBytes, PBYTE_STATS Stats)
+{
+	ULONGLONG nPrintable = 0;
+	double Expected, Probability, Delta;
+
+	memset(Stats, 0, sizeof(BYTE_STATS));
+	if (SizeInBytes == 0)
+		return;
+	SectionStats_Count((const BYTE*)Buffer, SizeInBytes, Stats->Histogram);
+	Stats->nBytes = SizeInBytes;
+
+	Expected = (double)SizeInBytes / 256;
+	for (DWORD i = 0; i < 256; i++)
+	{
+		if ((i >= 0x20 && i < 0x7F) || i == '\t' || i == '\r' || i == '\n')
+			nPrintable += Stats->Histogram[i];
+		Delta = (double)Stats->Histogram[i] - Expected;
+		Stats->ChiSquare += Delta * Delta / Expected;
+		if (Stats->Histogram[i] == 0)
+			continue;
+		Probability = (double)Stats->Histogram[i] / (double)SizeInBytes;
+		Stats->Entropy -= Probability * log2(Probability);
+	}
+	Stats->PrintableRatio = (double)nPrintable / (double)SizeInBytes;
+}
+
+VOID PE32_GetSectionStats(PSECTION_ENTRY Section, PBYTE_STATS Stats)
+{
+	SIZE_T SizeInBytes = 0;
+
+	if (Section->SectionLimit > (ULONG_PTR)Section->SectionData)
+		SizeInBytes = (SIZE_T)(Section->SectionLimit - (ULONG_PTR)Section->SectionData);
+	PE32_ComputeByteStats(Section->SectionData, SizeInBytes, Stats);
+}
+
+DWORD PE32_GetSlidingEntropy(LPCVOID Buffer, SIZE_T SizeInBytes, DWORD WindowSize, DWORD Step, double* lpEntropies, DWORD nMax)
+{
+	const BYTE* Data = (const BYTE*)Buffer;
+	DWORD Histogram[256];
+	double* CLogC;
+	double SumCLogC = 0;
+	double LogWindow;
+	SIZE_T Offset;
+	DWORD nWindows = 0;
+	BYTE Value;
+
+	if (WindowSize == 0 || Step == 0 || SizeInBytes < WindowSize || nMax == 0)
+		return 0;
+	/* c*log2(c) for every count a window can hold */
+	CLogC = (double*)malloc(((SIZE_T)WindowSize + 1) * sizeof(double));
+	if (CLogC == NULL)
+		return 0;
+	CLogC[0] = 0;
+	for (DWORD c = 1; c <= WindowSize; c++)
+		CLogC[c] = c * log2((double)c);
+	LogWindow = log2((double)WindowSize);
+
+	/* H = log2(W) - sum(c*log2(c)) / W */
+	for (Offset = 0; Offset + WindowSize <= SizeInBytes && nWindows < nMax; Offset += Step)
+	{
+		if (nWindows == 0 || Step >= WindowSize)
+		{
+			memset(Histogram, 0, sizeof(Histogram));
+			for (DWORD i = 0; i < WindowSize; i++)
+				Histogram[Data[Offset + i]]++;
+			SumCLogC = 0;
+			for (DWORD i = 0; i < 256; i++)
+				SumCLogC += CLogC[Histogram[i]];
+		}
+		else
+		{
+			/* the window moved by Step bytes: the first ones leave, as many enter */
+			for (DWORD i = 0; i < Step; i++)
+			{
+				Value = Data[Offset - Step + i];
+				SumCLogC += CLogC[Histogram[Value] - 1] - CLogC[Histogram[Value]];
+				Histogram[Value]--;
+				Value = Data[Offset + WindowSize - Step + i];
+				SumCLogC += CLogC[Histogram[Value] + 1] - CLogC[Histogram[Value]];
+				Histogram[Value]++;
+			}
+		}
+		lpEntropies[nWindows] = LogWindow - SumCLogC / WindowSize;
+		if (lpEntropies[nWindows] < 0)
+			lpEntropies[nWindows] = 0;
+		nWindows++;
+	}
+	free(CLogC);
+	return nWindows;
+}
@@ -0,0 +1,65 @@
+/**
+ * \file SectionStats.h
+ * \brief Byte histogram, entropy, chi-square and printable ratio of sections
+ * \author Tomtombinary
+ * \version 1.0
+ * \date 17 octobre 2026
+ * The histogram is counted in 4 interleaved tables, so consecutive equal
+ * bytes increment different counters and don't wait for each other's store.
+ * The sliding entropy keeps the histogram of the window and the sum of
+ * c*log2(c) up to date with the bytes which enter and leave it.
+ * Entropy uses <math.h>: link with -lm outside of Windows.
+ */
+
+#pragma once
+#include "stdafx.h"
+#include "PEUtils.h"
+
+/**
+ * \struct BYTE_STATS
+ * \brief statistics of a buffer
+ * Histogram: number of occurrences of each byte value
+ * nBytes: size of the buffer
+ * Entropy: Shannon entropy in bits per byte (0 to 8)
+ * ChiSquare: chi-square of the histogram against a uniform distribution
+ * PrintableRatio: part of the bytes which are printable ASCII characters, tab, CR or LF (0 to 1)
+ */
+typedef struct _BYTE_STATS
+{
+	ULONGLONG Histogram[256];
+	ULONGLONG nBytes;
+	double Entropy;
+	double ChiSquare;
+	double PrintableRatio;
+}BYTE_STATS,*PBYTE_STATS;
+
+/**
+ * \fn VOID PE32_ComputeByteStats(LPCVOID Buffer, SIZE_T SizeInBytes, PBYTE_STATS Stats);
+ * \brief compute the statistics of a buffer
+ * \param Buffer: data
+ * \param SizeInBytes: size of the data
+ * \param Stats: [out] statistics, all zero for an empty buffer
+ */
+VOID PE32_ComputeByteStats(LPCVOID Buffer, SIZE_T SizeInBytes, PBYTE_STATS Stats);
+
+/**
+ * \fn VOID PE32_GetSectionStats(PSECTION_ENTRY Section, PBYTE_STATS Stats);
+ * \brief compute the statistics of a section, from SectionData to SectionLimit
+ * \param Section: section given by PE32_EnumSections or PE32_EnumSectionsEx
+ * \param Stats: [out] statistics
+ */
+VOID PE32_GetSectionStats(PSECTION_ENTRY Section, PBYTE_STATS Stats);
+
+/**
+ * \fn DWORD PE32_GetSlidingEntropy(LPCVOID Buffer, SIZE_T SizeInBytes, DWORD WindowSize, DWORD Step, double* lpEntropies, DWORD nMax);
+ * \brief entropy of windows of a buffer, to find encrypted or compressed blobs inside a large section
+ * Window i starts at offset i * Step, windows which would end beyond the buffer are skipped.
+ * \param Buffer: data
+ * \param SizeInBytes: size of the data
+ * \param WindowSize: size of a window in bytes
+ * \param Step: distance between the starts of two windows (at least 1)
+ * \param lpEntropies: [out] entropy of each window, in bits per byte
+ * \param nMax: capacity of lpEntropies
+ * \return number of windows computed, 0 if the buffer is smaller than a window or memory couldn't be allocated
+ */
+DWORD PE32_GetSlidingEntropy(LPCVOID Buffer, SIZE_T SizeInBytes, DWORD WindowSize, DWORD Step, double* lpEntropies, DWORD nMax);
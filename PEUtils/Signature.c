@@ -0,0 +1,542 @@
+/**
+ * \file Signature.c
+ * \brief Defines function described in file Signature.h
+ * \author Tomtombinary
+ * \version 1.0
+ * \date 17 octobre 2026
+ */
+
+#include "stdafx.h"
+#include "Signature.h"
+#include "CpuUtils.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+/* anchors of 4 bytes are hashed on SIGNATURE_QUAD_BITS bits, their buckets are indexed by the high bits of the hash */
+#define SIGNATURE_QUAD_BITS 20
+#define SIGNATURE_QUAD_BUCKET_BITS 16
+#define SIGNATURE_QUADS (1 << SIGNATURE_QUAD_BITS)
+#define SIGNATURE_PAIRS 0x10000
+#define SIGNATURE_HASH(x) (((DWORD)(x) * 0x9E3779B1) >> (32 - SIGNATURE_QUAD_BITS))
+#define SIGNATURE_QUAD_BUCKET(h) ((h) >> (SIGNATURE_QUAD_BITS - SIGNATURE_QUAD_BUCKET_BITS))
+#define SIGNATURE_PAIRS_BUCKET (1 << SIGNATURE_QUAD_BUCKET_BITS)
+#define SIGNATURE_SINGLES_BUCKET (SIGNATURE_PAIRS_BUCKET + SIGNATURE_PAIRS)
+#define SIGNATURE_BUCKETS (SIGNATURE_SINGLES_BUCKET + 256)
+
+/**
+ * \struct SIGNATURE_SCAN
+ * \brief state of a scan given to the kernels
+ */
+typedef struct _SIGNATURE_SCAN
+{
+	PSIGNATURE_SET Set;
+	PSECTION_ENTRY Section;
+	DWORD BaseRVA;
+	DWORD dwCharacteristics;
+	SignatureMatchCallback pFuncCallback;
+	LPVOID lpUserArgs;
+}SIGNATURE_SCAN,*PSIGNATURE_SCAN;
+
+typedef BOOL(*SignatureScanRoutine)(PSIGNATURE_SCAN Scan, PBYTE Data, SIZE_T Size);
+
+/* kernel chosen by Signature_InitKernel for the running processor */
+static volatile SignatureScanRoutine Signature_Kernel = NULL;
+
+/* bytes frequent in x86 code and data, bad anchors */
+static const BYTE Signature_CommonBytes[] = {
+	0x00, 0xFF, 0x01, 0x0F, 0x24, 0x33, 0x44, 0x45, 0x48, 0x4C, 0x50, 0x74, 0x75, 0x83,
+	0x84, 0x85, 0x89, 0x8B, 0x8D, 0x90, 0xC0, 0xC3, 0xCC, 0xE8, 0xEB
+};
+
+static int Signature_HexDigit(char c)
+{
+	if (c >= '0' && c <= '9')
+		return c - '0';
+	if (c >= 'a' && c <= 'f')
+		return c - 'a' + 10;
+	if (c >= 'A' && c <= 'F')
+		return c - 'A' + 10;
+	return -1;
+}
+
+BOOL Signature_AddPattern(PSIGNATURE_SET Set, LPCSTR Pattern, DWORD Id)
+{
+	PSIGNATURE_PATTERN lpPattern;
+	DWORD Length = 0;
+	BOOL bFixed = FALSE;
+	int High, Low;
+
+	lpPattern = (PSIGNATURE_PATTERN)MemArenaAlloc(&Set->Arena, sizeof(SIGNATURE_PATTERN));
+	if (lpPattern == NULL)
+		return FALSE;
+	/* a byte needs at least 2 characters */
+	lpPattern->Values = (PBYTE)MemArenaAlloc(&Set->Arena, strlen(Pattern) / 2 + 1);
+	lpPattern->Masks = (PBYTE)MemArenaAlloc(&Set->Arena, strlen(Pattern) / 2 + 1);
+	if (lpPattern->Values == NULL || lpPattern->Masks == NULL)
+		return FALSE;
+
+	while (*Pattern != '\0')
+	{
+		if (*Pattern == ' ' || *Pattern == '\t')
+		{
+			Pattern++;
+			continue;
+		}
+		if (Pattern[1] == '\0')
+			return FALSE;
+		High = Pattern[0] == '?' ? 0x10 : Signature_HexDigit(Pattern[0]);
+		Low = Pattern[1] == '?' ? 0x10 : Signature_HexDigit(Pattern[1]);
+		if (High < 0 || Low < 0)
+			return FALSE;
+		lpPattern->Masks[Length] = (BYTE)((High == 0x10 ? 0 : 0xF0) | (Low == 0x10 ? 0 : 0x0F));
+		lpPattern->Values[Length] = (BYTE)(((High & 0xF) << 4) | (Low & 0xF)) & lpPattern->Masks[Length];
+		if (lpPattern->Masks[Length] == 0xFF)
+			bFixed = TRUE;
+		Length++;
+		Pattern += 2;
+	}
+	/* a pattern without fixed byte can't be anchored */
+	if (!bFixed)
+		return FALSE;
+
+	lpPattern->Id = Id;
+	lpPattern->Length = Length;
+	lpPattern->Next = Set->Patterns;
+	Set->Patterns = lpPattern;
+	Set->nPatterns++;
+	Set->Compiled = FALSE;
+	return TRUE;
+}
+
+/* anchor on the longest run of fixed bytes (up to 4) least likely to be seen, reusing first bytes already chosen */
+static VOID Signature_ChooseAnchor(PSIGNATURE_PATTERN lpPattern, const BYTE* Common, const BYTE* UsedLeads)
+{
+	DWORD Cost, BestCost = 0xFFFFFFFF;
+	DWORD Run, AnchorLength;
+	BYTE Lead;
+
+	for (DWORD k = 0; k < lpPattern->Length; k++)
+	{
+		if (lpPattern->Masks[k] != 0xFF)
+			continue;
+		for (Run = 1; Run < 4 && k + Run < lpPattern->Length && lpPattern->Masks[k + Run] == 0xFF; Run++)
+			;
+		AnchorLength = Run == 4 ? 4 : (Run >= 2 ? 2 : 1);
+		/* a longer anchor always wins */
+		Cost = AnchorLength == 4 ? 0 : (AnchorLength == 2 ? 64 : 128);
+		Lead = lpPattern->Values[k];
+		Cost += Common[Lead] ? 8 : (UsedLeads[Lead] ? 1 : 2);
+		for (DWORD j = 1; j < AnchorLength; j++)
+			Cost += Common[lpPattern->Values[k + j]];
+		if (Cost < BestCost)
+		{
+			BestCost = Cost;
+			lpPattern->Anchor = k;
+			lpPattern->AnchorLength = AnchorLength;
+		}
+	}
+}
+
+/* pshufb tables of the first bytes of anchors: rows (high nibbles) with the same set of low nibbles share a bit */
+static VOID Signature_BuildNibbles(PSIGNATURE_SET Set, const BYTE* UsedLeads)
+{
+	WORD Rows[16];
+	WORD Groups[8];
+	DWORD nGroups = 0, g;
+
+	memset(Set->LoNibbles, 0, sizeof(Set->LoNibbles));
+	memset(Set->HiNibbles, 0, sizeof(Set->HiNibbles));
+	for (DWORD h = 0; h < 16; h++)
+	{
+		Rows[h] = 0;
+		for (DWORD l = 0; l < 16; l++)
+		{
+			if (UsedLeads[h << 4 | l])
+				Rows[h] |= (WORD)(1 << l);
+		}
+		if (Rows[h] == 0)
+			continue;
+		for (g = 0; g < nGroups; g++)
+		{
+			if (Groups[g] == Rows[h])
+				break;
+		}
+		/* more than 8 different rows: extra rows are merged in a group, the pairs bitmap removes false positives */
+		if (g == nGroups)
+		{
+			if (nGroups < 8)
+				Groups[nGroups++] = Rows[h];
+			else
+				g = h & 7;
+		}
+		Set->HiNibbles[h] |= (BYTE)(1 << g);
+		for (DWORD l = 0; l < 16; l++)
+		{
+			if (Rows[h] & (1 << l))
+				Set->LoNibbles[l] |= (BYTE)(1 << g);
+		}
+	}
+}
+
+/* bit of the anchor of a pattern in the bitmap of its length: hash of the quad, pair or byte */
+static DWORD Signature_GetAnchorBit(PSIGNATURE_PATTERN lpPattern)
+{
+	PBYTE Anchor = lpPattern->Values + lpPattern->Anchor;
+
+	if (lpPattern->AnchorLength == 4)
+		return SIGNATURE_HASH(Anchor[0] | Anchor[1] << 8 | Anchor[2] << 16 | (DWORD)Anchor[3] << 24);
+	if (lpPattern->AnchorLength == 2)
+		return Anchor[0] | Anchor[1] << 8;
+	return Anchor[0];
+}
+
+static DWORD Signature_GetBucket(PSIGNATURE_PATTERN lpPattern)
+{
+	DWORD Bit = Signature_GetAnchorBit(lpPattern);
+
+	if (lpPattern->AnchorLength == 4)
+		return SIGNATURE_QUAD_BUCKET(Bit);
+	if (lpPattern->AnchorLength == 2)
+		return SIGNATURE_PAIRS_BUCKET + Bit;
+	return SIGNATURE_SINGLES_BUCKET + Bit;
+}
+
+BOOL Signature_Compile(PSIGNATURE_SET Set)
+{
+	BYTE Common[256] = { 0 };
+	BYTE UsedLeads[256] = { 0 };
+	PSIGNATURE_PATTERN lpPattern;
+	PSIGNATURE_ENTRY lpEntry;
+	DWORD Bucket, Bit;
+	PDWORD Fill;
+
+	for (DWORD i = 0; i < sizeof(Signature_CommonBytes); i++)
+		Common[Signature_CommonBytes[i]] = 1;
+
+	Set->Compiled = FALSE;
+	Set->nQuads = Set->nPairs = Set->nSingles = 0;
+	memset(Set->Singles, 0, sizeof(Set->Singles));
+	Set->Quads = (PBYTE)MemArenaAlloc(&Set->Arena, SIGNATURE_QUADS / 8);
+	Set->Pairs = (PBYTE)MemArenaAlloc(&Set->Arena, SIGNATURE_PAIRS / 8);
+	Set->BucketFirst = (PDWORD)MemArenaAlloc(&Set->Arena, (SIGNATURE_BUCKETS + 1) * sizeof(DWORD));
+	Set->Entries = (PSIGNATURE_ENTRY)MemArenaAlloc(&Set->Arena, Set->nPatterns * sizeof(SIGNATURE_ENTRY));
+	Fill = (PDWORD)malloc(SIGNATURE_BUCKETS * sizeof(DWORD));
+	if (Set->Quads == NULL || Set->Pairs == NULL || Set->BucketFirst == NULL || Set->Entries == NULL || Fill == NULL)
+	{
+		free(Fill);
+		return FALSE;
+	}
+
+	/* count the patterns of each bucket and set the bits of their anchors */
+	for (lpPattern = Set->Patterns; lpPattern != NULL; lpPattern = lpPattern->Next)
+	{
+		Signature_ChooseAnchor(lpPattern, Common, UsedLeads);
+		UsedLeads[lpPattern->Values[lpPattern->Anchor]] = 1;
+		Set->BucketFirst[Signature_GetBucket(lpPattern) + 1]++;
+		Bit = Signature_GetAnchorBit(lpPattern);
+		if (lpPattern->AnchorLength == 4)
+		{
+			Set->Quads[Bit >> 3] |= (BYTE)(1 << (Bit & 7));
+			Set->nQuads++;
+		}
+		else if (lpPattern->AnchorLength == 2)
+		{
+			Set->Pairs[Bit >> 3] |= (BYTE)(1 << (Bit & 7));
+			Set->nPairs++;
+		}
+		else
+		{
+			Set->Singles[Bit >> 3] |= (BYTE)(1 << (Bit & 7));
+			Set->nSingles++;
+		}
+	}
+	for (Bucket = 0; Bucket < SIGNATURE_BUCKETS; Bucket++)
+	{
+		Set->BucketFirst[Bucket + 1] += Set->BucketFirst[Bucket];
+		Fill[Bucket] = Set->BucketFirst[Bucket];
+	}
+
+	for (lpPattern = Set->Patterns; lpPattern != NULL; lpPattern = lpPattern->Next)
+	{
+		lpEntry = &Set->Entries[Fill[Signature_GetBucket(lpPattern)]++];
+		lpEntry->Pattern = lpPattern;
+		lpEntry->Value = lpEntry->Mask = 0;
+		for (DWORD j = 0; j < sizeof(ULONGLONG) && j < lpPattern->Length; j++)
+		{
+			lpEntry->Value |= (ULONGLONG)lpPattern->Values[j] << (8 * j);
+			lpEntry->Mask |= (ULONGLONG)lpPattern->Masks[j] << (8 * j);
+		}
+	}
+	free(Fill);
+
+	Signature_BuildNibbles(Set, UsedLeads);
+	Set->Compiled = TRUE;
+	return TRUE;
+}
+
+VOID Signature_ReleaseSet(PSIGNATURE_SET Set)
+{
+	MemArenaRelease(&Set->Arena);
+	memset(Set, 0, sizeof(SIGNATURE_SET));
+}
+
+/* read up to 8 bytes, bytes beyond the buffer read as 0 */
+static ULONGLONG Signature_ReadQword(PBYTE Data, SIZE_T Size, SIZE_T Offset)
+{
+	ULONGLONG Qword = 0;
+
+	if (Offset + sizeof(ULONGLONG) <= Size)
+		memcpy(&Qword, Data + Offset, sizeof(ULONGLONG));
+	else
+	{
+		for (DWORD j = 0; Offset + j < Size; j++)
+			Qword |= (ULONGLONG)Data[Offset + j] << (8 * j);
+	}
+	return Qword;
+}
+
+/* compare the patterns of a bucket anchored at Data[Offset] */
+static BOOL Signature_VerifyBucket(PSIGNATURE_SCAN Scan, PBYTE Data, SIZE_T Size, SIZE_T Offset, DWORD Bucket)
+{
+	PSIGNATURE_SET Set = Scan->Set;
+	PSIGNATURE_ENTRY lpEntry;
+	PSIGNATURE_PATTERN lpPattern;
+	SIGNATURE_MATCH Match;
+	SIZE_T Start;
+	DWORD i;
+
+	for (DWORD e = Set->BucketFirst[Bucket]; e < Set->BucketFirst[Bucket + 1]; e++)
+	{
+		lpEntry = &Set->Entries[e];
+		lpPattern = lpEntry->Pattern;
+		if (Offset < lpPattern->Anchor || Offset - lpPattern->Anchor + lpPattern->Length > Size)
+			continue;
+		Start = Offset - lpPattern->Anchor;
+		if ((Signature_ReadQword(Data, Size, Start) & lpEntry->Mask) != lpEntry->Value)
+			continue;
+		for (i = sizeof(ULONGLONG); i < lpPattern->Length; i++)
+		{
+			if ((Data[Start + i] & lpPattern->Masks[i]) != lpPattern->Values[i])
+				break;
+		}
+		if (i < lpPattern->Length)
+			continue;
+		Match.Id = lpPattern->Id;
+		Match.RVA = Scan->BaseRVA + (DWORD)Start;
+		Match.Section = Scan->Section;
+		Match.Data = Data + Start;
+		if (!Scan->pFuncCallback(&Match, Scan->lpUserArgs))
+			return FALSE;
+	}
+	return TRUE;
+}
+
+/* look for the anchors starting at Data[Offset] in the bitmaps of each length */
+static BOOL Signature_Verify(PSIGNATURE_SCAN Scan, PBYTE Data, SIZE_T Size, SIZE_T Offset)
+{
+	PSIGNATURE_SET Set = Scan->Set;
+	DWORD Word = 0, Bit;
+
+	/* bytes beyond the buffer read as 0, patterns needing them are rejected by the size check */
+	if (Offset + sizeof(DWORD) <= Size)
+		memcpy(&Word, Data + Offset, sizeof(DWORD));
+	else
+		Word = (DWORD)Signature_ReadQword(Data, Size, Offset);
+
+	if (Set->nQuads != 0)
+	{
+		Bit = SIGNATURE_HASH(Word);
+		if ((Set->Quads[Bit >> 3] & (1 << (Bit & 7))) && !Signature_VerifyBucket(Scan, Data, Size, Offset, SIGNATURE_QUAD_BUCKET(Bit)))
+			return FALSE;
+	}
+	if (Set->nPairs != 0)
+	{
+		Bit = Word & 0xFFFF;
+		if ((Set->Pairs[Bit >> 3] & (1 << (Bit & 7))) && !Signature_VerifyBucket(Scan, Data, Size, Offset, SIGNATURE_PAIRS_BUCKET + Bit))
+			return FALSE;
+	}
+	if (Set->nSingles != 0)
+	{
+		Bit = Data[Offset];
+		if ((Set->Singles[Bit >> 3] & (1 << (Bit & 7))) && !Signature_VerifyBucket(Scan, Data, Size, Offset, SIGNATURE_SINGLES_BUCKET + Bit))
+			return FALSE;
+	}
+	return TRUE;
+}
+
+static BOOL Signature_Scan_Scalar(PSIGNATURE_SCAN Scan, PBYTE Data, SIZE_T Size)
+{
+	for (SIZE_T i = 0; i < Size; i++)
+	{
+		if (!Signature_Verify(Scan, Data, Size, i))
+			return FALSE;
+	}
+	return TRUE;
+}
+
+/* verify each bit of the mask of candidates found at Data[Offset] */
+static BOOL Signature_VerifyMask(PSIGNATURE_SCAN Scan, PBYTE Data, SIZE_T Size, SIZE_T Offset, DWORD Mask)
+{
+	while (Mask != 0)
+	{
+#ifdef _MSC_VER
+		unsigned long Bit;
+		_BitScanForward(&Bit, Mask);
+#else
+		DWORD Bit = (DWORD)__builtin_ctz(Mask);
+#endif
+		if (!Signature_Verify(Scan, Data, Size, Offset + Bit))
+			return FALSE;
+		Mask &= Mask - 1;
+	}
+	return TRUE;
+}
+
+#ifdef CPU_X86
+CPU_TARGET("ssse3") static BOOL Signature_Scan_SSSE3(PSIGNATURE_SCAN Scan, PBYTE Data, SIZE_T Size)
+{
+	__m128i LoNibbles = _mm_loadu_si128((const __m128i*)Scan->Set->LoNibbles);
+	__m128i HiNibbles = _mm_loadu_si128((const __m128i*)Scan->Set->HiNibbles);
+	__m128i Nibble = _mm_set1_epi8(0x0F);
+	__m128i Zero = _mm_setzero_si128();
+	__m128i Block, Classes;
+	SIZE_T i;
+	DWORD Mask;
+
+	for (i = 0; i + 16 <= Size; i += 16)
+	{
+		Block = _mm_loadu_si128((const __m128i*)(Data + i));
+		Classes = _mm_and_si128(_mm_shuffle_epi8(LoNibbles, _mm_and_si128(Block, Nibble)),
+			_mm_shuffle_epi8(HiNibbles, _mm_and_si128(_mm_srli_epi16(Block, 4), Nibble)));
+		Mask = ~(DWORD)_mm_movemask_epi8(_mm_cmpeq_epi8(Classes, Zero)) & 0xFFFF;
+		if (Mask != 0 && !Signature_VerifyMask(Scan, Data, Size, i, Mask))
+			return FALSE;
+	}
+	for (; i < Size; i++)
+	{
+		if (!Signature_Verify(Scan, Data, Size, i))
+			return FALSE;
+	}
+	return TRUE;
+}
+
+/* lanes of Words (4 bytes read at 8 positions) whose anchor bits are set in a bitmap */
+CPU_TARGET("avx2") static __m256i Signature_Gather_AVX2(__m256i Hits, PBYTE Bitmap, __m256i Bit)
+{
+	__m256i Bits = _mm256_i32gather_epi32((const int*)Bitmap, _mm256_srli_epi32(Bit, 5), 4);
+	return _mm256_or_si256(Hits, _mm256_and_si256(Bits, _mm256_sllv_epi32(_mm256_set1_epi32(1), _mm256_and_si256(Bit, _mm256_set1_epi32(31)))));
+}
+
+CPU_TARGET("avx2") static BOOL Signature_Scan_AVX2(PSIGNATURE_SCAN Scan, PBYTE Data, SIZE_T Size)
+{
+	PSIGNATURE_SET Set = Scan->Set;
+	__m256i LoNibbles = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)Set->LoNibbles));
+	__m256i HiNibbles = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)Set->HiNibbles));
+	__m256i Nibble = _mm256_set1_epi8(0x0F);
+	__m256i Zero = _mm256_setzero_si256();
+	__m256i Block, Classes, Words, Hits;
+	SIZE_T i;
+	DWORD Mask, Lane;
+
+	/* the words of the last position of a block end 3 bytes after it */
+	for (i = 0; i + 32 + 3 <= Size; i += 32)
+	{
+		Block = _mm256_loadu_si256((const __m256i*)(Data + i));
+		Classes = _mm256_and_si256(_mm256_shuffle_epi8(LoNibbles, _mm256_and_si256(Block, Nibble)),
+			_mm256_shuffle_epi8(HiNibbles, _mm256_and_si256(_mm256_srli_epi16(Block, 4), Nibble)));
+		if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(Classes, Zero)) == -1)
+			continue;
+		/* lane j of the load at i + k holds the word of position i + k + 4 * j */
+		for (DWORD k = 0; k < 4; k++)
+		{
+			Words = _mm256_loadu_si256((const __m256i*)(Data + i + k));
+			Hits = Zero;
+			if (Set->nQuads != 0)
+				Hits = Signature_Gather_AVX2(Hits, Set->Quads, _mm256_srli_epi32(_mm256_mullo_epi32(Words, _mm256_set1_epi32((int)0x9E3779B1)), 32 - SIGNATURE_QUAD_BITS));
+			if (Set->nPairs != 0)
+				Hits = Signature_Gather_AVX2(Hits, Set->Pairs, _mm256_and_si256(Words, _mm256_set1_epi32(0xFFFF)));
+			if (Set->nSingles != 0)
+				Hits = Signature_Gather_AVX2(Hits, Set->Singles, _mm256_and_si256(Words, _mm256_set1_epi32(0xFF)));
+			Mask = ~(DWORD)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(Hits, Zero))) & 0xFF;
+			while (Mask != 0)
+			{
+#ifdef _MSC_VER
+				_BitScanForward((unsigned long*)&Lane, Mask);
+#else
+				Lane = (DWORD)__builtin_ctz(Mask);
+#endif
+				if (!Signature_Verify(Scan, Data, Size, i + k + 4 * Lane))
+					return FALSE;
+				Mask &= Mask - 1;
+			}
+		}
+	}
+	for (; i < Size; i++)
+	{
+		if (!Signature_Verify(Scan, Data, Size, i))
+			return FALSE;
+	}
+	return TRUE;
+}
+#endif
+
+static VOID Signature_InitKernel(VOID)
+{
+	SignatureScanRoutine Kernel = Signature_Scan_Scalar;
+#ifdef CPU_X86
+	DWORD Features = CpuUtils_GetFeatures();
+
+	if (Features & CPU_FEATURE_AVX2)
+		Kernel = Signature_Scan_AVX2;
+	else if (Features & CPU_FEATURE_SSSE3)
+		Kernel = Signature_Scan_SSSE3;
+#endif
+	Signature_Kernel = Kernel;
+}
+
+BOOL Signature_ScanBuffer(PSIGNATURE_SET Set, LPCVOID Buffer, SIZE_T SizeInBytes, SignatureMatchCallback pFuncCallback, LPVOID lpUserArgs)
+{
+	SIGNATURE_SCAN Scan;
+
+	if (!Set->Compiled)
+		return FALSE;
+	if (Signature_Kernel == NULL)
+		Signature_InitKernel();
+	Scan.Set = Set;
+	Scan.Section = NULL;
+	Scan.BaseRVA = 0;
+	Scan.dwCharacteristics = 0;
+	Scan.pFuncCallback = pFuncCallback;
+	Scan.lpUserArgs = lpUserArgs;
+	return Signature_Kernel(&Scan, (PBYTE)Buffer, SizeInBytes);
+}
+
+static BOOL Signature_ScanSection(PSECTION_ENTRY lpSectionEntry, LPVOID UserArgs)
+{
+	PSIGNATURE_SCAN Scan = (PSIGNATURE_SCAN)UserArgs;
+
+	if ((lpSectionEntry->header->Characteristics & Scan->dwCharacteristics) != Scan->dwCharacteristics)
+		return TRUE;
+	if (lpSectionEntry->SectionLimit <= (ULONG_PTR)lpSectionEntry->SectionData)
+		return TRUE;
+	Scan->Section = lpSectionEntry;
+	Scan->BaseRVA = lpSectionEntry->header->VirtualAddress;
+	return Signature_Kernel(Scan, lpSectionEntry->SectionData, (SIZE_T)(lpSectionEntry->SectionLimit - (ULONG_PTR)lpSectionEntry->SectionData));
+}
+
+BOOL PE32_ScanSignatures(PPE_IMAGE Image, PSIGNATURE_SET Set, DWORD dwCharacteristics, SignatureMatchCallback pFuncCallback, LPVOID lpUserArgs)
+{
+	SIGNATURE_SCAN Scan;
+
+	if (!Set->Compiled)
+		return FALSE;
+	if (Signature_Kernel == NULL)
+		Signature_InitKernel();
+	Scan.Set = Set;
+	Scan.dwCharacteristics = dwCharacteristics;
+	Scan.pFuncCallback = pFuncCallback;
+	Scan.lpUserArgs = lpUserArgs;
+	return PE32_EnumSectionsEx(Image, Signature_ScanSection, &Scan);
+}
@@ -0,0 +1,151 @@
+/**
+ * \file Signature.h
+ * \brief Multi-pattern scan of hex signatures with wildcards in sections
+ * \author Tomtombinary
+ * \version 1.0
+ * \date 17 octobre 2026
+ * Patterns are compiled into a single matcher. Each pattern gets an anchor:
+ * 4 consecutive fixed bytes, else 2, else 1. Bytes of the section which can
+ * start an anchor are found 16 or 32 at a time with pshufb nibble tables,
+ * then the bytes following them are checked in bitmaps of anchors and only
+ * the patterns of the matching buckets are compared.
+ */
+
+#pragma once
+#include "stdafx.h"
+#include "PEUtils.h"
+#include "MemUtils.h"
+
+/**
+ * \struct SIGNATURE_PATTERN
+ * \brief a parsed pattern: byte i matches when (Data[i] & Masks[i]) == Values[i]
+ * Anchor is the offset of the anchor inside the pattern, AnchorLength its
+ * number of fixed bytes (4, 2 or 1).
+ */
+typedef struct _SIGNATURE_PATTERN
+{
+	struct _SIGNATURE_PATTERN* Next;
+	DWORD Id;
+	DWORD Length;
+	DWORD Anchor;
+	DWORD AnchorLength;
+	PBYTE Values;
+	PBYTE Masks;
+}SIGNATURE_PATTERN,*PSIGNATURE_PATTERN;
+
+/**
+ * \struct SIGNATURE_ENTRY
+ * \brief a pattern in a bucket, with its first 8 bytes to reject most candidates without reading the pattern
+ * Value and Mask are little endian, bytes beyond the pattern have a null mask.
+ */
+typedef struct _SIGNATURE_ENTRY
+{
+	ULONGLONG Value;
+	ULONGLONG Mask;
+	PSIGNATURE_PATTERN Pattern;
+}SIGNATURE_ENTRY,*PSIGNATURE_ENTRY;
+
+/**
+ * \struct SIGNATURE_SET
+ * \brief patterns and their compiled matcher
+ * A zeroed SIGNATURE_SET is a valid empty set. After Signature_Compile the
+ * set is only read by scans and can be shared by threads.
+ * LoNibbles/HiNibbles: pshufb tables, a byte can start an anchor when
+ * LoNibbles[b & 15] & HiNibbles[b >> 4] isn't 0 (false positives possible).
+ * Quads: bitmap of the hashes of anchors of 4 bytes.
+ * Pairs: bitmap of anchors of 2 bytes, bit (b0 | b1 << 8).
+ * Singles: bitmap of anchors of 1 byte.
+ * BucketFirst/Entries: buckets of the high bits of the hashes of quads, then
+ * of the pairs, then of the single bytes, bucket i is Entries[BucketFirst[i]] .. Entries[BucketFirst[i+1]-1].
+ */
+typedef struct _SIGNATURE_SET
+{
+	MEM_ARENA Arena;
+	PSIGNATURE_PATTERN Patterns;
+	DWORD nPatterns;
+	BOOL Compiled;
+	BYTE LoNibbles[16];
+	BYTE HiNibbles[16];
+	DWORD nQuads;
+	DWORD nPairs;
+	DWORD nSingles;
+	PBYTE Quads;
+	PBYTE Pairs;
+	BYTE Singles[32];
+	PDWORD BucketFirst;
+	PSIGNATURE_ENTRY Entries;
+}SIGNATURE_SET,*PSIGNATURE_SET;
+
+/**
+ * \struct SIGNATURE_MATCH
+ * \brief a pattern found in a section
+ * Id: identifier given to Signature_AddPattern
+ * RVA: relative virtual address of the first byte of the match
+ * Section: section of the match, NULL for Signature_ScanBuffer
+ * Data: pointer to the first byte of the match
+ */
+typedef struct _SIGNATURE_MATCH
+{
+	DWORD Id;
+	DWORD RVA;
+	PSECTION_ENTRY Section;
+	PBYTE Data;
+}SIGNATURE_MATCH,*PSIGNATURE_MATCH;
+
+/**
+ * Callback function type for PE32_ScanSignatures and Signature_ScanBuffer
+ */
+typedef BOOL(*SignatureMatchCallback)(PSIGNATURE_MATCH lpMatch, LPVOID UserArgs);
+
+/**
+ * \fn BOOL Signature_AddPattern(PSIGNATURE_SET Set, LPCSTR Pattern, DWORD Id);
+ * \brief parse a pattern like "8B 45 ?? 3D ?? ?? 00 00" and add it to a set
+ * Bytes are 2 hexadecimal digits, spaces are optional, "??" matches any byte
+ * and "?" matches any nibble ("4?", "?5"). The set must be compiled again before a scan.
+ * \param Set: signature set
+ * \param Pattern: pattern, at least one byte without wildcard
+ * \param Id: identifier reported in matches
+ * \return FALSE if pattern is malformed or memory couldn't be allocated
+ */
+BOOL Signature_AddPattern(PSIGNATURE_SET Set, LPCSTR Pattern, DWORD Id);
+
+/**
+ * \fn BOOL Signature_Compile(PSIGNATURE_SET Set);
+ * \brief choose anchors and build the matcher of all patterns added to a set
+ * \param Set: signature set
+ * \return FALSE if memory couldn't be allocated
+ */
+BOOL Signature_Compile(PSIGNATURE_SET Set);
+
+/**
+ * \fn VOID Signature_ReleaseSet(PSIGNATURE_SET Set);
+ * \brief release patterns and matcher, the set is empty and can be reused
+ * \param Set: signature set
+ */
+VOID Signature_ReleaseSet(PSIGNATURE_SET Set);
+
+/**
+ * \fn BOOL Signature_ScanBuffer(PSIGNATURE_SET Set, LPCVOID Buffer, SIZE_T SizeInBytes, SignatureMatchCallback pFuncCallback, LPVOID lpUserArgs);
+ * \brief find all patterns of a compiled set in a buffer, RVA of matches is their offset in the buffer
+ * Matches aren't sorted by RVA.
+ * \param Set: compiled signature set
+ * \param Buffer: data
+ * \param SizeInBytes: size of the data
+ * \param pFuncCallback: called for each match, returns FALSE to stop the scan
+ * \param lpUserArgs: user argument given to the callback
+ * \return FALSE if the set isn't compiled or the callback stopped the scan
+ */
+BOOL Signature_ScanBuffer(PSIGNATURE_SET Set, LPCVOID Buffer, SIZE_T SizeInBytes, SignatureMatchCallback pFuncCallback, LPVOID lpUserArgs);
+
+/**
+ * \fn BOOL PE32_ScanSignatures(PPE_IMAGE Image, PSIGNATURE_SET Set, DWORD dwCharacteristics, SignatureMatchCallback pFuncCallback, LPVOID lpUserArgs);
+ * \brief find all patterns of a compiled set in the sections of an image
+ * Matches don't cross section boundaries and aren't sorted by RVA.
+ * \param Image: image description
+ * \param Set: compiled signature set
+ * \param dwCharacteristics: only sections with all these IMAGE_SCN_* flags are scanned (ex: IMAGE_SCN_MEM_EXECUTE), 0 for all sections
+ * \param pFuncCallback: called for each match, returns FALSE to stop the scan
+ * \param lpUserArgs: user argument given to the callback
+ * \return FALSE if the set isn't compiled or the callback stopped the scan
+ */
+BOOL PE32_ScanSignatures(PPE_IMAGE Image, PSIGNATURE_SET Set, DWORD dwCharacteristics, SignatureMatchCallback pFuncCallback, LPVOID lpUserArgs);
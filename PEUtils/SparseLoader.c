@@ -0,0 +1,322 @@
+/**
+ * \file SparseLoader.c
+ * \brief Defines function described in file SparseLoader.h
+ * \author Tomtombinary
+ * \version 1.0
+ * \date 17 octobre 2026
+ */
+
+#include "stdafx.h"
+#include "SparseLoader.h"
+#include "MemUtils.h"
+#include "PETraits.h"
+
+#define SPARSE_PAGE_SIZE 0x1000
+/* absent pages between two requested runs read anyway to save a request */
+#define SPARSE_MAX_GAP 4
+
+#define SPARSE_PAGE_ABSENT 0
+#define SPARSE_PAGE_REQUESTED 1
+#define SPARSE_PAGE_RESIDENT 2
+
+typedef struct _SPARSE_LOADER
+{
+	PPE_IMAGE Image;
+	PFILE_VIEW View;
+	PFILE_READER Reader;
+	PBYTE Pages;
+	SIZE_T nPages;
+	SIZE_T nRequested;
+	ULONGLONG BytesRead;
+}SPARSE_LOADER,*PSPARSE_LOADER;
+
+static VOID Sparse_Request(PSPARSE_LOADER Loader, ULONGLONG Offset, ULONGLONG Size)
+{
+	SIZE_T Page, LastPage;
+
+	if (Size == 0 || Offset >= Loader->View->Size)
+		return;
+	if (Size > Loader->View->Size - Offset)
+		Size = Loader->View->Size - Offset;
+	LastPage = (SIZE_T)((Offset + Size - 1) / SPARSE_PAGE_SIZE);
+	for (Page = (SIZE_T)(Offset / SPARSE_PAGE_SIZE); Page <= LastPage; Page++)
+	{
+		if (Loader->Pages[Page] == SPARSE_PAGE_ABSENT)
+		{
+			Loader->Pages[Page] = SPARSE_PAGE_REQUESTED;
+			Loader->nRequested++;
+		}
+	}
+}
+
+static BOOL Sparse_IsResident(PSPARSE_LOADER Loader, LPVOID Data, ULONGLONG Size)
+{
+	ULONGLONG Offset = (PBYTE)Data - Loader->View->Data;
+	SIZE_T Page, LastPage;
+
+	if (Size == 0)
+		return TRUE;
+	if (Offset >= Loader->View->Size || Size > Loader->View->Size - Offset)
+		return FALSE;
+	LastPage = (SIZE_T)((Offset + Size - 1) / SPARSE_PAGE_SIZE);
+	for (Page = (SIZE_T)(Offset / SPARSE_PAGE_SIZE); Page <= LastPage; Page++)
+	{
+		if (Loader->Pages[Page] != SPARSE_PAGE_RESIDENT)
+			return FALSE;
+	}
+	return TRUE;
+}
+
+/* request a range by RVA, returns TRUE if it is already resident */
+static BOOL Sparse_RequestRVA(PSPARSE_LOADER Loader, DWORD dwRVA, ULONGLONG Size)
+{
+	PBYTE lpData = (PBYTE)PE32_RVAToPointer(Loader->Image, dwRVA);
+
+	if (lpData == NULL)
+		return FALSE;
+	Sparse_Request(Loader, lpData - Loader->View->Data, Size);
+	return Sparse_IsResident(Loader, lpData, Size);
+}
+
+/* request the pages of a string until its terminator, returns TRUE if it is entirely resident */
+static BOOL Sparse_RequestString(PSPARSE_LOADER Loader, LPCSTR String)
+{
+	SIZE_T Offset, PageEnd;
+
+	if (String == NULL)
+		return TRUE;
+	for (Offset = (PBYTE)String - Loader->View->Data; Offset < Loader->View->Size; Offset = PageEnd)
+	{
+		PageEnd = (Offset / SPARSE_PAGE_SIZE + 1) * SPARSE_PAGE_SIZE;
+		if (PageEnd > Loader->View->Size)
+			PageEnd = Loader->View->Size;
+		if (Loader->Pages[Offset / SPARSE_PAGE_SIZE] != SPARSE_PAGE_RESIDENT)
+		{
+			Sparse_Request(Loader, Offset, 1);
+			return FALSE;
+		}
+		if (memchr(Loader->View->Data + Offset, 0, PageEnd - Offset) != NULL)
+			return TRUE;
+	}
+	return TRUE;
+}
+
+/* read all requested pages, runs of pages are coalesced */
+static BOOL Sparse_Fetch(PSPARSE_LOADER Loader)
+{
+	PFILE_RANGE Ranges;
+	DWORD nRanges = 0;
+	SIZE_T Page, RunEnd = 0;
+	BOOL bSuccess;
+
+	if (Loader->nRequested == 0)
+		return TRUE;
+	Ranges = (PFILE_RANGE)malloc(Loader->nRequested * sizeof(FILE_RANGE));
+	if (Ranges == NULL)
+		return FALSE;
+
+	for (Page = 0; Page < Loader->nPages; Page++)
+	{
+		if (Loader->Pages[Page] != SPARSE_PAGE_REQUESTED)
+			continue;
+		if (nRanges > 0 && Page - RunEnd <= SPARSE_MAX_GAP)
+		{
+			/* absent pages of the gap become resident too */
+			Ranges[nRanges - 1].Size = (Page + 1) * SPARSE_PAGE_SIZE - Ranges[nRanges - 1].Offset;
+			for (; RunEnd <= Page; RunEnd++)
+				Loader->Pages[RunEnd] = SPARSE_PAGE_RESIDENT;
+			continue;
+		}
+		Ranges[nRanges].Offset = (ULONGLONG)Page * SPARSE_PAGE_SIZE;
+		Ranges[nRanges].Size = SPARSE_PAGE_SIZE;
+		nRanges++;
+		Loader->Pages[Page] = SPARSE_PAGE_RESIDENT;
+		RunEnd = Page + 1;
+	}
+
+	bSuccess = FileUtils_ReadView(Loader->Reader, Loader->View, Ranges, nRanges);
+	for (DWORD i = 0; i < nRanges; i++)
+	{
+		if (Ranges[i].Offset + Ranges[i].Size > Loader->View->Size)
+			Ranges[i].Size = (SIZE_T)(Loader->View->Size - Ranges[i].Offset);
+		Loader->BytesRead += Ranges[i].Size;
+	}
+	free(Ranges);
+	Loader->nRequested = 0;
+	return bSuccess;
+}
+
+static BOOL Sparse_LoadHeaders(PSPARSE_LOADER Loader)
+{
+	PIMAGE_DOS_HEADER lpDOSHeader = (PIMAGE_DOS_HEADER)Loader->View->Data;
+	PIMAGE_NT_HEADERS32 lpNtHeaders;
+	ULONGLONG HeadersEnd;
+
+	Sparse_Request(Loader, 0, SPARSE_PAGE_SIZE);
+	if (!Sparse_Fetch(Loader))
+		return FALSE;
+	/* PE32_InitImage reports the errors of the headers */
+	if (Loader->View->Size < sizeof(IMAGE_DOS_HEADER) || lpDOSHeader->e_lfanew < 0)
+		return TRUE;
+
+	/* from e_lfanew, large enough for both widths of optional header: the DOS stub isn't read again */
+	HeadersEnd = (ULONGLONG)lpDOSHeader->e_lfanew + sizeof(IMAGE_NT_HEADERS64);
+	Sparse_Request(Loader, lpDOSHeader->e_lfanew, HeadersEnd - lpDOSHeader->e_lfanew);
+	if (!Sparse_Fetch(Loader))
+		return FALSE;
+	if ((ULONGLONG)lpDOSHeader->e_lfanew + sizeof(IMAGE_NT_HEADERS32) > Loader->View->Size)
+		return TRUE;
+
+	lpNtHeaders = (PIMAGE_NT_HEADERS32)(Loader->View->Data + lpDOSHeader->e_lfanew);
+	HeadersEnd = (ULONGLONG)lpDOSHeader->e_lfanew + offsetof(IMAGE_NT_HEADERS32, OptionalHeader)
+		+ lpNtHeaders->FileHeader.SizeOfOptionalHeader
+		+ (ULONGLONG)lpNtHeaders->FileHeader.NumberOfSections * sizeof(IMAGE_SECTION_HEADER);
+	Sparse_Request(Loader, lpDOSHeader->e_lfanew, HeadersEnd - lpDOSHeader->e_lfanew);
+	return Sparse_Fetch(Loader);
+}
+
+static VOID Sparse_RequestExports(PSPARSE_LOADER Loader)
+{
+	PPE_DIRECTORY lpDirectory = &Loader->Image->Directories[IMAGE_DIRECTORY_ENTRY_EXPORT];
+	PIMAGE_EXPORT_DIRECTORY lpExportDirectory = (PIMAGE_EXPORT_DIRECTORY)lpDirectory->Data;
+	PDWORD lpAddressOfFunctions;
+	PDWORD lpAddressOfNames;
+
+	if (lpExportDirectory == NULL || lpDirectory->Size < sizeof(IMAGE_EXPORT_DIRECTORY))
+		return;
+	Sparse_RequestRVA(Loader, lpExportDirectory->AddressOfNameOrdinals, (ULONGLONG)lpExportDirectory->NumberOfNames * sizeof(WORD));
+
+	if (Sparse_RequestRVA(Loader, lpExportDirectory->AddressOfFunctions, (ULONGLONG)lpExportDirectory->NumberOfFunctions * sizeof(DWORD)))
+	{
+		/* forwarder strings start in the directory but may end after it */
+		lpAddressOfFunctions = (PDWORD)PE32_RVAToPointer(Loader->Image, lpExportDirectory->AddressOfFunctions);
+		for (DWORD i = 0; i < lpExportDirectory->NumberOfFunctions; i++)
+		{
+			if (lpAddressOfFunctions[i] - lpDirectory->VirtualAddress < lpDirectory->Size)
+				Sparse_RequestString(Loader, (LPCSTR)PE32_RVAToPointer(Loader->Image, lpAddressOfFunctions[i]));
+		}
+	}
+
+	if (Sparse_RequestRVA(Loader, lpExportDirectory->AddressOfNames, (ULONGLONG)lpExportDirectory->NumberOfNames * sizeof(DWORD)))
+	{
+		lpAddressOfNames = (PDWORD)PE32_RVAToPointer(Loader->Image, lpExportDirectory->AddressOfNames);
+		for (DWORD i = 0; i < lpExportDirectory->NumberOfNames; i++)
+			Sparse_RequestString(Loader, (LPCSTR)PE32_RVAToPointer(Loader->Image, lpAddressOfNames[i]));
+	}
+}
+
+static VOID Sparse_RequestImports(PSPARSE_LOADER Loader)
+{
+	PPE_DIRECTORY lpDirectory = &Loader->Image->Directories[IMAGE_DIRECTORY_ENTRY_IMPORT];
+	PIMAGE_IMPORT_DESCRIPTOR lpImportDesc = (PIMAGE_IMPORT_DESCRIPTOR)lpDirectory->Data;
+	PBYTE Limit = (PBYTE)lpDirectory->Data + lpDirectory->Size;
+	PCPE_TRAITS Traits = Loader->Image->Traits;
+	PIMAGE_IMPORT_BY_NAME pImportByName;
+	PBYTE HintNameRVAArray;
+	ULONGLONG Thunk;
+	DWORD nThunks;
+
+	if (lpImportDesc == NULL)
+		return;
+	for (; (PBYTE)(lpImportDesc + 1) <= Limit && !MemIsNull(lpImportDesc, sizeof(IMAGE_IMPORT_DESCRIPTOR)); lpImportDesc++)
+	{
+		Sparse_RequestString(Loader, (LPCSTR)PE32_RVAToPointer(Loader->Image, lpImportDesc->Name));
+
+		/* the lookup table is read page by page until its null entry */
+		HintNameRVAArray = (PBYTE)PE32_RVAToPointer(Loader->Image, lpImportDesc->OriginalFirstThunk != 0 ? lpImportDesc->OriginalFirstThunk : lpImportDesc->FirstThunk);
+		if (HintNameRVAArray == NULL)
+			continue;
+		for (nThunks = 0; ; nThunks++, HintNameRVAArray += Traits->ThunkSize)
+		{
+			if (!Sparse_IsResident(Loader, HintNameRVAArray, Traits->ThunkSize))
+			{
+				Sparse_Request(Loader, HintNameRVAArray - Loader->View->Data, Traits->ThunkSize);
+				break;
+			}
+			/* thunks are 4 or 8 bytes wide, little endian */
+			Thunk = 0;
+			memcpy(&Thunk, HintNameRVAArray, Traits->ThunkSize);
+			if (Thunk == 0)
+				break;
+			if (Thunk & Traits->OrdinalFlag)
+				continue;
+			pImportByName = (PIMAGE_IMPORT_BY_NAME)PE32_RVAToPointer(Loader->Image, (DWORD)Thunk);
+			if (pImportByName != NULL && Sparse_RequestRVA(Loader, (DWORD)Thunk, sizeof(WORD)))
+				Sparse_RequestString(Loader, (LPCSTR)pImportByName->Name);
+		}
+		/* IAT entries of the thunks known so far */
+		Sparse_RequestRVA(Loader, lpImportDesc->FirstThunk, (ULONGLONG)nThunks * Traits->ThunkSize);
+	}
+}
+
+BOOL PE32_OpenFileSparse(LPCSTR Path, DWORD Tables, PFILE_READER Reader, PPE_IMAGE Image, PULONGLONG lpBytesRead)
+{
+	SPARSE_LOADER Loader;
+	FILE_VIEW View;
+	PPE_DIRECTORY lpDirectory;
+	BOOL bSuccess = FALSE;
+	DWORD i;
+
+	if (lpBytesRead != NULL)
+		*lpBytesRead = 0;
+	if (!FileUtils_OpenSparseView(Path, &View))
+	{
+		memset(Image, 0, sizeof(PE_IMAGE));
+		Image->Error = PE_ERROR_FILE;
+		return FALSE;
+	}
+
+	memset(&Loader, 0, sizeof(SPARSE_LOADER));
+	Loader.Image = Image;
+	Loader.View = &View;
+	Loader.Reader = Reader;
+	Loader.nPages = (View.Size + SPARSE_PAGE_SIZE - 1) / SPARSE_PAGE_SIZE;
+	Loader.Pages = (PBYTE)calloc(Loader.nPages, 1);
+	if (Loader.Pages == NULL || !Sparse_LoadHeaders(&Loader))
+	{
+		memset(Image, 0, sizeof(PE_IMAGE));
+		Image->Error = PE_ERROR_FILE;
+		goto End;
+	}
+	if (!PE32_InitImage(Image, View.Data, View.Size, PE_LAYOUT_FILE))
+		goto End;
+
+	/* directories themselves */
+	for (i = 0; i < IMAGE_NUMBEROF_DIRECTORY_ENTRIES; i++)
+	{
+		lpDirectory = &Image->Directories[i];
+		if (lpDirectory->Data == NULL)
+			continue;
+		if ((i == IMAGE_DIRECTORY_ENTRY_EXPORT && (Tables & PE_TABLE_EXPORTS))
+			|| (i == IMAGE_DIRECTORY_ENTRY_IMPORT && (Tables & PE_TABLE_IMPORTS))
+			|| (i == IMAGE_DIRECTORY_ENTRY_BASERELOC && (Tables & PE_TABLE_RELOCS)))
+			Sparse_Request(&Loader, (PBYTE)lpDirectory->Data - View.Data, lpDirectory->Size);
+	}
+	bSuccess = Sparse_Fetch(&Loader);
+
+	/* then what they reference, until nothing is missing (a round makes its pages resident, at most nPages rounds) */
+	while (bSuccess)
+	{
+		if (Tables & PE_TABLE_EXPORTS)
+			Sparse_RequestExports(&Loader);
+		if (Tables & PE_TABLE_IMPORTS)
+			Sparse_RequestImports(&Loader);
+		if (Loader.nRequested == 0)
+			break;
+		bSuccess = Sparse_Fetch(&Loader);
+	}
+	if (!bSuccess)
+		Image->Error = PE_ERROR_FILE;
+
+End:
+	free(Loader.Pages);
+	if (lpBytesRead != NULL)
+		*lpBytesRead = Loader.BytesRead;
+	if (!bSuccess)
+	{
+		FileUtils_UnmapFile(&View);
+		return FALSE;
+	}
+	Image->View = View;
+	return TRUE;
+}
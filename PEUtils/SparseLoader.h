@@ -0,0 +1,30 @@
+/**
+ * \file SparseLoader.h
+ * \brief Partial loading of a PE file: headers and a few tables only
+ * \author Tomtombinary
+ * \version 1.0
+ * \date 17 octobre 2026
+ * The header page is read first. The section table then tells which file
+ * ranges the requested directories map to, and only the pages of those
+ * ranges are read, by rounds: directories, then the arrays and names they
+ * reference. Reads of a round are batched (io_uring on Linux, see
+ * FILE_READER). The rest of the image is zero-filled memory which is never
+ * committed, so a table which wasn't requested is seen as empty or
+ * truncated, never as an invalid access.
+ */
+
+#pragma once
+#include "stdafx.h"
+#include "PEUtils.h"
+
+/**
+ * \fn BOOL PE32_OpenFileSparse(LPCSTR Path, DWORD Tables, PFILE_READER Reader, PPE_IMAGE Image, PULONGLONG lpBytesRead);
+ * \brief open a PE file as a PE_LAYOUT_FILE image, reading only headers and the requested tables
+ * \param Path: path of the PE file
+ * \param Tables: PE_TABLE_* flags of the tables to load (exports, imports, relocations)
+ * \param Reader: [optional] reader batching the reads, NULL to read each range directly
+ * \param Image: [out] image description, must be released with PE32_CloseImage
+ * \param lpBytesRead: [out, optional] number of bytes read from the file
+ * \return FALSE if the file couldn't be read or isn't a valid PE, Image->Error gives the reason
+ */
+BOOL PE32_OpenFileSparse(LPCSTR Path, DWORD Tables, PFILE_READER Reader, PPE_IMAGE Image, PULONGLONG lpBytesRead);
@@ -0,0 +1,514 @@
+/**
+ * \file StringScan.c
+ * \brief Defines function described in file StringScan.h
+ * \author Tomtombinary
+ * \version 1.0
+ * \date 17 octobre 2026
+ */
+
+#include "stdafx.h"
+#include "StringScan.h"
+#include "CpuUtils.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#define STRING_BLOCK 128
+
+/* streams of characters followed by a cursor */
+#define STRING_STREAM_ASCII 0
+#define STRING_STREAM_EVEN 1
+#define STRING_STREAM_ODD 2
+
+/* masks of the printable bytes (0x20 - 0x7E and tab) and of the null bytes of a block, 64 bytes per ULONGLONG */
+typedef VOID(*StringClassifyRoutine)(const BYTE* Data, PULONGLONG Printable, PULONGLONG Zeros);
+
+/* kernel chosen by StringScan_InitKernel for the running processor */
+static volatile StringClassifyRoutine StringScan_Kernel = NULL;
+
+static DWORD StringScan_LowestBit(ULONGLONG Mask)
+{
+#if defined(_MSC_VER) && defined(_WIN64)
+	unsigned long Bit;
+	_BitScanForward64(&Bit, Mask);
+	return Bit;
+#elif defined(_MSC_VER)
+	unsigned long Bit;
+	if (_BitScanForward(&Bit, (DWORD)Mask))
+		return Bit;
+	_BitScanForward(&Bit, (DWORD)(Mask >> 32));
+	return Bit + 32;
+#else
+	return (DWORD)__builtin_ctzll(Mask);
+#endif
+}
+
+static DWORD StringScan_HighestBit(ULONGLONG Mask)
+{
+#if defined(_MSC_VER) && defined(_WIN64)
+	unsigned long Bit;
+	_BitScanReverse64(&Bit, Mask);
+	return Bit;
+#elif defined(_MSC_VER)
+	unsigned long Bit;
+	if (_BitScanReverse(&Bit, (DWORD)(Mask >> 32)))
+		return Bit + 32;
+	_BitScanReverse(&Bit, (DWORD)Mask);
+	return Bit;
+#else
+	return 63 - (DWORD)__builtin_clzll(Mask);
+#endif
+}
+
+/* bits 0, 2, 4 ... 62 of Mask packed in 32 bits */
+static DWORD StringScan_EvenBits(ULONGLONG Mask)
+{
+	Mask &= 0x5555555555555555ULL;
+	Mask = (Mask | (Mask >> 1)) & 0x3333333333333333ULL;
+	Mask = (Mask | (Mask >> 2)) & 0x0F0F0F0F0F0F0F0FULL;
+	Mask = (Mask | (Mask >> 4)) & 0x00FF00FF00FF00FFULL;
+	Mask = (Mask | (Mask >> 8)) & 0x0000FFFF0000FFFFULL;
+	Mask = (Mask | (Mask >> 16)) & 0x00000000FFFFFFFFULL;
+	return (DWORD)Mask;
+}
+
+static VOID StringScan_Classify_Scalar(const BYTE* Data, PULONGLONG Printable, PULONGLONG Zeros)
+{
+	for (DWORD h = 0; h < 2; h++)
+	{
+		Printable[h] = 0;
+		Zeros[h] = 0;
+		for (DWORD i = 0; i < 64; i++)
+		{
+			BYTE b = Data[64 * h + i];
+			Printable[h] |= (ULONGLONG)((b >= 0x20 && b <= 0x7E) || b == '\t') << i;
+			Zeros[h] |= (ULONGLONG)(b == 0) << i;
+		}
+	}
+}
+
+#ifdef CPU_X86
+/* signed compares: bytes above 0x7F are negative, so not greater than 0x1F */
+CPU_TARGET("sse2") static VOID StringScan_Classify_SSE2(const BYTE* Data, PULONGLONG Printable, PULONGLONG Zeros)
+{
+	__m128i Space = _mm_set1_epi8(0x1F);
+	__m128i Delete = _mm_set1_epi8(0x7F);
+	__m128i Tab = _mm_set1_epi8('\t');
+	__m128i Zero = _mm_setzero_si128();
+	__m128i Block, Mask;
+
+	for (DWORD h = 0; h < 2; h++)
+	{
+		Printable[h] = 0;
+		Zeros[h] = 0;
+		for (DWORD k = 0; k < 4; k++)
+		{
+			Block = _mm_loadu_si128((const __m128i*)(Data + 64 * h + 16 * k));
+			Mask = _mm_or_si128(_mm_and_si128(_mm_cmpgt_epi8(Block, Space), _mm_cmpgt_epi8(Delete, Block)), _mm_cmpeq_epi8(Block, Tab));
+			Printable[h] |= (ULONGLONG)(DWORD)_mm_movemask_epi8(Mask) << (16 * k);
+			Zeros[h] |= (ULONGLONG)(DWORD)_mm_movemask_epi8(_mm_cmpeq_epi8(Block, Zero)) << (16 * k);
+		}
+	}
+}
+
+CPU_TARGET("avx2") static VOID StringScan_Classify_AVX2(const BYTE* Data, PULONGLONG Printable, PULONGLONG Zeros)
+{
+	__m256i Space = _mm256_set1_epi8(0x1F);
+	__m256i Delete = _mm256_set1_epi8(0x7F);
+	__m256i Tab = _mm256_set1_epi8('\t');
+	__m256i Zero = _mm256_setzero_si256();
+	__m256i Block, Mask;
+
+	for (DWORD h = 0; h < 2; h++)
+	{
+		Printable[h] = 0;
+		Zeros[h] = 0;
+		for (DWORD k = 0; k < 2; k++)
+		{
+			Block = _mm256_loadu_si256((const __m256i*)(Data + 64 * h + 32 * k));
+			Mask = _mm256_or_si256(_mm256_and_si256(_mm256_cmpgt_epi8(Block, Space), _mm256_cmpgt_epi8(Delete, Block)), _mm256_cmpeq_epi8(Block, Tab));
+			Printable[h] |= (ULONGLONG)(DWORD)_mm256_movemask_epi8(Mask) << (32 * k);
+			Zeros[h] |= (ULONGLONG)(DWORD)_mm256_movemask_epi8(_mm256_cmpeq_epi8(Block, Zero)) << (32 * k);
+		}
+	}
+}
+#endif
+
+static VOID StringScan_InitKernel(VOID)
+{
+	StringClassifyRoutine Kernel = StringScan_Classify_Scalar;
+#ifdef CPU_X86
+	DWORD Features = CpuUtils_GetFeatures();
+
+	if (Features & CPU_FEATURE_AVX2)
+		Kernel = StringScan_Classify_AVX2;
+	else if (Features & CPU_FEATURE_SSE2)
+		Kernel = StringScan_Classify_SSE2;
+#endif
+	StringScan_Kernel = Kernel;
+}
+
+static BYTE StringScan_Lower(BYTE Char)
+{
+	return Char >= 'A' && Char <= 'Z' ? Char - 'A' + 'a' : Char;
+}
+
+/* FNV-1a of Length characters Stride bytes apart, ASCII case ignored */
+static DWORD StringScan_Hash(const BYTE* Data, DWORD Length, DWORD Stride)
+{
+	DWORD Hash = 0x811c9dc5;
+
+	for (DWORD i = 0; i < Length; i++)
+	{
+		Hash ^= StringScan_Lower(Data[i * Stride]);
+		Hash *= 0x01000193;
+	}
+	return Hash;
+}
+
+/* 0 if the strings differ, 1 if they differ by the case only, 2 if they are equal */
+static DWORD StringScan_Compare(LPCSTR Name, const BYTE* Data, DWORD Length, DWORD Stride)
+{
+	DWORD Result = 2;
+
+	for (DWORD i = 0; i < Length; i++)
+	{
+		if ((BYTE)Name[i] == Data[i * Stride])
+			continue;
+		if (StringScan_Lower((BYTE)Name[i]) != StringScan_Lower(Data[i * Stride]))
+			return 0;
+		Result = 1;
+	}
+	return Result;
+}
+
+/* add a name, or its references to the slot of the same bytes */
+static VOID StringScan_AddName(PSTRING_NAMES Names, LPCSTR Name, DWORD References)
+{
+	DWORD Length = (DWORD)strlen(Name);
+	DWORD Hash = StringScan_Hash((const BYTE*)Name, Length, 1);
+	PSTRING_NAME lpSlot;
+
+	if (Length == 0)
+		return;
+	for (DWORD Slot = Hash & Names->Mask;; Slot = (Slot + 1) & Names->Mask)
+	{
+		lpSlot = &Names->Slots[Slot];
+		if (lpSlot->Name == NULL)
+			break;
+		if (lpSlot->Hash == Hash && lpSlot->Length == Length && StringScan_Compare(lpSlot->Name, (const BYTE*)Name, Length, 1) == 2)
+		{
+			lpSlot->References |= References;
+			return;
+		}
+	}
+	lpSlot->Name = Name;
+	lpSlot->Length = Length;
+	lpSlot->Hash = Hash;
+	lpSlot->References = References;
+	Names->nNames++;
+	if (Names->nNames == 1 || Length < Names->MinLength)
+		Names->MinLength = Length;
+	if (Length > Names->MaxLength)
+		Names->MaxLength = Length;
+}
+
+/* counted in a first pass (Names->Slots NULL), added in a second one */
+typedef struct _STRING_NAMES_BUILD
+{
+	PPE_IMAGE Image;
+	PSTRING_NAMES Names;
+	DWORD nNames;
+	PIMAGE_IMPORT_DESCRIPTOR LastDescriptor;
+}STRING_NAMES_BUILD,*PSTRING_NAMES_BUILD;
+
+static BOOL StringScan_CallbackAddExport(PEXPORT_ENTRY lpExportEntry, LPVOID UserArgs)
+{
+	PSTRING_NAMES_BUILD Build = (PSTRING_NAMES_BUILD)UserArgs;
+
+	if (Build->Names->Slots == NULL)
+		Build->nNames++;
+	else if (lpExportEntry->Name != NULL)
+		StringScan_AddName(Build->Names, lpExportEntry->Name, STRING_REF_EXPORT);
+	return TRUE;
+}
+
+static BOOL StringScan_CallbackAddImport(PIMPORT_ENTRY lpImportEntry, LPVOID UserArgs)
+{
+	PSTRING_NAMES_BUILD Build = (PSTRING_NAMES_BUILD)UserArgs;
+	LPCSTR DllName;
+
+	if (Build->Names->Slots == NULL)
+	{
+		Build->nNames += 1 + (lpImportEntry->pImportDesc != Build->LastDescriptor);
+		Build->LastDescriptor = lpImportEntry->pImportDesc;
+		return TRUE;
+	}
+	if (lpImportEntry->pImportByName != NULL)
+		StringScan_AddName(Build->Names, (LPCSTR)lpImportEntry->pImportByName->Name, STRING_REF_IMPORT);
+	/* the DLL name once per descriptor */
+	if (lpImportEntry->pImportDesc != Build->LastDescriptor)
+	{
+		DllName = (LPCSTR)PE32_RVAToPointer(Build->Image, lpImportEntry->pImportDesc->Name);
+		if (DllName != NULL)
+			StringScan_AddName(Build->Names, DllName, STRING_REF_DLL);
+		Build->LastDescriptor = lpImportEntry->pImportDesc;
+	}
+	return TRUE;
+}
+
+BOOL PE32_BuildStringNames(PPE_IMAGE Image)
+{
+	PIMAGE_EXPORT_DIRECTORY lpExportDirectory = (PIMAGE_EXPORT_DIRECTORY)Image->Directories[IMAGE_DIRECTORY_ENTRY_EXPORT].Data;
+	STRING_NAMES_BUILD Build;
+	PSTRING_NAMES Names;
+	LPCSTR ImageName;
+	DWORD nSlots = 16;
+
+	if (Image->StringNames != NULL)
+		return TRUE;
+	Names = (PSTRING_NAMES)MemArenaAlloc(&Image->Arena, sizeof(STRING_NAMES));
+	if (Names == NULL)
+		return FALSE;
+
+	/* malformed tables give no names: their strings are still extracted */
+	Build.Image = Image;
+	Build.Names = Names;
+	Build.nNames = 1;
+	Build.LastDescriptor = NULL;
+	PE32_EnumExportsEx(Image, StringScan_CallbackAddExport, &Build);
+	PE32_EnumImportsEx(Image, StringScan_CallbackAddImport, &Build);
+	while (nSlots < 2 * Build.nNames)
+		nSlots *= 2;
+	Names->Slots = (PSTRING_NAME)MemArenaAlloc(&Image->Arena, (SIZE_T)nSlots * sizeof(STRING_NAME));
+	if (Names->Slots == NULL)
+		return FALSE;
+	Names->Mask = nSlots - 1;
+
+	Build.LastDescriptor = NULL;
+	PE32_EnumExportsEx(Image, StringScan_CallbackAddExport, &Build);
+	PE32_EnumImportsEx(Image, StringScan_CallbackAddImport, &Build);
+	if (lpExportDirectory != NULL && lpExportDirectory->Name != 0)
+	{
+		ImageName = (LPCSTR)PE32_RVAToPointer(Image, lpExportDirectory->Name);
+		if (ImageName != NULL)
+			StringScan_AddName(Names, ImageName, STRING_REF_DLL);
+	}
+	Image->StringNames = Names;
+	return TRUE;
+}
+
+/* STRING_REF_* flags of the names equal to a string */
+static WORD StringScan_Lookup(PSTRING_NAMES Names, PSTRING_ENTRY Entry)
+{
+	const BYTE* Data = (const BYTE*)Entry->Data;
+	DWORD Stride = Entry->Encoding == STRING_ENCODING_UTF16 ? 2 : 1;
+	DWORD Hash, Match;
+	PSTRING_NAME lpSlot;
+	WORD References = 0;
+
+	if (Entry->Length < Names->MinLength || Entry->Length > Names->MaxLength)
+		return 0;
+	Hash = StringScan_Hash(Data, Entry->Length, Stride);
+	for (DWORD Slot = Hash & Names->Mask; Names->Slots[Slot].Name != NULL; Slot = (Slot + 1) & Names->Mask)
+	{
+		lpSlot = &Names->Slots[Slot];
+		if (lpSlot->Hash != Hash || lpSlot->Length != Entry->Length)
+			continue;
+		Match = StringScan_Compare(lpSlot->Name, Data, Entry->Length, Stride);
+		/* function names are case sensitive, DLL names aren't */
+		if (Match == 2)
+			References |= (WORD)lpSlot->References | (lpSlot->Name == (LPCSTR)Data ? STRING_REF_TABLE : 0);
+		else if (Match == 1)
+			References |= (WORD)(lpSlot->References & STRING_REF_DLL);
+	}
+	return References;
+}
+
+BOOL PE32_InitStringCursor(PPE_IMAGE Image, PSECTION_ENTRY Section, DWORD MinLength, DWORD Flags, PSTRING_CURSOR Cursor)
+{
+	if (StringScan_Kernel == NULL)
+		StringScan_InitKernel();
+	memset(Cursor, 0, offsetof(STRING_CURSOR, Pending));
+	Cursor->Image = Image;
+	Cursor->Section = *Section;
+	if (Section->SectionLimit > (ULONG_PTR)Section->SectionData)
+		Cursor->Size = (SIZE_T)(Section->SectionLimit - (ULONG_PTR)Section->SectionData);
+	Cursor->MinLength = MinLength != 0 ? MinLength : STRING_DEFAULT_MIN_LENGTH;
+	Cursor->Flags = Flags;
+	if (Flags & STRING_REFERENCES)
+	{
+		if (!PE32_BuildStringNames(Image))
+			return FALSE;
+		Cursor->Names = Image->StringNames;
+	}
+	return TRUE;
+}
+
+/* write the string of Length characters from character Start of a stream, if it is long enough */
+static DWORD StringScan_Emit(PSTRING_CURSOR Cursor, DWORD Stream, DWORD Start, DWORD Length, PSTRING_ENTRY Entry)
+{
+	PIMAGE_SECTION_HEADER Header = Cursor->Section.header;
+	DWORD Offset;
+
+	if (Length < Cursor->MinLength)
+		return 0;
+	Offset = Stream == STRING_STREAM_ASCII ? Start : 2 * Start + (Stream == STRING_STREAM_ODD);
+	Entry->Section = Header;
+	Entry->Data = Cursor->Section.SectionData + Offset;
+	Entry->RVA = Header->VirtualAddress + Offset;
+	if (Cursor->Image->Layout == PE_LAYOUT_FILE || Offset < Header->SizeOfRawData)
+		Entry->FileOffset = Header->PointerToRawData + Offset;
+	else
+		Entry->FileOffset = STRING_NO_FILE_OFFSET;
+	Entry->Length = Length;
+	Entry->Encoding = Stream == STRING_STREAM_ASCII ? STRING_ENCODING_ASCII : STRING_ENCODING_UTF16;
+	Entry->References = Cursor->Names != NULL ? StringScan_Lookup(Cursor->Names, Entry) : 0;
+	return 1;
+}
+
+/* strings of a stream ending in the block of 64 characters starting at character Base */
+static DWORD StringScan_Runs(PSTRING_CURSOR Cursor, DWORD Stream, ULONGLONG Mask, DWORD Base, PSTRING_ENTRY Out)
+{
+	PSTRING_RUN Run = &Cursor->Runs[Stream];
+	DWORD Width = Cursor->MinLength < 64 ? Cursor->MinLength : 64;
+	DWORD Position = 0, n = 0, Bit;
+	ULONGLONG Long, Bits;
+
+	if (Mask == 0 && !Run->bActive)
+	{
+		Run->Previous = 0;
+		return 0;
+	}
+	/* bit p of Long: characters p - Width + 1 .. p are printable, only runs with such a bit are long enough */
+	Long = Mask;
+	for (DWORD s = 1; s < Width; s++)
+		Long &= (Mask << s) | (Run->Previous >> (64 - s));
+	while (TRUE)
+	{
+		if (Run->bActive)
+		{
+			Bits = ~Mask >> Position << Position;
+			if (Bits == 0)
+				break;
+			Bit = StringScan_LowestBit(Bits);
+			n += StringScan_Emit(Cursor, Stream, Run->Start, Base + Bit - Run->Start, Out + n);
+			Run->bActive = FALSE;
+			Position = Bit;
+		}
+		Bits = Long >> Position << Position;
+		if (Bits == 0)
+			break;
+		Bit = StringScan_LowestBit(Bits);
+		/* the run starts after the last non printable character below, or in a previous block */
+		Bits = ~Mask & (((ULONGLONG)1 << Bit) - 1);
+		if (Bits != 0)
+			Run->Start = Base + StringScan_HighestBit(Bits) + 1;
+		else
+			Run->Start = (Run->Previous >> 63) ? Run->TopStart : Base;
+		Run->bActive = TRUE;
+		Position = Bit;
+	}
+	if (Mask >> 63)
+	{
+		if (~Mask != 0)
+			Run->TopStart = Base + StringScan_HighestBit(~Mask) + 1;
+		else if (!(Run->Previous >> 63))
+			Run->TopStart = Base;
+	}
+	Run->Previous = Mask;
+	return n;
+}
+
+/* classify the next block and write the strings ending in it, at most STRING_MAX_PER_BLOCK */
+static DWORD StringScan_Block(PSTRING_CURSOR Cursor, PSTRING_ENTRY Out)
+{
+	const BYTE* Data = Cursor->Section.SectionData + Cursor->Offset;
+	SIZE_T Remaining = Cursor->Size - Cursor->Offset;
+	DWORD Base = (DWORD)Cursor->Offset;
+	BYTE Tail[STRING_BLOCK];
+	ULONGLONG Printable[2], Zeros[2], Chars[2];
+	ULONGLONG NextZero = 0;
+	DWORD n = 0;
+
+	if (Remaining >= STRING_BLOCK)
+	{
+		StringScan_Kernel(Data, Printable, Zeros);
+		if (Remaining > STRING_BLOCK)
+			NextZero = Data[STRING_BLOCK] == 0;
+	}
+	else
+	{
+		/* the null bytes of the padding aren't in the section: no UTF-16 character ends there */
+		memset(Tail, 0, sizeof(Tail));
+		memcpy(Tail, Data, Remaining);
+		StringScan_Kernel(Tail, Printable, Zeros);
+		if (Remaining < 64)
+		{
+			Zeros[0] &= ((ULONGLONG)1 << Remaining) - 1;
+			Zeros[1] = 0;
+		}
+		else
+			Zeros[1] &= ((ULONGLONG)1 << (Remaining - 64)) - 1;
+	}
+
+	if (Cursor->Flags & STRING_ASCII)
+	{
+		n += StringScan_Runs(Cursor, STRING_STREAM_ASCII, Printable[0], Base, Out + n);
+		n += StringScan_Runs(Cursor, STRING_STREAM_ASCII, Printable[1], Base + 64, Out + n);
+	}
+	if (Cursor->Flags & STRING_UTF16)
+	{
+		/* a character is a printable byte followed by a null byte, at an even or odd offset */
+		Chars[0] = Printable[0] & ((Zeros[0] >> 1) | (Zeros[1] << 63));
+		Chars[1] = Printable[1] & ((Zeros[1] >> 1) | (NextZero << 63));
+		n += StringScan_Runs(Cursor, STRING_STREAM_EVEN, StringScan_EvenBits(Chars[0]) | (ULONGLONG)StringScan_EvenBits(Chars[1]) << 32, Base / 2, Out + n);
+		n += StringScan_Runs(Cursor, STRING_STREAM_ODD, StringScan_EvenBits(Chars[0] >> 1) | (ULONGLONG)StringScan_EvenBits(Chars[1] >> 1) << 32, Base / 2, Out + n);
+	}
+
+	/* runs reaching the end of the section */
+	Cursor->Offset += STRING_BLOCK;
+	if (Cursor->Offset >= Cursor->Size)
+	{
+		for (DWORD Stream = STRING_STREAM_ASCII; Stream <= STRING_STREAM_ODD; Stream++)
+		{
+			PSTRING_RUN Run = &Cursor->Runs[Stream];
+			DWORD End = Stream == STRING_STREAM_ASCII ? (DWORD)Cursor->Offset : (DWORD)(Cursor->Offset / 2);
+			if (Run->bActive)
+				n += StringScan_Emit(Cursor, Stream, Run->Start, End - Run->Start, Out + n);
+			Run->bActive = FALSE;
+		}
+	}
+	return n;
+}
+
+DWORD PE32_GetStrings(PSTRING_CURSOR Cursor, PSTRING_ENTRY Entries, DWORD nMax)
+{
+	DWORD n = 0, nCopy;
+
+	while (n < nMax)
+	{
+		if (Cursor->iPending < Cursor->nPending)
+		{
+			nCopy = Cursor->nPending - Cursor->iPending;
+			if (nCopy > nMax - n)
+				nCopy = nMax - n;
+			memcpy(Entries + n, Cursor->Pending + Cursor->iPending, nCopy * sizeof(STRING_ENTRY));
+			Cursor->iPending += nCopy;
+			n += nCopy;
+			continue;
+		}
+		if (Cursor->Offset >= Cursor->Size)
+			break;
+		/* a block can't overflow the caller array: written in place, else kept in the cursor */
+		if (nMax - n >= STRING_MAX_PER_BLOCK)
+			n += StringScan_Block(Cursor, Entries + n);
+		else
+		{
+			Cursor->nPending = StringScan_Block(Cursor, Cursor->Pending);
+			Cursor->iPending = 0;
+		}
+	}
+	return n;
+}
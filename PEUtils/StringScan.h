@@ -0,0 +1,161 @@
+/**
+ * \file StringScan.h
+ * \brief Extraction of the ASCII and UTF-16LE strings of sections
+ * \author Tomtombinary
+ * \version 1.0
+ * \date 17 octobre 2026
+ * A section is read 128 bytes at a time: SSE2 or AVX2 compares turn each
+ * block into bit masks of printable bytes and of null bytes, a UTF-16LE
+ * character being a printable byte followed by a null byte (at an even or
+ * odd offset). Runs of at least MinLength characters are then found on the
+ * masks with shifts and bit scans, without looking at the bytes again.
+ * Strings are written in a caller array, chunk by chunk (see BulkEnum.h),
+ * as views of the image buffer: nothing is allocated per string.
+ * Strings equal to a name of the import or export table are flagged, the
+ * names being hashed once per image.
+ */
+
+#pragma once
+#include "stdafx.h"
+#include "PEUtils.h"
+
+#define STRING_DEFAULT_MIN_LENGTH 4
+
+/* kinds of strings extracted, flags of PE32_InitStringCursor */
+#define STRING_ASCII 0x1
+#define STRING_UTF16 0x2
+#define STRING_REFERENCES 0x4 /* look up each string in the names of the import and export tables */
+
+/* encoding of a STRING_ENTRY */
+#define STRING_ENCODING_ASCII 0
+#define STRING_ENCODING_UTF16 1
+
+/* names a string is equal to, STRING_ENTRY.References */
+#define STRING_REF_IMPORT 0x1 /* name of an imported function */
+#define STRING_REF_EXPORT 0x2 /* name of an exported function */
+#define STRING_REF_DLL 0x4    /* name of an imported DLL or of the image, case ignored */
+#define STRING_REF_TABLE 0x8  /* the string is the name stored in the table itself */
+
+#define STRING_NO_FILE_OFFSET 0xFFFFFFFF
+
+/* strings ending in one block of 128 bytes: at most 64 ASCII, 2 x 32 UTF-16 and 3 open at the end of the section */
+#define STRING_MAX_PER_BLOCK 136
+
+/**
+ * \struct STRING_ENTRY
+ * \brief a string found in a section
+ * Section: header of the section
+ * Data: first byte of the string in the image buffer (not null terminated)
+ * RVA: relative virtual address of the first byte
+ * FileOffset: offset of the first byte in the file, STRING_NO_FILE_OFFSET beyond the raw data of a loaded image
+ * Length: number of characters
+ * Encoding: STRING_ENCODING_ASCII or STRING_ENCODING_UTF16 (Length * 2 bytes)
+ * References: STRING_REF_* flags, 0 without STRING_REFERENCES
+ */
+typedef struct _STRING_ENTRY
+{
+	PIMAGE_SECTION_HEADER Section;
+	LPCVOID Data;
+	DWORD RVA;
+	DWORD FileOffset;
+	DWORD Length;
+	WORD Encoding;
+	WORD References;
+}STRING_ENTRY,*PSTRING_ENTRY;
+
+/**
+ * \struct STRING_NAME
+ * \brief a slot of the table of names
+ * Name, Length: name in the image buffer, NULL for an empty slot
+ * Hash: hash of the name, ASCII case ignored
+ * References: STRING_REF_IMPORT, STRING_REF_EXPORT and STRING_REF_DLL of the name
+ */
+typedef struct _STRING_NAME
+{
+	LPCSTR Name;
+	DWORD Length;
+	DWORD Hash;
+	DWORD References;
+}STRING_NAME,*PSTRING_NAME;
+
+/**
+ * \struct STRING_NAMES
+ * \brief names of the import and export tables of an image, open addressing
+ * MinLength, MaxLength: bounds of the lengths of the names, strings outside are not looked up
+ */
+typedef struct _STRING_NAMES
+{
+	PSTRING_NAME Slots;
+	DWORD Mask;
+	DWORD nNames;
+	DWORD MinLength;
+	DWORD MaxLength;
+}STRING_NAMES,*PSTRING_NAMES;
+
+/**
+ * \struct STRING_RUN
+ * \brief run of printable characters followed across the blocks, in one of the three streams (ASCII, UTF-16 at even and odd offsets)
+ * Previous: mask of the previous block
+ * Start: first character of the current run
+ * TopStart: first character of the run ending at the last bit of Previous
+ * bActive: a run long enough is open
+ */
+typedef struct _STRING_RUN
+{
+	ULONGLONG Previous;
+	DWORD Start;
+	DWORD TopStart;
+	BOOL bActive;
+}STRING_RUN,*PSTRING_RUN;
+
+/**
+ * \struct STRING_CURSOR
+ * \brief position in a section, initialized by PE32_InitStringCursor
+ * Pending: strings of the last block which didn't fit in the caller array
+ */
+typedef struct _STRING_CURSOR
+{
+	PPE_IMAGE Image;
+	SECTION_ENTRY Section;
+	SIZE_T Size;
+	SIZE_T Offset;
+	DWORD MinLength;
+	DWORD Flags;
+	PSTRING_NAMES Names;
+	STRING_RUN Runs[3];
+	DWORD nPending;
+	DWORD iPending;
+	STRING_ENTRY Pending[STRING_MAX_PER_BLOCK];
+}STRING_CURSOR,*PSTRING_CURSOR;
+
+/**
+ * \fn BOOL PE32_BuildStringNames(PPE_IMAGE Image);
+ * \brief hash the names of the import and export tables of an image (function names, imported DLLs, name of the image)
+ * PE32_InitStringCursor calls it for STRING_REFERENCES: call it before the image is shared between threads.
+ * \param Image: image description
+ * \return FALSE if memory couldn't be allocated
+ */
+BOOL PE32_BuildStringNames(PPE_IMAGE Image);
+
+/**
+ * \fn BOOL PE32_InitStringCursor(PPE_IMAGE Image, PSECTION_ENTRY Section, DWORD MinLength, DWORD Flags, PSTRING_CURSOR Cursor);
+ * \brief place a cursor on the first byte of a section
+ * \param Image: image description
+ * \param Section: section given by PE32_EnumSectionsEx
+ * \param MinLength: shortest string in characters, 0 for STRING_DEFAULT_MIN_LENGTH
+ * \param Flags: STRING_ASCII, STRING_UTF16 and STRING_REFERENCES
+ * \param Cursor: [out] cursor
+ * \return FALSE if the names couldn't be hashed for STRING_REFERENCES
+ */
+BOOL PE32_InitStringCursor(PPE_IMAGE Image, PSECTION_ENTRY Section, DWORD MinLength, DWORD Flags, PSTRING_CURSOR Cursor);
+
+/**
+ * \fn DWORD PE32_GetStrings(PSTRING_CURSOR Cursor, PSTRING_ENTRY Entries, DWORD nMax);
+ * \brief extract the next strings of a section, in the order of the blocks of the section (not sorted by RVA inside a block)
+ * Blocks are written in place while STRING_MAX_PER_BLOCK entries remain in the array, else through the cursor.
+ * \param Cursor: [in, out] position in the section
+ * \param Entries: [out] strings
+ * \param nMax: capacity of Entries
+ * \return number of strings extracted, 0 when the section has been drained
+ */
+DWORD PE32_GetStrings(PSTRING_CURSOR Cursor, PSTRING_ENTRY Entries, DWORD nMax);
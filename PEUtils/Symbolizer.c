@@ -0,0 +1,424 @@
+/**
+ * \file Symbolizer.c
+ * \brief Defines function described in file Symbolizer.h
+ * \author Tomtombinary
+ * \version 1.0
+ * \date 17 octobre 2026
+ */
+
+#include "stdafx.h"
+#include "Symbolizer.h"
+#include "ExportIndex.h"
+#include "PETraits.h"
+#include "MemUtils.h"
+#include "Validate.h"
+
+/**
+ * \struct SYMBOL_EXPORT
+ * \brief exported function collected before sorting
+ */
+typedef struct _SYMBOL_EXPORT
+{
+	DWORD RVA;
+	WORD Ordinal;
+	LPCSTR Name;
+}SYMBOL_EXPORT,*PSYMBOL_EXPORT;
+
+static int Symbolizer_CompareExports(const void* Left, const void* Right)
+{
+	const SYMBOL_EXPORT* a = (const SYMBOL_EXPORT*)Left;
+	const SYMBOL_EXPORT* b = (const SYMBOL_EXPORT*)Right;
+
+	if (a->RVA != b->RVA)
+		return a->RVA < b->RVA ? -1 : 1;
+	/* a named export is kept before the ordinals at the same address */
+	if ((a->Name == NULL) != (b->Name == NULL))
+		return a->Name != NULL ? -1 : 1;
+	return (int)a->Ordinal - (int)b->Ordinal;
+}
+
+static LPCSTR Symbolizer_CopyString(PMEM_ARENA Arena, LPCSTR String)
+{
+	SIZE_T Length = strlen(String);
+	PCHAR Copy = (PCHAR)MemArenaAlloc(Arena, Length + 1);
+
+	if (Copy != NULL)
+		memcpy(Copy, String, Length + 1);
+	return Copy;
+}
+
+/* remember the first name of each function, indexed by unbiased ordinal */
+static BOOL Symbolizer_CollectName(PEXPORT_ENTRY lpExportEntry, LPVOID UserArgs)
+{
+	LPCSTR* Names = (LPCSTR*)UserArgs;
+
+	if (Names[lpExportEntry->Ordinal] == NULL)
+		Names[lpExportEntry->Ordinal] = lpExportEntry->Name;
+	return TRUE;
+}
+
+/* sorted exported functions of the image, copied in the module arena */
+static BOOL Symbolizer_CopyExports(PSYMBOL_MODULE Module, PPE_IMAGE Image)
+{
+	PIMAGE_EXPORT_DIRECTORY Directory = (PIMAGE_EXPORT_DIRECTORY)Image->Directories[IMAGE_DIRECTORY_ENTRY_EXPORT].Data;
+	PSYMBOL_EXPORT Exports;
+	EXPORT_ENTRY Entry;
+	LPCSTR* Names;
+	DWORD nExports = 0;
+	BOOL bSuccess = FALSE;
+
+	if (Image->Directories[IMAGE_DIRECTORY_ENTRY_EXPORT].VirtualAddress == 0 || !PE32_IsTableSafe(Image, PE_TABLE_EXPORTS))
+		return TRUE;
+	if (Directory->NumberOfFunctions == 0)
+		return TRUE;
+	Names = (LPCSTR*)calloc(Directory->NumberOfFunctions, sizeof(LPCSTR));
+	Exports = (PSYMBOL_EXPORT)malloc(Directory->NumberOfFunctions * sizeof(SYMBOL_EXPORT));
+	if (Names == NULL || Exports == NULL)
+		goto Cleanup;
+
+	PE32_EnumExportsEx(Image, Symbolizer_CollectName, Names);
+	for (DWORD i = 0; i < Directory->NumberOfFunctions; i++)
+	{
+		/* forwarders have no code in this module */
+		if (!PE32_FindExportByOrdinal(Image, Directory->Base + i, &Entry) || Entry.Forwarder != NULL)
+			continue;
+		Exports[nExports].RVA = Entry.RVAFunction;
+		Exports[nExports].Ordinal = (WORD)(Directory->Base + i);
+		Exports[nExports].Name = Names[i];
+		nExports++;
+	}
+	qsort(Exports, nExports, sizeof(SYMBOL_EXPORT), Symbolizer_CompareExports);
+
+	Module->ExportRVAs = (PDWORD)MemArenaAlloc(&Module->Arena, nExports * sizeof(DWORD));
+	Module->ExportOrdinals = (PWORD)MemArenaAlloc(&Module->Arena, nExports * sizeof(WORD));
+	Module->ExportNames = (LPCSTR*)MemArenaAlloc(&Module->Arena, nExports * sizeof(LPCSTR));
+	if (Module->ExportRVAs == NULL || Module->ExportOrdinals == NULL || Module->ExportNames == NULL)
+		goto Cleanup;
+	for (DWORD i = 0; i < nExports; i++)
+	{
+		/* aliases: only the first export of an address is kept */
+		if (Module->nExports != 0 && Module->ExportRVAs[Module->nExports - 1] == Exports[i].RVA)
+			continue;
+		Module->ExportRVAs[Module->nExports] = Exports[i].RVA;
+		Module->ExportOrdinals[Module->nExports] = Exports[i].Ordinal;
+		Module->ExportNames[Module->nExports] = NULL;
+		if (Exports[i].Name != NULL)
+		{
+			Module->ExportNames[Module->nExports] = Symbolizer_CopyString(&Module->Arena, Exports[i].Name);
+			if (Module->ExportNames[Module->nExports] == NULL)
+				goto Cleanup;
+		}
+		Module->nExports++;
+	}
+	bSuccess = TRUE;
+
+Cleanup:
+	free(Names);
+	free(Exports);
+	return bSuccess;
+}
+
+/* copy the section index and the section table of the image */
+static BOOL Symbolizer_CopySections(PSYMBOL_MODULE Module, PPE_IMAGE Image)
+{
+	PSECTION_INDEX Index;
+
+	if (!PE32_BuildSectionIndex(Image))
+		return FALSE;
+	Index = Image->SectionIndex;
+	Module->Sections.nRanges = Index->nRanges;
+	Module->Sections.Starts = (PDWORD)MemArenaAlloc(&Module->Arena, Index->nRanges * sizeof(DWORD));
+	Module->Sections.Ranges = (PSECTION_RANGE)MemArenaAlloc(&Module->Arena, Index->nRanges * sizeof(SECTION_RANGE));
+	Module->SectionHeaders = (PIMAGE_SECTION_HEADER)MemArenaAlloc(&Module->Arena, Image->nSections * sizeof(IMAGE_SECTION_HEADER));
+	if (Module->Sections.Starts == NULL || Module->Sections.Ranges == NULL || Module->SectionHeaders == NULL)
+		return FALSE;
+	memcpy(Module->Sections.Starts, Index->Starts, Index->nRanges * sizeof(DWORD));
+	memcpy(Module->Sections.Ranges, Index->Ranges, Index->nRanges * sizeof(SECTION_RANGE));
+	memcpy(Module->SectionHeaders, Image->SectionHeaders, Image->nSections * sizeof(IMAGE_SECTION_HEADER));
+	return TRUE;
+}
+
+static PSYMBOL_MODULE Symbolizer_CreateModule(PPE_IMAGE Image, ULONGLONG Base, LPCSTR Name)
+{
+	PSYMBOL_MODULE Module;
+	PIMAGE_EXPORT_DIRECTORY Directory;
+
+	Module = (PSYMBOL_MODULE)calloc(1, sizeof(SYMBOL_MODULE));
+	if (Module == NULL)
+		return NULL;
+	if (Base == 0)
+		Base = Image->Layout == PE_LAYOUT_IMAGE ? (ULONGLONG)(ULONG_PTR)Image->Base : Image->Traits->GetImageBase(Image);
+	Module->Base = Base;
+	Module->Limit = Base + Image->NtHeaders->OptionalHeader.SizeOfImage;
+
+	if (Name == NULL)
+	{
+		Name = "";
+		Directory = (PIMAGE_EXPORT_DIRECTORY)Image->Directories[IMAGE_DIRECTORY_ENTRY_EXPORT].Data;
+		if (Directory != NULL && PE32_IsTableSafe(Image, PE_TABLE_EXPORTS) && PE32_RVAToPointer(Image, Directory->Name) != NULL)
+			Name = (LPCSTR)PE32_RVAToPointer(Image, Directory->Name);
+	}
+	Module->Name = Symbolizer_CopyString(&Module->Arena, Name);
+	if (Module->Name == NULL || !Symbolizer_CopySections(Module, Image) || !Symbolizer_CopyExports(Module, Image))
+	{
+		MemArenaRelease(&Module->Arena);
+		free(Module);
+		return NULL;
+	}
+	return Module;
+}
+
+/* index of the last base <= Address, (DWORD)-1 if there is none */
+static DWORD Symbolizer_Predecessor(PULONGLONG Bases, DWORD nBases, ULONGLONG Address)
+{
+	DWORD Low = 0, High = nBases, Middle;
+
+	while (Low < High)
+	{
+		Middle = (Low + High) / 2;
+		if (Bases[Middle] <= Address)
+			Low = Middle + 1;
+		else
+			High = Middle;
+	}
+	return Low - 1;
+}
+
+/* index of the last export at or before dwRVA, (DWORD)-1 if there is none */
+static DWORD Symbolizer_ExportPredecessor(PSYMBOL_MODULE Module, DWORD dwRVA)
+{
+	DWORD Low = 0, High = Module->nExports, Middle;
+
+	while (Low < High)
+	{
+		Middle = (Low + High) / 2;
+		if (Module->ExportRVAs[Middle] <= dwRVA)
+			Low = Middle + 1;
+		else
+			High = Middle;
+	}
+	return Low - 1;
+}
+
+static PSYMBOL_SNAPSHOT Symbolizer_AllocSnapshot(DWORD nModules)
+{
+	PSYMBOL_SNAPSHOT Snapshot;
+
+	Snapshot = (PSYMBOL_SNAPSHOT)malloc(sizeof(SYMBOL_SNAPSHOT) + nModules * (sizeof(ULONGLONG) + sizeof(PSYMBOL_MODULE)));
+	if (Snapshot == NULL)
+		return NULL;
+	Snapshot->nModules = nModules;
+	Snapshot->Bases = (PULONGLONG)(Snapshot + 1);
+	Snapshot->Modules = (PSYMBOL_MODULE*)(Snapshot->Bases + nModules);
+	Snapshot->NextRetired = NULL;
+	return Snapshot;
+}
+
+/* publish a snapshot, the previous one is kept until Symbolizer_Reclaim (called with the lock held) */
+static VOID Symbolizer_Publish(PSYMBOLIZER Symbolizer, PSYMBOL_SNAPSHOT Snapshot)
+{
+	PSYMBOL_SNAPSHOT Previous;
+
+	Previous = (PSYMBOL_SNAPSHOT)ThreadUtils_AtomicExchangePointer((LPVOID volatile*)&Symbolizer->Snapshot, Snapshot);
+	if (Previous != NULL)
+	{
+		Previous->NextRetired = Symbolizer->RetiredSnapshots;
+		Symbolizer->RetiredSnapshots = Previous;
+	}
+}
+
+VOID Symbolizer_Init(PSYMBOLIZER Symbolizer)
+{
+	memset(Symbolizer, 0, sizeof(SYMBOLIZER));
+	ThreadUtils_InitLock(&Symbolizer->Lock);
+	Symbolizer->Snapshot = Symbolizer_AllocSnapshot(0);
+}
+
+BOOL Symbolizer_AddModule(PSYMBOLIZER Symbolizer, PPE_IMAGE Image, ULONGLONG Base, LPCSTR Name)
+{
+	PSYMBOL_MODULE Module;
+	PSYMBOL_SNAPSHOT Current, Snapshot;
+	DWORD i;
+
+	if (Symbolizer->Snapshot == NULL)
+		return FALSE;
+	Module = Symbolizer_CreateModule(Image, Base, Name);
+	if (Module == NULL)
+		return FALSE;
+
+	ThreadUtils_Lock(&Symbolizer->Lock);
+	Current = Symbolizer->Snapshot;
+	/* insertion point: the module must end before the next one and start after the previous one */
+	i = Symbolizer_Predecessor(Current->Bases, Current->nModules, Module->Base) + 1;
+	if ((i != 0 && Current->Modules[i - 1]->Limit > Module->Base)
+		|| (i < Current->nModules && Module->Limit > Current->Bases[i])
+		|| (Snapshot = Symbolizer_AllocSnapshot(Current->nModules + 1)) == NULL)
+	{
+		ThreadUtils_Unlock(&Symbolizer->Lock);
+		MemArenaRelease(&Module->Arena);
+		free(Module);
+		return FALSE;
+	}
+	memcpy(Snapshot->Bases, Current->Bases, i * sizeof(ULONGLONG));
+	memcpy(Snapshot->Modules, Current->Modules, i * sizeof(PSYMBOL_MODULE));
+	Snapshot->Bases[i] = Module->Base;
+	Snapshot->Modules[i] = Module;
+	memcpy(Snapshot->Bases + i + 1, Current->Bases + i, (Current->nModules - i) * sizeof(ULONGLONG));
+	memcpy(Snapshot->Modules + i + 1, Current->Modules + i, (Current->nModules - i) * sizeof(PSYMBOL_MODULE));
+	Symbolizer_Publish(Symbolizer, Snapshot);
+	ThreadUtils_Unlock(&Symbolizer->Lock);
+	return TRUE;
+}
+
+BOOL Symbolizer_RemoveModule(PSYMBOLIZER Symbolizer, ULONGLONG Base)
+{
+	PSYMBOL_SNAPSHOT Current, Snapshot;
+	PSYMBOL_MODULE Module;
+	DWORD i;
+
+	if (Symbolizer->Snapshot == NULL)
+		return FALSE;
+	ThreadUtils_Lock(&Symbolizer->Lock);
+	Current = Symbolizer->Snapshot;
+	i = Symbolizer_Predecessor(Current->Bases, Current->nModules, Base);
+	if (i == (DWORD)-1 || Current->Bases[i] != Base || (Snapshot = Symbolizer_AllocSnapshot(Current->nModules - 1)) == NULL)
+	{
+		ThreadUtils_Unlock(&Symbolizer->Lock);
+		return FALSE;
+	}
+	Module = Current->Modules[i];
+	memcpy(Snapshot->Bases, Current->Bases, i * sizeof(ULONGLONG));
+	memcpy(Snapshot->Modules, Current->Modules, i * sizeof(PSYMBOL_MODULE));
+	memcpy(Snapshot->Bases + i, Current->Bases + i + 1, (Current->nModules - i - 1) * sizeof(ULONGLONG));
+	memcpy(Snapshot->Modules + i, Current->Modules + i + 1, (Current->nModules - i - 1) * sizeof(PSYMBOL_MODULE));
+	Symbolizer_Publish(Symbolizer, Snapshot);
+	Module->NextRetired = Symbolizer->RetiredModules;
+	Symbolizer->RetiredModules = Module;
+	ThreadUtils_Unlock(&Symbolizer->Lock);
+	return TRUE;
+}
+
+#ifdef _WIN32
+static BOOL Symbolizer_AddLoadedModule(PLDR_DATA_TABLE_ENTRY pLdrDataEntry, LPVOID UserArgs)
+{
+	PSYMBOLIZER Symbolizer = (PSYMBOLIZER)UserArgs;
+	PE_IMAGE Image;
+	BOOL bSuccess;
+	char Name[MAX_PATH];
+	LPCSTR BaseName;
+
+	if (pLdrDataEntry->DllBase == NULL || !PE32_InitImage(&Image, pLdrDataEntry->DllBase, 0, PE_LAYOUT_IMAGE))
+		return TRUE;
+	if (WideCharToMultiByte(CP_ACP, 0, pLdrDataEntry->FullDllName.Buffer, pLdrDataEntry->FullDllName.Length / sizeof(WCHAR), Name, sizeof(Name) - 1, NULL, NULL) == 0)
+		Name[0] = '\0';
+	else
+		Name[min(pLdrDataEntry->FullDllName.Length / sizeof(WCHAR), sizeof(Name) - 1)] = '\0';
+	BaseName = strrchr(Name, '\\');
+	BaseName = BaseName != NULL ? BaseName + 1 : Name;
+	bSuccess = Symbolizer_AddModule(Symbolizer, &Image, 0, BaseName[0] != '\0' ? BaseName : NULL);
+	PE32_CloseImage(&Image);
+	return bSuccess;
+}
+
+BOOL Symbolizer_AddLoadedModules(PSYMBOLIZER Symbolizer)
+{
+	return PEBUtils_EnumModules(Symbolizer_AddLoadedModule, Symbolizer);
+}
+#endif
+
+BOOL Symbolizer_Lookup(PSYMBOLIZER Symbolizer, ULONGLONG Address, PADDRESS_SYMBOL Symbol)
+{
+	PSYMBOL_SNAPSHOT Snapshot;
+	PSYMBOL_MODULE Module;
+	PSECTION_RANGE Range;
+	DWORD i, dwRVA, SectionStart = 0;
+
+	Snapshot = (PSYMBOL_SNAPSHOT)ThreadUtils_AtomicLoadPointer((LPVOID volatile*)&Symbolizer->Snapshot);
+	if (Snapshot == NULL)
+		return FALSE;
+	i = Symbolizer_Predecessor(Snapshot->Bases, Snapshot->nModules, Address);
+	if (i == (DWORD)-1 || Address >= Snapshot->Modules[i]->Limit)
+		return FALSE;
+	Module = Snapshot->Modules[i];
+	dwRVA = (DWORD)(Address - Module->Base);
+
+	Symbol->ModuleName = Module->Name;
+	Symbol->ModuleBase = Module->Base;
+	Symbol->RVA = dwRVA;
+	Symbol->Section = NULL;
+	Range = PE32_LookupSectionIndex(&Module->Sections, dwRVA);
+	if (Range != NULL)
+	{
+		Symbol->Section = &Module->SectionHeaders[Range->Section];
+		SectionStart = Module->Sections.Starts[Range - Module->Sections.Ranges];
+	}
+
+	/* an export of another section (or of the headers) isn't the function containing the address */
+	i = Symbolizer_ExportPredecessor(Module, dwRVA);
+	if (Range != NULL && i != (DWORD)-1 && Module->ExportRVAs[i] >= SectionStart)
+	{
+		Symbol->ExportName = Module->ExportNames[i];
+		Symbol->Ordinal = Module->ExportOrdinals[i];
+		Symbol->Offset = dwRVA - Module->ExportRVAs[i];
+	}
+	else
+	{
+		Symbol->ExportName = NULL;
+		Symbol->Ordinal = 0;
+		Symbol->Offset = dwRVA;
+	}
+	return TRUE;
+}
+
+int Symbolizer_Format(PADDRESS_SYMBOL Symbol, char* Buffer, size_t Size)
+{
+	if (Symbol->ModuleName[0] == '\0')
+		return snprintf(Buffer, Size, "0x%llx+0x%llx", (unsigned long long)Symbol->ModuleBase, (unsigned long long)Symbol->RVA);
+	if (Symbol->ExportName != NULL)
+		return snprintf(Buffer, Size, "%s!%s+0x%llx", Symbol->ModuleName, Symbol->ExportName, (unsigned long long)Symbol->Offset);
+	if (Symbol->Ordinal != 0)
+		return snprintf(Buffer, Size, "%s!#%u+0x%llx", Symbol->ModuleName, (unsigned int)Symbol->Ordinal, (unsigned long long)Symbol->Offset);
+	return snprintf(Buffer, Size, "%s+0x%llx", Symbol->ModuleName, (unsigned long long)Symbol->Offset);
+}
+
+VOID Symbolizer_Reclaim(PSYMBOLIZER Symbolizer)
+{
+	PSYMBOL_SNAPSHOT Snapshot, NextSnapshot;
+	PSYMBOL_MODULE Module, NextModule;
+
+	/* detached under the lock, released outside of it */
+	ThreadUtils_Lock(&Symbolizer->Lock);
+	Snapshot = Symbolizer->RetiredSnapshots;
+	Module = Symbolizer->RetiredModules;
+	Symbolizer->RetiredSnapshots = NULL;
+	Symbolizer->RetiredModules = NULL;
+	ThreadUtils_Unlock(&Symbolizer->Lock);
+
+	for (; Snapshot != NULL; Snapshot = NextSnapshot)
+	{
+		NextSnapshot = Snapshot->NextRetired;
+		free(Snapshot);
+	}
+	for (; Module != NULL; Module = NextModule)
+	{
+		NextModule = Module->NextRetired;
+		MemArenaRelease(&Module->Arena);
+		free(Module);
+	}
+}
+
+VOID Symbolizer_Release(PSYMBOLIZER Symbolizer)
+{
+	if (Symbolizer->Snapshot != NULL)
+	{
+		for (DWORD i = 0; i < Symbolizer->Snapshot->nModules; i++)
+		{
+			MemArenaRelease(&Symbolizer->Snapshot->Modules[i]->Arena);
+			free(Symbolizer->Snapshot->Modules[i]);
+		}
+		free(Symbolizer->Snapshot);
+	}
+	Symbolizer_Reclaim(Symbolizer);
+	ThreadUtils_DeleteLock(&Symbolizer->Lock);
+	memset(Symbolizer, 0, sizeof(SYMBOLIZER));
+}
@@ -0,0 +1,163 @@
+/**
+ * \file Symbolizer.h
+ * \brief Resolve addresses to module!export+offset over a set of images
+ * \author Tomtombinary
+ * \version 1.0
+ * \date 17 octobre 2026
+ * Modules are kept in a snapshot sorted by base address. Adding or removing
+ * a module builds a new snapshot under a lock and publishes it with an atomic
+ * exchange: lookups never wait, they search the snapshot they have read.
+ * Replaced snapshots and removed modules are kept, as a lookup may still
+ * read them: each add or remove retires a snapshot of the whole set (16 bytes
+ * per module) and a removed module keeps its copy of sections and exports.
+ * A process loading and unloading modules for a long time (emulator) calls
+ * Symbolizer_Reclaim where no lookup runs to release them, else they are
+ * released by Symbolizer_Release.
+ */
+
+#pragma once
+#include "stdafx.h"
+#include "PEUtils.h"
+#include "SectionIndex.h"
+#include "ThreadUtils.h"
+
+/**
+ * \struct SYMBOL_MODULE
+ * \brief a module of the symbolizer, copied from its image: the image can be closed once added
+ * Base, Limit: addresses [Base, Base + SizeOfImage) of the module
+ * Sections: section index, ranges point in SectionHeaders
+ * ExportRVAs: RVAs of the exported functions (forwarders excluded), sorted,
+ * with their biased ordinal and name (NULL for an export by ordinal only)
+ */
+typedef struct _SYMBOL_MODULE
+{
+	ULONGLONG Base;
+	ULONGLONG Limit;
+	LPCSTR Name;
+	SECTION_INDEX Sections;
+	PIMAGE_SECTION_HEADER SectionHeaders;
+	DWORD nExports;
+	PDWORD ExportRVAs;
+	PWORD ExportOrdinals;
+	LPCSTR* ExportNames;
+	MEM_ARENA Arena;
+	struct _SYMBOL_MODULE* NextRetired;
+}SYMBOL_MODULE,*PSYMBOL_MODULE;
+
+/**
+ * \struct SYMBOL_SNAPSHOT
+ * \brief modules sorted by base address, Bases kept in their own array for the binary search
+ */
+typedef struct _SYMBOL_SNAPSHOT
+{
+	DWORD nModules;
+	PULONGLONG Bases;
+	PSYMBOL_MODULE* Modules;
+	struct _SYMBOL_SNAPSHOT* NextRetired;
+}SYMBOL_SNAPSHOT,*PSYMBOL_SNAPSHOT;
+
+/**
+ * \struct SYMBOLIZER
+ * \brief set of modules, initialized by Symbolizer_Init
+ * Lock: serializes Symbolizer_AddModule and Symbolizer_RemoveModule
+ */
+typedef struct _SYMBOLIZER
+{
+	THREAD_LOCK Lock;
+	PSYMBOL_SNAPSHOT volatile Snapshot;
+	PSYMBOL_SNAPSHOT RetiredSnapshots;
+	PSYMBOL_MODULE RetiredModules;
+}SYMBOLIZER,*PSYMBOLIZER;
+
+/**
+ * \struct ADDRESS_SYMBOL
+ * \brief description of an address
+ * Section: section header of the address, NULL in the headers or between sections
+ * ExportName, Ordinal: nearest export at or before the address in the same section,
+ * ExportName is NULL for an export by ordinal only, Ordinal is 0 when there is no such export
+ * Offset: distance from the export, or from the module base when there is no export
+ */
+typedef struct _ADDRESS_SYMBOL
+{
+	LPCSTR ModuleName;
+	ULONGLONG ModuleBase;
+	DWORD RVA;
+	PIMAGE_SECTION_HEADER Section;
+	LPCSTR ExportName;
+	WORD Ordinal;
+	ULONGLONG Offset;
+}ADDRESS_SYMBOL,*PADDRESS_SYMBOL;
+
+/**
+ * \fn VOID Symbolizer_Init(PSYMBOLIZER Symbolizer);
+ * \brief initialize an empty symbolizer
+ * \param Symbolizer: symbolizer
+ */
+VOID Symbolizer_Init(PSYMBOLIZER Symbolizer);
+
+/**
+ * \fn BOOL Symbolizer_AddModule(PSYMBOLIZER Symbolizer, PPE_IMAGE Image, ULONGLONG Base, LPCSTR Name);
+ * \brief add a module, lookups running at the same time aren't blocked
+ * \param Symbolizer: symbolizer
+ * \param Image: image of the module (the section index of the image is built)
+ * \param Base: address of the module, 0 for the address of a loaded image or the ImageBase of a file
+ * \param Name: [optional] name of the module, NULL for the name of the export directory
+ * \return FALSE if the module overlaps another one or memory couldn't be allocated
+ */
+BOOL Symbolizer_AddModule(PSYMBOLIZER Symbolizer, PPE_IMAGE Image, ULONGLONG Base, LPCSTR Name);
+
+/**
+ * \fn BOOL Symbolizer_RemoveModule(PSYMBOLIZER Symbolizer, ULONGLONG Base);
+ * \brief remove a module, lookups running at the same time aren't blocked
+ * \param Symbolizer: symbolizer
+ * \param Base: base address of the module
+ * \return FALSE if there is no module at Base or memory couldn't be allocated
+ */
+BOOL Symbolizer_RemoveModule(PSYMBOLIZER Symbolizer, ULONGLONG Base);
+
+#ifdef _WIN32
+/**
+ * \fn BOOL Symbolizer_AddLoadedModules(PSYMBOLIZER Symbolizer);
+ * \brief add the modules loaded in the current process (PEBUtils_EnumModules)
+ * \param Symbolizer: symbolizer
+ * \return FALSE if a module couldn't be added
+ */
+BOOL Symbolizer_AddLoadedModules(PSYMBOLIZER Symbolizer);
+#endif
+
+/**
+ * \fn BOOL Symbolizer_Lookup(PSYMBOLIZER Symbolizer, ULONGLONG Address, PADDRESS_SYMBOL Symbol);
+ * \brief find the module, section and nearest export of an address
+ * Strings of the result stay valid until Symbolizer_Release, or Symbolizer_Reclaim once the module is removed.
+ * \param Symbolizer: symbolizer
+ * \param Address: virtual address
+ * \param Symbol: [out] description of the address
+ * \return FALSE if the address isn't in a module
+ */
+BOOL Symbolizer_Lookup(PSYMBOLIZER Symbolizer, ULONGLONG Address, PADDRESS_SYMBOL Symbol);
+
+/**
+ * \fn int Symbolizer_Format(PADDRESS_SYMBOL Symbol, char* Buffer, size_t Size);
+ * \brief write "module!export+0xoffset", "module!#ordinal+0xoffset" or "module+0xoffset"
+ * A module without name is written "0xbase+0xrva".
+ * \param Symbol: description given by Symbolizer_Lookup
+ * \param Buffer: [out] string
+ * \param Size: size of Buffer
+ * \return length of the string (as snprintf)
+ */
+int Symbolizer_Format(PADDRESS_SYMBOL Symbol, char* Buffer, size_t Size);
+
+/**
+ * \fn VOID Symbolizer_Reclaim(PSYMBOLIZER Symbolizer);
+ * \brief release the replaced snapshots and the removed modules, no lookup must be running
+ * Modules can be added and removed meanwhile. Strings of the results of removed modules are released.
+ * \param Symbolizer: symbolizer
+ */
+VOID Symbolizer_Reclaim(PSYMBOLIZER Symbolizer);
+
+/**
+ * \fn VOID Symbolizer_Release(PSYMBOLIZER Symbolizer);
+ * \brief release all modules and snapshots, no lookup must be running
+ * \param Symbolizer: symbolizer
+ */
+VOID Symbolizer_Release(PSYMBOLIZER Symbolizer);
@@ -0,0 +1,166 @@
+/**
+ * \file ThreadUtils.c
+ * \brief Defines function described in file ThreadUtils.h
+ * \author Tomtombinary
+ * \version 1.0
+ * \date 17 octobre 2026
+ */
+
+#include "stdafx.h"
+#include "ThreadUtils.h"
+
+#ifndef _WIN32
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+/* start routine signatures differ from ThreadRoutine, a small block carries the real one */
+typedef struct _THREAD_START
+{
+	ThreadRoutine Routine;
+	LPVOID UserArgs;
+}THREAD_START,*PTHREAD_START;
+
+#ifdef _WIN32
+static DWORD WINAPI ThreadUtils_Start(LPVOID lpParameter)
+#else
+static void* ThreadUtils_Start(void* lpParameter)
+#endif
+{
+	THREAD_START Start = *(PTHREAD_START)lpParameter;
+	free(lpParameter);
+	Start.Routine(Start.UserArgs);
+	return 0;
+}
+
+BOOL ThreadUtils_CreateThread(PTHREAD_HANDLE Thread, ThreadRoutine Routine, LPVOID UserArgs)
+{
+	PTHREAD_START Start = (PTHREAD_START)malloc(sizeof(THREAD_START));
+
+	if (Start == NULL)
+		return FALSE;
+	Start->Routine = Routine;
+	Start->UserArgs = UserArgs;
+#ifdef _WIN32
+	Thread->hThread = CreateThread(NULL, 0, ThreadUtils_Start, Start, 0, NULL);
+	if (Thread->hThread == NULL)
+#else
+	if (pthread_create(&Thread->Thread, NULL, ThreadUtils_Start, Start) != 0)
+#endif
+	{
+		free(Start);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+VOID ThreadUtils_JoinThread(PTHREAD_HANDLE Thread)
+{
+#ifdef _WIN32
+	WaitForSingleObject(Thread->hThread, INFINITE);
+	CloseHandle(Thread->hThread);
+#else
+	pthread_join(Thread->Thread, NULL);
+#endif
+}
+
+VOID ThreadUtils_Yield()
+{
+#ifdef _WIN32
+	SwitchToThread();
+#else
+	sched_yield();
+#endif
+}
+
+DWORD ThreadUtils_GetProcessorCount()
+{
+#ifdef _WIN32
+	SYSTEM_INFO SystemInfo;
+	GetSystemInfo(&SystemInfo);
+	return SystemInfo.dwNumberOfProcessors != 0 ? SystemInfo.dwNumberOfProcessors : 1;
+#else
+	long nProcessors = sysconf(_SC_NPROCESSORS_ONLN);
+	return nProcessors > 0 ? (DWORD)nProcessors : 1;
+#endif
+}
+
+ULONGLONG ThreadUtils_GetTime()
+{
+#ifdef _WIN32
+	LARGE_INTEGER Counter, Frequency;
+	QueryPerformanceCounter(&Counter);
+	QueryPerformanceFrequency(&Frequency);
+	return (ULONGLONG)(Counter.QuadPart / Frequency.QuadPart) * 1000000
+		+ (ULONGLONG)(Counter.QuadPart % Frequency.QuadPart) * 1000000 / Frequency.QuadPart;
+#else
+	struct timespec Now;
+	clock_gettime(CLOCK_MONOTONIC, &Now);
+	return (ULONGLONG)Now.tv_sec * 1000000 + (ULONGLONG)Now.tv_nsec / 1000;
+#endif
+}
+
+VOID ThreadUtils_InitLock(PTHREAD_LOCK Lock)
+{
+#ifdef _WIN32
+	InitializeCriticalSection(&Lock->Section);
+#else
+	pthread_mutex_init(&Lock->Mutex, NULL);
+#endif
+}
+
+VOID ThreadUtils_Lock(PTHREAD_LOCK Lock)
+{
+#ifdef _WIN32
+	EnterCriticalSection(&Lock->Section);
+#else
+	pthread_mutex_lock(&Lock->Mutex);
+#endif
+}
+
+VOID ThreadUtils_Unlock(PTHREAD_LOCK Lock)
+{
+#ifdef _WIN32
+	LeaveCriticalSection(&Lock->Section);
+#else
+	pthread_mutex_unlock(&Lock->Mutex);
+#endif
+}
+
+VOID ThreadUtils_DeleteLock(PTHREAD_LOCK Lock)
+{
+#ifdef _WIN32
+	DeleteCriticalSection(&Lock->Section);
+#else
+	pthread_mutex_destroy(&Lock->Mutex);
+#endif
+}
+
+LONG ThreadUtils_AtomicAdd(volatile LONG* Target, LONG Value)
+{
+#ifdef _WIN32
+	return InterlockedExchangeAdd(Target, Value) + Value;
+#else
+	return __atomic_add_fetch(Target, Value, __ATOMIC_SEQ_CST);
+#endif
+}
+
+LPVOID ThreadUtils_AtomicExchangePointer(LPVOID volatile* Target, LPVOID Value)
+{
+#ifdef _WIN32
+	return InterlockedExchangePointer(Target, Value);
+#else
+	return __atomic_exchange_n(Target, Value, __ATOMIC_SEQ_CST);
+#endif
+}
+
+LPVOID ThreadUtils_AtomicLoadPointer(LPVOID volatile* Target)
+{
+#ifdef _WIN32
+	/* volatile reads have acquire semantics with MSVC */
+	return *Target;
+#else
+	return __atomic_load_n(Target, __ATOMIC_ACQUIRE);
+#endif
+}
@@ -0,0 +1,124 @@
+/**
+ * \file ThreadUtils.h
+ * \brief Minimal portable threads, locks and atomics (Win32 or pthreads)
+ * \author Tomtombinary
+ * \version 1.0
+ * \date 17 octobre 2026
+ */
+
+#pragma once
+#include "stdafx.h"
+
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+/**
+ * \struct THREAD_HANDLE
+ * \brief thread created by ThreadUtils_CreateThread
+ */
+typedef struct _THREAD_HANDLE
+{
+#ifdef _WIN32
+	HANDLE hThread;
+#else
+	pthread_t Thread;
+#endif
+}THREAD_HANDLE,*PTHREAD_HANDLE;
+
+/**
+ * \struct THREAD_LOCK
+ * \brief mutual exclusion lock (CRITICAL_SECTION or pthread mutex)
+ */
+typedef struct _THREAD_LOCK
+{
+#ifdef _WIN32
+	CRITICAL_SECTION Section;
+#else
+	pthread_mutex_t Mutex;
+#endif
+}THREAD_LOCK,*PTHREAD_LOCK;
+
+/**
+ * Thread entry point for ThreadUtils_CreateThread
+ */
+typedef VOID(*ThreadRoutine)(LPVOID UserArgs);
+
+/**
+ * \fn BOOL ThreadUtils_CreateThread(PTHREAD_HANDLE Thread, ThreadRoutine Routine, LPVOID UserArgs);
+ * \brief start a thread
+ * \param Thread: [out] thread handle, must be released by ThreadUtils_JoinThread
+ * \param Routine: function executed by the thread
+ * \param UserArgs: [optional] argument of the function
+ * \return FALSE if the thread couldn't be created
+ */
+BOOL ThreadUtils_CreateThread(PTHREAD_HANDLE Thread, ThreadRoutine Routine, LPVOID UserArgs);
+
+/**
+ * \fn VOID ThreadUtils_JoinThread(PTHREAD_HANDLE Thread);
+ * \brief wait for the end of a thread and release its handle
+ */
+VOID ThreadUtils_JoinThread(PTHREAD_HANDLE Thread);
+
+/**
+ * \fn VOID ThreadUtils_Yield();
+ * \brief give the processor to another thread
+ */
+VOID ThreadUtils_Yield();
+
+/**
+ * \fn DWORD ThreadUtils_GetProcessorCount();
+ * \brief number of processors available to the process (at least 1)
+ */
+DWORD ThreadUtils_GetProcessorCount();
+
+/**
+ * \fn ULONGLONG ThreadUtils_GetTime();
+ * \brief monotonic clock, in microseconds
+ */
+ULONGLONG ThreadUtils_GetTime();
+
+/**
+ * \fn VOID ThreadUtils_InitLock(PTHREAD_LOCK Lock);
+ * \brief initialize a lock, it must be released by ThreadUtils_DeleteLock
+ */
+VOID ThreadUtils_InitLock(PTHREAD_LOCK Lock);
+
+/**
+ * \fn VOID ThreadUtils_Lock(PTHREAD_LOCK Lock);
+ * \brief acquire a lock, waiting for its owner to release it
+ */
+VOID ThreadUtils_Lock(PTHREAD_LOCK Lock);
+
+/**
+ * \fn VOID ThreadUtils_Unlock(PTHREAD_LOCK Lock);
+ * \brief release a lock acquired by ThreadUtils_Lock
+ */
+VOID ThreadUtils_Unlock(PTHREAD_LOCK Lock);
+
+/**
+ * \fn VOID ThreadUtils_DeleteLock(PTHREAD_LOCK Lock);
+ * \brief release the resources of a lock
+ */
+VOID ThreadUtils_DeleteLock(PTHREAD_LOCK Lock);
+
+/**
+ * \fn LONG ThreadUtils_AtomicAdd(volatile LONG* Target, LONG Value);
+ * \brief atomically add a value (full barrier)
+ * \return the new value of *Target
+ */
+LONG ThreadUtils_AtomicAdd(volatile LONG* Target, LONG Value);
+
+/**
+ * \fn LPVOID ThreadUtils_AtomicExchangePointer(LPVOID volatile* Target, LPVOID Value);
+ * \brief atomically replace a pointer (full barrier), to publish a structure filled before
+ * \return the previous value of *Target
+ */
+LPVOID ThreadUtils_AtomicExchangePointer(LPVOID volatile* Target, LPVOID Value);
+
+/**
+ * \fn LPVOID ThreadUtils_AtomicLoadPointer(LPVOID volatile* Target);
+ * \brief read a pointer published by ThreadUtils_AtomicExchangePointer (acquire barrier)
+ * \return the value of *Target
+ */
+LPVOID ThreadUtils_AtomicLoadPointer(LPVOID volatile* Target);
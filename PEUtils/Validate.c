@@ -0,0 +1,155 @@
+/**
+ * \file Validate.c
+ * \brief Defines function described in file Validate.h
+ * \author Tomtombinary
+ * \version 1.0
+ * \date 17 octobre 2026
+ */
+
+#include "stdafx.h"
+#include "Validate.h"
+#include "MemUtils.h"
+#include "PETraits.h"
+
+/* a string must be terminated before the end of the buffer */
+static BOOL Validate_String(PPE_IMAGE Image, LPCSTR String)
+{
+	if (String == NULL)
+		return FALSE;
+	return memchr(String, 0, Image->Size - ((PBYTE)String - Image->Base)) != NULL;
+}
+
+static BOOL Validate_Exports(PPE_IMAGE Image)
+{
+	PPE_DIRECTORY lpDirectory = &Image->Directories[IMAGE_DIRECTORY_ENTRY_EXPORT];
+	PIMAGE_EXPORT_DIRECTORY lpExportDirectory = (PIMAGE_EXPORT_DIRECTORY)lpDirectory->Data;
+	PDWORD lpAddressOfFunctions;
+	PDWORD lpAddressOfNames;
+	PWORD lpAddressOfNameOrdinals;
+
+	if (lpDirectory->VirtualAddress == 0)
+		return TRUE;
+	if (lpExportDirectory == NULL || lpDirectory->Size < sizeof(IMAGE_EXPORT_DIRECTORY))
+		return FALSE;
+
+	if (lpExportDirectory->NumberOfFunctions != 0)
+	{
+		lpAddressOfFunctions = (PDWORD)PE32_RVAToPointerRange(Image, lpExportDirectory->AddressOfFunctions, (ULONGLONG)lpExportDirectory->NumberOfFunctions * sizeof(DWORD));
+		if (lpAddressOfFunctions == NULL)
+			return FALSE;
+		/* forwarder strings */
+		for (DWORD i = 0; i < lpExportDirectory->NumberOfFunctions; i++)
+		{
+			if (lpAddressOfFunctions[i] - lpDirectory->VirtualAddress < lpDirectory->Size
+				&& !Validate_String(Image, (LPCSTR)PE32_RVAToPointer(Image, lpAddressOfFunctions[i])))
+				return FALSE;
+		}
+	}
+
+	if (lpExportDirectory->NumberOfNames != 0)
+	{
+		lpAddressOfNames = (PDWORD)PE32_RVAToPointerRange(Image, lpExportDirectory->AddressOfNames, (ULONGLONG)lpExportDirectory->NumberOfNames * sizeof(DWORD));
+		lpAddressOfNameOrdinals = (PWORD)PE32_RVAToPointerRange(Image, lpExportDirectory->AddressOfNameOrdinals, (ULONGLONG)lpExportDirectory->NumberOfNames * sizeof(WORD));
+		if (lpAddressOfNames == NULL || lpAddressOfNameOrdinals == NULL)
+			return FALSE;
+		for (DWORD i = 0; i < lpExportDirectory->NumberOfNames; i++)
+		{
+			if (lpAddressOfNameOrdinals[i] >= lpExportDirectory->NumberOfFunctions)
+				return FALSE;
+			if (!Validate_String(Image, (LPCSTR)PE32_RVAToPointer(Image, lpAddressOfNames[i])))
+				return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+DWORD PE32_CountThunks(PPE_IMAGE Image, LPVOID ThunkArray)
+{
+	return Image->Traits->CountThunks(Image, ThunkArray);
+}
+
+static BOOL Validate_Imports(PPE_IMAGE Image)
+{
+	PPE_DIRECTORY lpDirectory = &Image->Directories[IMAGE_DIRECTORY_ENTRY_IMPORT];
+	PIMAGE_IMPORT_DESCRIPTOR lpImportDesc = (PIMAGE_IMPORT_DESCRIPTOR)lpDirectory->Data;
+	PBYTE Limit;
+
+	if (lpDirectory->VirtualAddress == 0)
+		return TRUE;
+	if (lpImportDesc == NULL)
+		return FALSE;
+	Limit = (PBYTE)lpImportDesc + lpDirectory->Size;
+
+	for (; (PBYTE)(lpImportDesc + 1) <= Limit && !MemIsNull(lpImportDesc, sizeof(IMAGE_IMPORT_DESCRIPTOR)); lpImportDesc++)
+	{
+		if (!Validate_String(Image, (LPCSTR)PE32_RVAToPointer(Image, lpImportDesc->Name)))
+			return FALSE;
+		/* thunk arrays and names, 32 or 64 bits wide */
+		if (!Image->Traits->ValidateThunks(Image, lpImportDesc))
+			return FALSE;
+	}
+	return TRUE;
+}
+
+static BOOL Validate_Relocs(PPE_IMAGE Image)
+{
+	PPE_DIRECTORY lpDirectory = &Image->Directories[IMAGE_DIRECTORY_ENTRY_BASERELOC];
+	PIMAGE_BASE_RELOCATION BaseRelocation = (PIMAGE_BASE_RELOCATION)lpDirectory->Data;
+	PBYTE Limit;
+
+	if (lpDirectory->VirtualAddress == 0)
+		return TRUE;
+	if (BaseRelocation == NULL)
+		return FALSE;
+	Limit = (PBYTE)BaseRelocation + lpDirectory->Size;
+
+	/* a SizeOfBlock of 0 would loop forever, a big one would leave the directory */
+	while ((PBYTE)BaseRelocation + sizeof(IMAGE_BASE_RELOCATION) <= Limit && !MemIsNull(BaseRelocation, sizeof(IMAGE_BASE_RELOCATION)))
+	{
+		if (BaseRelocation->SizeOfBlock < sizeof(IMAGE_BASE_RELOCATION) || BaseRelocation->SizeOfBlock > (DWORD)(Limit - (PBYTE)BaseRelocation))
+			return FALSE;
+		BaseRelocation = (PIMAGE_BASE_RELOCATION)((PBYTE)BaseRelocation + BaseRelocation->SizeOfBlock);
+	}
+	return TRUE;
+}
+
+BOOL PE32_IsTableSafe(PPE_IMAGE Image, DWORD Table)
+{
+	BOOL bSafe;
+	DWORD dwError;
+
+	if (!(Image->CheckedTables & Table))
+	{
+		switch (Table)
+		{
+		case PE_TABLE_EXPORTS:
+			bSafe = Validate_Exports(Image);
+			dwError = PE_ERROR_EXPORT_DIRECTORY;
+			break;
+		case PE_TABLE_IMPORTS:
+			bSafe = Validate_Imports(Image);
+			dwError = PE_ERROR_IMPORT_DIRECTORY;
+			break;
+		case PE_TABLE_RELOCS:
+			bSafe = Validate_Relocs(Image);
+			dwError = PE_ERROR_RELOC_DIRECTORY;
+			break;
+		default:
+			return FALSE;
+		}
+		if (bSafe)
+			Image->SafeTables |= Table;
+		else if (Image->Error == PE_ERROR_SUCCESS)
+			Image->Error = dwError;
+		Image->CheckedTables |= Table;
+	}
+	return (Image->SafeTables & Table) != 0;
+}
+
+DWORD PE32_ValidateImage(PPE_IMAGE Image)
+{
+	PE32_IsTableSafe(Image, PE_TABLE_EXPORTS);
+	PE32_IsTableSafe(Image, PE_TABLE_IMPORTS);
+	PE32_IsTableSafe(Image, PE_TABLE_RELOCS);
+	return Image->Error;
+}
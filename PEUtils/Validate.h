@@ -0,0 +1,45 @@
+/**
+ * \file Validate.h
+ * \brief Validation of the tables of an image before walking them
+ * \author Tomtombinary
+ * \version 1.0
+ * \date 17 octobre 2026
+ * Each table is checked once against the size of the image buffer: every
+ * array, string and block it references must be inside the buffer. The
+ * enumerators only walk tables marked safe, without checking each element,
+ * and return FALSE for malformed ones instead of faulting.
+ */
+
+#pragma once
+#include "stdafx.h"
+#include "PEUtils.h"
+
+/**
+ * \fn DWORD PE32_ValidateImage(PPE_IMAGE Image);
+ * \brief validate all tables of an image not validated yet
+ * Tables are otherwise validated on first use: call this function before
+ * sharing an image between threads.
+ * \param Image: image description
+ * \return PE_ERROR_SUCCESS, or the PE_ERROR_* code of the first malformed table (also stored in Image->Error)
+ */
+DWORD PE32_ValidateImage(PPE_IMAGE Image);
+
+/**
+ * \fn BOOL PE32_IsTableSafe(PPE_IMAGE Image, DWORD Table);
+ * \brief validate a table if needed and tell if it can be walked without bounds checks
+ * An absent table is safe (nothing to walk).
+ * \param Image: image description
+ * \param Table: PE_TABLE_EXPORTS, PE_TABLE_IMPORTS or PE_TABLE_RELOCS
+ * \return FALSE if the table is malformed
+ */
+BOOL PE32_IsTableSafe(PPE_IMAGE Image, DWORD Table);
+
+/**
+ * \fn DWORD PE32_CountThunks(PPE_IMAGE Image, LPVOID ThunkArray);
+ * \brief count the entries of a thunk array before its null terminator (vectorized search)
+ * Thunks are DWORDs in a PE32 image and ULONGLONGs in a PE32+ image.
+ * \param Image: image description
+ * \param ThunkArray: pointer to the array inside the image
+ * \return number of entries, or the number of thunks left in the buffer if there is no terminator
+ */
+DWORD PE32_CountThunks(PPE_IMAGE Image, LPVOID ThunkArray);